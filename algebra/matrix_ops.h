@@ -32,6 +32,7 @@
 #include "jml/arch/simd_vector.h"
 #include "jml/utils/string_functions.h"
 #include "jml/arch/cache.h"
+#include "jml/arch/tile_tuning.h"
 
 namespace boost {
 
@@ -61,7 +62,7 @@ void copy_transposed(boost::multi_array<Float, 2> & A,
     size_t mem = (i1 - i0) * (j1 - j0) * sizeof(float);
 
     // Fits in memory (with some allowance for loss): copy directly
-    if (mem * 4 / 3 < l1_cache_size) {
+    if (mem * 4 / 3 < l1_cache_size()) {
         // 1.  Prefetch everything we need to access with non-unit stride
         //     in cache in order
         for (unsigned i = i0;  i < i1;  ++i)
@@ -100,7 +101,7 @@ void copy_lower_to_upper(boost::multi_array<Float, 2> & A,
     size_t mem = (i1 - i0) * (j1 - j0) * sizeof(float) / 2;
 
     // Fits in memory (with some allowance for loss): copy directly
-    if (mem * 4 / 3 < l1_cache_size) {
+    if (mem * 4 / 3 < l1_cache_size()) {
         // 1.  Prefetch everything in cache in order
         for (unsigned i = i0;  i < i1;  ++i)
             warmup_cache_all_levels(&A[i][j0], i - j0);
@@ -325,6 +326,63 @@ operator * (const boost::multi_array<Float1, 2> & A,
 /* MULTIPLY_TRANSPOSED                                                       */
 /*****************************************************************************/
 
+// Multiply A * transpose(A) into X, a tile of rows against a tile of rows
+// at a time so that both tiles stay in the cache.
+template<typename FloatR, typename Float>
+void multiply_transposed_tiled(const boost::multi_array<Float, 2> & A,
+                               boost::multi_array<FloatR, 2> & X,
+                               int tile)
+{
+    int As0 = A.shape()[0];
+    int As1 = A.shape()[1];
+
+    for (int i0 = 0;  i0 < As0;  i0 += tile) {
+        int i1 = std::min(As0, i0 + tile);
+        for (int j0 = 0;  j0 <= i0;  j0 += tile) {
+            for (int i = i0;  i < i1;  ++i) {
+                int j1 = std::min(i + 1, j0 + tile);
+                for (int j = j0;  j < j1;  ++j)
+                    X[i][j] = X[j][i]
+                        = SIMD::vec_dotprod_dp(&A[i][0], &A[j][0], As1);
+            }
+        }
+    }
+}
+
+// Multiply A * transpose(B) into X, tiled in the same way.
+template<typename FloatR, typename Float1, typename Float2>
+void multiply_transposed_tiled(const boost::multi_array<Float1, 2> & A,
+                               const boost::multi_array<Float2, 2> & BT,
+                               boost::multi_array<FloatR, 2> & X,
+                               int tile)
+{
+    int As0 = A.shape()[0];
+    int Bs0 = BT.shape()[0];
+    int As1 = A.shape()[1];
+
+    for (int i0 = 0;  i0 < As0;  i0 += tile) {
+        int i1 = std::min(As0, i0 + tile);
+        for (int j0 = 0;  j0 < Bs0;  j0 += tile) {
+            int j1 = std::min(Bs0, j0 + tile);
+            for (int i = i0;  i < i1;  ++i)
+                for (int j = j0;  j < j1;  ++j)
+                    X[i][j] = SIMD::vec_dotprod_dp(&A[i][0], &BT[j][0], As1);
+        }
+    }
+}
+
+// Number of rows in each tile, where each row of the tile takes up the
+// given number of bytes.  The tiles share the L2 cache.
+inline int multiply_transposed_tile(size_t row_bytes,
+                                    const std::function<void (size_t)> & run)
+{
+    size_t tile = cache_tile_items(row_bytes, l2_cache_size(), 4, 1024);
+    if (!tile_autotune_enabled()) return tile;
+    return tuned_tile_size(format("multiply_transposed/%d",
+                                  tile_size_class(row_bytes)),
+                           tile, tile_candidates(tile, 4, 1024), run);
+}
+
 // Multiply A * transpose(A)
 template<typename FloatR, typename Float>
 boost::multi_array<FloatR, 2>
@@ -334,9 +392,12 @@ multiply_transposed(const boost::multi_array<Float, 2> & A)
     int As1 = A.shape()[1];
 
     boost::multi_array<FloatR, 2> X(boost::extents[As0][As0]);
-    for (unsigned i = 0;  i < As0;  ++i) 
-        for (unsigned j = 0;  j <= i;  ++j)
-            X[i][j] = X[j][i] = SIMD::vec_dotprod_dp(&A[i][0], &A[j][0], As1);
+
+    int tile = multiply_transposed_tile
+        (2 * As1 * sizeof(Float),
+         [&] (size_t tile) { multiply_transposed_tiled(A, X, tile); });
+
+    multiply_transposed_tiled(A, X, tile);
     
     return X;
 }
@@ -354,10 +415,12 @@ multiply_transposed(const boost::multi_array<Float1, 2> & A,
         throw ML::Exception("Incompatible matrix sizes");
 
     boost::multi_array<FloatR, 2> X(boost::extents[As0][Bs0]);
-    for (unsigned j = 0;  j < Bs0;  ++j) {
-        for (unsigned i = 0;  i < As0;  ++i)
-            X[i][j] = SIMD::vec_dotprod_dp(&A[i][0], &BT[j][0], As1);
-    }
+
+    int tile = multiply_transposed_tile
+        (As1 * (sizeof(Float1) + sizeof(Float2)),
+         [&] (size_t tile) { multiply_transposed_tiled(A, BT, X, tile); });
+
+    multiply_transposed_tiled(A, BT, X, tile);
 
     return X;
 }
@@ -1,2 +1,3 @@
 $(eval $(call test,least_squares_test,algebra utils arch worker_task,boost))
 $(eval $(call test,remove_dependent_test,algebra,boost))
+$(eval $(call test,matrix_ops_test,algebra utils arch,boost))
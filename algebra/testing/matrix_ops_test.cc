@@ -0,0 +1,70 @@
+/* matrix_ops_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the cache-blocked matrix operations.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+
+#include "jml/algebra/matrix_ops.h"
+#include "jml/utils/rng.h"
+
+using namespace ML;
+using namespace std;
+
+boost::multi_array<float, 2> random_matrix(int rows, int cols, int seed)
+{
+    RNG rng(seed);
+    boost::multi_array<float, 2> result(boost::extents[rows][cols]);
+    for (int i = 0;  i < rows;  ++i)
+        for (int j = 0;  j < cols;  ++j)
+            result[i][j] = rng.random01() - 0.5;
+    return result;
+}
+
+/* The tiles only change the order in which the entries are calculated,
+   so the results must be identical to the untiled product whatever the
+   tile size. */
+BOOST_AUTO_TEST_CASE( test_multiply_transposed_tiles )
+{
+    boost::multi_array<float, 2> A = random_matrix(37, 19, 1);
+    boost::multi_array<float, 2> B = random_matrix(23, 19, 2);
+
+    boost::multi_array<double, 2> AAT_expected(boost::extents[37][37]);
+    boost::multi_array<double, 2> ABT_expected(boost::extents[37][23]);
+    for (int i = 0;  i < 37;  ++i) {
+        for (int j = 0;  j < 37;  ++j)
+            AAT_expected[i][j] = SIMD::vec_dotprod_dp(&A[i][0], &A[j][0], 19);
+        for (int j = 0;  j < 23;  ++j)
+            ABT_expected[i][j] = SIMD::vec_dotprod_dp(&A[i][0], &B[j][0], 19);
+    }
+
+    int tiles[] = { 1, 4, 7, 16, 37, 100 };
+
+    for (unsigned t = 0;  t < 6;  ++t) {
+        BOOST_TEST_CHECKPOINT("tile " << tiles[t]);
+
+        boost::multi_array<double, 2> AAT(boost::extents[37][37]);
+        multiply_transposed_tiled(A, AAT, tiles[t]);
+        BOOST_CHECK(AAT == AAT_expected);
+
+        boost::multi_array<double, 2> ABT(boost::extents[37][23]);
+        multiply_transposed_tiled(A, B, ABT, tiles[t]);
+        BOOST_CHECK(ABT == ABT_expected);
+    }
+
+    /* Float times float gives a float result. */
+    boost::multi_array<float, 2> AAT = multiply_transposed(A, A);
+    boost::multi_array<float, 2> ABT = multiply_transposed(A, B);
+    for (int i = 0;  i < 37;  ++i) {
+        for (int j = 0;  j < 37;  ++j)
+            BOOST_CHECK_EQUAL(AAT[i][j], (float)AAT_expected[i][j]);
+        for (int j = 0;  j < 23;  ++j)
+            BOOST_CHECK_EQUAL(ABT[i][j], (float)ABT_expected[i][j]);
+    }
+}
@@ -11,6 +11,8 @@ LIBARCH_SOURCES := \
 	gpgpu.cc \
 	environment_static.cc \
 	cpu_info.cc \
+	numa.cc \
+	tile_tuning.cc \
 	vm.cc \
 	info.cc \
 	rtti_utils.cc \
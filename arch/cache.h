@@ -9,29 +9,57 @@
 #define __jml__arch__cache_h__
 
 #include "sse2.h"
+#include "cpuid.h"
 #include "jml/compiler/compiler.h"
+#include <algorithm>
 
 namespace ML {
 
-static const size_t l1_cache_size = 32 * 1024;
+/** Size of the L1 data cache, in bytes. */
+inline size_t l1_cache_size()
+{
+    return cache_info().l1_size;
+}
+
+/** Size of the L2 cache in bytes; if there isn't one, we pretend that it's
+    eight times the L1 cache. */
+inline size_t l2_cache_size()
+{
+    const Cache_Info & info = cache_info();
+    return info.l2_size ? info.l2_size : info.l1_size * 8;
+}
 
+inline int cache_line_size()
+{
+    return cache_info().line_size;
+}
+
+/** How many items of the given size to put in a tile so that it takes up
+    about half of a cache of the given size, leaving the rest for whatever
+    else the loop touches.  Clamped to [min_items, max_items]. */
+inline size_t cache_tile_items(size_t item_bytes, size_t cache_bytes,
+                               size_t min_items, size_t max_items)
+{
+    size_t result = cache_bytes / 2 / std::max<size_t>(item_bytes, 1);
+    return std::max(min_items, std::min(max_items, result));
+}
 
 inline void warmup_cache_all_levels(const float * mem, size_t n)
 {
-    // TODO: assumes 64 byte cache lines
     // TODO: prefetch?
-    float total JML_UNUSED = 0.0;
-    for (unsigned i = 0;  i < n;  i += 16)
-        total += mem[n];
+    size_t step = std::max<size_t>(cache_line_size() / sizeof(float), 1);
+    volatile float total JML_UNUSED = 0.0;
+    for (size_t i = 0;  i < n;  i += step)
+        total += mem[i];
 }
 
 inline void warmup_cache_all_levels(const double * mem, size_t n)
 {
-    // TODO: assumes 64 byte cache lines
     // TODO: prefetch?
-    double total JML_UNUSED = 0.0;
-    for (unsigned i = 0;  i < n;  i += 8)
-        total += mem[n];
+    size_t step = std::max<size_t>(cache_line_size() / sizeof(double), 1);
+    volatile double total JML_UNUSED = 0.0;
+    for (size_t i = 0;  i < n;  i += step)
+        total += mem[i];
 }
 
 inline void store_non_temporal(float & addr, float val)
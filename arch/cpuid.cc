@@ -8,8 +8,11 @@
 #include "simd.h"
 #include <boost/tuple/tuple.hpp>
 #include "jml/arch/exception.h"
+#include "jml/arch/format.h"
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <stdlib.h>
 
 using namespace std;
 
@@ -239,4 +242,145 @@ CPU_Info * static_cpu_info = 0;
 
 #endif // __i686__
 
+
+/*****************************************************************************/
+/* CACHE_INFO                                                                */
+/*****************************************************************************/
+
+namespace {
+
+/* Parse a sysfs cache size like "32K" or "8M" into bytes. */
+size_t parse_cache_size(const std::string & str)
+{
+    char * end;
+    size_t result = strtoul(str.c_str(), &end, 10);
+    switch (*end) {
+    case 'K': return result * 1024;
+    case 'M': return result * 1024 * 1024;
+    case 'G': return result * 1024 * 1024 * 1024;
+    default:  return result;
+    }
+}
+
+std::string read_line(const std::string & filename)
+{
+    ifstream stream(filename.c_str());
+    std::string result;
+    getline(stream, result);
+    return result;
+}
+
+} // file scope
+
+Cache_Info::
+Cache_Info()
+    : l1_size(32 * 1024), l2_size(0), l3_size(0), line_size(64),
+      source("default")
+{
+    if (!read_sysfs())
+        read_cpuid();
+}
+
+bool
+Cache_Info::
+read_sysfs(const std::string & dir)
+{
+    bool found = false;
+
+    for (unsigned i = 0;  ;  ++i) {
+        std::string index = dir + format("/index%d/", i);
+
+        std::string level = read_line(index + "level");
+        if (level.empty()) break;
+
+        std::string type = read_line(index + "type");
+        if (type != "Data" && type != "Unified") continue;
+
+        size_t size = parse_cache_size(read_line(index + "size"));
+        if (size == 0) continue;
+
+        int line = atoi(read_line(index + "coherency_line_size").c_str());
+
+        switch (atoi(level.c_str())) {
+        case 1:
+            l1_size = size;
+            if (line > 0) line_size = line;
+            break;
+        case 2: l2_size = size;  break;
+        case 3: l3_size = size;  break;
+        default: continue;
+        }
+
+        found = true;
+    }
+
+    if (found) source = "sysfs";
+    return found;
+}
+
+bool
+Cache_Info::
+read_cpuid()
+{
+#if defined __i686__ || defined __amd64__
+    uint32_t level = cpuid(CPUID_LEVEL).eax;
+    uint32_t extlevel = cpuid(CPUID_EXT_LEVEL).eax;
+    if (extlevel < 0x80000000 || extlevel > 0x8000ffff)
+        extlevel = 0;
+
+    bool found = false;
+
+    if (vendor_id() == "GenuineIntel" && level >= CPUID_EXT_CACHE_INFO) {
+        /* Deterministic cache parameters: one subleaf per cache. */
+        for (unsigned i = 0;  i < 16;  ++i) {
+            Regs r = cpuid(CPUID_EXT_CACHE_INFO, i);
+            int type = r.eax & 31;
+            if (type == 0) break;              // no more caches
+            if (type == 2) continue;           // instruction cache
+
+            int cache_level = (r.eax >> 5) & 7;
+            size_t ways = (r.ebx >> 22) + 1;
+            size_t partitions = ((r.ebx >> 12) & 0x3ff) + 1;
+            size_t line = (r.ebx & 0xfff) + 1;
+            size_t sets = r.ecx + 1;
+            size_t size = ways * partitions * line * sets;
+
+            if (cache_level == 1) { l1_size = size;  line_size = line; }
+            else if (cache_level == 2) l2_size = size;
+            else if (cache_level == 3) l3_size = size;
+            found = true;
+        }
+    }
+    else if (extlevel >= CPUID_EXT_L2CACHE) {
+        /* AMD style: sizes in kb straight from the extended leaves. */
+        Regs l1 = cpuid(CPUID_EXT_L1CACHE);
+        Regs l2 = cpuid(CPUID_EXT_L2CACHE);
+
+        if (l1.ecx >> 24) {
+            l1_size = (l1.ecx >> 24) * 1024;
+            line_size = l1.ecx & 0xff;
+            found = true;
+        }
+        l2_size = (l2.ecx >> 16) * 1024;
+        l3_size = (size_t)(l2.edx >> 18) * 512 * 1024;
+        found = found || l2_size;
+    }
+
+    if (found) source = "cpuid";
+    return found;
+#else
+    return false;
+#endif
+}
+
+std::string
+Cache_Info::
+print() const
+{
+    return format("l1=%zd l2=%zd l3=%zd line=%d (%s)",
+                  l1_size, l2_size, l3_size, line_size, source.c_str());
+}
+
+Cache_Info * static_cache_info = 0;
+
 } // namespace ML
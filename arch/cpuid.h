@@ -161,6 +161,48 @@ std::string model_id();
 
 #endif // __i686__
 
+
+/*****************************************************************************/
+/* CACHE_INFO                                                                */
+/*****************************************************************************/
+
+/** Sizes of the data caches of the CPU we're running on, for sizing the
+    tiles of cache-blocked loops.  They are read from sysfs if it's there
+    (which is also right under most hypervisors), otherwise from cpuid.
+    A cache level that can't be found has a size of 0, except for the L1
+    cache and line size which default to 32kb and 64 bytes.
+*/
+
+struct Cache_Info {
+    Cache_Info();
+
+    size_t l1_size;       ///< L1 data cache, in bytes
+    size_t l2_size;       ///< L2 cache, in bytes
+    size_t l3_size;       ///< L3 cache, in bytes (shared between cores)
+    int line_size;        ///< Cache line size, in bytes
+    std::string source;   ///< Where it came from: sysfs, cpuid or default
+
+    /** Read the sizes from the given sysfs cache directory.  Returns false
+        if there was nothing there. */
+    bool read_sysfs(const std::string & dir
+                        = "/sys/devices/system/cpu/cpu0/cache");
+
+    /** Read the sizes using the cpuid instruction.  Returns false if the
+        CPU doesn't tell us. */
+    bool read_cpuid();
+
+    std::string print() const;
+};
+
+extern Cache_Info * static_cache_info;
+
+JML_ALWAYS_INLINE const Cache_Info & cache_info()
+{
+    if (JML_UNLIKELY(!static_cache_info))
+        static_cache_info = new Cache_Info;
+    return *static_cache_info;
+}
+
 } // namespace ML
 
 #endif /* __arch__cpuid_h__ */
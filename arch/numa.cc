@@ -0,0 +1,269 @@
+/* numa.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   NUMA topology detection and placement.  We talk to the kernel directly
+   (sysfs and the move_pages system call) rather than depending on libnuma.
+*/
+
+#include "numa.h"
+#include "cpu_info.h"
+#include "vm.h"
+#include "exception.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <dirent.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+
+using namespace std;
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* NUMA_TOPOLOGY                                                             */
+/*****************************************************************************/
+
+int
+Numa_Topology::
+node_of_cpu(int cpu) const
+{
+    if (cpu < 0 || cpu >= cpu_nodes.size() || cpu_nodes[cpu] == -1)
+        return 0;
+    return cpu_nodes[cpu];
+}
+
+vector<int> parse_cpu_list(const string & list)
+{
+    vector<int> result;
+
+    const char * p = list.c_str();
+    while (*p) {
+        while (*p == ',' || isspace(*p)) ++p;
+        if (!*p) break;
+
+        char * e;
+        long first = strtol(p, &e, 10);
+        if (e == p)
+            throw Exception("parse_cpu_list(): invalid CPU list '%s'",
+                            list.c_str());
+        p = e;
+
+        long last = first;
+        if (*p == '-') {
+            ++p;
+            last = strtol(p, &e, 10);
+            if (e == p || last < first)
+                throw Exception("parse_cpu_list(): invalid CPU list '%s'",
+                                list.c_str());
+            p = e;
+        }
+
+        for (long cpu = first;  cpu <= last;  ++cpu)
+            result.push_back(cpu);
+    }
+
+    return result;
+}
+
+Numa_Topology
+Numa_Topology::
+detect(const std::string & sysfs_dir)
+{
+    Numa_Topology result;
+
+    DIR * dir = opendir(sysfs_dir.c_str());
+    if (dir) {
+        vector<int> ids;
+        while (dirent * entry = readdir(dir)) {
+            string name = entry->d_name;
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0
+                || name.find_first_not_of("0123456789", 4) != string::npos)
+                continue;
+            ids.push_back(atoi(name.c_str() + 4));
+        }
+        closedir(dir);
+
+        std::sort(ids.begin(), ids.end());
+
+        for (unsigned i = 0;  i < ids.size();  ++i) {
+            ifstream stream(sysfs_dir + "/node" + to_string(ids[i])
+                            + "/cpulist");
+            string line;
+            getline(stream, line);
+
+            Node node;
+            node.id = ids[i];
+            node.cpus = parse_cpu_list(line);
+
+            /* Memory-only nodes have no CPUs to run threads on. */
+            if (node.cpus.empty()) continue;
+
+            result.nodes.push_back(node);
+        }
+    }
+
+    if (result.nodes.empty()) {
+        Node node;
+        node.id = 0;
+        for (int i = 0;  i < num_cpus();  ++i)
+            node.cpus.push_back(i);
+        result.nodes.push_back(node);
+    }
+
+    for (unsigned i = 0;  i < result.nodes.size();  ++i) {
+        const vector<int> & cpus = result.nodes[i].cpus;
+        for (unsigned j = 0;  j < cpus.size();  ++j) {
+            if (cpus[j] >= result.cpu_nodes.size())
+                result.cpu_nodes.resize(cpus[j] + 1, -1);
+            result.cpu_nodes[cpus[j]] = i;
+        }
+    }
+
+    return result;
+}
+
+const Numa_Topology & numa_topology()
+{
+    static const Numa_Topology result = Numa_Topology::detect();
+    return result;
+}
+
+int numa_nodes()
+{
+    static const int result = numa_topology().node_count();
+    return result;
+}
+
+int numa_current_node()
+{
+    if (numa_nodes() == 1) return 0;
+    return numa_topology().node_of_cpu(sched_getcpu());
+}
+
+bool numa_pin_thread(int node)
+{
+    const Numa_Topology & topology = numa_topology();
+    if (node < 0 || node >= topology.node_count())
+        throw Exception("numa_pin_thread(): invalid node %d", node);
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu: topology.nodes[node].cpus)
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+
+/*****************************************************************************/
+/* MEMORY PLACEMENT                                                          */
+/*****************************************************************************/
+
+namespace {
+
+/* Flag for move_pages; from <numaif.h>, which we don't want to depend on. */
+enum { JML_MPOL_MF_MOVE = 1 << 1 };
+
+bool placement_enabled()
+{
+    const char * env = getenv("JML_NUMA_PLACEMENT");
+    return !env || atoi(env) != 0;
+}
+
+/* Ask the kernel to move the pages.  Returns false if move_pages isn't
+   available; otherwise the per-page status is filled in. */
+bool move_pages(vector<void *> & pages, vector<int> & nodes,
+                vector<int> & status)
+{
+#ifdef SYS_move_pages
+    enum { BATCH = 1024 };
+
+    status.resize(pages.size());
+
+    for (size_t i = 0;  i < pages.size();  i += BATCH) {
+        size_t n = std::min<size_t>(BATCH, pages.size() - i);
+        long res = syscall(SYS_move_pages, 0 /* this process */, n,
+                           &pages[i], &nodes[i], &status[i],
+                           JML_MPOL_MF_MOVE);
+        if (res < 0) return false;
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // file scope
+
+void numa_place(const void * data, size_t bytes, Numa_Placement placement)
+{
+    static const bool enabled = placement_enabled();
+
+    int nnodes = numa_nodes();
+    if (placement == NUMA_LOCAL || nnodes == 1 || !enabled) return;
+
+    size_t start = ((size_t)data + page_size - 1) & page_num_mask;
+    size_t end = ((size_t)data + bytes) & page_num_mask;
+    if (end <= start) return;
+
+    size_t npages = (end - start) / page_size;
+
+    const Numa_Topology & topology = numa_topology();
+
+    vector<void *> pages(npages);
+    vector<int> nodes(npages);
+    for (size_t i = 0;  i < npages;  ++i) {
+        pages[i] = (void *)(start + i * page_size);
+        int node = (placement == NUMA_INTERLEAVED
+                    ? i % nnodes
+                    : numa_partition_node(i, npages, nnodes));
+        nodes[i] = topology.nodes[node].id;
+    }
+
+    vector<int> status;
+    bool moved = move_pages(pages, nodes, status);
+
+    /* Pages that have never been touched aren't moved; we place them by
+       touching them from a thread running on their node.  The same goes
+       for all pages if we couldn't move them, which at least places the
+       untouched ones. */
+    vector<vector<char *> > to_touch(nnodes);
+    for (size_t i = 0;  i < npages;  ++i) {
+        if (moved && status[i] != -ENOENT) continue;
+        int node = (placement == NUMA_INTERLEAVED
+                    ? i % nnodes
+                    : numa_partition_node(i, npages, nnodes));
+        to_touch[node].push_back((char *)pages[i]);
+    }
+
+    vector<std::thread> threads;
+    for (int node = 0;  node < nnodes;  ++node) {
+        if (to_touch[node].empty()) continue;
+        const vector<char *> & touch = to_touch[node];
+        threads.emplace_back([node, &touch] ()
+            {
+                numa_pin_thread(node);
+                for (char * p: touch) {
+                    volatile char * v = p;
+                    *v = *v;
+                }
+            });
+    }
+
+    for (auto & t: threads)
+        t.join();
+}
+
+} // namespace ML
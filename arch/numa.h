@@ -0,0 +1,114 @@
+/* numa.h                                                          -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   NUMA topology, thread placement and memory placement.  Everything here
+   degrades to a single node (and does nothing) on machines, kernels or
+   containers that don't expose a NUMA topology.
+*/
+
+#ifndef __jml__arch__numa_h__
+#define __jml__arch__numa_h__
+
+#include <vector>
+#include <string>
+#include <stddef.h>
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* NUMA_TOPOLOGY                                                             */
+/*****************************************************************************/
+
+/** Which CPUs are attached to which memory node.  Nodes are referred to by
+    their index here, which is not necessarily the same as the kernel's
+    node number (those can be sparse).
+*/
+
+struct Numa_Topology {
+    struct Node {
+        int id;                  ///< Kernel's number for the node
+        std::vector<int> cpus;   ///< CPUs attached to the node
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> cpu_nodes;  ///< Node index of each CPU, or -1
+
+    int node_count() const { return nodes.size(); }
+
+    /** Node index of the given CPU, or 0 if it's not known. */
+    int node_of_cpu(int cpu) const;
+
+    /** Read the topology from the given sysfs node directory.  If it's
+        not there, a single node with num_cpus() CPUs is returned. */
+    static Numa_Topology
+    detect(const std::string & sysfs_dir = "/sys/devices/system/node");
+};
+
+/** Parse a kernel CPU list like "0-3,8,10-11". */
+std::vector<int> parse_cpu_list(const std::string & list);
+
+/** The topology of this machine; detected once. */
+const Numa_Topology & numa_topology();
+
+/** Number of NUMA nodes on this machine; 1 if it isn't NUMA. */
+int numa_nodes();
+
+/** Node index of the CPU that the calling thread is currently running on. */
+int numa_current_node();
+
+/** Restrict the calling thread to the CPUs of the given node.  Returns
+    false if the affinity couldn't be set. */
+bool numa_pin_thread(int node);
+
+/** Node that owns element i of n when they are split into one contiguous
+    block per node.  Jobs over ranges of examples can use this as a hint
+    to run where the NUMA_PARTITIONED data for those examples lives. */
+inline int numa_partition_node(size_t i, size_t n, int nodes = numa_nodes())
+{
+    if (n == 0 || nodes <= 1) return 0;
+    return (i * nodes) / n;
+}
+
+
+/*****************************************************************************/
+/* MEMORY PLACEMENT                                                          */
+/*****************************************************************************/
+
+enum Numa_Placement {
+    NUMA_LOCAL,         ///< Leave the pages where they are
+    NUMA_INTERLEAVED,   ///< Pages are spread round-robin over the nodes
+    NUMA_PARTITIONED    ///< One contiguous block of pages per node
+};
+
+/** Place the pages of the given memory region onto the nodes according to
+    the placement.  Pages that have already been touched are migrated;
+    pages that haven't are first-touched from a thread on their node.
+
+    Only whole pages within the region are moved, so that neighbouring
+    allocations are left alone.  It must not be called while other
+    threads are writing to the region.  Does nothing on a single node
+    machine or if the JML_NUMA_PLACEMENT environment variable is 0.
+*/
+void numa_place(const void * data, size_t bytes, Numa_Placement placement);
+
+/** Place a contiguous container, such as a vector or a multi_array. */
+template<class Container>
+void numa_place_array(const Container & c, Numa_Placement placement)
+{
+    if (c.num_elements() == 0) return;
+    numa_place(c.data(), c.num_elements() * sizeof(*c.data()), placement);
+}
+
+template<typename T, class A>
+void numa_place_array(const std::vector<T, A> & v, Numa_Placement placement)
+{
+    if (v.empty()) return;
+    numa_place(&v[0], v.size() * sizeof(T), placement);
+}
+
+} // namespace ML
+
+#endif /* __jml__arch__numa_h__ */
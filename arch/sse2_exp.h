@@ -176,14 +176,14 @@ static double Q[] = {
 static double C1 = 6.93145751953125E-1;
 static double C2 = 1.42860682030941723212E-6;
 
-double LOG2E  =  1.4426950408889634073599;     /* 1/log(2) */
+static double LOG2E  =  1.4426950408889634073599;     /* 1/log(2) */
 
 #ifdef DENORMAL
-double MAXLOG =  7.09782712893383996732E2;     /* log(MAXNUM) */
-double MINLOG = -7.451332191019412076235E2;     /* log(2**-1075) */
+static double MAXLOG =  7.09782712893383996732E2;     /* log(MAXNUM) */
+static double MINLOG = -7.451332191019412076235E2;     /* log(2**-1075) */
 #else
-double MAXLOG =  7.08396418532264106224E2;     /* log 2**1022 */
-double MINLOG = -7.08396418532264106224E2;     /* log 2**-1022 */
+static double MAXLOG =  7.08396418532264106224E2;     /* log 2**1022 */
+static double MINLOG = -7.08396418532264106224E2;     /* log 2**-1022 */
 #endif
 
 
@@ -0,0 +1,77 @@
+/* sse2_scan.h                                                     -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Scanning of text for delimiter characters, sixteen at a time.
+*/
+
+#ifndef __arch__sse2_scan_h__
+#define __arch__sse2_scan_h__
+
+#include "jml/arch/arch.h"
+#include "jml/compiler/compiler.h"
+
+#ifdef JML_INTEL_ISA
+# include <emmintrin.h>
+#endif
+
+namespace ML {
+namespace SIMD {
+
+/** Return a pointer to the first character in [begin, end) that is equal
+    to any of c0 to c3, or end if there isn't one.  To look for fewer than
+    four characters, repeat one of them.  Never reads outside of the range.
+*/
+JML_ALWAYS_INLINE const char *
+find_first_of(const char * begin, const char * end,
+              char c0, char c1, char c2, char c3)
+{
+    const char * p = begin;
+
+#ifdef JML_INTEL_ISA
+    __m128i v0 = _mm_set1_epi8(c0), v1 = _mm_set1_epi8(c1);
+    __m128i v2 = _mm_set1_epi8(c2), v3 = _mm_set1_epi8(c3);
+
+    for (; p + 16 <= end;  p += 16) {
+        __m128i chars = _mm_loadu_si128((const __m128i *)p);
+        __m128i found
+            = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, v0),
+                                        _mm_cmpeq_epi8(chars, v1)),
+                           _mm_or_si128(_mm_cmpeq_epi8(chars, v2),
+                                        _mm_cmpeq_epi8(chars, v3)));
+        int mask = _mm_movemask_epi8(found);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+#endif
+
+    for (; p < end;  ++p) {
+        char c = *p;
+        if (c == c0 || c == c1 || c == c2 || c == c3) return p;
+    }
+
+    return end;
+}
+
+JML_ALWAYS_INLINE const char *
+find_first_of(const char * begin, const char * end, char c0)
+{
+    return find_first_of(begin, end, c0, c0, c0, c0);
+}
+
+JML_ALWAYS_INLINE const char *
+find_first_of(const char * begin, const char * end, char c0, char c1)
+{
+    return find_first_of(begin, end, c0, c1, c1, c1);
+}
+
+JML_ALWAYS_INLINE const char *
+find_first_of(const char * begin, const char * end,
+              char c0, char c1, char c2)
+{
+    return find_first_of(begin, end, c0, c1, c2, c2);
+}
+
+} // namespace SIMD
+} // namespace ML
+
+#endif /* __arch__sse2_scan_h__ */
@@ -12,3 +12,5 @@ $(eval $(call test,vm_test,arch,boost))
 $(eval $(call test,info_test,arch,boost))
 $(eval $(call test,rtti_utils_test,arch,boost))
 $(eval $(call test,thread_specific_test,arch boost_thread,boost))
+$(eval $(call test,numa_test,arch,boost))
+$(eval $(call test,cache_info_test,arch,boost))
@@ -0,0 +1,136 @@
+/* cache_info_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test for cache size detection and tile tuning.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "jml/arch/cpuid.h"
+#include "jml/arch/cache.h"
+#include "jml/arch/tile_tuning.h"
+
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+
+using namespace ML;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE( test_this_machine )
+{
+    const Cache_Info & info = cache_info();
+    cerr << "cache info: " << info.print() << endl;
+
+    BOOST_CHECK(info.l1_size >= 4096);
+    BOOST_CHECK(info.line_size >= 16 && info.line_size <= 512);
+    BOOST_CHECK(info.l2_size == 0 || info.l2_size >= info.l1_size);
+    BOOST_CHECK(l2_cache_size() >= l1_cache_size());
+}
+
+/* A fake sysfs cache directory as on a typical server: separate L1 data
+   and instruction caches, then unified L2 and L3. */
+BOOST_AUTO_TEST_CASE( test_read_sysfs )
+{
+    char dir_template[] = "/tmp/cache_info_test_XXXXXX";
+    BOOST_REQUIRE(mkdtemp(dir_template));
+    string dir = dir_template;
+
+    auto add_index = [&] (int index, int level, const string & type,
+                          const string & size, int line)
+        {
+            string index_dir = dir + "/index" + to_string(index);
+            BOOST_REQUIRE_EQUAL(mkdir(index_dir.c_str(), 0700), 0);
+            ofstream((index_dir + "/level").c_str()) << level << endl;
+            ofstream((index_dir + "/type").c_str()) << type << endl;
+            ofstream((index_dir + "/size").c_str()) << size << endl;
+            ofstream((index_dir + "/coherency_line_size").c_str())
+                << line << endl;
+        };
+
+    add_index(0, 1, "Data", "48K", 64);
+    add_index(1, 1, "Instruction", "32K", 64);
+    add_index(2, 2, "Unified", "2048K", 64);
+    add_index(3, 3, "Unified", "105M", 64);
+
+    Cache_Info info;
+    BOOST_REQUIRE(info.read_sysfs(dir));
+    BOOST_CHECK_EQUAL(info.l1_size, 48 * 1024);
+    BOOST_CHECK_EQUAL(info.l2_size, 2048 * 1024);
+    BOOST_CHECK_EQUAL(info.l3_size, 105 * 1024 * 1024);
+    BOOST_CHECK_EQUAL(info.line_size, 64);
+    BOOST_CHECK_EQUAL(info.source, "sysfs");
+
+    system(("rm -rf " + dir).c_str());
+
+    Cache_Info missing;
+    string source = missing.source;
+    BOOST_CHECK(!missing.read_sysfs("/nonexistent/cache/dir"));
+    BOOST_CHECK_EQUAL(missing.source, source);
+}
+
+BOOST_AUTO_TEST_CASE( test_tile_items )
+{
+    BOOST_CHECK_EQUAL(cache_tile_items(64, 32768, 1, 1000), 256);
+    BOOST_CHECK_EQUAL(cache_tile_items(64, 32768, 1, 100), 100);
+    BOOST_CHECK_EQUAL(cache_tile_items(100000, 32768, 4, 100), 4);
+    BOOST_CHECK_EQUAL(cache_tile_items(0, 32768, 4, 100), 100);
+
+    vector<size_t> candidates = tile_candidates(64, 16, 128);
+    vector<size_t> expected = { 16, 32, 64, 128 };
+    BOOST_CHECK(candidates == expected);
+
+    BOOST_CHECK_EQUAL(tile_size_class(1), 0);
+    BOOST_CHECK_EQUAL(tile_size_class(64), 6);
+    BOOST_CHECK_EQUAL(tile_size_class(100), 6);
+}
+
+BOOST_AUTO_TEST_CASE( test_tuning )
+{
+    char file_template[] = "/tmp/cache_tuning_test_XXXXXX";
+    int fd = mkstemp(file_template);
+    BOOST_REQUIRE(fd != -1);
+    close(fd);
+
+    setenv("JML_TILE_CACHE", file_template, 1);
+    setenv("JML_TILE_AUTOTUNE", "1", 1);
+
+    BOOST_REQUIRE(tile_autotune_enabled());
+
+    vector<size_t> candidates = { 8, 16, 32 };
+
+    /* Make the middle candidate the fastest. */
+    int runs = 0;
+    auto run = [&] (size_t tile)
+        {
+            ++runs;
+            double total = 0.0;
+            int n = (tile == 16 ? 1000 : 1000000);
+            for (int i = 0;  i < n;  ++i)
+                total += 1.0 / (i + 1);
+            volatile double result JML_UNUSED = total;
+        };
+
+    BOOST_CHECK_EQUAL(tuned_tile_size("test_kernel", 8, candidates, run), 16);
+    BOOST_CHECK_EQUAL(runs, 3);
+
+    /* It's remembered, so no more tuning. */
+    BOOST_CHECK_EQUAL(tuned_tile_size("test_kernel", 8, candidates, run), 16);
+    BOOST_CHECK_EQUAL(runs, 3);
+
+    /* And it's saved in the file. */
+    ifstream stream(file_template);
+    string key;
+    size_t size;
+    BOOST_REQUIRE(stream >> key >> size);
+    BOOST_CHECK_EQUAL(key.find("test_kernel@"), 0);
+    BOOST_CHECK_EQUAL(size, 16);
+
+    unlink(file_template);
+}
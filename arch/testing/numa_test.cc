@@ -0,0 +1,126 @@
+/* numa_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test for the NUMA topology and placement functions.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "jml/arch/numa.h"
+#include "jml/arch/cpu_info.h"
+#include "jml/arch/exception.h"
+
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include <fstream>
+#include <numeric>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+
+using namespace ML;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE( test_parse_cpu_list )
+{
+    BOOST_CHECK(parse_cpu_list("").empty());
+    BOOST_CHECK(parse_cpu_list("\n").empty());
+
+    vector<int> expected = { 0 };
+    BOOST_CHECK(parse_cpu_list("0\n") == expected);
+
+    expected = { 0, 1, 2, 3, 8, 10, 11 };
+    BOOST_CHECK(parse_cpu_list("0-3,8,10-11\n") == expected);
+
+    BOOST_CHECK_THROW(parse_cpu_list("a-b"), ML::Exception);
+    BOOST_CHECK_THROW(parse_cpu_list("3-1"), ML::Exception);
+}
+
+/* Build a fake sysfs node directory for a two socket machine, with the
+   hyperthreads numbered after the cores as Linux does, a sparse node
+   number and a memory-only node. */
+BOOST_AUTO_TEST_CASE( test_detect_topology )
+{
+    char dir_template[] = "/tmp/numa_test_XXXXXX";
+    BOOST_REQUIRE(mkdtemp(dir_template));
+    string dir = dir_template;
+
+    auto add_node = [&] (const string & name, const string & cpus)
+        {
+            string node_dir = dir + "/" + name;
+            BOOST_REQUIRE_EQUAL(mkdir(node_dir.c_str(), 0700), 0);
+            ofstream stream((node_dir + "/cpulist").c_str());
+            stream << cpus << endl;
+        };
+
+    add_node("node0", "0-3,8-11");
+    add_node("node2", "4-7,12-15");
+    add_node("node3", "");
+    add_node("possible", "");
+
+    Numa_Topology topology = Numa_Topology::detect(dir);
+
+    BOOST_REQUIRE_EQUAL(topology.node_count(), 2);
+    BOOST_CHECK_EQUAL(topology.nodes[0].id, 0);
+    BOOST_CHECK_EQUAL(topology.nodes[1].id, 2);
+    BOOST_CHECK_EQUAL(topology.nodes[0].cpus.size(), 8);
+    BOOST_CHECK_EQUAL(topology.nodes[1].cpus.size(), 8);
+    BOOST_CHECK_EQUAL(topology.node_of_cpu(2), 0);
+    BOOST_CHECK_EQUAL(topology.node_of_cpu(5), 1);
+    BOOST_CHECK_EQUAL(topology.node_of_cpu(9), 0);
+    BOOST_CHECK_EQUAL(topology.node_of_cpu(15), 1);
+    BOOST_CHECK_EQUAL(topology.node_of_cpu(100), 0);
+
+    system(("rm -rf " + dir).c_str());
+
+    /* No NUMA information gives a single node with all of the CPUs. */
+    Numa_Topology flat = Numa_Topology::detect("/nonexistent/numa/dir");
+    BOOST_REQUIRE_EQUAL(flat.node_count(), 1);
+    BOOST_CHECK_EQUAL(flat.nodes[0].cpus.size(), num_cpus());
+}
+
+BOOST_AUTO_TEST_CASE( test_partition_node )
+{
+    BOOST_CHECK_EQUAL(numa_partition_node(0, 100, 4), 0);
+    BOOST_CHECK_EQUAL(numa_partition_node(24, 100, 4), 0);
+    BOOST_CHECK_EQUAL(numa_partition_node(25, 100, 4), 1);
+    BOOST_CHECK_EQUAL(numa_partition_node(99, 100, 4), 3);
+    BOOST_CHECK_EQUAL(numa_partition_node(5, 100, 1), 0);
+    BOOST_CHECK_EQUAL(numa_partition_node(0, 0, 4), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_this_machine )
+{
+    cerr << "this machine has " << numa_nodes() << " NUMA nodes" << endl;
+
+    BOOST_CHECK(numa_nodes() >= 1);
+    BOOST_CHECK(numa_current_node() >= 0);
+    BOOST_CHECK(numa_current_node() < numa_nodes());
+    BOOST_CHECK_THROW(numa_pin_thread(numa_nodes()), ML::Exception);
+}
+
+/* Placement must never change the contents, whether the memory has been
+   touched or not. */
+BOOST_AUTO_TEST_CASE( test_place_keeps_data )
+{
+    vector<int> data(1000000);
+    std::iota(data.begin(), data.end(), 0);
+
+    numa_place_array(data, NUMA_INTERLEAVED);
+    numa_place_array(data, NUMA_PARTITIONED);
+    numa_place(&data[1], 100, NUMA_PARTITIONED);
+
+    for (unsigned i = 0;  i < data.size();  ++i)
+        if (data[i] != i)
+            BOOST_REQUIRE_EQUAL(data[i], i);
+
+    size_t size = 16 * 1024 * 1024;
+    char * untouched = (char *)malloc(size);
+    numa_place(untouched, size, NUMA_PARTITIONED);
+    memset(untouched, 1, size);
+    BOOST_CHECK_EQUAL(untouched[size - 1], 1);
+    free(untouched);
+}
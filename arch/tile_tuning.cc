@@ -0,0 +1,152 @@
+/* tile_tuning.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Auto-tuning of tile sizes.
+*/
+
+#include "tile_tuning.h"
+#include "cpuid.h"
+#include "format.h"
+#include "timers.h"
+
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <stdlib.h>
+
+
+using namespace std;
+
+
+namespace ML {
+
+namespace {
+
+std::mutex tuned_lock;
+std::map<std::string, size_t> tuned;
+bool tuned_loaded = false;
+
+std::string cache_filename()
+{
+    const char * file = getenv("JML_TILE_CACHE");
+    if (file && *file) return file;
+
+    const char * home = getenv("HOME");
+    if (home && *home) return string(home) + "/.jml_tile_cache";
+
+    return "";
+}
+
+/* Tiles tuned on one machine mean nothing on another, so the key includes
+   the cache sizes. */
+std::string tuning_key(const std::string & kernel)
+{
+    const Cache_Info & info = cache_info();
+    return format("%s@l1=%zd,l2=%zd,l3=%zd,line=%d",
+                  kernel.c_str(), info.l1_size, info.l2_size, info.l3_size,
+                  info.line_size);
+}
+
+/* Must be called with the lock held. */
+void load_tuned_ul()
+{
+    if (tuned_loaded) return;
+    tuned_loaded = true;
+
+    string filename = cache_filename();
+    if (filename.empty()) return;
+
+    ifstream stream(filename.c_str());
+    string key;
+    size_t size;
+    while (stream >> key >> size)
+        tuned[key] = size;
+}
+
+void save_tuned(const std::string & key, size_t size)
+{
+    string filename = cache_filename();
+    if (filename.empty()) return;
+
+    ofstream stream(filename.c_str(), ios::app);
+    stream << key << " " << size << endl;
+    if (!stream)
+        cerr << "warning: couldn't save tuned tile size to " << filename
+             << endl;
+}
+
+} // file scope
+
+bool tile_autotune_enabled()
+{
+    static const bool result = [] ()
+        {
+            const char * env = getenv("JML_TILE_AUTOTUNE");
+            return env && atoi(env) != 0;
+        } ();
+    return result;
+}
+
+std::vector<size_t>
+tile_candidates(size_t default_size, size_t min_size, size_t max_size)
+{
+    vector<size_t> result;
+    size_t candidates[5] = { default_size / 4, default_size / 2, default_size,
+                             default_size * 2, default_size * 4 };
+    for (unsigned i = 0;  i < 5;  ++i) {
+        size_t size = std::max(min_size, std::min(max_size, candidates[i]));
+        if (std::find(result.begin(), result.end(), size) == result.end())
+            result.push_back(size);
+    }
+    return result;
+}
+
+size_t tuned_tile_size(const std::string & kernel,
+                       size_t default_size,
+                       const std::vector<size_t> & candidates,
+                       const std::function<void (size_t)> & run)
+{
+    if (!tile_autotune_enabled() || candidates.size() < 2)
+        return default_size;
+
+    string key = tuning_key(kernel);
+
+    {
+        std::unique_lock<std::mutex> guard(tuned_lock);
+        load_tuned_ul();
+        auto it = tuned.find(key);
+        if (it != tuned.end()) return it->second;
+    }
+
+    /* Not tuned yet.  We don't hold the lock while we tune, as the kernel
+       may well tune others; if two threads tune the same kernel at once
+       then they'll both come up with an answer, which is harmless. */
+    size_t best = default_size;
+    double best_time = INFINITY;
+
+    for (unsigned i = 0;  i < candidates.size();  ++i) {
+        Timer timer;
+        run(candidates[i]);
+        double elapsed = timer.elapsed_wall();
+        if (elapsed < best_time) {
+            best_time = elapsed;
+            best = candidates[i];
+        }
+    }
+
+    {
+        std::unique_lock<std::mutex> guard(tuned_lock);
+        if (tuned.count(key)) return tuned[key];
+        tuned[key] = best;
+    }
+
+    save_tuned(key, best);
+
+    return best;
+}
+
+} // namespace ML
@@ -0,0 +1,58 @@
+/* tile_tuning.h                                                   -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Optional auto-tuning of the tile sizes of cache-blocked kernels.
+*/
+
+#ifndef __jml__arch__tile_tuning_h__
+#define __jml__arch__tile_tuning_h__
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <stddef.h>
+
+
+namespace ML {
+
+/** Is auto-tuning turned on?  It is when the JML_TILE_AUTOTUNE environment
+    variable is set to something other than 0. */
+bool tile_autotune_enabled();
+
+/** Candidate tile sizes around the given default: a quarter, a half, the
+    same, double and quadruple, clamped to [min_size, max_size]. */
+std::vector<size_t>
+tile_candidates(size_t default_size, size_t min_size, size_t max_size);
+
+/** Return the tile size to use for the given kernel.
+
+    With auto-tuning turned off, this is just default_size.  With it on,
+    the first time that a kernel is seen each candidate is timed by calling
+    run(candidate), and the fastest one is used from then on.  The choice
+    is saved in a file (JML_TILE_CACHE, or ~/.jml_tile_cache) along with
+    the cache sizes of the machine, so that later processes on the same
+    machine don't need to tune again.
+
+    The kernel name should include anything that changes the best tile
+    size, such as a size class of the input.  run() must do the same work
+    whatever the tile size, and must not itself call tuned_tile_size()
+    for the same kernel.
+*/
+size_t tuned_tile_size(const std::string & kernel,
+                       size_t default_size,
+                       const std::vector<size_t> & candidates,
+                       const std::function<void (size_t)> & run);
+
+/** Size class (the base 2 logarithm, rounded down) of n, for putting in a
+    kernel name. */
+inline int tile_size_class(size_t n)
+{
+    int result = 0;
+    while (n > 1) { n >>= 1;  ++result; }
+    return result;
+}
+
+} // namespace ML
+
+#endif /* __jml__arch__tile_tuning_h__ */
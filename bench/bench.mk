@@ -0,0 +1,15 @@
+# Makefile for the benchmark harness
+# Jeremy Barnes, 19 October 2026
+# Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+JML_BENCH_SOURCES := \
+	jml_bench.cc \
+	benchmark.cc \
+	synthetic_data.cc \
+	boosting_benchmarks.cc \
+	utils_benchmarks.cc \
+	simd_benchmarks.cc
+
+JML_BENCH_LINK := boosting utils arch db worker_task boost_program_options boost_regex
+
+$(eval $(call program,jml_bench,$(JML_BENCH_LINK),$(JML_BENCH_SOURCES),tools))
@@ -0,0 +1,386 @@
+/* benchmark.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Registry and runner for the performance benchmarks.
+*/
+
+#include "benchmark.h"
+#include "jml/arch/timers.h"
+#include "jml/arch/format.h"
+#include "jml/arch/exception.h"
+#include "jml/arch/info.h"
+#include "jml/utils/json_parsing.h"
+#include "jml/utils/worker_task.h"
+#include <algorithm>
+#include <map>
+#include <cmath>
+#include <time.h>
+
+
+using namespace std;
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* BENCHMARK_OPTIONS                                                         */
+/*****************************************************************************/
+
+Benchmark_Options::
+Benchmark_Options()
+    : scale(1.0), seed(1), min_runs(3), max_runs(50), min_time(1.0)
+{
+}
+
+int
+Benchmark_Options::
+scaled(int n, int min) const
+{
+    return std::max<int>(min, n * scale);
+}
+
+
+/*****************************************************************************/
+/* BENCHMARK                                                                 */
+/*****************************************************************************/
+
+std::string
+Benchmark::
+group() const
+{
+    return string(name, 0, name.find('.'));
+}
+
+namespace {
+
+typedef map<string, Benchmark> Registry;
+
+Registry & registry()
+{
+    static Registry result;
+    return result;
+}
+
+} // file scope
+
+void register_benchmark(const std::string & name,
+                        const std::string & units,
+                        bool macro,
+                        const Benchmark::Setup & setup)
+{
+    if (registry().count(name))
+        throw Exception("benchmark " + name + " registered twice");
+
+    Benchmark & benchmark = registry()[name];
+    benchmark.name = name;
+    benchmark.units = units;
+    benchmark.macro = macro;
+    benchmark.setup = setup;
+}
+
+std::vector<Benchmark> registered_benchmarks()
+{
+    vector<Benchmark> result;
+    for (Registry::const_iterator it = registry().begin(),
+             end = registry().end();
+         it != end;  ++it)
+        result.push_back(it->second);
+    return result;
+}
+
+
+/*****************************************************************************/
+/* BENCHMARK_RESULT                                                          */
+/*****************************************************************************/
+
+Benchmark_Result::
+Benchmark_Result()
+    : macro(false), runs(0), items(0.0),
+      min_seconds(NAN), median_seconds(NAN), mean_seconds(NAN),
+      max_seconds(NAN)
+{
+}
+
+double
+Benchmark_Result::
+items_per_second() const
+{
+    return items / median_seconds;
+}
+
+Benchmark_Result run_benchmark(const Benchmark & benchmark,
+                               const Benchmark_Options & options)
+{
+    Benchmark::Run run = benchmark.setup(options);
+
+    // Warm up the caches, and make sure that anything lazily initialized
+    // isn't counted
+    double items = run();
+
+    vector<double> times;
+    double total = 0.0;
+
+    while ((int)times.size() < options.max_runs
+           && ((int)times.size() < options.min_runs
+               || total < options.min_time)) {
+        Timer timer;
+        double run_items = run();
+        double elapsed = timer.elapsed_wall();
+
+        if (run_items != items)
+            throw Exception("benchmark " + benchmark.name
+                            + " processed a different number of items on "
+                            "different runs");
+
+        times.push_back(elapsed);
+        total += elapsed;
+    }
+
+    std::sort(times.begin(), times.end());
+
+    Benchmark_Result result;
+    result.name = benchmark.name;
+    result.units = benchmark.units;
+    result.macro = benchmark.macro;
+    result.runs = times.size();
+    result.items = items;
+    result.min_seconds = times.front();
+    result.max_seconds = times.back();
+    result.mean_seconds = total / times.size();
+
+    int n = times.size();
+    result.median_seconds
+        = (n % 2 ? times[n / 2] : 0.5 * (times[n / 2 - 1] + times[n / 2]));
+
+    return result;
+}
+
+void write_results_json(std::ostream & stream,
+                        const std::vector<Benchmark_Result> & results,
+                        const Benchmark_Options & options)
+{
+    time_t now = time(0);
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    char date[64];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", &tm);
+
+    stream << "{\n"
+           << "  \"version\": 1,\n"
+           << "  \"date\": \"" << date << "\",\n"
+           << "  \"host\": \"" << jsonEscape(hostname()) << "\",\n"
+           << "  \"threads\": " << num_threads() << ",\n"
+           << "  \"scale\": " << options.scale << ",\n"
+           << "  \"seed\": " << options.seed << ",\n"
+           << "  \"results\": [";
+
+    for (unsigned i = 0;  i < results.size();  ++i) {
+        const Benchmark_Result & r = results[i];
+        stream << (i == 0 ? "" : ",") << "\n    {"
+               << " \"name\": \"" << jsonEscape(r.name) << "\","
+               << " \"units\": \"" << jsonEscape(r.units) << "\","
+               << " \"macro\": " << (r.macro ? "true" : "false") << ","
+               << " \"runs\": " << r.runs << ","
+               << format(" \"items\": %.17g,", r.items)
+               << format(" \"min_seconds\": %.9g,", r.min_seconds)
+               << format(" \"median_seconds\": %.9g,", r.median_seconds)
+               << format(" \"mean_seconds\": %.9g,", r.mean_seconds)
+               << format(" \"max_seconds\": %.9g,", r.max_seconds)
+               << format(" \"items_per_second\": %.9g", r.items_per_second())
+               << " }";
+    }
+
+    stream << "\n  ]\n}\n";
+}
+
+namespace {
+
+double expect_number(Parse_Context & context)
+{
+    JsonNumber number = expectJsonNumber(context);
+    switch (number.type) {
+    case JsonNumber::UNSIGNED_INT: return number.uns;
+    case JsonNumber::SIGNED_INT:   return number.sgn;
+    case JsonNumber::FLOATING_POINT: return number.fp;
+    default:
+        context.exception("expected number");
+    }
+}
+
+/* Skip over a value that we don't care about. */
+void skip_json(Parse_Context & context)
+{
+    skipJsonWhitespace(context);
+    if (*context == '"')
+        expectJsonStringAscii(context);
+    else if (*context == '{')
+        expectJsonObject(context,
+                         [] (const std::string &, Parse_Context & context)
+                         {
+                             skip_json(context);
+                         });
+    else if (*context == '[')
+        expectJsonArray(context,
+                        [] (int, Parse_Context & context)
+                        {
+                            skip_json(context);
+                        });
+    else if (context.match_literal("true") || context.match_literal("false")
+             || context.match_literal("null"))
+        ;
+    else expectJsonNumber(context);
+}
+
+Benchmark_Result expect_result(Parse_Context & context)
+{
+    Benchmark_Result result;
+
+    auto on_field = [&] (const std::string & key, Parse_Context & context)
+        {
+            if (key == "name")
+                result.name = expectJsonStringAscii(context);
+            else if (key == "units")
+                result.units = expectJsonStringAscii(context);
+            else if (key == "macro")
+                result.macro = expectJsonBool(context);
+            else if (key == "runs")
+                result.runs = expect_number(context);
+            else if (key == "items")
+                result.items = expect_number(context);
+            else if (key == "min_seconds")
+                result.min_seconds = expect_number(context);
+            else if (key == "median_seconds")
+                result.median_seconds = expect_number(context);
+            else if (key == "mean_seconds")
+                result.mean_seconds = expect_number(context);
+            else if (key == "max_seconds")
+                result.max_seconds = expect_number(context);
+            else skip_json(context);
+        };
+
+    expectJsonObject(context, on_field);
+
+    if (result.name.empty())
+        context.exception("benchmark result has no name");
+
+    return result;
+}
+
+} // file scope
+
+std::vector<Benchmark_Result> read_results_json(const std::string & filename)
+{
+    Parse_Context context(filename);
+
+    vector<Benchmark_Result> result;
+
+    auto on_field = [&] (const std::string & key, Parse_Context & context)
+        {
+            if (key == "version") {
+                if (expect_number(context) != 1)
+                    context.exception("unknown benchmark results version");
+            }
+            else if (key == "results") {
+                expectJsonArray(context,
+                                [&] (int, Parse_Context & context)
+                                {
+                                    result.push_back(expect_result(context));
+                                });
+            }
+            else skip_json(context);
+        };
+
+    expectJsonObject(context, on_field);
+
+    return result;
+}
+
+
+/*****************************************************************************/
+/* COMPARISON                                                                */
+/*****************************************************************************/
+
+std::vector<Benchmark_Comparison>
+compare_results(const std::vector<Benchmark_Result> & before,
+                const std::vector<Benchmark_Result> & after,
+                double threshold)
+{
+    map<string, Benchmark_Comparison> comparisons;
+
+    for (unsigned i = 0;  i < before.size();  ++i) {
+        Benchmark_Comparison & c = comparisons[before[i].name];
+        c.name = before[i].name;
+        c.before = before[i].median_seconds;
+        c.after = c.ratio = NAN;
+        c.status = Benchmark_Comparison::ONLY_BEFORE;
+    }
+
+    for (unsigned i = 0;  i < after.size();  ++i) {
+        const Benchmark_Result & r = after[i];
+
+        if (!comparisons.count(r.name)) {
+            Benchmark_Comparison & c = comparisons[r.name];
+            c.name = r.name;
+            c.before = c.ratio = NAN;
+            c.after = r.median_seconds;
+            c.status = Benchmark_Comparison::ONLY_AFTER;
+            continue;
+        }
+
+        Benchmark_Comparison & c = comparisons[r.name];
+        c.after = r.median_seconds;
+        c.ratio = c.after / c.before;
+
+        if (c.ratio > 1.0 + threshold)
+            c.status = Benchmark_Comparison::SLOWER;
+        else if (c.ratio < 1.0 / (1.0 + threshold))
+            c.status = Benchmark_Comparison::FASTER;
+        else c.status = Benchmark_Comparison::SAME;
+    }
+
+    vector<Benchmark_Comparison> result;
+    for (map<string, Benchmark_Comparison>::const_iterator
+             it = comparisons.begin(), end = comparisons.end();
+         it != end;  ++it)
+        result.push_back(it->second);
+
+    return result;
+}
+
+int print_comparison(std::ostream & stream,
+                     const std::vector<Benchmark_Comparison> & comparison)
+{
+    int regressions = 0;
+
+    stream << format("%-44s %12s %12s %8s  %s\n",
+                     "benchmark", "before (s)", "after (s)", "ratio",
+                     "status");
+
+    for (unsigned i = 0;  i < comparison.size();  ++i) {
+        const Benchmark_Comparison & c = comparison[i];
+
+        const char * status = "";
+        switch (c.status) {
+        case Benchmark_Comparison::SAME:        status = "";  break;
+        case Benchmark_Comparison::FASTER:      status = "faster";  break;
+        case Benchmark_Comparison::SLOWER:      status = "REGRESSION";  break;
+        case Benchmark_Comparison::ONLY_BEFORE: status = "removed";  break;
+        case Benchmark_Comparison::ONLY_AFTER:  status = "new";  break;
+        }
+
+        if (c.status == Benchmark_Comparison::SLOWER)
+            ++regressions;
+
+        stream << format("%-44s %12.6f %12.6f %8.3f  %s\n",
+                         c.name.c_str(), c.before, c.after, c.ratio, status);
+    }
+
+    stream << regressions << " regression" << (regressions == 1 ? "" : "s")
+           << endl;
+
+    return regressions;
+}
+
+} // namespace ML
@@ -0,0 +1,157 @@
+/* benchmark.h                                                     -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Registry and runner for the performance benchmarks.
+*/
+
+#ifndef __jml__bench__benchmark_h__
+#define __jml__bench__benchmark_h__
+
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <functional>
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* BENCHMARK_OPTIONS                                                         */
+/*****************************************************************************/
+
+/** Controls how big the benchmark problems are and how many times each one
+    is run. */
+
+struct Benchmark_Options {
+    Benchmark_Options();
+
+    double scale;       ///< Multiplier for the problem sizes; 1.0 is default
+    int seed;           ///< Seed for the synthetic data
+    int min_runs;       ///< Time at least this many runs...
+    int max_runs;       ///< ... and at most this many ...
+    double min_time;    ///< ... stopping once this many seconds are spent
+
+    /** Scale the given default problem size, never returning less than
+        min. */
+    int scaled(int n, int min = 1) const;
+};
+
+
+/*****************************************************************************/
+/* BENCHMARK                                                                 */
+/*****************************************************************************/
+
+/** A benchmark.  The setup function creates whatever state the benchmark
+    needs (which isn't timed) and returns a function that performs one run
+    and returns the number of items it processed. */
+
+struct Benchmark {
+    typedef std::function<double ()> Run;
+    typedef std::function<Run (const Benchmark_Options &)> Setup;
+
+    std::string name;         ///< Dotted name, eg boosting.stump.dense
+    std::string units;        ///< What the items are, eg "examples"
+    bool macro;               ///< Macro (whole algorithm) or micro benchmark
+    Setup setup;
+
+    /** The group is the part of the name before the first dot. */
+    std::string group() const;
+};
+
+/** Add a benchmark to the registry. */
+void register_benchmark(const std::string & name,
+                        const std::string & units,
+                        bool macro,
+                        const Benchmark::Setup & setup);
+
+/** Return all of the registered benchmarks, sorted by name. */
+std::vector<Benchmark> registered_benchmarks();
+
+/** Object that registers a benchmark when constructed, so that
+    benchmarks can be registered at file scope. */
+struct Register_Benchmark {
+    Register_Benchmark(const std::string & name,
+                       const std::string & units,
+                       bool macro,
+                       const Benchmark::Setup & setup)
+    {
+        register_benchmark(name, units, macro, setup);
+    }
+};
+
+
+/*****************************************************************************/
+/* BENCHMARK_RESULT                                                          */
+/*****************************************************************************/
+
+/** Timings from running a benchmark.  All times are wall clock seconds for
+    a single run. */
+
+struct Benchmark_Result {
+    Benchmark_Result();
+
+    std::string name;
+    std::string units;
+    bool macro;
+    int runs;
+    double items;
+    double min_seconds;
+    double median_seconds;
+    double mean_seconds;
+    double max_seconds;
+
+    double items_per_second() const;
+};
+
+/** Run the given benchmark according to the options. */
+Benchmark_Result run_benchmark(const Benchmark & benchmark,
+                               const Benchmark_Options & options);
+
+/** Write a set of results as a JSON document. */
+void write_results_json(std::ostream & stream,
+                        const std::vector<Benchmark_Result> & results,
+                        const Benchmark_Options & options);
+
+/** Read a set of results written by write_results_json(). */
+std::vector<Benchmark_Result> read_results_json(const std::string & filename);
+
+
+/*****************************************************************************/
+/* COMPARISON                                                                */
+/*****************************************************************************/
+
+/** The result of comparing one benchmark between two runs. */
+
+struct Benchmark_Comparison {
+    enum Status {
+        SAME,          ///< Within the threshold
+        FASTER,        ///< Faster by more than the threshold
+        SLOWER,        ///< Slower by more than the threshold; a regression
+        ONLY_BEFORE,   ///< Only in the first set of results
+        ONLY_AFTER     ///< Only in the second set of results
+    };
+
+    std::string name;
+    double before;     ///< Median seconds in the first set of results
+    double after;      ///< Median seconds in the second set of results
+    double ratio;      ///< after / before
+    Status status;
+};
+
+/** Compare two sets of results by median time.  A benchmark has changed if
+    its time differs by more than a fraction threshold of the original. */
+std::vector<Benchmark_Comparison>
+compare_results(const std::vector<Benchmark_Result> & before,
+                const std::vector<Benchmark_Result> & after,
+                double threshold);
+
+/** Print a comparison as a table.  Returns the number of regressions. */
+int print_comparison(std::ostream & stream,
+                     const std::vector<Benchmark_Comparison> & comparison);
+
+} // namespace ML
+
+#endif /* __jml__bench__benchmark_h__ */
@@ -0,0 +1,170 @@
+/* boosting_benchmarks.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Benchmarks for training and scoring classifiers.
+*/
+
+#include "benchmark.h"
+#include "synthetic_data.h"
+#include "jml/boosting/stump_generator.h"
+#include "jml/boosting/decision_tree_generator.h"
+#include "jml/boosting/boosting_generator.h"
+#include "jml/boosting/compiled_scorer.h"
+#include "jml/boosting/classifier.h"
+#include "jml/boosting/thread_context.h"
+#include "jml/utils/configuration.h"
+
+
+using namespace std;
+using namespace ML;
+
+
+namespace {
+
+/* Default problem sizes, before scaling. */
+enum {
+    NX = 20000,         ///< Number of examples
+    NF = 50,            ///< Number of dense features
+    NF_SPARSE = 2000    ///< Number of sparse features
+};
+
+std::shared_ptr<Synthetic_Dataset>
+make_dataset(Synthetic_Data_Type type, const Benchmark_Options & options)
+{
+    int nf = (type == SD_SPARSE ? NF_SPARSE : NF);
+    return std::make_shared<Synthetic_Dataset>
+        (type, options.scaled(NX, 100), nf, options.seed,
+         10.0 / nf /* density */);
+}
+
+/* Set up a benchmark that trains the given type of generator on the given
+   type of data. */
+template<class Generator>
+Benchmark::Run
+setup_training(Synthetic_Data_Type type,
+               const std::string & config_string,
+               const Benchmark_Options & options)
+{
+    std::shared_ptr<Synthetic_Dataset> dataset = make_dataset(type, options);
+
+    Configuration config;
+    config.parse_string(config_string, "benchmark config");
+
+    std::shared_ptr<Generator> generator(new Generator());
+    generator->configure(config);
+    generator->init(dataset->feature_space, dataset->label);
+
+    int seed = options.seed;
+
+    return [=] ()
+        {
+            Thread_Context context;
+            context.seed(seed);
+            distribution<float> weights(dataset->data->example_count(), 1.0);
+            generator->generate(context, *dataset->data, weights,
+                                dataset->features);
+            return (double)dataset->data->example_count();
+        };
+}
+
+const char * stump_config = "verbosity=0\n";
+const char * tree_config = "verbosity=0\ntrace=0\nmax_depth=8\n";
+const char * boosting_config
+    = "verbosity=0\nmin_iter=20\nmax_iter=20\nweak_learner.type=stump\n"
+      "weak_learner.verbosity=0\n";
+
+#define REGISTER_TRAINING(name, Generator, type, config)                  \
+    Register_Benchmark register_##name                                    \
+    ("boosting." #name, "examples", true,                                 \
+     [] (const Benchmark_Options & options)                               \
+     {                                                                    \
+         return setup_training<Generator>(type, config, options);         \
+     })
+
+REGISTER_TRAINING(stump_dense, Stump_Generator, SD_DENSE, stump_config);
+REGISTER_TRAINING(stump_sparse, Stump_Generator, SD_SPARSE, stump_config);
+REGISTER_TRAINING(stump_categorical, Stump_Generator, SD_CATEGORICAL,
+                  stump_config);
+REGISTER_TRAINING(stump_multiclass, Stump_Generator, SD_MULTICLASS,
+                  stump_config);
+
+REGISTER_TRAINING(decision_tree_dense, Decision_Tree_Generator, SD_DENSE,
+                  tree_config);
+REGISTER_TRAINING(decision_tree_sparse, Decision_Tree_Generator, SD_SPARSE,
+                  tree_config);
+REGISTER_TRAINING(decision_tree_categorical, Decision_Tree_Generator,
+                  SD_CATEGORICAL, tree_config);
+REGISTER_TRAINING(decision_tree_multiclass, Decision_Tree_Generator,
+                  SD_MULTICLASS, tree_config);
+
+REGISTER_TRAINING(boosted_stumps_dense, Boosting_Generator, SD_DENSE,
+                  boosting_config);
+
+
+/* Train a decision tree on dense data, for the scoring benchmarks. */
+Classifier train_tree(const Synthetic_Dataset & dataset, int seed)
+{
+    Configuration config;
+    config.parse_string(tree_config, "benchmark config");
+
+    Decision_Tree_Generator generator;
+    generator.configure(config);
+    generator.init(dataset.feature_space, dataset.label);
+
+    Thread_Context context;
+    context.seed(seed);
+    distribution<float> weights(dataset.data->example_count(), 1.0);
+    return Classifier(generator.generate(context, *dataset.data, weights,
+                                         dataset.features));
+}
+
+/* Score through the normal (feature set) interface. */
+Register_Benchmark register_predict
+("scoring.decision_tree_predict", "examples", false,
+ [] (const Benchmark_Options & options)
+ {
+     std::shared_ptr<Synthetic_Dataset> dataset
+         = make_dataset(SD_DENSE, options);
+     std::shared_ptr<Classifier> classifier
+         (new Classifier(train_tree(*dataset, options.seed)));
+
+     return [=] ()
+     {
+         const Training_Data & data = *dataset->data;
+         double total = 0.0;
+         for (unsigned x = 0;  x < data.example_count();  ++x)
+             total += classifier->predict(1, data[x]);
+         if (!std::isfinite(total))
+             throw Exception("non-finite prediction");
+         return (double)data.example_count();
+     };
+ });
+
+/* Score dense vectors through the compiled scorer. */
+Register_Benchmark register_compiled_scorer
+("scoring.compiled_scorer", "examples", false,
+ [] (const Benchmark_Options & options)
+ {
+     std::shared_ptr<Synthetic_Dataset> dataset
+         = make_dataset(SD_DENSE, options);
+     std::shared_ptr<Compiled_Scorer> scorer
+         (new Compiled_Scorer(train_tree(*dataset, options.seed)));
+
+     return [=] ()
+     {
+         const boost::multi_array<float, 2> & dense = dataset->dense;
+         Compiled_Scorer::Scratch scratch;
+         float output[scorer->label_count()];
+         double total = 0.0;
+         for (unsigned x = 0;  x < dense.shape()[0];  ++x) {
+             scorer->score(&dense[x][0], output, scratch);
+             total += output[1];
+         }
+         if (!std::isfinite(total))
+             throw Exception("non-finite prediction");
+         return (double)dense.shape()[0];
+     };
+ });
+
+} // file scope
@@ -0,0 +1,160 @@
+/* jml_bench.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Runs the performance benchmarks, writing the results as JSON, and
+   compares two sets of results to find regressions.
+*/
+
+#include "benchmark.h"
+#include "jml/arch/exception.h"
+#include "jml/arch/format.h"
+
+#include <iostream>
+#include <fstream>
+#include <boost/regex.hpp>
+
+#include <boost/program_options/cmdline.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/program_options/variables_map.hpp>
+
+using namespace std;
+
+using namespace ML;
+
+int main(int argc, char ** argv)
+try
+{
+    ios::sync_with_stdio(false);
+
+    Benchmark_Options options;
+    string filter = ".*";
+    string output_file;
+    bool list = false;
+    bool micro_only = false;
+    bool macro_only = false;
+    vector<string> compare_files;
+    double threshold = 0.10;
+    int verbosity = 1;
+
+    namespace opt = boost::program_options;
+
+    opt::options_description run_options("Run options");
+    opt::options_description compare_options("Compare options");
+    {
+        using namespace boost::program_options;
+
+        run_options.add_options()
+            ( "filter,f", value<string>(&filter),
+              "only run benchmarks whose name matches REGEX" )
+            ( "list,l", value<bool>(&list)->zero_tokens(),
+              "list the benchmarks and exit" )
+            ( "micro", value<bool>(&micro_only)->zero_tokens(),
+              "only run the micro benchmarks" )
+            ( "macro", value<bool>(&macro_only)->zero_tokens(),
+              "only run the macro benchmarks" )
+            ( "scale,s", value<double>(&options.scale),
+              "multiply the problem sizes by SCALE" )
+            ( "seed", value<int>(&options.seed),
+              "seed for the synthetic data" )
+            ( "min-runs", value<int>(&options.min_runs),
+              "time each benchmark at least N times" )
+            ( "max-runs", value<int>(&options.max_runs),
+              "time each benchmark at most N times" )
+            ( "min-time", value<double>(&options.min_time),
+              "time each benchmark for at least SECONDS" )
+            ( "output,o", value<string>(&output_file),
+              "write the JSON results to FILE (default stdout)" )
+            ( "verbosity,v", value<int>(&verbosity),
+              "set verbosity to LEVEL [0-1]" );
+
+        compare_options.add_options()
+            ( "compare,c", value<vector<string> >(&compare_files)->multitoken(),
+              "compare the results in BEFORE and AFTER files" )
+            ( "threshold,t", value<double>(&threshold),
+              "flag changes of more than this fraction (default 0.10)" );
+
+        options_description all_opt;
+        all_opt
+            .add(run_options)
+            .add(compare_options);
+
+        all_opt.add_options()
+            ("help,h", "print this message");
+
+        variables_map vm;
+        store(command_line_parser(argc, argv)
+              .options(all_opt)
+              .run(),
+              vm);
+        notify(vm);
+
+        if (vm.count("help")) {
+            cerr << all_opt << endl;
+            return 1;
+        }
+    }
+
+    if (!compare_files.empty()) {
+        if (compare_files.size() != 2)
+            throw Exception("--compare needs exactly two files");
+
+        vector<Benchmark_Result> before = read_results_json(compare_files[0]);
+        vector<Benchmark_Result> after = read_results_json(compare_files[1]);
+
+        int regressions
+            = print_comparison(cout, compare_results(before, after, threshold));
+
+        return regressions > 0;
+    }
+
+    boost::regex filter_regex(filter);
+
+    vector<Benchmark> benchmarks = registered_benchmarks();
+    vector<Benchmark> to_run;
+    for (unsigned i = 0;  i < benchmarks.size();  ++i) {
+        const Benchmark & b = benchmarks[i];
+        if (!boost::regex_search(b.name, filter_regex)) continue;
+        if (micro_only && b.macro) continue;
+        if (macro_only && !b.macro) continue;
+        to_run.push_back(b);
+    }
+
+    if (list) {
+        for (unsigned i = 0;  i < to_run.size();  ++i)
+            cout << format("%-40s %-6s %s\n", to_run[i].name.c_str(),
+                           to_run[i].macro ? "macro" : "micro",
+                           to_run[i].units.c_str());
+        return 0;
+    }
+
+    vector<Benchmark_Result> results;
+
+    for (unsigned i = 0;  i < to_run.size();  ++i) {
+        if (verbosity > 0)
+            cerr << format("%-40s ", to_run[i].name.c_str()) << flush;
+
+        Benchmark_Result result = run_benchmark(to_run[i], options);
+        results.push_back(result);
+
+        if (verbosity > 0)
+            cerr << format("%4d runs  median %10.6fs  %12.5g %s/s\n",
+                           result.runs, result.median_seconds,
+                           result.items_per_second(), result.units.c_str());
+    }
+
+    if (output_file.empty())
+        write_results_json(cout, results, options);
+    else {
+        ofstream stream(output_file.c_str());
+        write_results_json(stream, results, options);
+        if (!stream)
+            throw Exception("couldn't write results to " + output_file);
+    }
+}
+catch (const std::exception & exc) {
+    cerr << "error: " << exc.what() << endl;
+    exit(1);
+}
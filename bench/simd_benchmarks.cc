@@ -0,0 +1,95 @@
+/* simd_benchmarks.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Benchmarks for the SIMD vector kernels.
+*/
+
+#include "benchmark.h"
+#include "jml/arch/simd_vector.h"
+#include "jml/arch/exception.h"
+#include "jml/utils/rng.h"
+#include <vector>
+#include <memory>
+#include <cmath>
+
+
+using namespace std;
+using namespace ML;
+using namespace ML::SIMD;
+
+
+namespace {
+
+/* The vectors are small enough to stay in the cache, so that these
+   measure the kernels rather than the memory bandwidth. */
+enum {
+    VECTOR_SIZE = 4096,
+    NREPEATS = 1000
+};
+
+template<typename Float>
+struct Vectors {
+    Vectors(const Benchmark_Options & options)
+        : n(VECTOR_SIZE), repeats(options.scaled(NREPEATS)),
+          x(n), y(n), r(n)
+    {
+        RNG rng(options.seed);
+        for (unsigned i = 0;  i < n;  ++i) {
+            x[i] = rng.random01() * 2.0 - 1.0;
+            y[i] = rng.random01() * 2.0 - 1.0;
+        }
+    }
+
+    int n;
+    int repeats;
+    vector<Float> x, y, r;
+
+    double items() const { return (double)n * repeats; }
+
+    /* Make sure that the result is used so that the work isn't optimized
+       away. */
+    void check(double total) const
+    {
+        if (!std::isfinite(total))
+            throw Exception("non-finite SIMD result");
+    }
+};
+
+/* Register a benchmark that runs the given statement over the vectors. */
+#define REGISTER_SIMD(name, Float, statement)                             \
+    Register_Benchmark register_##name                                    \
+    ("simd." #name, "elements", false,                                    \
+     [] (const Benchmark_Options & options)                               \
+     {                                                                    \
+         std::shared_ptr<Vectors<Float> > v                               \
+             (new Vectors<Float>(options));                               \
+         return [=] ()                                                    \
+         {                                                                \
+             int n = v->n;                                                \
+             const Float * x = &v->x[0];                                  \
+             const Float * y = &v->y[0];                                  \
+             Float * r = &v->r[0];                                        \
+             (void)y;  /* not every statement needs both operands */      \
+             double total = 0.0;                                          \
+             for (unsigned i = 0;  i < v->repeats;  ++i) {                \
+                 statement;                                               \
+             }                                                            \
+             v->check(total + r[0]);                                      \
+             return v->items();                                           \
+         };                                                               \
+     })
+
+REGISTER_SIMD(vec_dotprod_float, float, total += vec_dotprod(x, y, n));
+REGISTER_SIMD(vec_dotprod_double, double, total += vec_dotprod(x, y, n));
+REGISTER_SIMD(vec_dotprod_dp_float, float,
+              total += vec_dotprod_dp(x, y, n));
+REGISTER_SIMD(vec_add_float, float, vec_add(x, 0.5f, y, r, n));
+REGISTER_SIMD(vec_add_double, double, vec_add(x, 0.5, y, r, n));
+REGISTER_SIMD(vec_prod_float, float, vec_prod(x, y, r, n));
+REGISTER_SIMD(vec_exp_float, float, vec_exp(x, r, n));
+REGISTER_SIMD(vec_exp_double, double, vec_exp(x, r, n));
+REGISTER_SIMD(vec_twonorm_sqr_float, float,
+              total += vec_twonorm_sqr(x, n));
+
+} // file scope
@@ -0,0 +1,134 @@
+/* synthetic_data.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Deterministic synthetic datasets for benchmarking.
+*/
+
+#include "synthetic_data.h"
+#include "jml/boosting/sparse_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/utils/rng.h"
+#include "jml/utils/smart_ptr_utils.h"
+#include "jml/arch/format.h"
+#include "jml/arch/exception.h"
+
+
+using namespace std;
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* SYNTHETIC_DATASET                                                         */
+/*****************************************************************************/
+
+Synthetic_Dataset::
+Synthetic_Dataset(Synthetic_Data_Type type, int nx, int nf, int seed,
+                  float density, int nvalues)
+    : type(type), label_count(type == SD_MULTICLASS ? nvalues : 2)
+{
+    RNG rng(seed);
+
+    // Random number in [-1, 1]
+    auto random11 = [&] () { return rng.random01() * 2.0f - 1.0f; };
+
+    // Weights of the model that generates the labels
+    int nmodels = (type == SD_MULTICLASS ? nvalues : 1);
+    int nweights = (type == SD_CATEGORICAL ? nvalues : 1);
+    boost::multi_array<float, 3> weights
+        (boost::extents[nmodels][nf][nweights]);
+    for (unsigned m = 0;  m < nmodels;  ++m)
+        for (unsigned f = 0;  f < nf;  ++f)
+            for (unsigned w = 0;  w < nweights;  ++w)
+                weights[m][f][w] = random11();
+
+    if (type == SD_SPARSE) {
+        std::shared_ptr<Sparse_Feature_Space>
+            fs(new Sparse_Feature_Space());
+        label = fs->make_feature("LABEL", Feature_Info(BOOLEAN, false, true));
+        for (unsigned f = 0;  f < nf;  ++f)
+            features.push_back(fs->make_feature(format("f%05d", f), REAL));
+
+        feature_space = fs;
+        data.reset(new Training_Data(fs));
+
+        for (unsigned x = 0;  x < nx;  ++x) {
+            std::shared_ptr<Mutable_Feature_Set>
+                fset(new Mutable_Feature_Set());
+
+            double score = 0.2 * random11();
+            for (unsigned f = 0;  f < nf;  ++f) {
+                if (rng.random01() >= density) continue;
+                float value = rng.random01();
+                fset->add(features[f], value);
+                score += weights[0][f][0] * value;
+            }
+
+            fset->add(label, score > 0.0);
+            fset->sort();
+            data->add_example(fset);
+        }
+
+        return;
+    }
+
+    dense_feature_space.reset(new Dense_Feature_Space());
+
+    if (type == SD_MULTICLASS)
+        dense_feature_space->add_feature
+            ("LABEL",
+             Feature_Info(make_sp(new Fixed_Categorical_Info(nvalues)),
+                          false, true));
+    else dense_feature_space->add_feature
+             ("LABEL", Feature_Info(BOOLEAN, false, true));
+
+    Feature_Info info(REAL);
+    if (type == SD_CATEGORICAL)
+        info = Feature_Info(make_sp(new Fixed_Categorical_Info(nvalues)));
+
+    for (unsigned f = 0;  f < nf;  ++f)
+        dense_feature_space->add_feature(format("f%05d", f), info);
+
+    features = dense_feature_space->features();
+    label = features[0];
+    features.erase(features.begin());
+
+    feature_space = dense_feature_space;
+    data.reset(new Training_Data(dense_feature_space));
+
+    dense.resize(boost::extents[nx][nf + 1]);
+
+    for (unsigned x = 0;  x < nx;  ++x) {
+        distribution<float> scores(nmodels, 0.0);
+
+        for (unsigned f = 0;  f < nf;  ++f) {
+            if (type == SD_CATEGORICAL) {
+                int value = rng.random(nvalues);
+                dense[x][f + 1] = value;
+                scores[0] += weights[0][f][value];
+            }
+            else {
+                float value = random11();
+                dense[x][f + 1] = value;
+                for (unsigned m = 0;  m < nmodels;  ++m)
+                    scores[m] += weights[m][f][0] * value;
+            }
+        }
+
+        for (unsigned m = 0;  m < nmodels;  ++m)
+            scores[m] += 0.2 * random11();
+
+        if (type == SD_MULTICLASS)
+            dense[x][0] = std::max_element(scores.begin(), scores.end())
+                - scores.begin();
+        else dense[x][0] = scores[0] > 0.0;
+
+        data->add_example(dense_feature_space->encode
+                          (vector<float>(&dense[x][0],
+                                         &dense[x][0] + nf + 1)));
+    }
+}
+
+} // namespace ML
@@ -0,0 +1,69 @@
+/* synthetic_data.h                                                -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Deterministic synthetic datasets for benchmarking.
+*/
+
+#ifndef __jml__bench__synthetic_data_h__
+#define __jml__bench__synthetic_data_h__
+
+
+#include "jml/boosting/training_data.h"
+#include "jml/boosting/feature_space.h"
+#include "jml/boosting/dense_features.h"
+#include <boost/multi_array.hpp>
+
+
+namespace ML {
+
+
+/** What kind of data to generate. */
+enum Synthetic_Data_Type {
+    SD_DENSE,        ///< Dense real features, binary label
+    SD_SPARSE,       ///< Sparse real features, binary label
+    SD_CATEGORICAL,  ///< Dense categorical features, binary label
+    SD_MULTICLASS    ///< Dense real features, label with several classes
+};
+
+
+/*****************************************************************************/
+/* SYNTHETIC_DATASET                                                         */
+/*****************************************************************************/
+
+/** A synthetic dataset.  The label is a noisy function of the features, so
+    that there is something for a classifier to learn.  The same parameters
+    always give exactly the same dataset. */
+
+struct Synthetic_Dataset {
+
+    /** Generate nx examples with nf features (not counting the label).  For
+        SD_SPARSE, each example has about density * nf of the features;
+        for SD_CATEGORICAL each feature has nvalues categories; for
+        SD_MULTICLASS there are nvalues labels. */
+    Synthetic_Dataset(Synthetic_Data_Type type, int nx, int nf, int seed,
+                      float density = 0.05, int nvalues = 8);
+
+    Synthetic_Data_Type type;
+
+    std::shared_ptr<Feature_Space> feature_space;
+    std::shared_ptr<Training_Data> data;
+
+    /** The label feature */
+    Feature label;
+
+    /** All features apart from the label */
+    std::vector<Feature> features;
+
+    /** Number of label values */
+    int label_count;
+
+    /** For the dense types, the dense feature space and the feature
+        vectors (including the label in column 0). */
+    std::shared_ptr<Dense_Feature_Space> dense_feature_space;
+    boost::multi_array<float, 2> dense;
+};
+
+} // namespace ML
+
+#endif /* __jml__bench__synthetic_data_h__ */
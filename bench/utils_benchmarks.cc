@@ -0,0 +1,182 @@
+/* utils_benchmarks.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Benchmarks for parsing and the worker task.
+*/
+
+#include "benchmark.h"
+#include "jml/utils/parse_context.h"
+#include "jml/utils/csv.h"
+#include "jml/utils/rng.h"
+#include "jml/utils/worker_task.h"
+#include "jml/arch/atomic_ops.h"
+#include "jml/arch/format.h"
+#include "jml/arch/exception.h"
+#include <sstream>
+
+
+using namespace std;
+using namespace ML;
+
+
+namespace {
+
+/* Generate lines of CSV with a mix of integer, real and text fields. */
+std::shared_ptr<std::string>
+make_csv(int nlines, int seed)
+{
+    RNG rng(seed);
+
+    ostringstream stream;
+    for (unsigned i = 0;  i < nlines;  ++i) {
+        stream << rng.random(1000000) << ","
+               << format("%.6f", rng.random01() * 2000.0 - 1000.0) << ","
+               << format("%.3g", rng.random01()) << ","
+               << "\"text " << rng.random(100) << "\","
+               << -(int)rng.random(1000) << "\n";
+    }
+
+    return std::make_shared<std::string>(stream.str());
+}
+
+/* Parse the CSV the slow way, copying every field into a string. */
+Register_Benchmark register_csv_strings
+("parsing.csv_strings", "bytes", false,
+ [] (const Benchmark_Options & options)
+ {
+     std::shared_ptr<std::string> text
+         = make_csv(options.scaled(100000, 10), options.seed);
+
+     return [=] ()
+     {
+         Parse_Context context("csv", text->c_str(), text->size());
+         size_t nfields = 0;
+         while (context) {
+             vector<string> row = expect_csv_row(context, 5);
+             nfields += row.size();
+         }
+         return (double)text->size();
+     };
+ });
+
+/* Parse the CSV as views into the buffer, converting the numeric fields. */
+Register_Benchmark register_csv_fields
+("parsing.csv_fields", "bytes", false,
+ [] (const Benchmark_Options & options)
+ {
+     std::shared_ptr<std::string> text
+         = make_csv(options.scaled(100000, 10), options.seed);
+
+     return [=] ()
+     {
+         Parse_Context context("csv", text->c_str(), text->size());
+         vector<Csv_Field> fields;
+         string storage;
+         double total = 0.0;
+         while (context) {
+             expect_csv_row(context, fields, storage, 5);
+             double d;
+             if (fields[1].match_double(d))
+                 total += d;
+         }
+         if (!std::isfinite(total))
+             throw Exception("bad CSV total");
+         return (double)text->size();
+     };
+ });
+
+/* Parse whitespace separated numbers directly from the context. */
+Register_Benchmark register_parse_numbers
+("parsing.numbers", "bytes", false,
+ [] (const Benchmark_Options & options)
+ {
+     RNG rng(options.seed);
+     ostringstream stream;
+     int n = options.scaled(500000, 10);
+     for (unsigned i = 0;  i < n;  ++i) {
+         stream << rng.random(100000) << " "
+                << format("%.7g", rng.random01() * 100.0 - 50.0);
+         stream << (i % 10 == 9 ? "\n" : " ");
+     }
+     std::shared_ptr<std::string> text
+         = std::make_shared<std::string>(stream.str());
+
+     return [=] ()
+     {
+         Parse_Context context("numbers", text->c_str(), text->size());
+         double total = 0.0;
+         while (context) {
+             total += context.expect_int();
+             context.expect_whitespace();
+             total += context.expect_double();
+             context.match_whitespace();
+             context.match_eol();
+         }
+         if (!std::isfinite(total))
+             throw Exception("bad total");
+         return (double)text->size();
+     };
+ });
+
+/* Overhead of scheduling lots of tiny jobs on the worker task. */
+Register_Benchmark register_worker_task
+("worker_task.small_jobs", "jobs", false,
+ [] (const Benchmark_Options & options)
+ {
+     int njobs = options.scaled(100000, 100);
+
+     return [=] ()
+     {
+         Worker_Task & worker = Worker_Task::instance(num_threads() - 1);
+
+         int done = 0;
+
+         int group;
+         {
+             group = worker.get_group(NO_JOB, "benchmark group");
+             Call_Guard guard(std::bind(&Worker_Task::unlock_group,
+                                        std::ref(worker),
+                                        group));
+
+             for (unsigned i = 0;  i < njobs;  ++i)
+                 worker.add([&] () { atomic_add(done, 1); },
+                            "benchmark job", group);
+         }
+
+         worker.run_until_finished(group);
+
+         if (done != njobs)
+             throw Exception("not all jobs were run");
+
+         return (double)njobs;
+     };
+ });
+
+/* Jobs that each do a reasonable amount of work, to see how well the
+   worker task scales across threads. */
+Register_Benchmark register_worker_task_scaling
+("worker_task.parallel_work", "jobs", false,
+ [] (const Benchmark_Options & options)
+ {
+     int njobs = options.scaled(1000, 10);
+
+     return [=] ()
+     {
+         vector<double> results(njobs);
+
+         auto do_job = [&] (int job)
+         {
+             double total = 0.0;
+             for (unsigned i = 1;  i <= 20000;  ++i)
+                 total += 1.0 / (i + job);
+             results[job] = total;
+         };
+
+         run_in_parallel(0, njobs, do_job);
+
+         return (double)njobs;
+     };
+ });
+
+} // file scope
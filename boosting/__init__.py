@@ -0,0 +1,28 @@
+import numpy
+import _boosting
+
+def load_classifier(filename):
+    return _boosting.load_classifier(filename)
+
+def label_count(classifier):
+    return _boosting.label_count(classifier)
+
+def predict_batch(classifier, input, output=None):
+    """Score each row of input, a C-contiguous float32 array with a column for
+    each variable of the classifier's feature space, into output, which is
+    allocated if it isn't given.  Returns output."""
+
+    if output is None:
+        output = numpy.empty((input.shape[0], label_count(classifier)),
+                             dtype=numpy.float32)
+    _boosting.predict_batch(classifier, input, output)
+    return output
+
+def training_data(array, classifier=None):
+    """Training data over the rows of array, which is used in place and so
+    must not be modified while the training data is alive."""
+
+    return _boosting.training_data(array, classifier)
+
+def accuracy(classifier, data):
+    return _boosting.accuracy(classifier, data)
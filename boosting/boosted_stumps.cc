@@ -78,13 +78,14 @@ Function_Profiler __profiler(var);
 /*****************************************************************************/
 
 Boosted_Stumps::Boosted_Stumps()
+    : optimized_(false)
 {
 }
 
 Boosted_Stumps::
 Boosted_Stumps(const std::shared_ptr<const Feature_Space> & feature_space,
                const Feature & predicted)
-    : Classifier_Impl(feature_space, predicted)
+    : Classifier_Impl(feature_space, predicted), optimized_(false)
 {
     output = RAW;
 }
@@ -92,6 +93,7 @@ Boosted_Stumps(const std::shared_ptr<const Feature_Space> & feature_space,
 Boosted_Stumps::
 Boosted_Stumps(DB::Store_Reader & reader,
                const std::shared_ptr<const Feature_Space> & feature_space)
+    : optimized_(false)
 {
     this->reconstitute(reader, feature_space);
 }
@@ -100,7 +102,8 @@ Boosted_Stumps::
 Boosted_Stumps(const std::shared_ptr<const Feature_Space> & feature_space,
                const Feature & predicted,
                size_t label_count)
-    : Classifier_Impl(feature_space, predicted, label_count)
+    : Classifier_Impl(feature_space, predicted, label_count),
+      optimized_(false)
 {
 }
 
@@ -142,6 +145,23 @@ struct Results_Single {
     
 };
 
+/** Class for the results which accumulates the weight of each feature for
+    a single label. */
+struct Results_Explain {
+    Results_Explain(Explanation & explanation, int label, double weight)
+        : explanation(explanation), label(label), weight(weight) {}
+
+    void operator () (const distribution<float> & dist, float w,
+                      const Feature & feature) const
+    {
+        explanation.feature_weights[feature] += weight * w * dist[label];
+    }
+
+    Explanation & explanation;
+    int label;
+    double weight;
+};
+
 } // file scope
 
 distribution<float>
@@ -169,38 +189,17 @@ predict(const Feature_Set & features,
     //result.normalize();
     //result -= 0.5;
 
-    double total = 0.0;
-
-    if (output == LOGIT || output == LOGIT_NORM) {
-        for (unsigned i = 0;  i < result.size();  ++i) {
-            /* Avoid an overflow from the exp. */
-            if (result[i] > fp_traits<float>::max_exp_arg * 0.9)
-                result[i] = fp_traits<float>::max_exp_arg * 0.9;
-            double e = exp(result[i]);
-            double x = e / (e + (1.0 / e));
-            total += x;
-            result[i] = x;
-        }
-        if (output == LOGIT_NORM) {
-            if ((float)total == 0.0F) {
-                cerr << "warning: boosted stumps says no results are correct"
-                     << endl;
-                result.fill(1);  // assign all elements
-                result.normalize();
-            }
-            else result /= total;
-        }
-    }
+    transform_output(result);
 
     for (unsigned i = 0;  i < result.size();  ++i) {
         if (!finite(result[i])) {
+            double total = 0.0;
             distribution<float> result2(label_count());
             if (bias.size()) result2 += bias;
             predict_core(features, Results_Dist(result2, *feature_space()));
             
             cerr << "result = " << result << endl;
             cerr << "output of predict_core = " << result2 << endl;
-            cerr << "total = " << total << endl;
 
             for (unsigned i = 0;  i < result2.size();  ++i) {
                 /* Avoid an overflow from the exp. */
@@ -223,6 +222,34 @@ predict(const Feature_Set & features,
     return result;
 }
 
+void
+Boosted_Stumps::
+transform_output(distribution<float> & result) const
+{
+    double total = 0.0;
+
+    if (output == LOGIT || output == LOGIT_NORM) {
+        for (unsigned i = 0;  i < result.size();  ++i) {
+            /* Avoid an overflow from the exp. */
+            if (result[i] > fp_traits<float>::max_exp_arg * 0.9)
+                result[i] = fp_traits<float>::max_exp_arg * 0.9;
+            double e = exp(result[i]);
+            double x = e / (e + (1.0 / e));
+            total += x;
+            result[i] = x;
+        }
+        if (output == LOGIT_NORM) {
+            if ((float)total == 0.0F) {
+                cerr << "warning: boosted stumps says no results are correct"
+                     << endl;
+                result.fill(1);  // assign all elements
+                result.normalize();
+            }
+            else result /= total;
+        }
+    }
+}
+
 float
 Boosted_Stumps::
 predict(int label, const Feature_Set & features,
@@ -251,11 +278,124 @@ predict(int label, const Feature_Set & features,
     return result;
 }
 
+bool
+Boosted_Stumps::
+optimization_supported() const
+{
+    return true;
+}
+
+bool
+Boosted_Stumps::
+predict_is_optimized() const
+{
+    return optimized_;
+}
+
+bool
+Boosted_Stumps::
+optimize_impl(Optimization_Info & info)
+{
+    for (stumps_type::iterator it = stumps.begin();  it != stumps.end();  ++it)
+        it->second.split.optimize(info);
+
+    return optimized_ = true;
+}
+
+Label_Dist
+Boosted_Stumps::
+optimized_predict_impl(const float * features,
+                       const Optimization_Info & info,
+                       PredictionContext * context) const
+{
+    Label_Dist result(label_count());
+    if (bias.size()) result += bias;
+
+    for (stumps_type::const_iterator it = stumps.begin(), end = stumps.end();
+         it != end;  ++it) {
+        const Stump & stump = it->second;
+        stump.action.apply(result, stump.split.apply(features));
+    }
+
+    transform_output(result);
+
+    return result;
+}
+
+float
+Boosted_Stumps::
+optimized_predict_impl(int label,
+                       const float * features,
+                       const Optimization_Info & info,
+                       PredictionContext * context) const
+{
+    if (output == LOGIT_NORM)
+        return optimized_predict_impl(features, info, context)[label];
+
+    float result = 0.0;
+    if (bias.size()) result += bias[label];
+
+    for (stumps_type::const_iterator it = stumps.begin(), end = stumps.end();
+         it != end;  ++it) {
+        const Stump & stump = it->second;
+        result += stump.action.apply(label, stump.split.apply(features));
+    }
+
+    if (output == LOGIT) {
+        double e = exp(result);
+        result = e / (e + 1.0 / e);
+    }
+    return result;
+}
+
+void
+Boosted_Stumps::
+optimized_explain_impl(const float * features,
+                       const Optimization_Info & info,
+                       int label,
+                       double * contributions,
+                       double & bias,
+                       double weight) const
+{
+    if (!optimized_) {
+        Classifier_Impl::optimized_explain_impl(features, info, label,
+                                                contributions, bias, weight);
+        return;
+    }
+
+    if (this->bias.size()) bias += weight * this->bias[label];
+
+    for (stumps_type::const_iterator it = stumps.begin(), end = stumps.end();
+         it != end;  ++it) {
+        const Stump & stump = it->second;
+        contributions[stump.split.optimized_index()]
+            += weight * stump.action.apply(label, stump.split.apply(features));
+    }
+}
+
+Explanation
+Boosted_Stumps::
+explain(const Feature_Set & feature_set,
+        int label,
+        double weight,
+        PredictionContext * context) const
+{
+    Explanation result(feature_space(), weight);
+
+    if (bias.size()) result.bias += weight * bias[label];
+    predict_core(feature_set, Results_Explain(result, label, weight));
+
+    return result;
+}
+
 Boosted_Stumps::iterator Boosted_Stumps::
 insert(const Stump & stump, float weight)
 {
     if (stump.split.feature() == MISSING_FEATURE) return end();
 
+    /* The new stump isn't optimized. */
+    optimized_ = false;
+
     iterator it = find(stump.split);
     if (it == end())
         return iterator
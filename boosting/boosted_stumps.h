@@ -120,6 +120,7 @@ public:
         bias.swap(other.bias);
         sum_missing.swap(other.sum_missing);
         std::swap(predicted_, other.predicted_);
+        std::swap(optimized_, other.optimized_);
     }
 
     using Classifier_Impl::predict;
@@ -163,6 +164,42 @@ public:
     void predict_core(const Feature_Set & features, const Results & results)
         const;
 
+    virtual bool optimization_supported() const;
+
+    virtual bool predict_is_optimized() const;
+
+    /** Optimize each of the stumps to look up its feature in the dense
+        feature vector.  Inserting another stump undoes this. */
+    virtual bool optimize_impl(Optimization_Info & info);
+
+    virtual Label_Dist
+    optimized_predict_impl(const float * features,
+                           const Optimization_Info & info,
+                           PredictionContext * context = 0) const;
+
+    virtual float
+    optimized_predict_impl(int label,
+                           const float * features,
+                           const Optimization_Info & info,
+                           PredictionContext * context = 0) const;
+
+    using Classifier_Impl::optimized_predict_impl;
+
+    /** Each stump contributes the output of its action to the feature it
+        splits on, before the output transformation. */
+    virtual void
+    optimized_explain_impl(const float * features,
+                           const Optimization_Info & info,
+                           int label,
+                           double * contributions,
+                           double & bias,
+                           double weight = 1.0) const;
+
+    virtual Explanation explain(const Feature_Set & feature_set,
+                                int label,
+                                double weight = 1.0,
+                                PredictionContext * context = 0) const;
+
     /** Calculate the accuracy.  This can be done much quicker with the
         boosted stumps as it only needs to look at the index for the features
         that it has learned a stump for, and these are nicely indexed
@@ -256,6 +293,11 @@ public:
     merge(const Classifier_Impl & other, float weight = 1.0) const;
     
 private:
+    bool optimized_;
+
+    /** Apply the output transform to the raw predictions. */
+    void transform_output(distribution<float> & result) const;
+
     /** For reconstituting old classifiers only */
     Boosted_Stumps(const std::shared_ptr<const Feature_Space>
                        & feature_space,
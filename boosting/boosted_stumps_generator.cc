@@ -22,8 +22,11 @@
 #include "jml/utils/smart_ptr_utils.h"
 #include <boost/scoped_ptr.hpp>
 #include "stump_predict.h"
+#include "jml/db/persistent.h"
+#include "jml/algebra/multi_array_utils.h"
 
 using namespace std;
+using namespace ML::DB;
 
 
 namespace ML {
@@ -46,6 +49,105 @@ struct Prof {
 } prof;
 #endif
 
+/** Work out the weights of the stumps trained in one iteration of fair
+    training.  This depends upon the 1/Z score. */
+distribution<float> fair_weights(const std::vector<Stump> & all_trained)
+{
+    distribution<float> cl_weights(all_trained.size());
+    float total_z = 0.0;
+    for (unsigned s = 0;  s < all_trained.size();  ++s) {
+        float Z = all_trained[s].Z;
+        if (Z < 1e-5) cl_weights[s] = 0.0;
+        else { cl_weights[s] = 1.0 / Z;  total_z += 1.0 / Z; }
+    }
+    if (cl_weights.total() == 0.0)
+        throw Exception("Boosted_Stumps_Generator::train_iteration_fair: "
+                        "zero weight");
+    
+    /* Get the average Z score, which is needed by the logistic update. */
+    //float avg_z = total_z / cl_weights.total();
+
+    cl_weights.normalize();
+
+    return cl_weights;
+}
+
+/** Everything that generate_stumps() carries from one iteration to the
+    next.  Checkpoints are written from a copy of it, so that training can
+    carry on while they are written. */
+struct Stumps_Checkpoint {
+    Stumps_Checkpoint(unsigned iter,
+                      const boost::multi_array<float, 2> & weights,
+                      const boost::multi_array<float, 2> & training_output,
+                      const boost::multi_array<float, 2> & validation_output,
+                      const vector<pair<Stump, float> > & history,
+                      size_t best_history, float best_score, int best_iter,
+                      double validate_acc, double train_acc,
+                      const vector<Feature> & features,
+                      const std::string & rng_state)
+        : iter(iter), weights(weights), training_output(training_output),
+          validation_output(validation_output), history(history),
+          best_history(best_history), best_score(best_score),
+          best_iter(best_iter), validate_acc(validate_acc),
+          train_acc(train_acc), features(features), rng_state(rng_state)
+    {
+    }
+
+    unsigned iter;
+    boost::multi_array<float, 2> weights;
+    boost::multi_array<float, 2> training_output;
+    boost::multi_array<float, 2> validation_output;
+    vector<pair<Stump, float> > history;
+    size_t best_history;
+    float best_score;
+    int best_iter;
+    double validate_acc;
+    double train_acc;
+    vector<Feature> features;
+    std::string rng_state;
+
+    void serialize(DB::Store_Writer & store, const Feature_Space & fs) const
+    {
+        save_checkpoint_header(store, "boosted_stumps", iter);
+        save_checkpoint_matrix(store, weights);
+        save_checkpoint_matrix(store, training_output);
+        save_checkpoint_matrix(store, validation_output);
+        store << compact_size_t(history.size());
+        for (unsigned i = 0;  i < history.size();  ++i) {
+            history[i].first.serialize(store);
+            store << history[i].second;
+        }
+        store << compact_size_t(best_history) << best_score << best_iter
+              << validate_acc << train_acc;
+        save_checkpoint_features(store, fs, features);
+        store << rng_state;
+    }
+
+    /** Reconstitute into a state that already has the matrices allocated
+        with the right shape and layout. */
+    void reconstitute(DB::Store_Reader & store,
+                      const std::shared_ptr<const Feature_Space> & fs)
+    {
+        iter = load_checkpoint_header(store, "boosted_stumps");
+        load_checkpoint_matrix(store, weights, "weights");
+        load_checkpoint_matrix(store, training_output, "training output");
+        load_checkpoint_matrix(store, validation_output, "validation output");
+        compact_size_t nh(store);
+        history.clear();
+        for (unsigned i = 0;  i < nh;  ++i) {
+            Stump stump(store, fs);
+            float weight;
+            store >> weight;
+            history.push_back(make_pair(stump, weight));
+        }
+        compact_size_t bh(store);
+        best_history = bh;
+        store >> best_score >> best_iter >> validate_acc >> train_acc;
+        load_checkpoint_features(store, *fs, features);
+        store >> rng_state;
+    }
+};
+
 } // file scope
 
 
@@ -76,7 +178,10 @@ configure(const Configuration & config)
     config.find(cost_function,        "cost_function");
     config.find(output_function,      "output_function");
     config.find(short_circuit_window, "short_circuit_window");
+    config.find(stopping_criterion,   "stopping_criterion");
     config.find(trace_training_acc,   "trace_training_acc");
+    config.find(label_major_min_labels, "label_major_min_labels");
+    checkpoint.configure(config);
 }
 
 void
@@ -91,6 +196,10 @@ defaults()
     cost_function = CF_EXPONENTIAL;
     output_function = Boosted_Stumps::RAW;
     short_circuit_window = 0;
+    stopping_criterion = SC_ACCURACY;
+    trace_training_acc = false;
+    label_major_min_labels = 32;
+    checkpoint.defaults();
 }
 
 Config_Options
@@ -114,8 +223,15 @@ options() const
         .add("short_circuit_window", short_circuit_window, "0-",
              "short circuit (stop) training if no improvement for N iter "
              "(0 off)")
+        .add("stopping_criterion", stopping_criterion,
+             "statistic of the validation set that selects the best "
+             "iteration and short circuits")
         .add("trace_training_acc", trace_training_acc,
              "trace the accuracy of the training set as well as validation")
+        .add("label_major_min_labels", label_major_min_labels, "0-",
+             "store the weights label by label with at least this many "
+             "labels (0 off)")
+        .add(checkpoint.options())
         .add(weak_learner.options());
 
     return result;
@@ -163,10 +279,17 @@ generate_stumps(Thread_Context & context,
 
     unsigned nl = training_set.label_count(predicted);
     Boosted_Stumps stumps(training_set.feature_space(), predicted);
-    Boosted_Stumps best(training_set.feature_space(), predicted);
-    float best_acc = 0.0;
+    /* The best score of the stopping criterion, where higher is better. */
+    float best_score = -INFINITY;
     int best_iter = 0;
 
+    /* Every stump inserted into the model, in order, along with the weight
+       it was inserted with.  Rather than copying the whole model each time
+       the validation accuracy improves, we remember how much of the history
+       it took to get there and replay it once at the end. */
+    vector<pair<Stump, float> > history;
+    size_t best_history = 0;
+
     bool validate_is_train = false;
     if (validation_set.example_count() == 0
         || ((&validation_set == &training_set)
@@ -216,8 +339,16 @@ generate_stumps(Thread_Context & context,
     boost::multi_array<float, 2> validation_output
         (boost::extents[validation_set.example_count()][nl]);
     
+    /* With many labels, the weights of one example span several cache
+       lines; keeping each label's weights together lets the updates run
+       along the examples instead. */
+    Weights_Layout layout = WL_EXAMPLE_MAJOR;
+    if (label_major_min_labels > 0 && nl >= (unsigned)label_major_min_labels)
+        layout = WL_LABEL_MAJOR;
+
     boost::multi_array<float, 2> weights
-        = expand_weights(training_set, training_ex_weights, predicted);
+        = expand_weights(training_set, training_ex_weights, predicted,
+                         layout);
     
     boost::scoped_ptr<boost::progress_display> progress;
 
@@ -262,11 +393,46 @@ generate_stumps(Thread_Context & context,
     double validate_acc = 0.0;
     double train_acc = 0.0;
 
-    for (unsigned i = 0;  i < max_iter;  ++i) {
+    unsigned first_iter = 0;
+    if (!checkpoint.resume_from.empty()) {
+        Stumps_Checkpoint state(0, weights, training_output,
+                                validation_output, history, best_history,
+                                best_score, best_iter, validate_acc, train_acc,
+                                features, context.rng_state());
+        DB::Store_Reader store(checkpoint.resume_from);
+        state.reconstitute(store, training_set.feature_space());
+
+        swap_multi_arrays(weights, state.weights);
+        swap_multi_arrays(training_output, state.training_output);
+        swap_multi_arrays(validation_output, state.validation_output);
+        history = state.history;
+        best_history = state.best_history;
+        best_score = state.best_score;
+        best_iter = state.best_iter;
+        validate_acc = state.validate_acc;
+        train_acc = state.train_acc;
+        features = state.features;
+        context.set_rng_state(state.rng_state);
+
+        /* The model under construction is only there to be added to, so
+           replaying the history gets it back well enough. */
+        for (unsigned i = 0;  i < history.size();  ++i)
+            stumps.insert(history[i].first, history[i].second);
+
+        first_iter = state.iter + 1;
+        if (verbosity > 0)
+            cerr << "resuming from iteration " << first_iter << endl;
+    }
+
+    Training_Checkpointer checkpointer(checkpoint);
+
+    for (unsigned i = first_iter;  i < max_iter;  ++i) {
 
         if (progress) ++(*progress);
         //vector<ML::Feature> features;
 
+        Boosting_Stats validate_stats;
+
         if (!fair) {
 
             Stump stump;
@@ -286,13 +452,20 @@ generate_stumps(Thread_Context & context,
                                       opt_info);
             }
             
-            if (validate_is_train) validate_acc = train_acc;
+            history.push_back(make_pair(stump, 1.0f));
+
+            if (validate_is_train)
+                validate_stats
+                    = boosting_stats(train_acc, training_output, training_set,
+                                     predicted, training_ex_weights,
+                                     cost_function, stopping_criterion);
             else {
-                validate_acc
+                validate_stats
                     = update_accuracy(context,
                                       stump, opt_info, validation_set, features,
                                       validation_output, validate_ex_weights);
             }
+            validate_acc = validate_stats.accuracy;
 
             if (verbosity > 2) {
                 cerr << format("%4d", i);
@@ -300,6 +473,11 @@ generate_stumps(Thread_Context & context,
                     cerr << format(" %6.2f%% ", train_acc * 100.0);
                 cerr << format("%6.2f%% ",
                                validate_acc * 100.0);
+                if (stopping_criterion != SC_ACCURACY)
+                    cerr << print_stopping_score
+                                (stopping_criterion,
+                                 validate_stats.score(stopping_criterion))
+                         << " ";
                 cerr << stump.summary();
                 cerr << endl;
             }
@@ -311,6 +489,10 @@ generate_stumps(Thread_Context & context,
                                        training_set, weights, features, stumps,
                                        opt_infos);
 
+            distribution<float> cl_weights = fair_weights(all_stumps);
+            for (unsigned j = 0;  j < all_stumps.size();  ++j)
+                history.push_back(make_pair(all_stumps[j], cl_weights[j]));
+
             update_scores(training_output, training_set, all_stumps,
                           opt_infos,
                           context.group());
@@ -324,6 +506,11 @@ generate_stumps(Thread_Context & context,
             validate_acc
                 = accuracy(validation_output, validation_set,
                            predicted, validate_ex_weights);
+            validate_stats
+                = boosting_stats(validate_acc, validation_output,
+                                 validation_set, predicted,
+                                 validate_ex_weights, cost_function,
+                                 stopping_criterion);
             
             if (verbosity > 2) {
                 cerr << format("%4d %6.2f%% %6.2f%% ",
@@ -339,29 +526,53 @@ generate_stumps(Thread_Context & context,
             }
         }
         
-        if (validate_acc > best_acc && i >= min_iter) {
-            best = stumps;
-            best_acc = validate_acc;
+        double validate_score = validate_stats.score(stopping_criterion);
+        if (validate_score > best_score && i >= min_iter) {
+            best_history = history.size();
+            best_score = validate_score;
             best_iter = i;
         }
 
+        /* best_iter starts off as 0, so best_score tells if there is one. */
         if (short_circuit_window > 0 && i >= min_iter
-            && best_iter > 0 && i > best_iter + short_circuit_window) {
+            && best_score > -INFINITY && i > best_iter + short_circuit_window) {
             cerr << "no improvement for " << short_circuit_window
                  << " iterations; short circuiting" << endl;
             break;
         }
+
+        if (checkpointer.due(i)) {
+            std::shared_ptr<Stumps_Checkpoint> state
+                (new Stumps_Checkpoint(i, weights, training_output,
+                                       validation_output, history,
+                                       best_history, best_score, best_iter,
+                                       validate_acc, train_acc, features,
+                                       context.rng_state()));
+            std::shared_ptr<const Feature_Space> fs_ptr
+                = training_set.feature_space();
+            checkpointer.save([=] (DB::Store_Writer & store)
+                              {
+                                  state->serialize(store, *fs_ptr);
+                              });
+        }
     }
+
+    checkpointer.wait();
     
     if (profile)
         cerr << "training time: " << timer.elapsed() << "s" << endl;
     
     if (verbosity > 0) {
-        cerr << format("best was %6.2f%% on iteration %d", best_acc * 100.0,
-                       best_iter)
-             << endl;
+        cerr << "best was " << print_stopping_score(stopping_criterion,
+                                                     best_score)
+             << " on iteration " << best_iter << endl;
     }
 
+    Boosted_Stumps best(training_set.feature_space(), predicted);
+    if (best_history > 0) best.output = output_function;
+    for (unsigned i = 0;  i < best_history;  ++i)
+        best.insert(history[i].first, history[i].second);
+
     return best;
 }
 
@@ -507,22 +718,7 @@ train_iteration_fair(Thread_Context & context,
     }
 
 
-    /* Work out the weights.  This depends upon the 1/Z score. */
-    distribution<float> cl_weights(all_trained.size());
-    float total_z = 0.0;
-    for (unsigned s = 0;  s < all_trained.size();  ++s) {
-        float Z = all_trained[s].Z;
-        if (Z < 1e-5) cl_weights[s] = 0.0;
-        else { cl_weights[s] = 1.0 / Z;  total_z += 1.0 / Z; }
-    }
-    if (cl_weights.total() == 0.0)
-        throw Exception("Boosted_Stumps_Generator::train_iteration_fair: "
-                        "zero weight");
-    
-    /* Get the average Z score, which is needed by the logistic update. */
-    //float avg_z = total_z / cl_weights.total();
-
-    cl_weights.normalize();
+    distribution<float> cl_weights = fair_weights(all_trained);
 
     /* Insert it */
     result.insert(all_trained, cl_weights);
@@ -763,7 +959,7 @@ train_iteration(Thread_Context & context,
    all in one pass (which saves on execution time as less memory is used).
 */
 
-double
+Boosting_Stats
 Boosted_Stumps_Generator::
 update_accuracy(Thread_Context & context,
                 const Stump & stump,
@@ -811,7 +1007,9 @@ update_accuracy(Thread_Context & context,
     
     update_ticks += (ticks() - ticks_before);
 
-    return correct / ex_weights.total();
+    return boosting_stats(correct / ex_weights.total(), output, data,
+                          predicted, ex_weights, cost_function,
+                          stopping_criterion);
 }
 
 
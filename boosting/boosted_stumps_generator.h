@@ -14,6 +14,7 @@
 #include "stump_generator.h"
 #include "boosted_stumps.h"
 #include "boosting_training.h"
+#include "training_checkpoint.h"
 
 
 namespace ML {
@@ -84,8 +85,17 @@ public:
     Boosted_Stumps::Output output_function;
     bool fair;
     int short_circuit_window;
+    Stopping_Criterion stopping_criterion;
     bool trace_training_acc;
 
+    /** Keep the boosting weights label-major when there are at least this
+        many labels (0 never does). */
+    int label_major_min_labels;
+
+    /** Where and how often generate_stumps() writes checkpoints of its
+        state, and which one to resume from. */
+    Checkpoint_Config checkpoint;
+
     /* Once init has been called, we clone our potential models from this
        one. */
     Boosted_Stumps model;
@@ -147,7 +157,9 @@ public:
                          Boosted_Stumps & result,
                          std::vector<Optimization_Info> & opt_infos) const;
 
-    double
+    /** Add the stump's scores to output and return the statistics of the
+        result that the stopping criterion needs. */
+    Boosting_Stats
     update_accuracy(Thread_Context & context,
                     const Stump & stump,
                     const Optimization_Info & opt_info,
@@ -56,7 +56,11 @@ void predict_even(const Feature_Set & features, const Results & results,
     /* Algorithm: we go through the features and the algorithms at the same
        time. */
     stumps_type::const_iterator stit = stumps.begin();
+
+    /* Each call to begin() or end() is a virtual call, so we get them only
+       once. */
     Feature_Set::const_iterator fsit = features.begin();
+    Feature_Set::const_iterator fend = fsit + features.size();
         
     //cerr << "predict_core" << endl;
     while (stit != stumps.end()) {
@@ -64,12 +68,12 @@ void predict_even(const Feature_Set & features, const Results & results,
         const Feature & feature = stit->first.feature();
             
         /* Look in the feature set for this feature. */
-        while (fsit != features.end() && (*fsit).first < feature)
+        while (fsit != fend && fsit.feature() < feature)
             ++fsit;
             
         /* Get an iterator to the range of them, and find out how many. */
         Feature_Set::const_iterator fsit_end = fsit;
-        while (fsit_end != features.end() && (*fsit_end).first == feature)
+        while (fsit_end != fend && fsit_end.feature() == feature)
             ++fsit_end;
         
         stit = predict_feature_range(feature, stit, stumps.end(), fsit,
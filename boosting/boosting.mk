@@ -45,7 +45,10 @@ LIBBOOSTING_SOURCES := \
         feature_transform.cc \
         transform_list.cc \
         committee.cc \
+        compiled_scorer.cc \
+        boosting_core.cc \
         boosting_training.cc \
+        training_checkpoint.cc \
         null_classifier_generator.cc \
 	tree.cc \
 	split.cc \
@@ -55,7 +58,7 @@ LIBBOOSTING_SOURCES := \
 	label.cc \
 	buckets.cc
 
-LIBBOOSTING_LINK :=	utils db algebra arch judy ACE boost_regex boost_thread worker_task
+LIBBOOSTING_LINK :=	utils db algebra arch judy ACE boost_regex boost_thread stats worker_task
 
 #$(eval $(call set_compile_option,perceptron_generator.cc perceptron.cc,-ffast-math))
 
@@ -70,5 +73,20 @@ $(eval $(call library,boosting_cuda,$(LIBBOOSTING_CUDA_SOURCES),$(LIBBOOSTING_CU
 
 endif # CUDA_ENABLED
 
+ifeq ($(PYTHON_ENABLED),1)
+
+BOOSTING_PYTHON_SOURCES := \
+	boosting_python.cc
+
+$(eval $(call set_compile_option,$(BOOSTING_PYTHON_SOURCES),-I$(PYTHON_INCLUDE_PATH)))
+
+BOOSTING_PYTHON_LINK := boosting
+
+$(eval $(call library,boosting_python,$(BOOSTING_PYTHON_SOURCES),$(BOOSTING_PYTHON_LINK),_boosting))
+
+$(eval $(call python_module,boosting,__init__.py,,boosting_python))
+
+endif # PYTHON_ENABLED
+
 $(eval $(call include_sub_make,boosting_tools,tools))
 $(eval $(call include_sub_make,boosting_testing,testing))
@@ -0,0 +1,190 @@
+/* boosting_core.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Vectorized versions of the boosting loss functions.
+*/
+
+#include "boosting_core.h"
+#include "jml/arch/sse2_exp.h"
+
+
+using namespace std;
+
+
+namespace ML {
+
+using namespace SIMD;
+
+
+/*****************************************************************************/
+/* LOSS FUNCTIONS                                                            */
+/*****************************************************************************/
+
+namespace {
+
+/** Load four predictions, negating the one (if any) for the correct label
+    so that the margin has the right sign. */
+JML_ALWAYS_INLINE v4sf load_margin(const float * pred, int l, int corr)
+{
+    v4sf result = __builtin_ia32_loadups(pred + l);
+    if (JML_UNLIKELY(corr >= l && corr < l + 4)) {
+        float vals[4];
+        unpack(result, vals);
+        vals[corr - l] = -vals[corr - l];
+        result = pack(vals);
+    }
+    return result;
+}
+
+/** Below this many labels, the overhead of packing and unpacking the
+    vectors costs more than the scalar exp() calls that are saved. */
+enum { MIN_SIMD_LABELS = 16 };
+
+/** Apply the given vectorized update to a row of weights, four labels at
+    a time.  The few labels left over at the end (and rows that are too
+    short to benefit) use the scalar loss function. */
+template<class Loss, class Update>
+JML_ALWAYS_INLINE float
+update_row_simd(const Loss & loss, const Update & update,
+                int corr, const float * pred, float * weights, size_t nl)
+{
+    float total = 0.0;
+    unsigned l = 0;
+
+    if (nl >= MIN_SIMD_LABELS) {
+        v4sf total4 = vec_splat(0.0f);
+
+        for (; l + 4 <= nl;  l += 4) {
+            v4sf w = update(load_margin(pred, l, corr),
+                            __builtin_ia32_loadups(weights + l));
+            __builtin_ia32_storeups(weights + l, w);
+            total4 = total4 + w;
+        }
+
+        float vals[4];
+        unpack(total4, vals);
+        total = (vals[0] + vals[1]) + (vals[2] + vals[3]);
+    }
+
+    for (; l < nl;  ++l) {
+        weights[l] = loss(l, corr, pred[l], weights[l]);
+        total += weights[l];
+    }
+
+    return total;
+}
+
+/** Load the predictions for four examples of one label, negating those of
+    the examples for which it's the correct label. */
+JML_ALWAYS_INLINE v4sf
+load_column_margin(const float * pred, const Label * corr, int label)
+{
+    v4sf result = __builtin_ia32_loadups(pred);
+    if (JML_UNLIKELY(corr[0] == label || corr[1] == label
+                     || corr[2] == label || corr[3] == label)) {
+        float vals[4];
+        unpack(result, vals);
+        for (unsigned i = 0;  i < 4;  ++i)
+            if (corr[i] == label) vals[i] = -vals[i];
+        result = pack(vals);
+    }
+    return result;
+}
+
+/** Apply the given vectorized update to the weights of one label over a
+    run of examples, four examples at a time. */
+template<class Loss, class Update>
+JML_ALWAYS_INLINE float
+update_column_simd(const Loss & loss, const Update & update, int label,
+                   const Label * corr, const float * pred, float * weights,
+                   size_t n)
+{
+    v4sf total4 = vec_splat(0.0f);
+    unsigned x = 0;
+
+    for (; x + 4 <= n;  x += 4) {
+        v4sf w = update(load_column_margin(pred + x, corr + x, label),
+                        __builtin_ia32_loadups(weights + x));
+        __builtin_ia32_storeups(weights + x, w);
+        total4 = total4 + w;
+    }
+
+    float vals[4];
+    unpack(total4, vals);
+    float total = (vals[0] + vals[1]) + (vals[2] + vals[3]);
+
+    for (; x < n;  ++x) {
+        weights[x] = loss(label, corr[x], pred[x], weights[x]);
+        total += weights[x];
+    }
+
+    return total;
+}
+
+struct Boosting_Loss_Update {
+    JML_ALWAYS_INLINE v4sf operator () (v4sf margin, v4sf current) const
+    {
+        return current * sse2_expf(margin);
+    }
+};
+
+/* Only the exp is vectorized here; the rest is done in double precision
+   like the scalar version, as it is badly conditioned when the weights
+   get close to 1. */
+struct Logistic_Loss_Update {
+    Logistic_Loss_Update(double z)
+        : z(z)
+    {
+    }
+
+    double z;
+
+    JML_ALWAYS_INLINE v4sf operator () (v4sf margin, v4sf current) const
+    {
+        float qz[4], w[4];
+        unpack(sse2_expf(margin), qz);
+        unpack(current, w);
+        for (unsigned i = 0;  i < 4;  ++i)
+            w[i] = 1.0 / ((z / qz[i] * ((1.0 / w[i]) - 1.0)) - 1.0);
+        return pack(w);
+    }
+};
+
+} // file scope
+
+float
+Boosting_Loss::
+update_row(int corr, const float * pred, float * weights, size_t nl) const
+{
+    return update_row_simd(*this, Boosting_Loss_Update(),
+                           corr, pred, weights, nl);
+}
+
+float
+Boosting_Loss::
+update_column(int label, const Label * corr, const float * pred,
+              float * weights, size_t n) const
+{
+    return update_column_simd(*this, Boosting_Loss_Update(), label,
+                              corr, pred, weights, n);
+}
+
+float
+Logistic_Loss::
+update_row(int corr, const float * pred, float * weights, size_t nl) const
+{
+    return update_row_simd(*this, Logistic_Loss_Update(z),
+                           corr, pred, weights, nl);
+}
+
+float
+Logistic_Loss::
+update_column(int label, const Label * corr, const float * pred,
+              float * weights, size_t n) const
+{
+    return update_column_simd(*this, Logistic_Loss_Update(z), label,
+                              corr, pred, weights, n);
+}
+
+} // namespace ML
@@ -17,6 +17,7 @@
 #include "training_index.h"
 #include "evaluation.h"
 #include "stump_predict.h"
+#include "weighted_training.h"
 
 namespace ML {
 
@@ -26,6 +27,13 @@ namespace ML {
 
 /** Each of these objects calculate the weight associated with a single
     prediction, according to the given loss function.
+
+    They also provide an update_row() method, which updates the weights for
+    all of the labels of one example at once and returns their total.  This
+    is where the loss function gets vectorized; the Normal_Updater calls it
+    whenever the labels of an example are contiguous.  The update_column()
+    method does the same for one label over a run of examples, for when the
+    weights are label-major.
 */
 
 /** The boosting loss function.  It is exponential in the margin. */
@@ -38,6 +46,14 @@ struct Boosting_Loss {
         //*((int *)&pred) ^= (correct << 31);  // flip sign bit if correct
         return current * exp(pred);
     }
+
+    /** Update the nl weights of one example, using SIMD exp. */
+    float update_row(int corr, const float * pred, float * weights,
+                     size_t nl) const;
+
+    /** Update the weights of one label for n examples, using SIMD exp. */
+    float update_column(int label, const Label * corr, const float * pred,
+                        float * weights, size_t n) const;
 };
 
 /** The logistic boost loss function.  Requires the z function from the boosting
@@ -54,6 +70,14 @@ struct Logistic_Loss {
         float qz = exp(pred);
         return 1.0 / ((z/qz * ((1.0 / current) - 1.0)) - 1.0);
     }
+
+    /** Update the nl weights of one example, using SIMD exp. */
+    float update_row(int corr, const float * pred, float * weights,
+                     size_t nl) const;
+
+    /** Update the weights of one label for n examples, using SIMD exp. */
+    float update_column(int label, const Label * corr, const float * pred,
+                        float * weights, size_t n) const;
     
     double z;
 };
@@ -66,6 +90,30 @@ struct Boosting_Predict {
     {
         return current + pred;
     }
+
+    JML_ALWAYS_INLINE
+    float update_row(int corr, const float * pred, float * weights,
+                     size_t nl) const
+    {
+        float total = 0.0;
+        for (unsigned l = 0;  l < nl;  ++l) {
+            weights[l] += pred[l];
+            total += weights[l];
+        }
+        return total;
+    }
+
+    JML_ALWAYS_INLINE
+    float update_column(int label, const Label * corr, const float * pred,
+                        float * weights, size_t n) const
+    {
+        float total = 0.0;
+        for (unsigned x = 0;  x < n;  ++x) {
+            weights[x] += pred[x];
+            total += weights[x];
+        }
+        return total;
+    }
 };
 
 
@@ -122,6 +170,19 @@ struct Binsym_Updater {
         *weight_begin = fn(0, corr, (*pred_it) * cl_weight, *weight_begin);
         return *weight_begin * 2.0;
     }
+
+    /* Update the weights of one label over a run of examples.  There is
+       only the one column, so this is never vectorized. */
+    float update_column(int label, const Label * corr, const float * pred,
+                        float * weights, size_t n) const
+    {
+        float total = 0.0;
+        for (unsigned x = 0;  x < n;  ++x) {
+            weights[x] = fn(0, corr[x], pred[x], weights[x]);
+            total += weights[x] * 2.0;
+        }
+        return total;
+    }
 }; 
 
 template<class Fn>
@@ -171,7 +232,9 @@ struct Normal_Updater {
     {
         float total = 0.0;
         
-        if (advance) {
+        if (advance == 1)
+            total = fn.update_row(corr, &*pred_it, &*weight_begin, nl);
+        else if (advance) {
             for (unsigned l = 0;  l < nl;  ++l) {
                 *weight_begin = fn(l, corr, pred_it[l], *weight_begin);
                 total += *weight_begin;
@@ -184,6 +247,14 @@ struct Normal_Updater {
         
         return total;
     }
+
+    /* Update the weights of one label over a run of examples, given the
+       predictions for that label. */
+    float update_column(int label, const Label * corr, const float * pred,
+                        float * weights, size_t n) const
+    {
+        return fn.update_column(label, corr, pred, weights, n);
+    }
 };
 
 
@@ -197,6 +268,80 @@ struct Find_Example {
         
 
 
+/*****************************************************************************/
+/* LABEL-MAJOR UPDATES                                                       */
+/*****************************************************************************/
+
+/** Find which way each of the examples from start_x to end_x goes through
+    the split of the stump, as the weight on each branch. */
+inline void
+get_split_weights(const Stump & stump, const Training_Data & data,
+                  int start_x, int end_x, Split::Weights * result)
+{
+    Joint_Index index
+        = data.index().joint(stump.predicted(), stump.split.feature(),
+                             BY_EXAMPLE,
+                             IC_VALUE | IC_EXAMPLE);
+
+    Index_Iterator ex_start
+        = (start_x == 0
+           ? index.begin()
+           : std::lower_bound(index.begin(), index.end(), start_x,
+                              Find_Example()));
+    Index_Iterator ex_end = index.end();
+
+    for (unsigned x = start_x;  x < end_x;  ++x) {
+        Index_Iterator ex_range = ex_start;
+        while (ex_range != ex_end && ex_range->example() == x)
+            ++ex_range;
+
+        stump.split.apply(ex_start, ex_range, result[x - start_x]);
+        ex_start = ex_range;
+    }
+}
+
+/** Update the label-major weights of the examples from start_x to end_x
+    for a stump, given the way that each of them went through its split.
+    Each label is done in turn, so that the predictions and the weights are
+    both contiguous over the examples and the loss function can work on
+    several examples at once.  Returns the total of the updated weights.
+*/
+template<class Updater>
+float update_label_major(const Updater & updater,
+                         const Stump & stump, float cl_weight,
+                         const Split::Weights * split_weights,
+                         boost::multi_array<float, 2> & weights,
+                         const std::vector<Label> & labels,
+                         int start_x, int end_x)
+{
+    size_t n = end_x - start_x, nl = weights.shape()[1];
+    if (n == 0) return 0.0;
+
+    int advance = label_advance(weights);
+    float * base = &weights[start_x][0];
+
+    std::vector<float> pred(n);
+    double total = 0.0;
+
+    for (unsigned l = 0;  l < nl;  ++l) {
+        float pred_false = stump.action.pred_false[l] * cl_weight;
+        float pred_true = stump.action.pred_true[l] * cl_weight;
+        float pred_missing = stump.action.pred_missing[l] * cl_weight;
+
+        for (unsigned i = 0;  i < n;  ++i) {
+            const Split::Weights & w = split_weights[i];
+            pred[i] = w[false] * pred_false + w[true] * pred_true
+                + w[MISSING] * pred_missing;
+        }
+
+        total += updater.update_column(l, &labels[start_x], &pred[0],
+                                       base + l * advance, n);
+    }
+
+    return total;
+}
+
+
 /*****************************************************************************/
 /* UPDATE_WEIGHTS                                                            */
 /*****************************************************************************/
@@ -221,6 +366,16 @@ struct Update_Weights {
     {
         if (end_x == -1) end_x = data.example_count();
 
+        if (weights_layout(weights) == WL_LABEL_MAJOR) {
+            std::vector<Split::Weights> split_weights(end_x - start_x);
+            get_split_weights(stump, data, start_x, end_x,
+                              split_weights.data());
+            return update_label_major(updater, stump, cl_weight,
+                                      split_weights.data(), weights,
+                                      data.index().labels(stump.predicted()),
+                                      start_x, end_x);
+        }
+
         Joint_Index index
             = data.index().joint(stump.predicted(), stump.split.feature(),
                                  BY_EXAMPLE,
@@ -239,7 +394,7 @@ struct Update_Weights {
         const std::vector<Label> & labels
             = data.index().labels(stump.predicted());
 
-        int advance = (weights.shape()[1] == 1 ? 0 : 1);
+        int advance = label_advance(weights);
 
         for (unsigned x = start_x;  x < end_x;  ++x) {
 
@@ -294,7 +449,7 @@ struct Update_Weights {
         const std::vector<Label> & labels
             = data.index().labels(classifier.predicted());
         
-        int advance = (weights.shape()[1] == 1 ? 0 : 1);
+        int advance = label_advance(weights);
 
         using namespace std;
         //map<float, int> output;
@@ -408,10 +563,18 @@ struct Update_Weights_And_Scores {
         const std::vector<Label> & labels
             = data.index().labels(stump.predicted());
 
-        int advance = (weights.shape()[1] == 1 ? 0 : 1);
+        int advance = label_advance(weights);
+        int output_advance = label_advance(output);
         //cerr << "advance = " << advance << endl;
         //cerr << "cl_weight = " << cl_weight << endl;
 
+        /* Label-major weights are updated a label at a time once we know
+           which way each example went; the output is always example-major,
+           as the scorer needs each example's outputs together. */
+        bool label_major = (weights_layout(weights) == WL_LABEL_MAJOR);
+        std::vector<Split::Weights>
+            split_weights(label_major ? end_x - start_x : 0);
+
         double correct = 0.0;
 
         Index_Iterator ex_start
@@ -438,24 +601,35 @@ struct Update_Weights_And_Scores {
             //         << cl_weight << " classifier.predict(data[x]) = "
             //         << stump.predict(data[x]) << endl;
 
-            float t = weights_updater(stump, opt_info, cl_weight, labels[x],
-                                      ex_start, ex_range,
-                                      &weights[x][0], advance);
+            if (label_major)
+                stump.split.apply(ex_start, ex_range,
+                                  split_weights[x - start_x]);
+            else {
+                float t = weights_updater(stump, opt_info, cl_weight,
+                                          labels[x], ex_start, ex_range,
+                                          &weights[x][0], advance);
+                //cerr << "  updater returned total " << t << endl;
+                total += t;
+                __builtin_prefetch(&weights[x][0] + 24, 1, 3);
+            }
             
             output_updater(stump, opt_info, cl_weight, labels[x],
                            ex_start, ex_range,
-                           &output[x][0], advance);
+                           &output[x][0], output_advance);
 
             correct += scorer(labels[x], &output[x][0], &output[x][0] + nl)
                 * example_weights[x];
 
-            //cerr << "  updater returned total " << t << endl;
-            total += t;
-            
-            __builtin_prefetch(&weights[x][0] + 24, 1, 3);
             __builtin_prefetch(&output[x][0] + 24, 1, 3);
             ex_start = ex_range;
         }
+
+        /* Examples with no weight went down no branch, and so keep their
+           (zero) weights. */
+        if (label_major)
+            total += update_label_major(weights_updater, stump, cl_weight,
+                                        split_weights.data(), weights,
+                                        labels, start_x, end_x);
         
         accuracy = correct / example_weights.total();
 
@@ -484,7 +658,8 @@ struct Update_Weights_And_Scores {
         const std::vector<Label> & labels
             = data.index().labels(classifier.predicted());
 
-        int advance = (weights.shape()[1] == 1 ? 0 : 1);
+        int advance = label_advance(weights);
+        int output_advance = label_advance(output);
 
 
         using namespace std;
@@ -507,7 +682,7 @@ struct Update_Weights_And_Scores {
                                       data[x], &weights[x][0], advance);
             
             output_updater(classifier, opt_info, cl_weight, labels[x],
-                           data[x], &output[x][0], advance);
+                           data[x], &output[x][0], output_advance);
             
             correct += scorer(labels[x], &output[x][0], &output[x][0] + nl)
                 * example_weights[x];
@@ -586,7 +761,7 @@ struct Update_Scores {
                                   Find_Example()));
         Index_Iterator ex_end   = index.end();
 
-        int advance = (output.shape()[1] == 1 ? 0 : 1);
+        int advance = label_advance(output);
 
         double correct = 0.0;
 
@@ -634,7 +809,7 @@ struct Update_Scores {
         const std::vector<Label> & labels
             = data.index().labels(classifier.predicted());
 
-        int advance = (output.shape()[1] == 1 ? 0 : 1);
+        int advance = label_advance(output);
 
         double correct = 0.0;
 
@@ -13,10 +13,25 @@
 #include "jml/utils/guard.h"
 #include <boost/bind.hpp>
 #include "jml/utils/smart_ptr_utils.h"
+#include "jml/arch/numa.h"
 
 
 namespace ML {
 
+/** Adjust the number of examples that each job updates for the layout of
+    the weights.  Label-major weights are updated along a run of the job's
+    examples for each label in turn, so the runs need to be long enough to
+    be streamed through rather than each touching a few cache lines.
+*/
+inline size_t
+update_chunk_examples(const boost::multi_array<float, 2> & weights,
+                      size_t examples_per_chunk)
+{
+    if (weights_layout(weights) == WL_LABEL_MAJOR)
+        return std::max<size_t>(examples_per_chunk, 1024);
+    return examples_per_chunk;
+}
+
 /*****************************************************************************/
 /* UPDATE_WEIGHTS_PARALLEL                                                   */
 /*****************************************************************************/
@@ -131,7 +146,9 @@ struct Update_Weights_Parallel : public Update_Weights<Updater> {
         size_t nx = weights.shape()[0];
         
         size_t ENTRIES_PER_CHUNK = 4096;
-        size_t examples_per_chunk = ENTRIES_PER_CHUNK / weights.shape()[1];
+        size_t examples_per_chunk
+            = update_chunk_examples(weights,
+                                    ENTRIES_PER_CHUNK / weights.shape()[1]);
 
         total = 0.0;
 
@@ -143,7 +160,7 @@ struct Update_Weights_Parallel : public Update_Weights<Updater> {
                               chunk_start,
                               std::min(nx, chunk_start + examples_per_chunk),
                               group),
-                       group);
+                       group, numa_partition_node(chunk_start, nx));
             chunk_start += examples_per_chunk;
         }
     }
@@ -248,7 +265,7 @@ struct Update_Weights_Parallel : public Update_Weights<Updater> {
             worker.add(Update_Job_Classifier(info, chunk_start, end),
                        format("Update_Job_Classifier %zd-%zd under %d",
                               chunk_start, end, group),
-                       group);
+                       group, numa_partition_node(chunk_start, nx));
             chunk_start = end;
         }
     }
@@ -388,7 +405,7 @@ struct Update_Scores_Parallel
             worker.add(Update_Job(info, chunk_start, end),
                        format("Update_Job %zd-%zd under %d",
                               chunk_start, end, group),
-                       group);
+                       group, numa_partition_node(chunk_start, nx));
             chunk_start = end;
         }
     }
@@ -497,7 +514,7 @@ struct Update_Scores_Parallel
             worker.add(Update_Job_Classifier(info, chunk_start, end),
                        format("Update_Job_Classifier %zd-%zd under %d",
                               chunk_start, end, group),
-                       group);
+                       group, numa_partition_node(chunk_start, nx));
             chunk_start = end;
         }
     }
@@ -658,7 +675,9 @@ struct Update_Weights_And_Scores_Parallel
         size_t nx = output.shape()[0];
         
         size_t ENTRIES_PER_CHUNK = 2048;
-        size_t examples_per_chunk = ENTRIES_PER_CHUNK / output.shape()[1];
+        size_t examples_per_chunk
+            = update_chunk_examples(weights,
+                                    ENTRIES_PER_CHUNK / output.shape()[1]);
 
         size_t chunk_start = 0;
         while (chunk_start < nx) {
@@ -666,7 +685,7 @@ struct Update_Weights_And_Scores_Parallel
             worker.add(Update_Job(info, chunk_start, end),
                        format("Update_Job %zd-%zd under %d",
                               chunk_start, end, group),
-                       group);
+                       group, numa_partition_node(chunk_start, nx));
             chunk_start = end;
         }
     }
@@ -780,7 +799,7 @@ struct Update_Weights_And_Scores_Parallel
             worker.add(Update_Job_Classifier(info, chunk_start, end),
                        format("Update_Job_Classifier %zd-%zd under %d",
                               chunk_start, end, group),
-                       group);
+                       group, numa_partition_node(chunk_start, nx));
             chunk_start = end;
         }
     }
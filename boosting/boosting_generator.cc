@@ -23,13 +23,89 @@
 #include "jml/utils/worker_task.h"
 #include "jml/utils/guard.h"
 #include <boost/scoped_ptr.hpp>
+#include "jml/db/persistent.h"
+#include "jml/algebra/multi_array_utils.h"
 
 
 using namespace std;
+using namespace ML::DB;
 
 
 namespace ML {
 
+namespace {
+
+/** Everything that Boosting_Generator::generate() carries from one
+    iteration to the next.  The weak classifiers are shared rather than
+    copied, as they never change once they have been trained. */
+struct Boosting_Checkpoint {
+    Boosting_Checkpoint(unsigned iter,
+                        const boost::multi_array<float, 2> & weights,
+                        const boost::multi_array<float, 2> & training_output,
+                        const boost::multi_array<float, 2> & validation_output,
+                        const vector<std::shared_ptr<Classifier_Impl> >
+                            & classifiers,
+                        float best_score, int best_iter,
+                        double validate_acc, double train_acc,
+                        const vector<Feature> & features,
+                        const std::string & rng_state)
+        : iter(iter), weights(weights), training_output(training_output),
+          validation_output(validation_output), classifiers(classifiers),
+          best_score(best_score), best_iter(best_iter),
+          validate_acc(validate_acc), train_acc(train_acc),
+          features(features), rng_state(rng_state)
+    {
+    }
+
+    unsigned iter;
+    boost::multi_array<float, 2> weights;
+    boost::multi_array<float, 2> training_output;
+    boost::multi_array<float, 2> validation_output;
+    vector<std::shared_ptr<Classifier_Impl> > classifiers;
+    float best_score;
+    int best_iter;
+    double validate_acc;
+    double train_acc;
+    vector<Feature> features;
+    std::string rng_state;
+
+    void serialize(DB::Store_Writer & store, const Feature_Space & fs) const
+    {
+        save_checkpoint_header(store, "boosting", iter);
+        save_checkpoint_matrix(store, weights);
+        save_checkpoint_matrix(store, training_output);
+        save_checkpoint_matrix(store, validation_output);
+        store << compact_size_t(classifiers.size());
+        for (unsigned i = 0;  i < classifiers.size();  ++i)
+            classifiers[i]->poly_serialize(store, false);
+        store << best_score << best_iter << validate_acc << train_acc;
+        save_checkpoint_features(store, fs, features);
+        store << rng_state;
+    }
+
+    /** Reconstitute into a state that already has the matrices allocated
+        with the right shape and layout. */
+    void reconstitute(DB::Store_Reader & store,
+                      const std::shared_ptr<const Feature_Space> & fs)
+    {
+        iter = load_checkpoint_header(store, "boosting");
+        load_checkpoint_matrix(store, weights, "weights");
+        load_checkpoint_matrix(store, training_output, "training output");
+        load_checkpoint_matrix(store, validation_output, "validation output");
+        compact_size_t nc(store);
+        classifiers.clear();
+        for (unsigned i = 0;  i < nc;  ++i)
+            classifiers.push_back
+                (Classifier_Impl::poly_reconstitute(store, fs));
+        store >> best_score >> best_iter >> validate_acc >> train_acc;
+        load_checkpoint_features(store, *fs, features);
+        store >> rng_state;
+    }
+};
+
+} // file scope
+
+
 /*****************************************************************************/
 /* BOOSTING_GENERATOR                                                        */
 /*****************************************************************************/
@@ -54,7 +130,9 @@ configure(const Configuration & config)
     config.find(min_iter,             "min_iter");
     config.find(cost_function,        "cost_function");
     config.find(short_circuit_window, "short_circuit_window");
+    config.find(stopping_criterion,   "stopping_criterion");
     config.find(trace_training_acc,   "trace_training_acc");
+    checkpoint.configure(config);
 
     weak_learner = get_trainer("weak_learner", config);
 }
@@ -68,8 +146,10 @@ defaults()
     min_iter = 10;
     cost_function = CF_EXPONENTIAL;
     short_circuit_window = 0;
+    stopping_criterion = SC_ACCURACY;
     weak_learner.reset();
     trace_training_acc = false;
+    checkpoint.defaults();
 }
 
 Config_Options
@@ -87,8 +167,12 @@ options() const
         .add("short_circuit_window", short_circuit_window, "0-",
              "short circuit (stop) training if no improvement for N iter "
              "(0 off)")
+        .add("stopping_criterion", stopping_criterion,
+             "statistic of the validation set that selects the best "
+             "iteration and short circuits")
         .add("trace_training_acc", trace_training_acc,
              "trace the accuracy of the training set as well as validation")
+        .add(checkpoint.options())
         .subconfig("weak_leaner", weak_learner,
                    "weak learner that produces each bag");
 
@@ -120,7 +204,8 @@ generate(Thread_Context & context,
 
     unsigned nl = training_set.label_count(predicted);
 
-    float best_acc = 0.0;
+    /* The best score of the stopping criterion, where higher is better. */
+    float best_score = -INFINITY;
     int best_iter = 0;
 
     bool validate_is_train = false;
@@ -162,7 +247,34 @@ generate(Thread_Context & context,
     double validate_acc = 0.0;
     double train_acc = 0.0;
 
-    for (unsigned i = 0;  i < max_iter;  ++i) {
+    unsigned first_iter = 0;
+    if (!checkpoint.resume_from.empty()) {
+        Boosting_Checkpoint state(0, weights, training_output,
+                                  validation_output, classifiers,
+                                  best_score, best_iter, validate_acc,
+                                  train_acc, features, context.rng_state());
+        DB::Store_Reader store(checkpoint.resume_from);
+        state.reconstitute(store, training_set.feature_space());
+
+        swap_multi_arrays(weights, state.weights);
+        swap_multi_arrays(training_output, state.training_output);
+        swap_multi_arrays(validation_output, state.validation_output);
+        classifiers = state.classifiers;
+        best_score = state.best_score;
+        best_iter = state.best_iter;
+        validate_acc = state.validate_acc;
+        train_acc = state.train_acc;
+        features = state.features;
+        context.set_rng_state(state.rng_state);
+
+        first_iter = state.iter + 1;
+        if (verbosity > 0)
+            cerr << "resuming from iteration " << first_iter << endl;
+    }
+
+    Training_Checkpointer checkpointer(checkpoint);
+
+    for (unsigned i = first_iter;  i < max_iter;  ++i) {
 
         if (progress) ++(*progress);
 
@@ -181,12 +293,19 @@ generate(Thread_Context & context,
                 = train_iteration(context, training_set, weights, features,
                                   Z, opt_info);
         
-        if (validate_is_train) validate_acc = train_acc;
+        Boosting_Stats validate_stats;
+        if (validate_is_train)
+            validate_stats
+                = boosting_stats(train_acc, training_output, training_set,
+                                 predicted, training_ex_weights,
+                                 cost_function, stopping_criterion);
         else
-            validate_acc
+            validate_stats
                 = update_accuracy(context, *weak_classifier, opt_info,
                                   validation_set, features,
                                   validation_output, validate_ex_weights);
+        validate_acc = validate_stats.accuracy;
+        double validate_score = validate_stats.score(stopping_criterion);
 
 #if 0
         float min_weight = 1.0, max_weight = 0.0, max_diff = 0.0;
@@ -244,15 +363,26 @@ generate(Thread_Context & context,
             if (trace_training_acc)
                 cerr << format(" %6.2f%%", train_acc * 100.0);
             cerr << format(" %6.2f%% %5.3f ", validate_acc * 100.0, Z);
+            if (stopping_criterion != SC_ACCURACY)
+                cerr << print_stopping_score(stopping_criterion,
+                                             validate_score) << " ";
             cerr << weak_classifier->summary();
             cerr << endl;
         }
 
         classifiers.push_back(weak_classifier);
 
-        if (validate_acc > best_acc && i >= min_iter) {
+        if (validate_score > best_score && i >= min_iter) {
             best_iter = i;
-            best_acc = validate_acc;
+            best_score = validate_score;
+        }
+
+        /* best_iter starts off as 0, so best_score tells if there is one. */
+        if (short_circuit_window > 0 && i >= min_iter
+            && best_score > -INFINITY && i > best_iter + short_circuit_window) {
+            cerr << "no improvement for " << short_circuit_window
+                 << " iterations; short circuiting" << endl;
+            break;
         }
 
         if (Z == 1.0f) {
@@ -261,12 +391,29 @@ generate(Thread_Context & context,
             break;  // too much capacity; we've learned non-zero weights
                     // perfectly
         }
+
+        if (checkpointer.due(i)) {
+            std::shared_ptr<Boosting_Checkpoint> state
+                (new Boosting_Checkpoint(i, weights, training_output,
+                                         validation_output, classifiers,
+                                         best_score, best_iter, validate_acc,
+                                         train_acc, features,
+                                         context.rng_state()));
+            std::shared_ptr<const Feature_Space> fs_ptr
+                = training_set.feature_space();
+            checkpointer.save([=] (DB::Store_Writer & store)
+                              {
+                                  state->serialize(store, *fs_ptr);
+                              });
+        }
     }
 
+    checkpointer.wait();
+
     if (verbosity > 0) {
-        cerr << format("best was %6.2f%% on iteration %d", best_acc * 100.0,
-                       best_iter)
-             << endl;
+        cerr << "best was " << print_stopping_score(stopping_criterion,
+                                                     best_score)
+             << " on iteration " << best_iter << endl;
     }
 
     if (profile)
@@ -625,7 +772,7 @@ train_iteration(Thread_Context & context,
    all in one pass (which saves on execution time as less memory is used).
 */
 
-double
+Boosting_Stats
 Boosting_Generator::
 update_accuracy(Thread_Context & context,
                 const Classifier_Impl & weak_classifier,
@@ -669,7 +816,9 @@ update_accuracy(Thread_Context & context,
         task.run_until_finished(update.group);
     }
     
-    return correct / ex_weights.total();
+    return boosting_stats(correct / ex_weights.total(), output, data,
+                          predicted, ex_weights, cost_function,
+                          stopping_criterion);
 }
 
 
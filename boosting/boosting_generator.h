@@ -12,6 +12,7 @@
 
 #include "weight_updating_generator.h"
 #include "boosting_training.h"
+#include "training_checkpoint.h"
 
 
 namespace ML {
@@ -72,8 +73,13 @@ public:
     float ignore_highest;
     Stump::Update update_alg;
     int short_circuit_window;
+    Stopping_Criterion stopping_criterion;
     bool trace_training_acc;
 
+    /** Where and how often generate() writes checkpoints of its state, and
+        which one to resume from. */
+    Checkpoint_Config checkpoint;
+
     std::shared_ptr<Classifier_Impl>
     train_iteration(Thread_Context & context,
                     const Training_Data & data,
@@ -92,7 +98,9 @@ public:
                     double & training_accuracy, float & Z,
                     Optimization_Info & opt_info) const;
 
-    double
+    /** Add the weak classifier's scores to output and return the
+        statistics of the result that the stopping criterion needs. */
+    Boosting_Stats
     update_accuracy(Thread_Context & context,
                     const Classifier_Impl & weak_classifier,
                     const Optimization_Info & opt_info,
@@ -0,0 +1,401 @@
+/* boosting_python.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Python wrapper to score NumPy arrays with a classifier without copying
+   them.
+*/
+
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+
+#include <Python.h>
+#include <numpy/arrayobject.h>
+#include "classifier.h"
+#include "dense_features.h"
+#include "jml/arch/exception.h"
+#include "jml/arch/demangle.h"
+#include "jml/arch/format.h"
+#include <exception>
+#include <iostream>
+#include <cxxabi.h>
+#include <typeinfo>
+
+
+using namespace std;
+using namespace ML;
+
+// For the following: numpy/__multiarray_api.h: error: ‘int _import_array()’ defined but not used
+int (*fn) () = &_import_array;
+
+PyObject * to_python_exception(const std::type_info * exc_type,
+                               const char * what = 0)
+{
+    std::string message;
+    if (what)
+        message = format("JML Exception of type %s caught: %s",
+                         demangle(exc_type->name()).c_str(),
+                         what);
+    else
+        message = format("JML Exception of type %s caught",
+                         demangle(exc_type->name()).c_str());
+
+    PyErr_SetString(PyExc_RuntimeError, message.c_str());
+
+    return NULL;
+}
+
+PyObject * to_python_exception(const std::exception & exc)
+{
+    return to_python_exception(&typeid(exc), exc.what());
+}
+
+PyObject * to_python_exception()
+{
+    const std::type_info * exc_type = abi::__cxa_current_exception_type();
+    if (!exc_type) {
+        cerr << "exception type was null" << endl;
+        abort();
+    }
+
+    return to_python_exception(exc_type);
+}
+
+/** Turn an exception caught while the GIL was released into a Python one,
+    now that we have it back. */
+PyObject * to_python_exception(const std::exception_ptr & exc)
+{
+    try {
+        std::rethrow_exception(exc);
+    } catch (const std::exception & exc) {
+        return to_python_exception(exc);
+    } catch (...) {
+        return to_python_exception();
+    }
+}
+
+
+/*****************************************************************************/
+/* ARRAYS                                                                    */
+/*****************************************************************************/
+
+/** Check that obj is a 2 dimensional, C-contiguous, aligned float32 NumPy
+    array that we can use in place, and return it as one.  If writeable is
+    set it must also be writeable.  Returns NULL with a Python exception set
+    if it isn't. */
+static PyArrayObject *
+float32_matrix(PyObject * obj, const char * name, bool writeable = false)
+{
+    if (!PyArray_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a numpy array", name);
+        return NULL;
+    }
+
+    PyArrayObject * array = (PyArrayObject *)obj;
+
+    if (PyArray_TYPE(array) != NPY_FLOAT32) {
+        PyErr_Format(PyExc_TypeError, "%s must have dtype float32", name);
+        return NULL;
+    }
+    if (PyArray_NDIM(array) != 2) {
+        PyErr_Format(PyExc_ValueError, "%s must have 2 dimensions, not %d",
+                     name, PyArray_NDIM(array));
+        return NULL;
+    }
+    if (!PyArray_ISCARRAY_RO(array)) {
+        PyErr_Format(PyExc_ValueError, "%s must be C-contiguous and aligned",
+                     name);
+        return NULL;
+    }
+    if (writeable && !PyArray_ISWRITEABLE(array)) {
+        PyErr_Format(PyExc_ValueError, "%s must be writeable", name);
+        return NULL;
+    }
+
+    return array;
+}
+
+
+/*****************************************************************************/
+/* CLASSIFIER                                                                */
+/*****************************************************************************/
+
+/** What a classifier capsule holds.  The classifier is optimized for its
+    dense features once, when it's loaded, so that scoring doesn't modify
+    it and can run without the GIL. */
+struct Py_Classifier {
+    Classifier classifier;
+    std::shared_ptr<const Dense_Feature_Space> feature_space;
+    Optimization_Info info;
+};
+
+static const char * CLASSIFIER_CAPSULE = "jml.Classifier";
+
+static void delete_classifier(PyObject * capsule)
+{
+    delete (Py_Classifier *)PyCapsule_GetPointer(capsule, CLASSIFIER_CAPSULE);
+}
+
+/** Return the classifier in obj, or NULL with a Python exception set if it
+    isn't one from load_classifier(). */
+static Py_Classifier * get_classifier(PyObject * obj)
+{
+    if (!PyCapsule_IsValid(obj, CLASSIFIER_CAPSULE)) {
+        PyErr_SetString(PyExc_TypeError, "expected a classifier");
+        return NULL;
+    }
+    return (Py_Classifier *)PyCapsule_GetPointer(obj, CLASSIFIER_CAPSULE);
+}
+
+static PyObject *
+boosting_load_classifier(PyObject * self, PyObject * args)
+{
+    const char * filename;
+    if (!PyArg_ParseTuple(args, "s", &filename))
+        return NULL;
+
+    try {
+        std::unique_ptr<Py_Classifier> result(new Py_Classifier());
+        result->classifier.load(filename);
+        result->feature_space
+            = result->classifier.feature_space<Dense_Feature_Space>();
+        result->info = result->classifier.impl
+            ->optimize(result->feature_space->dense_features());
+
+        PyObject * capsule = PyCapsule_New(result.get(), CLASSIFIER_CAPSULE,
+                                           delete_classifier);
+        if (capsule)
+            result.release();
+        return capsule;
+    } catch (const std::exception & exc) {
+        return to_python_exception(exc);
+    } catch (...) {
+        return to_python_exception();
+    }
+}
+
+static PyObject *
+boosting_label_count(PyObject * self, PyObject * args)
+{
+    PyObject * classifier_obj;
+    if (!PyArg_ParseTuple(args, "O", &classifier_obj))
+        return NULL;
+
+    Py_Classifier * classifier = get_classifier(classifier_obj);
+    if (!classifier)
+        return NULL;
+
+    return PyLong_FromSize_t(classifier->classifier.label_count());
+}
+
+static PyObject *
+boosting_predict_batch(PyObject * self, PyObject * args)
+{
+    PyObject * classifier_obj, * input_obj, * output_obj;
+    if (!PyArg_ParseTuple(args, "OOO", &classifier_obj, &input_obj,
+                          &output_obj))
+        return NULL;
+
+    Py_Classifier * classifier = get_classifier(classifier_obj);
+    if (!classifier)
+        return NULL;
+
+    PyArrayObject * input = float32_matrix(input_obj, "input");
+    if (!input)
+        return NULL;
+    PyArrayObject * output = float32_matrix(output_obj, "output", true);
+    if (!output)
+        return NULL;
+
+    size_t n = PyArray_DIM(input, 0), cols = PyArray_DIM(input, 1);
+    size_t nv = classifier->feature_space->variable_count();
+    size_t nl = classifier->classifier.label_count();
+
+    if (cols != nv) {
+        PyErr_Format(PyExc_ValueError, "input has %zd columns but the "
+                     "classifier's feature space has %zd variables",
+                     cols, nv);
+        return NULL;
+    }
+    if ((size_t)PyArray_DIM(output, 0) != n
+        || (size_t)PyArray_DIM(output, 1) != nl) {
+        PyErr_Format(PyExc_ValueError, "output must have shape (%zd, %zd)",
+                     n, nl);
+        return NULL;
+    }
+
+    const float * rows = (const float *)PyArray_DATA(input);
+    float * result = (float *)PyArray_DATA(output);
+
+    std::exception_ptr exc;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        classifier->classifier
+            .predict_batch(rows, n, classifier->feature_space->dense_features(),
+                           result, &classifier->info);
+    } catch (...) {
+        exc = std::current_exception();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (exc)
+        return to_python_exception(exc);
+
+    Py_RETURN_NONE;
+}
+
+
+/*****************************************************************************/
+/* TRAINING DATA                                                             */
+/*****************************************************************************/
+
+static const char * TRAINING_DATA_CAPSULE = "jml.Dense_Training_Data";
+
+typedef std::shared_ptr<Dense_Training_Data> Training_Data_Ptr;
+
+static void delete_training_data(PyObject * capsule)
+{
+    delete (Training_Data_Ptr *)
+        PyCapsule_GetPointer(capsule, TRAINING_DATA_CAPSULE);
+}
+
+/** Drop the training data's reference to its array, which can happen on
+    any thread. */
+static void release_array(PyObject * array)
+{
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_DECREF(array);
+    PyGILState_Release(state);
+}
+
+static PyObject *
+boosting_training_data(PyObject * self, PyObject * args)
+{
+    PyObject * array_obj, * classifier_obj = 0;
+    if (!PyArg_ParseTuple(args, "O|O", &array_obj, &classifier_obj))
+        return NULL;
+
+    PyArrayObject * array = float32_matrix(array_obj, "array");
+    if (!array)
+        return NULL;
+
+    Py_Classifier * classifier = 0;
+    if (classifier_obj && classifier_obj != Py_None) {
+        classifier = get_classifier(classifier_obj);
+        if (!classifier)
+            return NULL;
+    }
+
+    try {
+        /* With a classifier the variables are its own, so that it can be
+           tested on the data; otherwise they're all real. */
+        std::shared_ptr<Dense_Feature_Space> fs
+            (classifier
+             ? classifier->feature_space->make_copy()
+             : new Dense_Feature_Space());
+
+        /* The data is used in place, so it keeps the array alive. */
+        Py_INCREF(array_obj);
+        std::shared_ptr<const void> owner(array_obj, release_array);
+
+        std::unique_ptr<Training_Data_Ptr> result
+            (new Training_Data_Ptr
+             (new Dense_Training_Data((const float *)PyArray_DATA(array),
+                                      PyArray_DIM(array, 0),
+                                      PyArray_DIM(array, 1),
+                                      fs, owner)));
+
+        PyObject * capsule = PyCapsule_New(result.get(), TRAINING_DATA_CAPSULE,
+                                           delete_training_data);
+        if (capsule)
+            result.release();
+        return capsule;
+    } catch (const std::exception & exc) {
+        return to_python_exception(exc);
+    } catch (...) {
+        return to_python_exception();
+    }
+}
+
+static PyObject *
+boosting_accuracy(PyObject * self, PyObject * args)
+{
+    PyObject * classifier_obj, * data_obj;
+    if (!PyArg_ParseTuple(args, "OO", &classifier_obj, &data_obj))
+        return NULL;
+
+    Py_Classifier * classifier = get_classifier(classifier_obj);
+    if (!classifier)
+        return NULL;
+
+    if (!PyCapsule_IsValid(data_obj, TRAINING_DATA_CAPSULE)) {
+        PyErr_SetString(PyExc_TypeError, "expected training data");
+        return NULL;
+    }
+    Training_Data_Ptr * data
+        = (Training_Data_Ptr *)PyCapsule_GetPointer(data_obj,
+                                                    TRAINING_DATA_CAPSULE);
+
+    std::pair<float, float> result;
+    std::exception_ptr exc;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        result = classifier->classifier.accuracy(**data);
+    } catch (...) {
+        exc = std::current_exception();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (exc)
+        return to_python_exception(exc);
+
+    return Py_BuildValue("(dd)", result.first, result.second);
+}
+
+static PyMethodDef BoostingMethods[] = {
+    {"load_classifier",  boosting_load_classifier, METH_VARARGS,
+     "Load a classifier over a dense feature space from a file."},
+    {"label_count",  boosting_label_count, METH_VARARGS,
+     "Return the number of labels that the classifier scores."},
+    {"predict_batch",  boosting_predict_batch, METH_VARARGS,
+     "Score each row of a C-contiguous float32 (n x variables) array into "
+     "a preallocated float32 (n x labels) array, without the GIL."},
+    {"training_data",  boosting_training_data, METH_VARARGS,
+     "Make dense training data that uses a C-contiguous float32 array in "
+     "place, over the variables of the classifier if one is given."},
+    {"accuracy",  boosting_accuracy, METH_VARARGS,
+     "Return the accuracy and mean margin of the classifier over the "
+     "training data."},
+    {NULL, NULL, 0, NULL}        /* Sentinel */
+};
+
+extern "C" {
+
+#if PY_MAJOR_VERSION >= 3
+
+static struct PyModuleDef boosting_module = {
+    PyModuleDef_HEAD_INIT, "_boosting", NULL, -1, BoostingMethods
+};
+
+PyMODINIT_FUNC
+PyInit__boosting(void)
+{
+    import_array();
+
+    return PyModule_Create(&boosting_module);
+}
+
+#else
+
+PyMODINIT_FUNC
+init_boosting(void)
+{
+    import_array();
+
+    Py_InitModule("_boosting", BoostingMethods);
+}
+
+#endif
+
+} // extern "C"
@@ -12,6 +12,9 @@
 #include "jml/utils/vector_utils.h"
 #include "boosting_core.h"
 #include "jml/utils/smart_ptr_utils.h"
+#include "jml/stats/auc.h"
+#include "jml/arch/format.h"
+#include <cfloat>
 
 
 using namespace std;
@@ -190,6 +193,143 @@ update_scores(boost::multi_array<float, 2> & example_scores,
     }
 }
 
+
+/*****************************************************************************/
+/* BOOSTING_STATS                                                            */
+/*****************************************************************************/
+
+namespace {
+
+/** Score of label l for example x.  A single column holds the score of
+    label 0 of a binary symmetric problem; label 1's is its negation. */
+inline float label_score(const boost::multi_array<float, 2> & output,
+                         int x, int l)
+{
+    if (output.shape()[1] == 1)
+        return (l == 0 ? output[x][0] : -output[x][0]);
+    return output[x][l];
+}
+
+inline int label_count(const boost::multi_array<float, 2> & output)
+{
+    return (output.shape()[1] == 1 ? 2 : output.shape()[1]);
+}
+
+} // file scope
+
+double
+Boosting_Stats::
+score(Stopping_Criterion criterion) const
+{
+    switch (criterion) {
+    case SC_ACCURACY: return accuracy;
+    /* A diverged loss can overflow a float, which is what the best score
+       is kept in; it's still a (very bad) score. */
+    case SC_LOSS:     return -std::min(loss, (double)FLT_MAX);
+    case SC_AUC:      return auc;
+    default:
+        throw Exception("Boosting_Stats::score(): unknown criterion");
+    }
+}
+
+std::string print_stopping_score(Stopping_Criterion criterion, double score)
+{
+    switch (criterion) {
+    case SC_ACCURACY: return format("%6.2f%%", score * 100.0);
+    case SC_LOSS:     return format("loss %8.6f", -score);
+    case SC_AUC:      return format("auc %6.4f", score);
+    default:
+        throw Exception("print_stopping_score(): unknown criterion");
+    }
+}
+
+Boosting_Stats
+boosting_stats(double accuracy,
+               const boost::multi_array<float, 2> & output,
+               const Training_Data & data,
+               const Feature & predicted,
+               const distribution<float> & ex_weights,
+               Cost_Function cost,
+               Stopping_Criterion criterion)
+{
+    Boosting_Stats result(accuracy);
+    if (criterion == SC_LOSS)
+        result.loss = boosting_loss(output, data, predicted, ex_weights, cost);
+    else if (criterion == SC_AUC)
+        result.auc = boosting_auc(output, data, predicted, ex_weights);
+    return result;
+}
+
+double boosting_loss(const boost::multi_array<float, 2> & output,
+                     const Training_Data & data,
+                     const Feature & predicted,
+                     const distribution<float> & ex_weights,
+                     Cost_Function cost)
+{
+    const vector<Label> & labels = data.index().labels(predicted);
+    size_t nx = output.shape()[0];
+    int nl = label_count(output);
+
+    if (ex_weights.size() != nx)
+        throw Exception("boosting_loss(): example weights don't match");
+
+    double total = 0.0;
+    for (unsigned x = 0;  x < nx;  ++x) {
+        if (ex_weights[x] == 0.0) continue;
+        int corr = labels[x];
+        double ex_loss = 0.0;
+        for (int l = 0;  l < nl;  ++l) {
+            double margin = label_score(output, x, l);
+            if (l != corr) margin = -margin;
+            if (cost == CF_LOGISTIC)
+                ex_loss += (margin < -30.0 ? -margin : log1p(exp(-margin)));
+            else ex_loss += exp(-margin);
+        }
+        total += ex_weights[x] * ex_loss;
+    }
+
+    return total / (ex_weights.total() * nl);
+}
+
+double boosting_auc(const boost::multi_array<float, 2> & output,
+                    const Training_Data & data,
+                    const Feature & predicted,
+                    const distribution<float> & ex_weights)
+{
+    const vector<Label> & labels = data.index().labels(predicted);
+    size_t nx = output.shape()[0];
+    int nl = label_count(output);
+
+    if (ex_weights.size() != nx)
+        throw Exception("boosting_auc(): example weights don't match");
+
+    double total = 0.0;
+    int nauc = 0;
+
+    vector<AUC_Entry> entries;
+    entries.reserve(nx);
+
+    for (int l = 0;  l < nl;  ++l) {
+        entries.clear();
+        size_t npos = 0, nneg = 0;
+        for (unsigned x = 0;  x < nx;  ++x) {
+            if (ex_weights[x] == 0.0) continue;
+            bool target = (labels[x] == l);
+            if (target) ++npos;
+            else ++nneg;
+            entries.push_back(AUC_Entry(label_score(output, x, l), target,
+                                        ex_weights[x]));
+        }
+        if (npos == 0 || nneg == 0) continue;
+
+        /* do_calc_auc() gives one minus the area, as an error. */
+        total += 1.0 - do_calc_auc(entries);
+        ++nauc;
+    }
+
+    return (nauc == 0 ? 0.0 : total / nauc);
+}
+
 } // namespace ML
 
 ENUM_INFO_NAMESPACE
@@ -202,4 +342,13 @@ Enum_Info<ML::Cost_Function>::OPT[2] = {
 const char * Enum_Info<ML::Cost_Function>::NAME
    = "Cost_Function";
 
+const Enum_Opt<ML::Stopping_Criterion>
+Enum_Info<ML::Stopping_Criterion>::OPT[3] = {
+    { "accuracy",         ML::SC_ACCURACY      },
+    { "loss",             ML::SC_LOSS          },
+    { "auc",              ML::SC_AUC           } };
+
+const char * Enum_Info<ML::Stopping_Criterion>::NAME
+   = "Stopping_Criterion";
+
 END_ENUM_INFO_NAMESPACE
@@ -22,6 +22,68 @@ enum Cost_Function {
     CF_LOGISTIC      ///< Use a logistic cost function (~LogitBoost)
 };
 
+/** This enum controls which statistic of the validation set boosting uses
+    to select its best iteration and to decide when to short circuit.  It
+    is passed under the key "stopping_criterion" in the training params. */
+enum Stopping_Criterion {
+    SC_ACCURACY,     ///< Highest accuracy
+    SC_LOSS,         ///< Lowest loss under the cost function
+    SC_AUC           ///< Highest area under the ROC curve
+};
+
+/** Statistics of the scores that boosting has accumulated over a dataset,
+    which are what it can stop on. */
+struct Boosting_Stats {
+    Boosting_Stats(double accuracy = 0.0, double loss = 0.0, double auc = 0.0)
+        : accuracy(accuracy), loss(loss), auc(auc)
+    {
+    }
+
+    double accuracy;  ///< Weighted proportion of examples correct
+    double loss;      ///< Weighted mean loss per example and label
+    double auc;       ///< Mean over the labels of their one-vs-rest AUC
+
+    /** Return the statistic that the criterion uses, signed so that higher
+        is always better and bounded by the range of a float. */
+    double score(Stopping_Criterion criterion) const;
+};
+
+/** Format a score returned by Boosting_Stats::score() for a training
+    trace. */
+std::string print_stopping_score(Stopping_Criterion criterion, double score);
+
+/** Calculate the statistics of the accumulated scores in output that the
+    criterion needs, given their accuracy, which the score updates count
+    as they go.  The output has either one column per label or, for
+    binary symmetric problems, just one with the score of label 0.  The
+    other statistics are left as zero, as the loss takes a pass over the
+    scores and the AUC a sort of them for each label. */
+Boosting_Stats
+boosting_stats(double accuracy,
+               const boost::multi_array<float, 2> & output,
+               const Training_Data & data,
+               const Feature & predicted,
+               const distribution<float> & ex_weights,
+               Cost_Function cost,
+               Stopping_Criterion criterion);
+
+/** Return the weighted mean over the examples and labels of the loss of
+    the scores in output under the given cost function. */
+double boosting_loss(const boost::multi_array<float, 2> & output,
+                     const Training_Data & data,
+                     const Feature & predicted,
+                     const distribution<float> & ex_weights,
+                     Cost_Function cost);
+
+/** Return the mean over the labels of the area under the ROC curve of
+    the scores in output for that label against the rest.  Labels that
+    are never or always correct are skipped, and examples with a zero
+    weight are ignored. */
+double boosting_auc(const boost::multi_array<float, 2> & output,
+                    const Training_Data & data,
+                    const Feature & predicted,
+                    const distribution<float> & ex_weights);
+
 /** Update the weights which we have been maintaining for a set of data,
     using the last decision stump learned.  This can remove an O(n) from
     the iterative training complexity. */
@@ -65,5 +127,6 @@ void update_weights(boost::multi_array<float, 2> & weights,
 } // namespace ML
 
 DECLARE_ENUM_INFO(ML::Cost_Function, 2);
+DECLARE_ENUM_INFO(ML::Stopping_Criterion, 3);
 
 #endif /* __boosting__boosting_training_h__ */
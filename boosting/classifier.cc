@@ -18,6 +18,7 @@
 #include "jml/utils/vector_utils.h"
 #include <boost/bind.hpp>
 #include <boost/thread/tss.hpp>
+#include <limits>
 #include "jml/utils/exc_assert.h"
 #include "jml/math/xdiv.h"
 #include "jml/utils/filter_streams.h"
@@ -52,16 +53,44 @@ BYTE_PERSISTENT_ENUM_IMPL(Output_Encoding);
 /* OPTIMIZATION_INFO                                                         */
 /*****************************************************************************/
 
-void
+bool
 Optimization_Info::
 apply(const Feature_Set & fset, float * output) const
 {
-    if (fset.size() != indexes.size())
-        throw Exception("Optimization_Info::apply(): size mismatch");
+    if (!initialized)
+        throw Exception("Optimization_Info::apply(): not initialized");
 
-    for (unsigned i = 0;  i < indexes.size();  ++i)
-        if (indexes[i] != -1)
-            output[indexes[i]] = fset[i].second;
+    std::fill(output, output + to_features.size(),
+              std::numeric_limits<float>::quiet_NaN());
+
+    /* Step through from_features as long as the feature set matches it,
+       and only fall back to the hash table once it doesn't.  Feature sets
+       are sorted, so a repeated feature shows up as adjacent duplicates. */
+    bool in_order = (fset.size() == indexes.size());
+    bool repeated = false;
+    unsigned i = 0;
+    Feature last = MISSING_FEATURE;
+
+    auto onFeature = [&] (const Feature & feature, float value)
+        {
+            if (i > 0 && feature == last) repeated = true;
+            last = feature;
+
+            int index;
+            if (in_order && from_features[i] == feature)
+                index = indexes[i];
+            else {
+                in_order = false;
+                index = find_optimized_index(feature);
+            }
+            ++i;
+
+            if (index != -1) output[index] = value;
+        };
+
+    for_each_feature(fset, onFeature);
+
+    return !repeated;
 }
 
 void
@@ -89,11 +118,10 @@ int
 Optimization_Info::
 get_optimized_index(const Feature & feature) const
 {
-    map<Feature, int>::const_iterator it
-        = feature_to_optimized_index.find(feature);
-    if (it == feature_to_optimized_index.end())
+    int result = find_optimized_index(feature);
+    if (result == -1)
         throw Exception("didn't find optimized feature index");
-    return it->second;
+    return result;
 }
 
 
@@ -238,6 +266,29 @@ normalize()
 }
 
 
+/*****************************************************************************/
+/* EXPLAIN_WORKSPACE                                                         */
+/*****************************************************************************/
+
+void
+Explain_Workspace::
+init(const Optimization_Info & info)
+{
+    int nf = info.features_out();
+
+    features.resize(nf);
+    contributions.resize(nf);
+    ranked.resize(nf);
+    row_index.assign(nf, -1);
+
+    for (unsigned i = 0;  i < info.indexes.size();  ++i)
+        if (info.indexes[i] != -1)
+            row_index[info.indexes[i]] = i;
+
+    this->info = &info;
+}
+
+
 /*****************************************************************************/
 /* CLASSIFIER_IMPL                                                           */
 /*****************************************************************************/
@@ -356,7 +407,8 @@ optimize(const std::vector<Feature> & features)
     if (!optimization_supported())
         return result;
 
-    map<Feature, int> & feature_map = result.feature_to_optimized_index;
+    Feature_Slot_Map & feature_map = result.feature_to_optimized_index;
+    feature_map.reserve(result.to_features.size() * 2);
     for (unsigned i = 0;  i < result.to_features.size();  ++i) {
         feature_map[result.to_features[i]] = i;
     }
@@ -364,14 +416,9 @@ optimize(const std::vector<Feature> & features)
     int num_done = 0;
     result.indexes.resize(features.size());
     for (unsigned i = 0;  i < features.size();  ++i) {
-        if (!feature_map.count(features[i])) {
-            // We don't need this feature
-            result.indexes[i] = -1;
-        }
-        else {
-            result.indexes[i] = feature_map[features[i]];
-            ++num_done;
-        }
+        // -1 if we don't need this feature
+        result.indexes[i] = result.find_optimized_index(features[i]);
+        if (result.indexes[i] != -1) ++num_done;
     }
 
     if (num_done != result.to_features.size()) {
@@ -379,7 +426,7 @@ optimize(const std::vector<Feature> & features)
         vector<Feature> sorted2;
 
         for (unsigned i = 0;  i < features.size();  ++i) {
-            if (feature_map.count(features[i]))
+            if (result.indexes[i] != -1)
                 sorted2.push_back(features[i]);
         }
 
@@ -452,7 +499,7 @@ predict(const Feature_Set & features,
     if (!predict_is_optimized() || !info) return predict(features, context);
 
     float fv[info.features_out()];
-    info.apply(features, fv);
+    if (!info.apply(features, fv)) return predict(features, context);
 
     return optimized_predict_impl(fv, info, context);
 }
@@ -492,7 +539,8 @@ predict(int label,
 
     float fv[info.features_out()];
 
-    info.apply(features, fv);
+    if (!info.apply(features, fv))
+        return predict(label, features, context);
 
     return optimized_predict_impl(label, fv, info, context);
 }
@@ -847,6 +895,97 @@ predict(const Training_Data & data,
     worker.run_until_finished(group);
 }
 
+namespace {
+
+struct Predict_Batch_Job {
+
+    size_t x_start, x_end;
+    const Classifier_Impl & classifier;
+    const float * rows;
+    std::shared_ptr<const vector<Feature> > features;
+    float * output;
+    const Optimization_Info * opt_info;
+
+    Predict_Batch_Job(size_t x_start, size_t x_end,
+                      const Classifier_Impl & classifier,
+                      const float * rows,
+                      std::shared_ptr<const vector<Feature> > features,
+                      float * output,
+                      const Optimization_Info * opt_info)
+        : x_start(x_start), x_end(x_end),
+          classifier(classifier), rows(rows), features(features),
+          output(output), opt_info(opt_info)
+    {
+    }
+
+    void operator () () const
+    {
+        size_t nf = features->size();
+        size_t nl = classifier.label_count();
+
+        for (size_t x = x_start;  x < x_end;  ++x) {
+            const float * row = rows + x * nf;
+            Label_Dist prediction;
+            if (opt_info)
+                prediction = classifier.predict(row, *opt_info);
+            else {
+                Dense_Feature_Set fset(features, row);
+                prediction = classifier.predict(fset);
+            }
+
+            if (prediction.size() != nl)
+                throw Exception("predict_batch(): classifier returned %zd "
+                                "labels, expected %zd",
+                                prediction.size(), nl);
+
+            std::copy(prediction.begin(), prediction.end(), output + x * nl);
+        }
+    }
+};
+
+} // file scope
+
+void
+Classifier_Impl::
+predict_batch(const float * rows, size_t n,
+              const std::vector<Feature> & features,
+              float * output,
+              const Optimization_Info * opt_info) const
+{
+    if (opt_info && !*opt_info) opt_info = 0;
+    if (opt_info && opt_info->features_in() != features.size())
+        throw Exception("predict_batch(): optimization info is for %d "
+                        "features but rows have %zd",
+                        opt_info->features_in(), features.size());
+    if (n == 0) return;
+
+    std::shared_ptr<const vector<Feature> > features_ptr
+        = make_unowned_sp(features);
+
+    static Worker_Task & worker = Worker_Task::instance(num_threads() - 1);
+
+    int group;
+    {
+        int parent = -1;  // no parent group
+        group = worker.get_group(NO_JOB,
+                                 format("predict batch group under %d", parent),
+                                 parent);
+        Call_Guard guard(boost::bind(&Worker_Task::unlock_group,
+                                     boost::ref(worker),
+                                     group));
+
+        /* Do 1024 examples per job. */
+        for (size_t x = 0;  x < n;  x += 1024)
+            worker.add(Predict_Batch_Job(x, std::min<size_t>(x + 1024, n),
+                                         *this, rows, features_ptr,
+                                         output, opt_info),
+                       "predict batch job",
+                       group);
+    }
+
+    worker.run_until_finished(group);
+}
+
 Explanation
 Classifier_Impl::
 explain(const Feature_Set & feature_set,
@@ -858,6 +997,165 @@ explain(const Feature_Set & feature_set,
                     + " doesn't implement the explain() method");
 }
 
+void
+Classifier_Impl::
+optimized_explain_impl(const float * features,
+                       const Optimization_Info & info,
+                       int label,
+                       double * contributions,
+                       double & bias,
+                       double weight) const
+{
+    Dense_Feature_Set fset(make_unowned_sp(info.to_features), features);
+
+    Explanation explanation = explain(fset, label, weight);
+
+    bias += explanation.bias;
+
+    for (Explanation::Feature_Weights::const_iterator
+             it = explanation.feature_weights.begin(),
+             end = explanation.feature_weights.end();
+         it != end;  ++it)
+        contributions[info.get_optimized_index(it->first)] += it->second;
+}
+
+double
+Classifier_Impl::
+explain_top_k(const float * row,
+              const Optimization_Info & info,
+              int label, int k,
+              int * top_features, float * top_weights,
+              Explain_Workspace & workspace) const
+{
+    if (!info)
+        throw Exception("explain_top_k(): needs optimization info");
+    if (label < 0 || label >= label_count())
+        throw Exception("explain_top_k(): label %d out of range", label);
+
+    if (workspace.info != &info) workspace.init(info);
+
+    int nf = info.features_out();
+    double * contributions = &workspace.contributions[0];
+
+    info.apply(row, &workspace.features[0]);
+    std::fill(contributions, contributions + nf, 0.0);
+
+    double bias = 0.0;
+    optimized_explain_impl(&workspace.features[0], info, label,
+                           contributions, bias);
+
+    /* Rank the features that contributed on the absolute value of their
+       contribution; only the top k need to be sorted. */
+    int * ranked = &workspace.ranked[0];
+    int nr = 0;
+    for (unsigned i = 0;  i < nf;  ++i)
+        if (contributions[i] != 0.0)
+            ranked[nr++] = i;
+
+    auto larger = [&] (int i1, int i2)
+        {
+            double c1 = fabs(contributions[i1]), c2 = fabs(contributions[i2]);
+            return c1 > c2 || (c1 == c2 && i1 < i2);
+        };
+
+    int nk = std::min(k, nr);
+    std::partial_sort(ranked, ranked + nk, ranked + nr, larger);
+
+    for (unsigned i = 0;  i < nk;  ++i) {
+        top_features[i] = workspace.row_index[ranked[i]];
+        top_weights[i] = contributions[ranked[i]];
+    }
+    for (unsigned i = nk;  i < k;  ++i) {
+        top_features[i] = -1;
+        top_weights[i] = 0.0;
+    }
+
+    return bias;
+}
+
+namespace {
+
+struct Explain_Batch_Job {
+
+    size_t x_start, x_end;
+    const Classifier_Impl & classifier;
+    const float * rows;
+    const Optimization_Info & info;
+    int label, k;
+    int * top_features;
+    float * top_weights;
+    float * bias;
+
+    Explain_Batch_Job(size_t x_start, size_t x_end,
+                      const Classifier_Impl & classifier,
+                      const float * rows,
+                      const Optimization_Info & info,
+                      int label, int k,
+                      int * top_features, float * top_weights,
+                      float * bias)
+        : x_start(x_start), x_end(x_end),
+          classifier(classifier), rows(rows), info(info),
+          label(label), k(k), top_features(top_features),
+          top_weights(top_weights), bias(bias)
+    {
+    }
+
+    void operator () () const
+    {
+        size_t nf = info.features_in();
+
+        /* One workspace for the whole job. */
+        Explain_Workspace workspace;
+        workspace.init(info);
+
+        for (size_t x = x_start;  x < x_end;  ++x)
+            bias[x] = classifier.explain_top_k(rows + x * nf, info, label, k,
+                                               top_features + x * k,
+                                               top_weights + x * k,
+                                               workspace);
+    }
+};
+
+} // file scope
+
+void
+Classifier_Impl::
+explain_batch(const float * rows, size_t n,
+              const Optimization_Info & info,
+              int label, int k,
+              int * top_features, float * top_weights,
+              float * bias) const
+{
+    if (!info)
+        throw Exception("explain_batch(): needs optimization info");
+    if (label < 0 || label >= label_count())
+        throw Exception("explain_batch(): label %d out of range", label);
+    if (n == 0) return;
+
+    static Worker_Task & worker = Worker_Task::instance(num_threads() - 1);
+
+    int group;
+    {
+        int parent = -1;  // no parent group
+        group = worker.get_group(NO_JOB,
+                                 format("explain batch group under %d", parent),
+                                 parent);
+        Call_Guard guard(boost::bind(&Worker_Task::unlock_group,
+                                     boost::ref(worker),
+                                     group));
+
+        /* Do 1024 examples per job. */
+        for (size_t x = 0;  x < n;  x += 1024)
+            worker.add(Explain_Batch_Job(x, std::min<size_t>(x + 1024, n),
+                                         *this, rows, info, label, k,
+                                         top_features, top_weights, bias),
+                       "explain batch job",
+                       group);
+    }
+
+    worker.run_until_finished(group);
+}
+
 
 std::shared_ptr<Classifier_Impl>
 Classifier_Impl::
@@ -21,6 +21,7 @@
 #include <boost/function.hpp>
 #include <string>
 #include "jml/utils/unnamed_bool.h"
+#include "jml/utils/lightweight_hash.h"
 
 namespace ML {
 
@@ -58,6 +59,52 @@ typedef distribution<float> Label_Dist;
 /* OPTIMIZATION_INFO                                                         */
 /*****************************************************************************/
 
+/** Hash function for a feature in a Feature_Slot_Map.  Feature::hash()
+    leaves the low bits (which is all that the hash table looks at) poorly
+    mixed, so we mix them in from the high bits. */
+struct Feature_Slot_Hash {
+    JML_ALWAYS_INLINE size_t operator () (const Feature & feature) const
+    {
+        uint64_t h = feature.hash() * 0x9e3779b97f4a7c15ULL;
+        return h ^ (h >> 29);
+    }
+};
+
+/** Lightweight_Hash operations for a map from a feature.  Every value of
+    Feature (including the default constructed one) can be a real feature,
+    so MISSING_FEATURE marks the empty buckets. */
+struct Feature_Slot_Ops
+    : public PairOps<Feature, int, Feature_Slot_Hash> {
+    typedef std::pair<Feature, int> Bucket;
+
+    static void initEmptyBucket(Bucket * bucket)
+    {
+        new (bucket) Bucket(MISSING_FEATURE, -1);
+    }
+
+    static void emptyBucket(Bucket * bucket)
+    {
+        bucket->~Bucket();
+        initEmptyBucket(bucket);
+    }
+
+    static bool bucketIsFull(const Bucket & bucket)
+    {
+        return bucket.first != MISSING_FEATURE;
+    }
+
+    static bool isGuardValue(const Feature & key)
+    {
+        return key == MISSING_FEATURE;
+    }
+};
+
+/** Open addressing hash table from a feature to its index in a dense
+    feature vector. */
+typedef Lightweight_Hash<Feature, int, std::pair<Feature, int>,
+                         std::pair<const Feature, int>, Feature_Slot_Ops>
+    Feature_Slot_Map;
+
 /** A structure that provides information on optimization to a classifier. */
 
 struct Optimization_Info {
@@ -68,7 +115,7 @@ struct Optimization_Info {
     std::vector<int> indexes;
     bool initialized;
 
-    std::map<Feature, int> feature_to_optimized_index;
+    Feature_Slot_Map feature_to_optimized_index;
 
     int features_in() const
     {
@@ -84,7 +131,17 @@ struct Optimization_Info {
         return to_features.size();
     }
 
-    void apply(const Feature_Set & fset, float * output) const;
+    /** Convert a feature set into the dense feature vector.  A feature set
+        with exactly the features that were passed to optimize() is copied
+        across by position.  Any other feature set (for example a sparse row
+        with only some of the features, in any order) is scattered into the
+        vector via the hash table; features that aren't in it are NaN
+        (missing), and features not used by the classifier are ignored.
+
+        A feature that occurs more than once in the feature set can't be
+        represented in the dense vector; in that case this returns false and
+        the caller should predict from the feature set instead. */
+    bool apply(const Feature_Set & fset, float * output) const;
     void apply(const std::vector<float> & fset, float * output) const;
     void apply(const float * fset, float * output) const;
     
@@ -93,6 +150,16 @@ struct Optimization_Info {
         it corresponds to.  If there is none, an exception will be thrown. */
     int get_optimized_index(const Feature & feature) const;
 
+    /** Same, but return -1 if the feature isn't used. */
+    int find_optimized_index(const Feature & feature) const
+    {
+        if (feature == MISSING_FEATURE) return -1;  // hash's empty value
+        Feature_Slot_Map::const_iterator it
+            = feature_to_optimized_index.find(feature);
+        if (it == feature_to_optimized_index.end()) return -1;
+        return it->second;
+    }
+
     JML_IMPLEMENT_OPERATOR_BOOL(initialized);
 };
 
@@ -143,6 +210,30 @@ struct Explanation {
 };
 
 
+/*****************************************************************************/
+/* EXPLAIN_WORKSPACE                                                         */
+/*****************************************************************************/
+
+/** Scratch space for Classifier_Impl::explain_top_k(), so that explaining
+    a row doesn't need to allocate any memory once it has been set up.  Each
+    thread needs its own.
+*/
+
+struct Explain_Workspace {
+    Explain_Workspace() : info(0) {}
+
+    /** Set up for rows optimized with the given info.  This is done
+        automatically the first time that it's used with the info. */
+    void init(const Optimization_Info & info);
+
+    const Optimization_Info * info;
+    std::vector<float> features;        ///< Row in the optimized layout
+    std::vector<double> contributions;  ///< For each optimized index
+    std::vector<int> row_index;         ///< Optimized index to row column
+    std::vector<int> ranked;            ///< Optimized indexes being ranked
+};
+
+
 /*****************************************************************************/
 /* PREDICTION CONTEXT                                                        */
 /*****************************************************************************/
@@ -416,6 +507,18 @@ public:
                          Predict_One_Output_Func output,
                          const Optimization_Info * opt_info = 0) const;
 
+    /** Run the classifier over a dense, row-major block of n examples,
+        in parallel.  Each row holds the values of the given features
+        (which should be sorted, as Feature(0) ... Feature(n - 1) are) and
+        is read in place, without being copied.  The label_count() scores
+        for example x are written to output[x * label_count()] onwards.
+        If opt_info is given, it must come from optimize(features).
+    */
+    virtual void predict_batch(const float * rows, size_t n,
+                               const std::vector<Feature> & features,
+                               float * output,
+                               const Optimization_Info * opt_info = 0) const;
+
     ///@}
 
     /** Perform a prediction and explain why the prediction was done in the
@@ -434,6 +537,50 @@ public:
         return explain(feature_set, label, weight);
     }
 
+    /** Explain the prediction of the given label for one dense row, laid
+        out as the features that were passed to optimize() to get info.
+        The k features with the largest absolute contributions are written,
+        largest first, to top_features (as their column in the row) and
+        top_weights; if fewer than k features contributed, the rest are -1
+        and 0.  Returns the bias, which together with all of the
+        contributions adds up to the prediction before any output
+        transformation.
+
+        Trees give their exact path-dependent Shapley values.  Classifiers
+        that override optimized_explain_impl() don't allocate any memory
+        once the workspace is set up.
+    */
+    double explain_top_k(const float * row,
+                         const Optimization_Info & info,
+                         int label, int k,
+                         int * top_features, float * top_weights,
+                         Explain_Workspace & workspace) const;
+
+    /** Run explain_top_k() over a dense, row-major block of n examples in
+        parallel, the same way as predict_batch().  The results for example x
+        go to top_features[x * k] and top_weights[x * k] onwards and its bias
+        to bias[x].
+    */
+    void explain_batch(const float * rows, size_t n,
+                       const Optimization_Info & info,
+                       int label, int k,
+                       int * top_features, float * top_weights,
+                       float * bias) const;
+
+    /** Optimized explain for a dense feature vector.  Adds weight times the
+        contribution of each feature to contributions[optimized index], and
+        of the bias to bias.  The default converts to a Feature_Set and calls
+        explain(), which allocates memory; classifiers that override it
+        shouldn't.
+    */
+    virtual void
+    optimized_explain_impl(const float * features,
+                           const Optimization_Info & info,
+                           int label,
+                           double * contributions,
+                           double & bias,
+                           double weight = 1.0) const;
+
     /** \name Accuracy
         These methods are all ways of returning the accuracy of the classifier
         over a set of training data.  They vary in how the output of the
@@ -714,6 +861,16 @@ public:
         return impl->predict(features, context);
     }
 
+    /** Predict the scores for a dense block of examples.  See
+        Classifier_Impl::predict_batch(). */
+    void predict_batch(const float * rows, size_t n,
+                       const std::vector<Feature> & features,
+                       float * output,
+                       const Optimization_Info * opt_info = 0) const
+    {
+        impl->predict_batch(rows, n, features, output, opt_info);
+    }
+
     /** Calculate the prediction accuracy over a training set. */
     std::pair<float, float>
     accuracy(const Training_Data & data,
@@ -178,6 +178,34 @@ optimized_predict_impl(int label,
     return result;
 }
 
+void
+Committee::
+optimized_explain_impl(const float * features,
+                       const Optimization_Info & info,
+                       int label,
+                       double * contributions,
+                       double & bias,
+                       double weight) const
+{
+    if (!optimized_) {
+        Classifier_Impl::optimized_explain_impl(features, info, label,
+                                                contributions, bias, weight);
+        return;
+    }
+
+    if (label >= this->bias.size())
+        throw Exception("Committee::explain(): invalid label");
+
+    bias += weight * this->bias[label];
+
+    for (unsigned i = 0;  i < classifiers.size();  ++i) {
+        if (weights[i] == 0.0) continue;
+        classifiers[i]
+            ->optimized_explain_impl(features, info, label, contributions,
+                                     bias, weight * weights[i]);
+    }
+}
+
 Explanation
 Committee::
 explain(const Feature_Set & feature_set,
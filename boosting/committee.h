@@ -101,6 +101,15 @@ public:
                            const Optimization_Info & info,
                            PredictionContext * context = 0) const;
 
+    /** Explains each of the classifiers with its weight. */
+    virtual void
+    optimized_explain_impl(const float * features,
+                           const Optimization_Info & info,
+                           int label,
+                           double * contributions,
+                           double & bias,
+                           double weight = 1.0) const;
+
     virtual Explanation explain(const Feature_Set & feature_set,
                                 int label,
                                 double weight = 1.0,
@@ -0,0 +1,148 @@
+/* compiled_scorer.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Implementation of the compiled scorer.
+*/
+
+#include "compiled_scorer.h"
+#include "jml/utils/smart_ptr_utils.h"
+#include "jml/utils/exc_assert.h"
+
+
+using namespace std;
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* COMPILED_SCORER                                                           */
+/*****************************************************************************/
+
+Compiled_Scorer::
+Compiled_Scorer()
+    : label_count_(0), optimized_(false)
+{
+}
+
+Compiled_Scorer::
+Compiled_Scorer(const Classifier & classifier,
+                std::shared_ptr<const Dense_Feature_Space> input_fs)
+    : label_count_(0), optimized_(false)
+{
+    init(classifier, input_fs);
+}
+
+Compiled_Scorer::
+Compiled_Scorer(const Classifier & classifier)
+    : label_count_(0), optimized_(false)
+{
+    init(classifier, classifier.feature_space<Dense_Feature_Space>());
+}
+
+Compiled_Scorer::
+~Compiled_Scorer()
+{
+}
+
+void
+Compiled_Scorer::
+init(const Classifier & classifier,
+     std::shared_ptr<const Dense_Feature_Space> input_fs)
+{
+    if (!classifier)
+        throw Exception("Compiled_Scorer::init(): null classifier");
+    if (!input_fs)
+        throw Exception("Compiled_Scorer::init(): null input feature space");
+
+    classifier_ = classifier;  // deep copy; we optimize our own version
+    classifier_fs_ = classifier_.feature_space<Dense_Feature_Space>();
+    input_fs_ = input_fs;
+    classifier_features_.reset(new vector<Feature>(classifier_fs_->features()));
+    label_count_ = classifier_.label_count();
+
+    mapping_.clear();
+    classifier_fs_->create_mapping(*input_fs_, mapping_);
+
+    opt_info_ = Optimization_Info();
+    optimized_ = false;
+
+    if (classifier_.impl->optimization_supported()) {
+        opt_info_ = classifier_.impl->optimize(*classifier_features_);
+        optimized_ = opt_info_ && classifier_.impl->predict_is_optimized();
+    }
+}
+
+void
+Compiled_Scorer::
+init_scratch(Scratch & scratch) const
+{
+    scratch.encoded.resize(classifier_fs_->variable_count());
+    scratch.optimized.resize(optimized_ ? opt_info_.features_out() : 0);
+    scratch.accum.resize(label_count_);
+}
+
+void
+Compiled_Scorer::
+encode(const float * input, Scratch & scratch) const
+{
+    if (scratch.encoded.size() != classifier_fs_->variable_count()
+        || scratch.accum.size() != label_count_)
+        init_scratch(scratch);
+
+    classifier_fs_->encode(input, &scratch.encoded[0], *input_fs_, mapping_);
+
+    if (optimized_)
+        opt_info_.apply(&scratch.encoded[0], &scratch.optimized[0]);
+}
+
+void
+Compiled_Scorer::
+score(const float * input, float * output) const
+{
+    score(input, output, *thread_scratch_.get());
+}
+
+void
+Compiled_Scorer::
+score(const float * input, float * output, Scratch & scratch) const
+{
+    encode(input, scratch);
+
+    if (!optimized_) {
+        Dense_Feature_Set fset(classifier_features_, &scratch.encoded[0]);
+        Label_Dist result = classifier_.impl->predict(fset);
+        ExcAssertEqual(result.size(), label_count_);
+        std::copy(result.begin(), result.end(), output);
+        return;
+    }
+
+    double * accum = &scratch.accum[0];
+    std::fill(accum, accum + label_count_, 0.0);
+
+    classifier_.impl->optimized_predict_impl(&scratch.optimized[0],
+                                             opt_info_, accum);
+
+    for (unsigned i = 0;  i < label_count_;  ++i)
+        output[i] = accum[i];
+}
+
+float
+Compiled_Scorer::
+score(int label, const float * input) const
+{
+    Scratch & scratch = *thread_scratch_.get();
+    encode(input, scratch);
+
+    if (!optimized_) {
+        Dense_Feature_Set fset(classifier_features_, &scratch.encoded[0]);
+        return classifier_.impl->predict(label, fset);
+    }
+
+    return classifier_.impl->optimized_predict_impl(label,
+                                                    &scratch.optimized[0],
+                                                    opt_info_);
+}
+
+} // namespace ML
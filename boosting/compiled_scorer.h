@@ -0,0 +1,136 @@
+/* compiled_scorer.h                                               -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   A scorer that binds a classifier, its dense feature space and a mapping
+   from the problem feature space so that predictions can be made without
+   any memory allocation.
+*/
+
+#ifndef __boosting__compiled_scorer_h__
+#define __boosting__compiled_scorer_h__
+
+
+#include "classifier.h"
+#include "dense_features.h"
+#include "jml/arch/thread_specific.h"
+#include <boost/noncopyable.hpp>
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* COMPILED_SCORER                                                           */
+/*****************************************************************************/
+
+/** Binds together everything that is needed to go from a raw vector of
+    floats in a problem feature space to the output of a classifier:
+
+    1.  The Dense_Feature_Space::Mapping from the problem feature space onto
+        the classifier's feature space (the encode(const float *, float *)
+        step);
+    2.  The Optimization_Info that maps the classifier's feature space onto
+        the dense vector used by optimized_predict_impl();
+    3.  Scratch space for each of these steps and for the output
+        accumulator.
+
+    Once constructed, score() performs no heap allocation as long as the
+    classifier supports optimized prediction (predict_is_optimized() returns
+    true after optimization).  Classifiers that don't will still work, but
+    fall back to the normal (allocating) predict() path.
+
+    The scorer is safe to use from multiple threads at once; each thread
+    gets its own scratch space, which is allocated on its first call to
+    score().  Callers that manage their own threads can instead allocate a
+    Scratch object themselves and pass it in explicitly.
+
+    Example:
+
+    Classifier classifier;
+    classifier.load("classifier.cls");
+    std::shared_ptr<const Dense_Feature_Space> problem_fs = ...;
+
+    Compiled_Scorer scorer(classifier, problem_fs);
+
+    float output[scorer.label_count()];
+    scorer.score(features, output);
+*/
+
+class Compiled_Scorer : boost::noncopyable {
+public:
+    /** Default construct.  Must be initialized before use. */
+    Compiled_Scorer();
+
+    /** Construct for the given classifier, taking input in the given
+        feature space.  The scorer takes its own copy of the classifier,
+        which is then optimized; the original is left untouched. */
+    Compiled_Scorer(const Classifier & classifier,
+                    std::shared_ptr<const Dense_Feature_Space> input_fs);
+
+    /** Construct for the given classifier, taking input in the classifier's
+        own feature space, which must be a Dense_Feature_Space. */
+    explicit Compiled_Scorer(const Classifier & classifier);
+
+    ~Compiled_Scorer();
+
+    /** Initialize.  See the constructors for details. */
+    void init(const Classifier & classifier,
+              std::shared_ptr<const Dense_Feature_Space> input_fs);
+
+    /** Per-thread scratch space.  Can be allocated by the caller and passed
+        to score() in order to avoid the thread-specific lookup. */
+    struct Scratch {
+        std::vector<float> encoded;    ///< In classifier feature space
+        std::vector<float> optimized;  ///< In optimized feature order
+        std::vector<double> accum;     ///< Output accumulator
+    };
+
+    /** Allocate scratch space of the right size for this scorer. */
+    void init_scratch(Scratch & scratch) const;
+
+    /** Number of floats expected in the input to score(). */
+    size_t input_count() const { return input_fs_->variable_count(); }
+
+    /** Number of floats written to the output of score(). */
+    size_t label_count() const { return label_count_; }
+
+    /** Does score() avoid all memory allocation?  True if the classifier
+        supported optimized prediction. */
+    bool allocation_free() const { return optimized_; }
+
+    /** Score the given input vector, which contains input_count() values in
+        the input feature space, writing label_count() values into the
+        output.  Uses this thread's scratch space. */
+    void score(const float * input, float * output) const;
+
+    /** Score using the given scratch space, which is initialized if
+        necessary. */
+    void score(const float * input, float * output, Scratch & scratch) const;
+
+    /** Score a single label. */
+    float score(int label, const float * input) const;
+
+    const Classifier & classifier() const { return classifier_; }
+
+private:
+    Classifier classifier_;
+    std::shared_ptr<const Dense_Feature_Space> classifier_fs_;
+    std::shared_ptr<const Dense_Feature_Space> input_fs_;
+    std::shared_ptr<const std::vector<Feature> > classifier_features_;
+    Dense_Feature_Space::Mapping mapping_;
+    Optimization_Info opt_info_;
+    size_t label_count_;
+    bool optimized_;
+
+    struct Scratch_Tag;
+    ThreadSpecificInstanceInfo<Scratch, Scratch_Tag> thread_scratch_;
+
+    /** Encode into scratch.encoded and scratch.optimized. */
+    void encode(const float * input, Scratch & scratch) const;
+};
+
+} // namespace ML
+
+
+#endif /* __boosting__compiled_scorer_h__ */
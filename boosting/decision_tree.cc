@@ -50,6 +50,15 @@ Decision_Tree(std::shared_ptr<const Feature_Space> feature_space,
       optimized_(false)
 {
 }
+
+Decision_Tree::
+Decision_Tree(std::shared_ptr<const Feature_Space> feature_space,
+              const Feature & predicted, size_t label_count)
+    : Classifier_Impl(feature_space, predicted, label_count),
+      encoding(OE_PROB),
+      optimized_(false)
+{
+}
     
 Decision_Tree::
 ~Decision_Tree()
@@ -61,7 +70,7 @@ Decision_Tree::
 swap(Decision_Tree & other)
 {
     Classifier_Impl::swap(other);
-    std::swap(tree, other.tree);
+    tree.swap(other.tree);
     std::swap(encoding, other.encoding);
     std::swap(optimized_, other.optimized_);
 }
@@ -491,6 +500,228 @@ explain_recursive(Explanation & explanation,
                           node.child_missing, &node);
 }
 
+namespace {
+
+/** Element of the path down to a node for the TreeSHAP algorithm.  Each
+    feature split on along the path has one element (as does the root),
+    with the proportion of permutations of the features on the path that
+    each length of subset has. */
+struct Shap_Path_Element {
+    int index;              ///< Optimized index of the feature
+    double zero_fraction;   ///< Proportion of training examples that follow
+    double one_fraction;    ///< Proportion of this example that follows
+    double pweight;         ///< Weight of subsets of this size
+};
+
+/** Add a feature to the end of the path (at position depth). */
+void shap_extend(Shap_Path_Element * path, int depth,
+                 double zero_fraction, double one_fraction, int index)
+{
+    path[depth].index = index;
+    path[depth].zero_fraction = zero_fraction;
+    path[depth].one_fraction = one_fraction;
+    path[depth].pweight = (depth == 0 ? 1.0 : 0.0);
+
+    for (int i = depth - 1;  i >= 0;  --i) {
+        path[i + 1].pweight
+            += one_fraction * path[i].pweight * (i + 1) / (depth + 1.0);
+        path[i].pweight
+            = zero_fraction * path[i].pweight * (depth - i) / (depth + 1.0);
+    }
+}
+
+/** Undo shap_extend() for the element at position path_index. */
+void shap_unwind(Shap_Path_Element * path, int depth, int path_index)
+{
+    double one_fraction = path[path_index].one_fraction;
+    double zero_fraction = path[path_index].zero_fraction;
+    double next_one_portion = path[depth].pweight;
+
+    for (int i = depth - 1;  i >= 0;  --i) {
+        if (one_fraction != 0.0) {
+            double tmp = path[i].pweight;
+            path[i].pweight
+                = next_one_portion * (depth + 1) / ((i + 1) * one_fraction);
+            next_one_portion
+                = tmp - path[i].pweight * zero_fraction * (depth - i)
+                / (depth + 1.0);
+        }
+        else {
+            path[i].pweight
+                = path[i].pweight * (depth + 1)
+                / (zero_fraction * (depth - i));
+        }
+    }
+
+    for (int i = path_index;  i < depth;  ++i) {
+        path[i].index = path[i + 1].index;
+        path[i].zero_fraction = path[i + 1].zero_fraction;
+        path[i].one_fraction = path[i + 1].one_fraction;
+    }
+}
+
+/** Total of the permutation weights if the element at path_index were
+    unwound, without modifying the path. */
+double shap_unwound_sum(const Shap_Path_Element * path, int depth,
+                        int path_index)
+{
+    double one_fraction = path[path_index].one_fraction;
+    double zero_fraction = path[path_index].zero_fraction;
+    double next_one_portion = path[depth].pweight;
+    double total = 0.0;
+
+    if (one_fraction != 0.0) {
+        for (int i = depth - 1;  i >= 0;  --i) {
+            double tmp = next_one_portion / ((i + 1) * one_fraction);
+            total += tmp;
+            next_one_portion
+                = path[i].pweight - tmp * zero_fraction * (depth - i);
+        }
+    }
+    else if (zero_fraction != 0.0) {
+        for (int i = depth - 1;  i >= 0;  --i)
+            total += path[i].pweight / ((depth - i) * zero_fraction);
+    }
+
+    return total * (depth + 1);
+}
+
+struct Shap_Context {
+    const float * features;
+    int label;
+    double * contributions;
+    double weight;
+};
+
+/** Proportion of the training examples at a node that went down a child.
+    Nodes that no examples reached send none down any branch. */
+JML_ALWAYS_INLINE double
+shap_cover(const Tree::Ptr & child, double cover)
+{
+    return (cover > 0.0 ? child.examples() / cover : 0.0);
+}
+
+void shap_recursive(const Shap_Context & context,
+                    const Tree::Ptr & ptr,
+                    Shap_Path_Element * parent_path,
+                    int depth,
+                    double zero_fraction, double one_fraction, int index)
+{
+    /* Our path goes in the space following our parent's. */
+    Shap_Path_Element * path = parent_path + depth;
+    std::copy(parent_path, parent_path + depth, path);
+    shap_extend(path, depth, zero_fraction, one_fraction, index);
+
+    if (!ptr.node()) {
+        double value = ptr.leaf()->pred.at(context.label) * context.weight;
+        for (int i = 1;  i <= depth;  ++i) {
+            const Shap_Path_Element & el = path[i];
+            double w = shap_unwound_sum(path, depth, i);
+            context.contributions[el.index]
+                += w * (el.one_fraction - el.zero_fraction) * value;
+        }
+        return;
+    }
+
+    const Tree::Node & node = *ptr.node();
+    int split_index = node.split.optimized_index();
+    Split::Weights weights = node.split.apply(context.features);
+
+    /* If we already split on this feature, undo that split so that it can
+       be redone here with the proportions multiplied together. */
+    double incoming_zero = 1.0, incoming_one = 1.0;
+    for (int k = 1;  k <= depth;  ++k) {
+        if (path[k].index != split_index) continue;
+        incoming_zero = path[k].zero_fraction;
+        incoming_one = path[k].one_fraction;
+        shap_unwind(path, depth, k);
+        --depth;
+        break;
+    }
+
+    double cover = node.examples;
+    const Tree::Ptr * children[3];
+    children[false] = &node.child_false;
+    children[true] = &node.child_true;
+    children[MISSING] = &node.child_missing;
+
+    for (unsigned b = 0;  b < 3;  ++b) {
+        const Tree::Ptr & child = *children[b];
+
+        /* A branch that's empty or that neither the training examples nor
+           this one go down contributes nothing. */
+        if (!child) continue;
+        double child_zero = shap_cover(child, cover);
+        double child_one = weights[b];
+        if (child_zero == 0.0 && child_one == 0.0) continue;
+
+        shap_recursive(context, child, path, depth + 1,
+                       incoming_zero * child_zero, incoming_one * child_one,
+                       split_index);
+    }
+}
+
+/** Expected value of the tree over the training examples, and its depth. */
+double shap_expected_value(const Tree::Ptr & ptr, int label,
+                           int depth, int & max_depth)
+{
+    max_depth = std::max(max_depth, depth);
+
+    if (!ptr.node())
+        return ptr.leaf()->pred.at(label);
+
+    const Tree::Node & node = *ptr.node();
+    double cover = node.examples;
+    double result = 0.0;
+
+    const Tree::Ptr * children[3]
+        = { &node.child_false, &node.child_true, &node.child_missing };
+    /* Branches that no examples went down (which may not have a valid
+       prediction) have no weight in the expectation. */
+    for (unsigned b = 0;  b < 3;  ++b) {
+        if (!*children[b]) continue;
+        double expected
+            = shap_expected_value(*children[b], label, depth + 1, max_depth);
+        double child_cover = shap_cover(*children[b], cover);
+        if (child_cover > 0.0) result += child_cover * expected;
+    }
+
+    return result;
+}
+
+} // file scope
+
+void
+Decision_Tree::
+optimized_explain_impl(const float * features,
+                       const Optimization_Info & info,
+                       int label,
+                       double * contributions,
+                       double & bias,
+                       double weight) const
+{
+    if (!optimized_) {
+        Classifier_Impl::optimized_explain_impl(features, info, label,
+                                                contributions, bias, weight);
+        return;
+    }
+
+    if (label < 0 || label >= label_count())
+        throw Exception("Decision_Tree::optimized_explain_impl(): no label");
+    if (!tree.root) return;
+
+    int max_depth = 0;
+    bias += weight * shap_expected_value(tree.root, label, 0, max_depth);
+
+    /* Each level of the recursion has its own copy of the path, one
+       element longer than its parent's. */
+    int max_path = max_depth + 2;
+    Shap_Path_Element path[(max_path * (max_path + 1)) / 2];
+
+    Shap_Context context = { features, label, contributions, weight };
+    shap_recursive(context, tree.root, path, 0, 1.0, 1.0, -1);
+}
+
 Disjunction<Tree::Leaf>
 Decision_Tree::
 to_rules() const
@@ -583,7 +814,7 @@ Decision_Tree::
 serialize(DB::Store_Writer & store) const
 {
     store << string("DECISION_TREE");
-    store << compact_size_t(3);  // version
+    store << compact_size_t(4);  // version
     store << compact_size_t(label_count());
     feature_space_->serialize(store, predicted_);
     tree.serialize(store, *feature_space());
@@ -613,10 +844,15 @@ reconstitute(DB::Store_Reader & store,
         break;
     }
     case 2:
-    case 3: {
+    case 3:
+    case 4: {
         compact_size_t label_count(store);
         feature_space->reconstitute(store, predicted_);
-        Classifier_Impl::init(feature_space, predicted_);
+        /* Before version 4, the label count always came from the predicted
+           feature; multiple target regression trees have one per target. */
+        if (version >= 4)
+            Classifier_Impl::init(feature_space, predicted_, label_count);
+        else Classifier_Impl::init(feature_space, predicted_);
         tree.reconstitute(store, *feature_space);
         if (version >= 3)
             store >> encoding;
@@ -47,6 +47,12 @@ public:
     /** Construct not filled in yet. */
     Decision_Tree(std::shared_ptr<const Feature_Space> feature_space,
                   const Feature & predicted);
+
+    /** Construct not filled in yet, with the given number of outputs.  This
+        is used for regression trees that predict several targets at once,
+        where predicted is the first of them. */
+    Decision_Tree(std::shared_ptr<const Feature_Space> feature_space,
+                  const Feature & predicted, size_t label_count);
     
     virtual ~Decision_Tree();
     
@@ -123,6 +129,20 @@ public:
                            const Tree::Ptr & ptr,
                            const Tree::Node * parent) const;
 
+    /** Explain using the exact path-dependent Shapley values of the tree
+        (the TreeSHAP algorithm of Lundberg et al), which take into account
+        the proportion of the training examples that went down each branch.
+        The bias is the expected value of the tree over those examples.
+        Runs in O(leaves * depth^2) time with the path on the stack.
+    */
+    virtual void
+    optimized_explain_impl(const float * features,
+                           const Optimization_Info & info,
+                           int label,
+                           double * contributions,
+                           double & bias,
+                           double weight = 1.0) const;
+
     /** Convert the decision tree to a disjuction of conjunctions form
         of boolean rules. */
     virtual Disjunction<Tree::Leaf> to_rules() const;
@@ -105,6 +105,16 @@ generate(Thread_Context & context,
 
     Feature predicted = model.predicted();
 
+    if (!targets.empty()) {
+        Decision_Tree current
+            = train_weighted_multi(context, training_set, targets,
+                                   target_weights, training_ex_weights,
+                                   features, max_depth);
+        if (verbosity > 2)
+            cerr << current.print() << endl;
+        return make_sp(current.make_copy());
+    }
+
     boost::multi_array<float, 2> weights
         = expand_weights(training_set, training_ex_weights, predicted);
 
@@ -130,6 +140,19 @@ generate(Thread_Context & context,
 
     //Feature predicted = model.predicted();
 
+    if (!targets.empty()) {
+        distribution<float> ex_weights(training_set.example_count());
+        for (unsigned x = 0;  x < ex_weights.size();  ++x)
+            ex_weights[x] = weights[x][0];
+
+        Decision_Tree current
+            = train_weighted_multi(context, training_set, targets,
+                                   target_weights, ex_weights, features,
+                                   max_depth);
+        if (verbosity > 2) cerr << current.print() << endl;
+        return make_sp(current.make_copy());
+    }
+
     Decision_Tree current
         = train_weighted(context, training_set, weights, features, max_depth);
     
@@ -138,29 +161,18 @@ generate(Thread_Context & context,
     return make_sp(current.make_copy());
 }
 
-Decision_Tree
-Decision_Tree_Generator::
-train_weighted(Thread_Context & context,
-               const Training_Data & data,
-               const boost::multi_array<float, 2> & weights,
-               const std::vector<Feature> & features,
-               int max_depth) const
-{
-    Decision_Tree result = model;
-
-    Feature predicted = model.predicted();
-
-    /* Record which examples are in our class and with what weight they
-       are there. */
-    distribution<float> in_class(data.example_count(), 1.0);
-
-    bool regression_problem
-        = result.feature_space()->info(predicted).type() == REAL;
+namespace {
 
+/** Select the features to train on.  For random forests, only a random
+    proportion of them are enabled. */
+vector<Feature>
+filter_features(Thread_Context & context,
+                const vector<Feature> & features,
+                float random_feature_propn)
+{
     if (random_feature_propn < 0.0 || random_feature_propn > 1.0)
         throw Exception("random_feature_propn is not between 0.0 and 1.0");
 
-
     vector<Feature> filtered_features;
     if (random_feature_propn < 1.0) {
 
@@ -174,6 +186,7 @@ train_weighted(Thread_Context & context,
                 if (rng() < random_feature_propn)
                     filtered_features.push_back(features[i]);
             }
+            ++iter;
         }
         
         if (filtered_features.empty())
@@ -182,6 +195,33 @@ train_weighted(Thread_Context & context,
     else filtered_features.insert(filtered_features.end(),
                                   features.begin(), features.end());
 
+    return filtered_features;
+}
+
+} // file scope
+
+Decision_Tree
+Decision_Tree_Generator::
+train_weighted(Thread_Context & context,
+               const Training_Data & data,
+               const boost::multi_array<float, 2> & weights,
+               const std::vector<Feature> & features,
+               int max_depth) const
+{
+    Decision_Tree result = model;
+
+    Feature predicted = model.predicted();
+
+    /* Record which examples are in our class and with what weight they
+       are there. */
+    distribution<float> in_class(data.example_count(), 1.0);
+
+    bool regression_problem
+        = result.feature_space()->info(predicted).type() == REAL;
+
+    vector<Feature> filtered_features
+        = filter_features(context, features, random_feature_propn);
+
     if (max_depth == -1)
         max_depth = 50;
 
@@ -465,6 +505,40 @@ fillin_leaf_regression(Tree::Leaf & leaf,
     leaf.examples = examples;
 }
 
+void
+fillin_leaf_multi_regression(Tree::Leaf & leaf,
+                             const Training_Data & data,
+                             const vector<Feature> & targets,
+                             const vector<const float *> & rows,
+                             const distribution<float> & in_class,
+                             float examples = -1.0)
+{
+    /* Calculate the weighted mean of each target over the examples in this
+       class.  The values in the rows may have been scaled by the target
+       weights, so the unscaled values come from the labels. */
+    int nx = data.example_count();
+    int nt = targets.size();
+
+    double total_weight = 0.0;
+    distribution<double> total_val(nt);
+
+    for (unsigned t = 0;  t < nt;  ++t) {
+        const vector<Label> & labels = data.index().labels(targets[t]);
+        for (unsigned x = 0;  x < nx;  ++x) {
+            float w = rows[x][0] * in_class[x];
+            if (w == 0.0) continue;
+            total_val[t] += w * labels[x].value();
+            if (t == 0) total_weight += w;
+        }
+    }
+
+    if (examples == -1.0) examples = in_class.total();
+
+    leaf.pred = distribution<float>(total_val.begin(), total_val.end());
+    leaf.pred /= total_weight;
+    leaf.examples = examples;
+}
+
 template<class Weights>
 void compact_dataset(const Training_Data & data, const vector<float> & in_class,
                      const Weights & weights, int num_non_zero,
@@ -1111,6 +1185,204 @@ train_recursive_regression(Thread_Context & context,
     return node;
 }
 
+Decision_Tree
+Decision_Tree_Generator::
+train_weighted_multi(Thread_Context & context,
+                     const Training_Data & data,
+                     const vector<Feature> & targets,
+                     const distribution<float> & target_weights,
+                     const distribution<float> & example_weights,
+                     const vector<Feature> & features,
+                     int max_depth) const
+{
+    size_t nx = data.example_count();
+    size_t nt = targets.size();
+
+    if (nt == 0)
+        throw Exception("Decision_Tree_Generator::train_weighted_multi(): "
+                        "no targets");
+    if (!target_weights.empty() && target_weights.size() != nt)
+        throw Exception("Decision_Tree_Generator::train_weighted_multi(): "
+                        "%zd targets but %zd target weights",
+                        nt, target_weights.size());
+    if (example_weights.size() != nx)
+        throw Exception("Decision_Tree_Generator::train_weighted_multi(): "
+                        "%zd examples but %zd example weights",
+                        nx, example_weights.size());
+
+    for (unsigned t = 0;  t < nt;  ++t) {
+        if (feature_space->info(targets[t]).type() != REAL)
+            throw Exception("Decision_Tree_Generator::train_weighted_multi(): "
+                            "target " + feature_space->print(targets[t])
+                            + " is not real valued");
+        if (!target_weights.empty() && target_weights[t] < 0.0)
+            throw Exception("Decision_Tree_Generator::train_weighted_multi(): "
+                            "negative target weight");
+    }
+
+    Decision_Tree result(feature_space, targets[0], nt);
+
+    /* The stump trainer gets the targets through the weights array: each
+       example has a row with its weight followed by the value of each
+       target, scaled so that its squared error is weighted by the target
+       weight.  See W_regress_multi. */
+    boost::multi_array<float, 2> values(boost::extents[nx][nt + 1]);
+    for (unsigned x = 0;  x < nx;  ++x)
+        values[x][0] = example_weights[x];
+
+    for (unsigned t = 0;  t < nt;  ++t) {
+        const vector<Label> & labels = data.index().labels(targets[t]);
+        float scale = (target_weights.empty() ? 1.0
+                       : sqrt(target_weights[t]));
+        for (unsigned x = 0;  x < nx;  ++x)
+            values[x][t + 1] = labels[x].value() * scale;
+    }
+
+    vector<const float *> rows(nx);
+    for (unsigned x = 0;  x < nx;  ++x)
+        rows[x] = &values[x][0];
+
+    /* The targets can't be used to predict themselves. */
+    vector<Feature> filtered_features;
+    for (const Feature & feature
+             : filter_features(context, features, random_feature_propn))
+        if (std::find(targets.begin(), targets.end(), feature)
+            == targets.end())
+            filtered_features.push_back(feature);
+
+    if (max_depth == -1)
+        max_depth = 50;
+
+    distribution<float> in_class(nx, 1.0);
+
+    result.tree.root = train_recursive_multi_regression
+        (context, data, rows, targets, filtered_features, in_class,
+         0, max_depth, result.tree);
+
+    return result;
+}
+
+Tree::Ptr
+Decision_Tree_Generator::
+train_recursive_multi_regression(Thread_Context & context,
+                                 const Training_Data & data,
+                                 const vector<const float *> & rows,
+                                 const vector<Feature> & targets,
+                                 const vector<Feature> & features_,
+                                 const distribution<float> & in_class,
+                                 int depth, int max_depth,
+                                 Tree & tree) const
+{
+    if (depth > 100 && max_depth == -1)
+        throw Exception("Decision_Tree_Generator::"
+                        "train_recursive_multi_regression(): "
+                        "depth of 100 reached");
+
+    Tree::Leaf leaf;
+    fillin_leaf_multi_regression(leaf, data, targets, rows, in_class);
+
+    double total_weight = in_class.total();
+
+    if (depth == max_depth || total_weight < 1.0) {
+        Tree::Leaf * result = tree.new_leaf();
+        *result = leaf;
+        return result;
+    }
+
+    int num_non_zero = std::count_if(in_class.begin(), in_class.end(),
+                                     std::bind2nd(std::greater<float>(), 0.0));
+
+    if (num_non_zero * 16 < in_class.size()) {
+        Training_Data new_data(data.feature_space());
+        distribution<float> new_in_class;
+        vector<const float *> new_rows;
+
+        /* The leaves need the labels of the other targets too. */
+        vector<Feature> to_index = features_;
+        to_index.insert(to_index.end(), targets.begin() + 1, targets.end());
+
+        compact_dataset(data, in_class, rows, num_non_zero,
+                        new_data, new_in_class, new_rows, to_index,
+                        targets[0]);
+
+        /* Restart, with the new training data. */
+        return train_recursive_multi_regression
+            (context, new_data, new_rows, targets, features_, new_in_class,
+             depth, max_depth, tree);
+    }
+
+    typedef W_regress_multi W;
+    typedef Z_regress_multi Z;
+
+    typedef Tree_Accum<W, Z, Stream_Tracer> Accum;
+    typedef Stump_Trainer<W, Z> Trainer;
+
+    int nt = targets.size();
+
+    Accum accum(*model.feature_space(), nt, trace);
+    Trainer trainer;
+
+    /* If all of the targets are constant, there's nothing to split on. */
+    W default_w = trainer.calc_default_w(data, targets[0], in_class, rows, nt);
+    double total_z = default_w.z(MISSING);
+    if (total_z <= 0.0) {
+        Tree::Leaf * result = tree.new_leaf();
+        *result = leaf;
+        return result;
+    }
+
+    vector<Feature> features = features_;
+
+    /* One pass over the index of each feature updates all of the targets;
+       the advance tells the W how many there are. */
+    trainer.test_all_and_sort(features, data, targets[0], rows, in_class,
+                              accum, nt);
+
+    /* A perfect split (z of zero) is kept; its children will be leaves. */
+    if (!accum.has_result() || accum.best_z >= total_z) {
+        Tree::Leaf * result = tree.new_leaf();
+        *result = leaf;
+        return result;
+    }
+
+    distribution<float> class_true;
+    distribution<float> class_false;
+    distribution<float> class_missing;
+
+    double total_true;
+    double total_false;
+    double total_missing;
+
+    split_dataset(data, accum.split(), in_class,
+                  class_true, class_false, class_missing,
+                  total_true, total_false, total_missing,
+                  validate);
+
+    Tree::Node * node = tree.new_node();
+    node->split = accum.split();
+    node->z = accum.z();
+    node->examples = total_weight;
+    node->pred = leaf.pred;
+
+    /* A branch that no training examples went down predicts the same as
+       this node, rather than dividing by a zero weight. */
+    auto branch = [&] (const distribution<float> & new_in_class,
+                       double total) -> Tree::Ptr
+        {
+            if (total <= 0.0)
+                return tree.new_leaf(leaf.pred, 0.0);
+            return train_recursive_multi_regression
+                (context, data, rows, targets, features, new_in_class,
+                 depth + 1, max_depth, tree);
+        };
+
+    node->child_true = branch(class_true, total_true);
+    node->child_false = branch(class_false, total_false);
+    node->child_missing = branch(class_missing, total_missing);
+
+    return node;
+}
+
 
 /*****************************************************************************/
 /* REGISTRATION                                                              */
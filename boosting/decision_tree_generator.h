@@ -71,6 +71,15 @@ public:
     Stump::Update update_alg;
     float random_feature_propn;
 
+    /** If not empty, generate() trains a single regression tree that
+        predicts all of these (real valued) features at once, in this order,
+        instead of one for the predicted feature. */
+    std::vector<Feature> targets;
+
+    /** Weight of each of the targets in the variance that the splits
+        minimize.  Empty means that they are all weighted equally. */
+    distribution<float> target_weights;
+
     /* Once init has been called, we clone our potential models from this
        one. */
     Decision_Tree model;
@@ -91,6 +100,20 @@ public:
                     const distribution<float> & in_class,
                     int depth, int max_depth, Tree & tree) const;
 
+    /** Train a regression tree with one output for each of the targets.
+        Each split is chosen to minimize the (weighted) sum of the squared
+        errors of all of the targets, which are accumulated together in one
+        pass over the index of each feature rather than one pass per
+        target. */
+    Decision_Tree
+    train_weighted_multi(Thread_Context & context,
+                         const Training_Data & data,
+                         const std::vector<Feature> & targets,
+                         const distribution<float> & target_weights,
+                         const distribution<float> & example_weights,
+                         const std::vector<Feature> & features,
+                         int max_depth) const;
+
     Tree::Ptr
     train_recursive_regression(Thread_Context & context,
                                const Training_Data & data,
@@ -99,6 +122,16 @@ public:
                                const distribution<float> & in_class,
                                int depth, int max_depth, Tree & tree) const;
 
+    Tree::Ptr
+    train_recursive_multi_regression(Thread_Context & context,
+                                     const Training_Data & data,
+                                     const std::vector<const float *> & rows,
+                                     const std::vector<Feature> & targets,
+                                     const std::vector<Feature> & features,
+                                     const distribution<float> & in_class,
+                                     int depth, int max_depth,
+                                     Tree & tree) const;
+
     void do_branch(Tree::Ptr & ptr,
                    int & group_to_wait_on,
                    Thread_Context & context,
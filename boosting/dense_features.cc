@@ -17,6 +17,7 @@
 #include "jml/utils/vector_utils.h"
 #include "jml/utils/filter_streams.h"
 #include "jml/utils/smart_ptr_utils.h"
+#include "jml/arch/numa.h"
 #include <boost/tuple/tuple.hpp>
 #include "stdint.h"
 
@@ -472,14 +473,18 @@ print(const Feature_Set & fs) const
 
     /* Assume it's in the right order. */
     std::string result;
-    for (unsigned i = 0;  i < fs.size();  ++i) {
-        if (i != 0) result += ' ';
-        if (i > 0 && fs[i].first.type() != fs[i-1].first.type() + 1) {
-            throw Exception("Feature_Set out of order for "
-                            "Dense_Feature_Space");
-        }
-        result += print(fs[i].first, fs[i].second);
-    }
+    int i = 0, prev_type = -1;
+    for_each_feature(fs, [&] (const Feature & feature, float value)
+        {
+            if (i != 0) result += ' ';
+            if (i > 0 && feature.type() != prev_type + 1) {
+                throw Exception("Feature_Set out of order for "
+                                "Dense_Feature_Space");
+            }
+            result += print(feature, value);
+            prev_type = feature.type();
+            ++i;
+        });
 
     return result;
 }
@@ -721,11 +726,13 @@ freeze()
 /*****************************************************************************/
 
 Dense_Training_Data::Dense_Training_Data()
+    : external_data(0), external_cols(0)
 {
 }
 
 Dense_Training_Data::
 Dense_Training_Data(const std::string & filename)
+    : external_data(0), external_cols(0)
 {
     init(filename);
 }
@@ -733,10 +740,20 @@ Dense_Training_Data(const std::string & filename)
 Dense_Training_Data::
 Dense_Training_Data(const std::string & filename,
                     std::shared_ptr<Dense_Feature_Space> feature_space)
+    : external_data(0), external_cols(0)
 {
     init(filename, feature_space);
 }
 
+Dense_Training_Data::
+Dense_Training_Data(const float * data, size_t rows, size_t cols,
+                    std::shared_ptr<Dense_Feature_Space> feature_space,
+                    std::shared_ptr<const void> owner)
+    : external_data(0), external_cols(0)
+{
+    init(data, rows, cols, feature_space, owner);
+}
+
 Dense_Training_Data::~Dense_Training_Data()
 {
 }
@@ -819,14 +836,18 @@ get_sizes(const std::string & filename,
 
 void Dense_Training_Data::
 add_data()
+{
+    add_data(dataset.data(), dataset.shape()[0], dataset.shape()[1]);
+}
+
+void
+Dense_Training_Data::
+add_data(const float * data, size_t nx, size_t nv)
 {
     /* Go through the dataset and turn each row into an example. */
     Training_Data::clear();
     Training_Data::init(feature_space());
     
-    int nv = dataset.shape()[1];
-    int nx = dataset.shape()[0];
-
     /* Feature vector */
     std::shared_ptr<vector<Feature> >
         feature_vec(new vector<Feature>(nv));
@@ -834,14 +855,49 @@ add_data()
         (*feature_vec)[j] = Feature(j);
     
     /* Add data */
-    for (unsigned x = 0;  x < nx;  ++x) {
+    for (size_t x = 0;  x < nx;  ++x) {
         std::shared_ptr<Dense_Feature_Set> features
-            (new Dense_Feature_Set(feature_vec, &dataset[x][0]));
+            (new Dense_Feature_Set(feature_vec, data + x * nv));
         //cerr << "got row " << feature_space()->print(*features) << endl;
         add_example(features);
     }
 }
 
+void
+Dense_Training_Data::
+init(const float * data, size_t rows, size_t cols,
+     std::shared_ptr<Dense_Feature_Space> feature_space,
+     std::shared_ptr<const void> owner)
+{
+    if (!data && rows != 0)
+        throw Exception("Dense_Training_Data::init(): null data");
+
+    if (feature_space->variable_count() == 0) {
+        vector<string> feature_names;
+        for (unsigned i = 0;  i < cols;  ++i)
+            feature_names.push_back(format("v%d", i));
+        feature_space->init(feature_names, REAL);
+    }
+    else if (feature_space->variable_count() != cols)
+        throw Exception("Dense_Training_Data::init(): data has %zd columns "
+                        "but feature space has %zd variables",
+                        cols, feature_space->variable_count());
+
+    Training_Data::init(feature_space);
+
+    dataset.resize(boost::extents[0][0]);
+    row_comments.clear();
+    row_comments.resize(rows);
+    row_offsets.clear();
+    row_offsets.resize(rows);
+
+    external_data = data;
+    external_cols = cols;
+    external_owner = owner;
+
+    add_data(data, rows, cols);
+}
+
 void Dense_Training_Data::
 init(const std::string & filename)
 {
@@ -918,6 +974,10 @@ init(const std::vector<Data_Source> & data_sources,
 {
     Training_Data::init(feature_space);
 
+    external_data = 0;
+    external_cols = 0;
+    external_owner.reset();
+
     /* Get all of the counts from all of the files. */
     size_t row_count = 0, var_count = 0;
     string header;
@@ -1028,6 +1088,7 @@ init(const std::vector<Data_Source> & data_sources,
     
     /* Allocate our array. */
     dataset.resize(boost::extents[row_count][var_count]);
+    numa_place_array(dataset, NUMA_PARTITIONED);
     row_comments.resize(row_count);
     row_offsets.resize(row_count);
 
@@ -1215,6 +1276,10 @@ modify_feature(int example_number,
     if (feature.type() < 0 || feature.type() >= example_count())
         throw Exception("can't add feature to dense dataset");
 
+    if (external_data)
+        throw Exception("can't modify dense dataset that was initialized "
+                        "in place over external data");
+
     float & val = dataset[example_number][feature.type()];
     float result = val;
     val = new_value;
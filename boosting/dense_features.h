@@ -285,6 +285,13 @@ public:
     Dense_Training_Data(const std::string & filename,
                         std::shared_ptr<Dense_Feature_Space> feature_space);
 
+    /** Initialise over a block of data in memory, without copying it.  See
+        the init() method with the same arguments. */
+    Dense_Training_Data(const float * data, size_t rows, size_t cols,
+                        std::shared_ptr<Dense_Feature_Space> feature_space,
+                        std::shared_ptr<const void> owner
+                            = std::shared_ptr<const void>());
+
     virtual ~Dense_Training_Data();
 
 
@@ -316,6 +323,19 @@ public:
               const char * data_end,
               std::shared_ptr<Dense_Feature_Space> feature_space);
 
+    /** Initialise over a dense, row-major block of rows x cols floats, with
+        one column per variable of the feature space, in place.  The data
+        is not copied, so it must stay valid and unchanged for as long as
+        this object (or any copy of it) exists; owner, if given, is kept
+        until then and can be used to keep the data alive.  If the feature
+        space is empty, it is initialised with cols REAL variables.  The
+        data can't be modified via modify_feature().
+    */
+    void init(const float * data, size_t rows, size_t cols,
+              std::shared_ptr<Dense_Feature_Space> feature_space,
+              std::shared_ptr<const void> owner
+                  = std::shared_ptr<const void>());
+
 private:
     struct Data_Source;
 
@@ -332,7 +352,10 @@ public:
         doesn't populate it. */
     virtual Dense_Training_Data * make_type() const;
 
-    size_t variable_count() const { return dataset.shape()[1]; }
+    size_t variable_count() const
+    {
+        return external_data ? external_cols : dataset.shape()[1];
+    }
 
     virtual size_t row_offset(size_t row) const;
 
@@ -354,10 +377,19 @@ protected:
     /** The offset from the start of the file for the start of the line for
         each of the examples in the file. */
     std::vector<size_t> row_offsets;
+
+    /** Data that's not ours and is used in place of dataset, if set by the
+        in-memory init(). */
+    const float * external_data;
+    size_t external_cols;
+    std::shared_ptr<const void> external_owner;
     
     /** Add the data from the dataset to the Training_Data structures so they
         can be indexed.  Usually called after all files have been read. */
     void add_data();
+
+    /** Add the rows of the given dense block. */
+    void add_data(const float * data, size_t rows, size_t cols);
 };
 
 
@@ -397,6 +429,15 @@ public:
     virtual Dense_Feature_Set * make_copy() const;
 };
 
+/** Visit a dense feature set with no virtual calls.  See for_each_feature
+    in feature_set.h. */
+template<class F>
+void for_each_feature(const Dense_Feature_Set & fs, F && f)
+{
+    if (fs.features->empty()) return;
+    for_each_feature(&(*fs.features)[0], fs.values, fs.features->size(), f);
+}
+
 
 } // namespace ML
 
@@ -24,6 +24,8 @@
 #include <cmath>
 #include "jml/utils/parse_context.h"
 #include "feature.h"
+#include "jml/compiler/compiler.h"
+#include <typeinfo>
 
 namespace ML {
 
@@ -423,6 +425,84 @@ private:
 };
 
 
+/*****************************************************************************/
+/* FEATURE SET VISITORS                                                      */
+/*****************************************************************************/
+
+/** Call f(feature, value) for each entry of a feature set, in sorted order.
+
+    This is the fast way to iterate over a feature set.  Going through the
+    Feature_Set::const_iterator costs a virtual get_data() call for each
+    call to begin() or end() plus strided pointer arithmetic for each
+    element.  These functions instead make (at most) one virtual call and
+    then run a plain loop over contiguous arrays.
+
+    The overloads for concrete feature set types (Mutable_Feature_Set here,
+    Dense_Feature_Set in dense_features.h) are selected at compile time
+    when the static type is known.  The overload for a generic Feature_Set
+    inspects the layout returned by get_data() and dispatches to the same
+    loops, falling back to strided access for unknown layouts.
+*/
+
+/** Visit parallel arrays of features and values. */
+template<class F>
+JML_ALWAYS_INLINE void
+for_each_feature(const Feature * features, const float * values, size_t n,
+                 F && f)
+{
+    for (size_t i = 0;  i < n;  ++i)
+        f(features[i], values[i]);
+}
+
+/** Visit an array of (feature, value) pairs. */
+template<class F>
+JML_ALWAYS_INLINE void
+for_each_feature(const std::pair<Feature, float> * entries, size_t n,
+                 F && f)
+{
+    for (size_t i = 0;  i < n;  ++i)
+        f(entries[i].first, entries[i].second);
+}
+
+template<class F>
+void for_each_feature(const Mutable_Feature_Set & fs, F && f)
+{
+    fs.sort();
+    if (fs.features.empty()) return;
+    for_each_feature(&fs.features[0], fs.features.size(), f);
+}
+
+template<class F>
+void for_each_feature(const Feature_Set & fs, F && f)
+{
+    if (typeid(fs) == typeid(Mutable_Feature_Set)) {
+        for_each_feature(static_cast<const Mutable_Feature_Set &>(fs), f);
+        return;
+    }
+
+    const Feature * feat;
+    const float * val;
+    int feat_stride;
+    int val_stride;
+    size_t size;
+    boost::tie(feat, val, feat_stride, val_stride, size) = fs.get_data(true);
+
+    typedef std::pair<Feature, float> Entry;
+
+    if (feat_stride == sizeof(Feature) && val_stride == sizeof(float))
+        for_each_feature(feat, val, size, f);
+    else if (feat_stride == sizeof(Entry) && val_stride == sizeof(Entry)
+             && (const void *)val == &((const Entry *)feat)->second)
+        for_each_feature((const Entry *)feat, size, f);
+    else {
+        for (Feature_Set::const_iterator it(feat, val, feat_stride, val_stride),
+                 end = it + size;
+             it != end;  ++it)
+            f(it.feature(), it.value());
+    }
+}
+
+
 /*****************************************************************************/
 /* MISCELLANEOUS                                                             */
 /*****************************************************************************/
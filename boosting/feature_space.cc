@@ -146,11 +146,14 @@ Feature_Space::
 print(const Feature_Set & fs) const
 {
     std::string result;
-    for (unsigned i = 0;  i < fs.size();  ++i) {
-        if (i > 0) result += ' ';
-        result += escape_feature_name(print(fs[i].first))
-            + ':' + escape_feature_name(print(fs[i].first, fs[i].second));
-    }
+    bool first = true;
+    for_each_feature(fs, [&] (const Feature & feature, float value)
+        {
+            if (!first) result += ' ';
+            first = false;
+            result += escape_feature_name(print(feature))
+                + ':' + escape_feature_name(print(feature, value));
+        });
     return result;
 }
 
@@ -160,10 +163,11 @@ serialize(DB::Store_Writer & store, const Feature_Set & fs) const
 {
     store << FS_SERIALIZE_VERSION;
     store << DB::compact_size_t(fs.size());
-    for (unsigned i = 0;  i < fs.size();  ++i) {
-        serialize(store, fs[i].first);
-        store << fs[i].second;
-    }
+    for_each_feature(fs, [&] (const Feature & feature, float value)
+        {
+            serialize(store, feature);
+            store << value;
+        });
 }
 
 void Feature_Space::
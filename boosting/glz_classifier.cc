@@ -183,11 +183,10 @@ optimize_impl(Optimization_Info & info)
 
     // Fill in the feature order
     for (unsigned i = 0;  i < features.size();  ++i) {
-        map<Feature, int>::const_iterator it
-            = info.feature_to_optimized_index.find(features[i].feature);
-        if (it == info.feature_to_optimized_index.end())
+        int idx = info.find_optimized_index(features[i].feature);
+        if (idx == -1)
             throw Exception("GLZ_Classifier::optimize(): feature not found");
-        feature_indexes.push_back(it->second);
+        feature_indexes.push_back(idx);
     }
 
     return optimized_ = true;
@@ -223,6 +222,30 @@ optimized_predict_impl(int label,
     return do_predict_impl(label, features_c, &feature_indexes[0]);
 }
 
+void
+GLZ_Classifier::
+optimized_explain_impl(const float * features_c,
+                       const Optimization_Info & info,
+                       int label,
+                       double * contributions,
+                       double & bias,
+                       double weight) const
+{
+    if (!optimized_) {
+        Classifier_Impl::optimized_explain_impl(features_c, info, label,
+                                                contributions, bias, weight);
+        return;
+    }
+
+    for (unsigned j = 0;  j < features.size();  ++j) {
+        int idx = feature_indexes[j];
+        float feat_val = decode_value(features_c[idx], features[j]);
+        contributions[idx] += weight * weights[label][j] * feat_val;
+    }
+
+    if (add_bias) bias += weight * weights[label][features.size()];
+}
+
 float
 GLZ_Classifier::
 decode_value(float feat_val, const Feature_Spec & spec) const
@@ -145,6 +145,16 @@ public:
                            const Optimization_Info & info,
                            PredictionContext * context = 0) const;
 
+    /** Each feature contributes its weight times its value; the
+        contributions are in the space before the link function. */
+    virtual void
+    optimized_explain_impl(const float * features,
+                           const Optimization_Info & info,
+                           int label,
+                           double * contributions,
+                           double & bias,
+                           double weight = 1.0) const;
+
 #ifndef JML_TESTING_GLZ_CLASSIFIER
 protected:
 #endif
@@ -15,6 +15,9 @@
 #include "config_impl.h"
 #include "jml/algebra/multi_array_utils.h"
 #include "jml/utils/pair_utils.h"
+#include "jml/utils/worker_task.h"
+#include "jml/arch/threads.h"
+#include "training_index.h"
 
 
 using namespace std;
@@ -29,13 +32,14 @@ using namespace DB;
 namespace ML {
 
 Naive_Bayes::Naive_Bayes()
+    : optimized_(false)
 {
 }
 
 Naive_Bayes::
 Naive_Bayes(std::shared_ptr<const Feature_Space> feature_space,
             const Feature & feature)
-    : Classifier_Impl(feature_space, feature)
+    : Classifier_Impl(feature_space, feature), optimized_(false)
 {
 }
 
@@ -49,6 +53,9 @@ void Naive_Bayes::swap(Naive_Bayes & other)
     features.swap(other.features);
     swap_multi_arrays(probs, other.probs);
     label_priors.swap(other.label_priors);
+    std::swap(optimized_, other.optimized_);
+    feature_indexes.swap(other.feature_indexes);
+    stats.swap(other.stats);
 }
 
 namespace {
@@ -185,18 +192,18 @@ predict(const Feature_Set & feature_set,
 
         /* Scan through the two together. */
         Feature_Set::const_iterator fsit = feature_set.begin();
+        Feature_Set::const_iterator fsend = fsit + feature_set.size();
         vector<Bayes_Feature>::const_iterator fit = features.begin();
 
-        while (fsit != feature_set.end() && fit != features.end()) {
+        while (fsit != fsend && fit != features.end()) {
             const Feature & feature = fit->feature;
 
             /* Skip any we don't care about. */
-            if ((*fsit).first < feature) { ++fsit;  continue; }
+            if (fsit.feature() < feature) { ++fsit;  continue; }
 
             /* Find how many examples match. */
             Feature_Set::const_iterator first = fsit, last = fsit;
-            while (last != feature_set.end()
-                   && (*last).first == feature) ++last;
+            while (last != fsend && last.feature() == feature) ++last;
             
             int example_count = last - first;
             unsigned f = fit - features.begin();
@@ -274,6 +281,13 @@ predict(const Feature_Set & feature_set,
     
     //cerr << "with priors = " << result + log(label_priors) << endl;
 
+    return to_probabilities(result);
+}
+
+distribution<float>
+Naive_Bayes::
+to_probabilities(distribution<double> & result) const
+{
     result -= result.max();
 
     //cerr << "result (before exp) = " << result << endl;
@@ -297,6 +311,69 @@ predict(int label, const Feature_Set & features,
     return predict(features)[label];
 }
 
+bool
+Naive_Bayes::
+optimization_supported() const
+{
+    return true;
+}
+
+bool
+Naive_Bayes::
+predict_is_optimized() const
+{
+    return optimized_;
+}
+
+bool
+Naive_Bayes::
+optimize_impl(Optimization_Info & info)
+{
+    feature_indexes.clear();
+
+    for (unsigned i = 0;  i < features.size();  ++i) {
+        int idx = info.find_optimized_index(features[i].feature);
+        if (idx == -1)
+            throw Exception("Naive_Bayes::optimize(): feature not found");
+        feature_indexes.push_back(idx);
+    }
+
+    return optimized_ = true;
+}
+
+Label_Dist
+Naive_Bayes::
+optimized_predict_impl(const float * features_c,
+                       const Optimization_Info & info,
+                       PredictionContext * context) const
+{
+    if (feature_indexes.size() != features.size())
+        throw Exception("Naive_Bayes: features changed since optimize()");
+
+    int nl = label_count();
+    distribution<double> result(nl);
+
+    for (unsigned f = 0;  f < features.size();  ++f) {
+        float val = features_c[feature_indexes[f]];
+        int branch = (!finite(val) ? MISSING : val >= features[f].arg);
+        const float * p = &probs[f][branch][0];
+        for (unsigned l = 0;  l < nl;  ++l)
+            result[l] += p[l];
+    }
+
+    return to_probabilities(result);
+}
+
+float
+Naive_Bayes::
+optimized_predict_impl(int label,
+                       const float * features_c,
+                       const Optimization_Info & info,
+                       PredictionContext * context) const
+{
+    return optimized_predict_impl(features_c, info, context)[label];
+}
+
 std::string Naive_Bayes::print() const
 {
     return "Naive Bayes classifier";
@@ -333,7 +410,7 @@ Naive_Bayes * Naive_Bayes::make_copy() const
 namespace {
 
 static const std::string NAIVE_BAYES_MAGIC = "NAIVE_BAYES";
-static const compact_size_t NAIVE_BAYES_VERSION = 2;
+static const compact_size_t NAIVE_BAYES_VERSION = 3;
 
 } // file scope
 
@@ -356,6 +433,10 @@ void Naive_Bayes::serialize(DB::Store_Writer & store) const
             for (unsigned l = 0;  l < label_count();  ++l)
                 store << probs[f][i][l];
 
+    store << compact_size_t(!stats.empty());
+    if (!stats.empty())
+        stats.serialize(store);
+
 #if 0
     ofstream dump("nb-serial.txt");
     dump << features.size() << " " << label_count() << endl;
@@ -373,6 +454,7 @@ void Naive_Bayes::serialize(DB::Store_Writer & store) const
 Naive_Bayes::
 Naive_Bayes(DB::Store_Reader & store,
             const std::shared_ptr<const Feature_Space> & feature_space)
+    : optimized_(false)
 {
     string magic;
     compact_size_t version;
@@ -416,6 +498,17 @@ Naive_Bayes(DB::Store_Reader & store,
                 store >> probs[f2][i][l];
     }
 
+    if (version >= 3) {
+        compact_size_t has_stats(store);
+        if (has_stats) {
+            stats.reconstitute(store);
+            if (stats.counts.shape()[0] != num_features
+                || stats.counts.shape()[2] != label_count)
+                throw Exception("Naive_Bayes: reconstituted statistics "
+                                "have the wrong shape");
+        }
+    }
+
 #if 0
     ofstream dump("nb-reconst.txt");
     dump << num_features.size_ << " " << label_count << endl;
@@ -429,8 +522,7 @@ Naive_Bayes(DB::Store_Reader & store,
     }
 #endif
 
-    this->probs = probs;
-    //probs.swap(this->probs);
+    swap_multi_arrays(this->probs, probs);
     this->features = vector<Bayes_Feature>
         (first_extractor(sorted.begin()), first_extractor(sorted.end()));
 
@@ -459,6 +551,245 @@ void Naive_Bayes::calc_missing_total()
     missing_total = distribution<float>(missing.begin(), missing.end());
 }
 
+void
+Naive_Bayes::
+calc_from_stats()
+{
+    size_t nf = features.size();
+    size_t nl = label_count();
+
+    if (stats.empty())
+        throw Exception("Naive_Bayes: no statistics to calculate from");
+    if (stats.counts.shape()[0] != nf || stats.counts.shape()[2] != nl
+        || stats.label_weights.size() != nl)
+        throw Exception("Naive_Bayes: statistics have the wrong shape");
+    if (stats.example_count <= 0.0)
+        throw Exception("Naive_Bayes: statistics have no examples");
+
+    /* This is the same smoothing as Naive_Bayes_Generator uses. */
+    double nx = stats.example_count;
+    float epsilon = 1.0 / (nx * nl);
+
+    boost::multi_array<float, 3> new_probs(boost::extents[nf][3][nl]);
+
+    for (unsigned f = 0;  f < nf;  ++f) {
+        bool optional = feature_space()->info(features[f].feature).optional();
+
+        for (unsigned l = 0;  l < nl;  ++l) {
+            float w_false   = stats.counts[f][false][l];
+            float w_true    = stats.counts[f][true][l];
+            float w_missing = stats.counts[f][MISSING][l];
+
+            float total = (w_false + w_true + w_missing) * epsilon;
+
+            new_probs[f][true][l]  = log(std::max(1.0F, w_true  / total));
+            new_probs[f][false][l] = log(std::max(1.0F, w_false / total));
+            new_probs[f][MISSING][l] = optional ? 0.0
+                : log(std::max(1.0F, w_missing / total));
+        }
+    }
+
+    distribution<double> class_weights(nl);
+    for (unsigned l = 0;  l < nl;  ++l)
+        class_weights[l] = std::max(stats.label_weights[l], 1.0 / (nx * nl));
+    class_weights.normalize();
+
+    swap_multi_arrays(probs, new_probs);
+    label_priors
+        = distribution<float>(class_weights.begin(), class_weights.end());
+    calc_missing_total();
+}
+
+Naive_Bayes::Bayes_Stats
+Naive_Bayes::
+accumulate(const Training_Data & data,
+           const distribution<float> & example_weights) const
+{
+    size_t nf = features.size();
+    size_t nl = label_count();
+    size_t nx = data.example_count();
+
+    if (!example_weights.empty() && example_weights.size() != nx)
+        throw Exception("Naive_Bayes::accumulate(): %zd examples but %zd "
+                        "weights", nx, example_weights.size());
+
+    const vector<Label> & labels = data.index().labels(predicted());
+
+    /* Each shard accumulates into its own statistics, so there is no
+       contention; they are added together at the end. */
+    int nshards = std::max<int>(1, std::min<int>(num_threads(),
+                                                 (nx + 1023) / 1024));
+    vector<Bayes_Stats> shard_stats(nshards, Bayes_Stats(nf, nl));
+
+    auto doShard = [&] (int shard)
+        {
+            Bayes_Stats & result = shard_stats[shard];
+            size_t x_start = nx * shard / nshards;
+            size_t x_end = nx * (shard + 1) / nshards;
+
+            for (size_t x = x_start;  x < x_end;  ++x) {
+                double w = (example_weights.empty() ? 1.0
+                            : example_weights[x]);
+                int label = labels[x];
+                if (label < 0 || label >= nl)
+                    throw Exception("Naive_Bayes::accumulate(): label %d "
+                                    "out of range", label);
+
+                result.example_count += 1.0;
+                result.label_weights[label] += w;
+
+                const Feature_Set & feature_set = data[x];
+
+                /* Bucket each feature the same way that predict() does. */
+                for (unsigned f = 0;  f < nf;  ++f) {
+                    Feature_Set::const_iterator first, last;
+                    boost::tie(first, last)
+                        = feature_set.find(features[f].feature);
+
+                    if (first == last) {
+                        result.counts[f][MISSING][label] += w;
+                        continue;
+                    }
+
+                    double scale = w / (last - first);
+                    for (;  first != last;  ++first) {
+                        float value = (*first).second;
+                        int bucket = (!finite(value) ? MISSING
+                                      : value >= features[f].arg);
+                        result.counts[f][bucket][label] += scale;
+                    }
+                }
+            }
+        };
+
+    run_in_parallel(0, nshards, doShard);
+
+    for (unsigned i = 1;  i < nshards;  ++i)
+        shard_stats[0].add(shard_stats[i]);
+
+    return shard_stats[0];
+}
+
+void
+Naive_Bayes::
+update(const Training_Data & data,
+       const distribution<float> & example_weights)
+{
+    if (stats.empty())
+        throw Exception("Naive_Bayes::update(): model has no statistics to "
+                        "update; it needs to be retrained");
+
+    Bayes_Stats new_stats = accumulate(data, example_weights);
+
+    /* Strong exception guarantee: only modify once it's all worked. */
+    Naive_Bayes updated(*this);
+    updated.stats.add(new_stats);
+    updated.calc_from_stats();
+    swap(updated);
+}
+
+void
+Naive_Bayes::
+merge_into(Naive_Bayes & other) const
+{
+    if (stats.empty() || other.stats.empty())
+        throw Exception("Naive_Bayes::merge_into(): both models need "
+                        "statistics to be merged");
+    if (features.size() != other.features.size()
+        || label_count() != other.label_count())
+        throw Exception("Naive_Bayes::merge_into(): models have different "
+                        "shapes");
+    for (unsigned f = 0;  f < features.size();  ++f)
+        if (features[f].feature != other.features[f].feature
+            || features[f].arg != other.features[f].arg)
+            throw Exception("Naive_Bayes::merge_into(): models have "
+                            "different features");
+
+    Naive_Bayes merged(other);
+    merged.stats.add(stats);
+    merged.calc_from_stats();
+    other.swap(merged);
+}
+
+
+/*****************************************************************************/
+/* NAIVE_BAYES::BAYES_STATS                                                  */
+/*****************************************************************************/
+
+Naive_Bayes::Bayes_Stats::
+Bayes_Stats(size_t nf, size_t nl)
+    : counts(boost::extents[nf][3][nl]), label_weights(nl),
+      example_count(0.0)
+{
+}
+
+Naive_Bayes::Bayes_Stats &
+Naive_Bayes::Bayes_Stats::
+operator = (const Bayes_Stats & other)
+{
+    /* multi_array won't assign between different shapes. */
+    Bayes_Stats new_me(other);
+    swap(new_me);
+    return *this;
+}
+
+void
+Naive_Bayes::Bayes_Stats::
+add(const Bayes_Stats & other)
+{
+    if (counts.num_elements() != other.counts.num_elements()
+        || !std::equal(counts.shape(), counts.shape() + 3,
+                       other.counts.shape())
+        || label_weights.size() != other.label_weights.size())
+        throw Exception("Naive_Bayes::Bayes_Stats::add(): shapes differ");
+
+    double * p = counts.data();
+    const double * q = other.counts.data();
+    for (size_t i = 0;  i < counts.num_elements();  ++i)
+        p[i] += q[i];
+
+    label_weights += other.label_weights;
+    example_count += other.example_count;
+}
+
+void
+Naive_Bayes::Bayes_Stats::
+swap(Bayes_Stats & other)
+{
+    swap_multi_arrays(counts, other.counts);
+    label_weights.swap(other.label_weights);
+    std::swap(example_count, other.example_count);
+}
+
+void
+Naive_Bayes::Bayes_Stats::
+serialize(DB::Store_Writer & store) const
+{
+    size_t nf = counts.shape()[0], nl = counts.shape()[2];
+    store << compact_size_t(nf) << compact_size_t(nl)
+          << example_count << label_weights;
+    for (unsigned f = 0;  f < nf;  ++f)
+        for (unsigned i = 0;  i < 3;  ++i)
+            for (unsigned l = 0;  l < nl;  ++l)
+                store << counts[f][i][l];
+}
+
+void
+Naive_Bayes::Bayes_Stats::
+reconstitute(DB::Store_Reader & store)
+{
+    compact_size_t nf(store), nl(store);
+    Bayes_Stats result(nf, nl);
+    store >> result.example_count >> result.label_weights;
+    if (result.label_weights.size() != nl)
+        throw Exception("Naive_Bayes::Bayes_Stats: wrong number of labels");
+    for (unsigned f = 0;  f < nf;  ++f)
+        for (unsigned i = 0;  i < 3;  ++i)
+            for (unsigned l = 0;  l < nl;  ++l)
+                store >> result.counts[f][i][l];
+    swap(result);
+}
+
 
 
 /*****************************************************************************/
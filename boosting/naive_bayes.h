@@ -98,6 +98,72 @@ public:
     distribution<float> label_priors;
     distribution<float> missing_total; /* sum of all missing distributions. */
 
+    /** The sufficient statistics that the probabilities are calculated
+        from.  Weights are in units where an example of weight one counts
+        as one.  Two sets of statistics for the same features can simply be
+        added together, which is what allows a model to be updated with new
+        data without going back over the old.
+    */
+    struct Bayes_Stats {
+        Bayes_Stats() : example_count(0.0) {}
+        Bayes_Stats(size_t nf, size_t nl);
+
+        Bayes_Stats & operator = (const Bayes_Stats & other);
+
+        /** Weight of the examples of each label in each bucket (false,
+            true, missing) of each feature: nf x 3 x nl. */
+        boost::multi_array<double, 3> counts;
+
+        /** Weight of the examples of each label. */
+        distribution<double> label_weights;
+
+        /** Number of examples that have been accumulated. */
+        double example_count;
+
+        bool empty() const { return counts.num_elements() == 0; }
+
+        /** Add the other statistics, which must be the same shape, into
+            these. */
+        void add(const Bayes_Stats & other);
+
+        void swap(Bayes_Stats & other);
+
+        void serialize(DB::Store_Writer & store) const;
+        void reconstitute(DB::Store_Reader & store);
+    };
+
+    /** The statistics of the data we were trained on.  Empty for models
+        that were loaded from a file saved before they were recorded, or
+        whose probs were set up directly. */
+    Bayes_Stats stats;
+
+    /** Accumulate the statistics of the given data (with the given example
+        weights; empty means all one) for our features, and recalculate the
+        probabilities from the total.  This takes time proportional to the
+        new data, not to what the model was trained on.  The examples are
+        split into shards which are accumulated in parallel.  Throws if
+        there are no statistics to update.
+    */
+    void update(const Training_Data & data,
+                const distribution<float> & example_weights
+                    = distribution<float>());
+
+    /** Add our statistics into the other model, which must have the same
+        features, and recalculate its probabilities.  This allows models
+        trained on separate pieces of data to be combined. */
+    void merge_into(Naive_Bayes & other) const;
+
+    /** Calculate the statistics of the given data for our features, without
+        changing the model. */
+    Bayes_Stats
+    accumulate(const Training_Data & data,
+               const distribution<float> & example_weights
+                   = distribution<float>()) const;
+
+    /** Recalculate probs, label_priors and missing_total from the
+        statistics. */
+    void calc_from_stats();
+
     using Classifier_Impl::predict;
 
     virtual float predict(int label, const Feature_Set & features,
@@ -107,6 +173,25 @@ public:
     predict(const Feature_Set & features,
             PredictionContext * context = 0) const;
 
+    virtual bool optimization_supported() const;
+
+    virtual bool predict_is_optimized() const;
+
+    virtual bool optimize_impl(Optimization_Info & info);
+
+    virtual Label_Dist
+    optimized_predict_impl(const float * features,
+                           const Optimization_Info & info,
+                           PredictionContext * context = 0) const;
+
+    virtual float
+    optimized_predict_impl(int label,
+                           const float * features,
+                           const Optimization_Info & info,
+                           PredictionContext * context = 0) const;
+
+    using Classifier_Impl::optimized_predict_impl;
+
     virtual std::string print() const;
 
     virtual std::vector<Feature> all_features() const;
@@ -123,6 +208,13 @@ public:
     virtual Naive_Bayes * make_copy() const;
 
     void calc_missing_total();
+
+private:
+    /** Turn the accumulated log probabilities into the output. */
+    distribution<float> to_probabilities(distribution<double> & result) const;
+
+    bool optimized_;
+    std::vector<int> feature_indexes;
 };
 
 
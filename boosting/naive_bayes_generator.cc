@@ -182,6 +182,11 @@ struct Naive_Bayes_Accum {
     vector<distribution<float> > dist_false;
     vector<distribution<float> > dist_missing;
 
+    /* The weights that they came from, for the sufficient statistics. */
+    vector<distribution<double> > w_true;
+    vector<distribution<double> > w_false;
+    vector<distribution<double> > w_missing;
+
     /** Method that gets called when we start a new feature.  We use it to
         pre-cache part of the work from the Z calculation, as we are
         assured that the MISSING buckets of W will never change after this
@@ -244,12 +249,17 @@ struct Naive_Bayes_Accum {
         features.push_back(bayes_feature);
 
         distribution<float> d_true(nl), d_false(nl), d_missing(nl);
+        distribution<double> c_true(nl), c_false(nl), c_missing(nl);
 
         for (unsigned l = 0; l < nl;  ++l) {
             float w_false   = w(l, false,   true);
             float w_true    = w(l, true,    true);
             float w_missing = w(l, MISSING, true);
 
+            c_false[l]   = w_false;
+            c_true[l]    = w_true;
+            c_missing[l] = w_missing;
+
             float total = (w_false + w_true + w_missing) * epsilon;
 
             d_true[l]    = log(std::max(1.0F, w_true    / total));
@@ -262,6 +272,10 @@ struct Naive_Bayes_Accum {
         dist_false.push_back(d_false);
         dist_missing.push_back(d_missing);
 
+        w_true.push_back(c_true);
+        w_false.push_back(c_false);
+        w_missing.push_back(c_missing);
+
         if (tracer)
             tracer("naive bayes accum", 3)
                 << "  finish: feature " << feature << " arg " << arg
@@ -286,6 +300,7 @@ struct Naive_Bayes_Accum {
         sort_on_first_ascending(sorted);
         
         boost::multi_array<float, 3> probs(boost::extents[features.size()][3][nl]);
+        Naive_Bayes::Bayes_Stats stats(features.size(), nl);
         distribution<double> missing(nl);
         output.features
             = vector<Naive_Bayes::Bayes_Feature>
@@ -299,10 +314,15 @@ struct Naive_Bayes_Accum {
                 probs[f][true][l]    = dist_true[f2][l];
                 probs[f][MISSING][l] = dist_missing[f2][l];
                 missing[l]          += dist_missing[f2][l];
+
+                stats.counts[f][false][l]   = w_false[f2][l];
+                stats.counts[f][true][l]    = w_true[f2][l];
+                stats.counts[f][MISSING][l] = w_missing[f2][l];
             }
         }
 
         swap_multi_arrays(output.probs, probs);
+        output.stats.swap(stats);
         output.missing_total
             = distribution<float>(missing.begin(), missing.end());
     }
@@ -385,6 +405,25 @@ train_weighted(Thread_Context & context,
         accum.results(result);
     }
 
+    /* The statistics are in units of the training weights.  Rescale them
+       so that an example counts for one, which is what
+       Naive_Bayes::update() adds, and fill in the label weights in the
+       same units. */
+    distribution<double> label_weights(nl);
+    double total_weight = 0.0;
+    for (unsigned x = 0;  x < nx;  ++x) {
+        float w = weights[x][weights.shape()[1] == 1 ? 0 : (int)labels[x]];
+        label_weights[labels[x]] += w;
+        total_weight += w;
+    }
+
+    double scale = (total_weight > 0.0 ? nx / total_weight : 1.0);
+    double * counts = result.stats.counts.data();
+    for (size_t i = 0;  i < result.stats.counts.num_elements();  ++i)
+        counts[i] *= scale;
+    result.stats.label_weights = label_weights * scale;
+    result.stats.example_count = nx;
+
     return result;
 }
 
@@ -17,6 +17,8 @@
 #include "registry.h"
 #include "jml/utils/environment.h"
 #include "jml/utils/vector_utils.h"
+#include "jml/utils/worker_task.h"
+#include "jml/utils/rng.h"
 #include <cmath>
 #include <fstream>
 #include "config_impl.h"
@@ -189,15 +191,24 @@ add_data_sparse(std::vector<distribution<double> > & data,
                 const Optimization_Info & opt_info)
 {
     size_t nx = training_data.example_count();
+    size_t nl = classifier.label_count();
 
     const vector<Label> & labels
         = training_data.index().labels(classifier.predicted());
+
+    vector<int> examples(nx);
+    for (unsigned x = 0;  x < nx;  ++x)
+        examples[x] = x;
+
+    boost::multi_array<double, 2> outputs
+        = score(training_data, classifier, opt_info, examples);
     
-    /* Go through the training examples one by one, and record the
-       outputs. */
+    /* Record the outputs, which have been calculated in parallel, example
+       by example. */
+    vector<float> output(nl);
     for (unsigned x = 0;  x < nx;  ++x) {
-        distribution<float> output
-            = classifier.predict(training_data[x], opt_info);
+        for (unsigned l = 0;  l < nl;  ++l)
+            output[l] = outputs[l][x];
         add_data_sparse(data, output, labels[x]);
     }
 }
@@ -306,16 +317,22 @@ train_mode0(boost::multi_array<double, 2> & outputs,
     /* Learn glz as a whole matrix.  Needs lots of data to work well. */
     distribution<double> w(weights.begin(), weights.end());
         
-    /* Perform a GLZ for each column.  TODO: really use the GLZ class. */
-    for (unsigned l = 0;  l < nl;  ++l) {
-        if (num_correct[l] > 0 && num_correct[l] <= nx) {
-            distribution<float> trained
-                = train_one_mode0(outputs, correct[l], w, dest);
-            if (trained[l] > 0.0) params[l] = trained;
-        }
-        if (debug)
+    /* Perform a GLZ for each column, in parallel.  TODO: really use the
+       GLZ class. */
+    auto trainLabel = [&] (int l)
+        {
+            if (num_correct[l] > 0 && num_correct[l] <= nx) {
+                distribution<float> trained
+                    = train_one_mode0(outputs, correct[l], w, dest);
+                if (trained[l] > 0.0) params[l] = trained;
+            }
+        };
+
+    run_in_parallel(0, nl, trainLabel);
+
+    if (debug)
+        for (unsigned l = 0;  l < nl;  ++l)
             cerr << "params for " << l << " = " << params.at(l) << endl;
-    }
 }
 
 distribution<float>
@@ -370,17 +387,22 @@ train_mode1(const boost::multi_array<double, 2> & outputs,
 
     distribution<double> w(weights.begin(), weights.end());
         
-    /* Perform a GLZ for each column.  TODO: really use the GLZ class. */
-    for (unsigned l = 0;  l < nl;  ++l) {
-        if (num_correct[l] > 0) {
-            distribution<float> trained
-                = train_one_mode1(outputs, correct[l], w, l);
-            if (trained[l] > 0.0) params[l] = trained;
-        }
-        
-        if (debug)
+    /* Perform a GLZ for each column, in parallel.  TODO: really use the
+       GLZ class. */
+    auto trainLabel = [&] (int l)
+        {
+            if (num_correct[l] > 0) {
+                distribution<float> trained
+                    = train_one_mode1(outputs, correct[l], w, l);
+                if (trained[l] > 0.0) params[l] = trained;
+            }
+        };
+
+    run_in_parallel(0, nl, trainLabel);
+
+    if (debug)
+        for (unsigned l = 0;  l < nl;  ++l)
             cerr << "params for " << l << " = " << params[l] << endl;
-    }
 }
 
 void GLZ_Probabilizer::
@@ -570,19 +592,23 @@ train_mode4(const boost::multi_array<double, 2> & outputs,
     /* Train the mode2 over all of the data.  We use this as a fallback. */
     train_mode2(outputs, correct, num_correct, weights, false);
     
-    /* Now select between them for each row. */
-    for (unsigned l = 0;  l < nl;  ++l) {
-        distribution<float> trained;
-        if (num_correct[l] >= min_mode0_examples)
-            trained = train_one_mode0(outputs_nodep, correct[l], w, dest);
-        else if (num_correct[l] >= min_mode1_examples)
-            trained = train_one_mode1(outputs, correct[l], w, l);
-        if (trained.size() && trained[l] > 0.0) params[l] = trained;
-        
-        if (debug)
+    /* Now select between them for each row, in parallel. */
+    auto trainLabel = [&] (int l)
+        {
+            distribution<float> trained;
+            if (num_correct[l] >= min_mode0_examples)
+                trained = train_one_mode0(outputs_nodep, correct[l], w, dest);
+            else if (num_correct[l] >= min_mode1_examples)
+                trained = train_one_mode1(outputs, correct[l], w, l);
+            if (trained.size() && trained[l] > 0.0) params[l] = trained;
+        };
+
+    run_in_parallel(0, nl, trainLabel);
+
+    if (debug)
+        for (unsigned l = 0;  l < nl;  ++l)
             cerr << "params for " << l << " (" << num_correct[l] << " ex) = "
                  << params[l] << endl;
-    }
 }
 
 void GLZ_Probabilizer::
@@ -654,54 +680,118 @@ train_mode5(const boost::multi_array<double, 2> & outputs,
             cerr << "params for " << l << " = " << params[l] << endl;
 }
 
-namespace {
+std::vector<int>
+GLZ_Probabilizer::
+stratified_sample(const std::vector<Label> & labels, size_t nl,
+                  size_t max_examples, int seed)
+{
+    size_t nx = labels.size();
+    bool regression_problem = (nl == 1);
 
-/** Small object to record the values of predictions once they're ready */
-struct Write_Output {
-    boost::multi_array<double, 2> & outputs;
-    int nl;
-    bool regression_problem;
-
-    Write_Output(boost::multi_array<double, 2> & outputs, int nl,
-                 bool regression_problem)
-        : outputs(outputs), nl(nl), regression_problem(regression_problem)
-    {
-        if (!regression_problem)
-            ExcAssertEqual(nl + 2, outputs.shape()[0]);
-        else ExcAssertEqual(nl, 1);
+    vector<int> result;
+
+    if (max_examples == 0 || nx <= max_examples) {
+        result.resize(nx);
+        for (unsigned x = 0;  x < nx;  ++x)
+            result[x] = x;
+        return result;
     }
 
-    void operator () (int example, const float * vals)
-    {
-        //cerr << "writing output: example " << example << " vals[0] "
-        //     << vals[0] << " nl " << nl << " sz " << outputs.shape()[0]
-        //     << "x" << outputs.shape()[1] << endl;
-        ExcAssertLess(example, outputs.shape()[1]);
+    /* Split the examples up by label. */
+    vector<vector<int> > strata(regression_problem ? 1 : nl);
+    for (unsigned x = 0;  x < nx;  ++x) {
+        int l = (regression_problem ? 0 : labels[x].label());
+        if (l < 0 || l >= strata.size())
+            throw Exception("GLZ_Probabilizer::stratified_sample(): "
+                            "label %d out of range", l);
+        strata[l].push_back(x);
+    }
 
-        if (!regression_problem) {
-            float max_output = *vals;
-            for (unsigned l = 0;  l < nl;  ++l) {
-                outputs[l][example] = vals[l];
-                max_output = std::max(max_output, vals[l]);
-            }
-            outputs[nl][example]     = max_output;  // maximum output
-            outputs[nl + 1][example] = 1.0;     // bias term
-        }
-        else {
-            outputs[0][example] = *vals;
-            outputs[1][example] = 1.0;
+    size_t nonempty = 0;
+    for (unsigned l = 0;  l < strata.size();  ++l)
+        if (!strata[l].empty()) ++nonempty;
+
+    /* Each label gets a minimum number, and then the rest are shared out
+       in proportion to what's left over. */
+    size_t min_per_label
+        = std::max<size_t>(1, std::min<size_t>(50, max_examples / nonempty));
+
+    vector<size_t> taken(strata.size());
+    size_t total_taken = 0, total_left = 0;
+    for (unsigned l = 0;  l < strata.size();  ++l) {
+        taken[l] = std::min(strata[l].size(), min_per_label);
+        total_taken += taken[l];
+        total_left += strata[l].size() - taken[l];
+    }
+
+    if (total_taken < max_examples && total_left > 0) {
+        double fraction = (double)(max_examples - total_taken) / total_left;
+        for (unsigned l = 0;  l < strata.size();  ++l)
+            taken[l] += (size_t)((strata[l].size() - taken[l]) * fraction);
+    }
+
+    /* Take a random subset of each stratum, via a partial shuffle. */
+    RNG rng(seed);
+    for (unsigned l = 0;  l < strata.size();  ++l) {
+        vector<int> & stratum = strata[l];
+        for (unsigned i = 0;  i < taken[l];  ++i) {
+            std::swap(stratum[i],
+                      stratum[i + rng.random(stratum.size() - i)]);
+            result.push_back(stratum[i]);
         }
     }
-};
 
-} // file scope
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+boost::multi_array<double, 2>
+GLZ_Probabilizer::
+score(const Training_Data & data,
+      const Classifier_Impl & classifier,
+      const Optimization_Info & opt_info,
+      const std::vector<int> & examples)
+{
+    size_t nl = classifier.label_count();
+    bool regression_problem = (nl == 1);
+    size_t ol = regression_problem ? 2 : nl + 2;
+    size_t nx = examples.size();
+
+    boost::multi_array<double, 2> outputs(boost::extents[ol][nx]);
+
+    auto scoreExample = [&] (int i)
+        {
+            Label_Dist vals = classifier.predict(data[examples[i]], opt_info);
+            ExcAssertEqual(vals.size(), nl);
+
+            if (!regression_problem) {
+                float max_output = vals[0];
+                for (unsigned l = 0;  l < nl;  ++l) {
+                    outputs[l][i] = vals[l];
+                    max_output = std::max(max_output, vals[l]);
+                }
+                outputs[nl][i]     = max_output;  // maximum output
+                outputs[nl + 1][i] = 1.0;         // bias term
+            }
+            else {
+                outputs[0][i] = vals[0];
+                outputs[1][i] = 1.0;
+            }
+        };
+
+    run_in_parallel_blocked(0, (int)nx, scoreExample);
+
+    return outputs;
+}
 
 void GLZ_Probabilizer::
 train(const Training_Data & training_data,
       const Classifier_Impl & classifier,
       const Optimization_Info & opt_info,
-      const distribution<float> & weights,
-      int mode, const string & link_name)
+      const distribution<float> & weights_,
+      int mode, const string & link_name,
+      size_t max_examples)
 {
     if (link_name != "") link = parse_link_function(link_name);
 
@@ -718,47 +808,62 @@ train(const Training_Data & training_data,
                     "different label counts", classifier.label_count(),
                     nl));
 
-    size_t nx = training_data.example_count();
+    size_t nx_all = training_data.example_count();
 
-    if (weights.size() != nx)
+    if (weights_.size() != nx_all)
         throw Exception(format("GLZ_Probabilizer::train(): passed %zd examples "
-                               "but %zd weights", nx, weights.size()));
+                               "but %zd weights", nx_all, weights_.size()));
     
-    if (nx == 0 && mode != 3)
+    if (nx_all == 0 && mode != 3)
         throw Exception("GLZ_Probabilizer::train(): passed 0 examples");
 
-    /* In order to train this, we make a vector of the output of the
-       classifier for each variable. */
-
     bool regression_problem = (nl == 1);
 
-    size_t ol = regression_problem ? 2 : nl + 2;
-    
-    //bool debug = false;
-    
-    boost::multi_array<double, 2> outputs(boost::extents[ol][nx]);
+    /* Cut down the number of examples if there are too many. */
+    vector<int> examples
+        = stratified_sample(labels, nl, max_examples);
+    size_t nx = examples.size();
+
+    /* Scale the weights up to account for the examples that weren't
+       sampled, so that the labels keep the same weight overall. */
+    distribution<float> weights(nx);
+    if (nx == nx_all) weights = weights_;
+    else {
+        size_t ns = regression_problem ? 1 : nl;
+        distribution<double> total(ns), sampled(ns);
+        for (unsigned x = 0;  x < nx_all;  ++x)
+            total[regression_problem ? 0 : labels[x].label()] += weights_[x];
+        for (unsigned i = 0;  i < nx;  ++i) {
+            int x = examples[i];
+            sampled[regression_problem ? 0 : labels[x].label()]
+                += weights_[x];
+        }
+        for (unsigned i = 0;  i < nx;  ++i) {
+            int x = examples[i];
+            int l = regression_problem ? 0 : labels[x].label();
+            weights[i] = weights_[x] * xdiv(total[l], sampled[l]);
+        }
+    }
+
+    /* In order to train this, we make a vector of the output of the
+       classifier for each variable.  This is done once, and is shared by
+       all of the modes. */
+    boost::multi_array<double, 2> outputs
+        = score(training_data, classifier, opt_info, examples);
+
     distribution<double> model(nx, 0.0);
     vector<distribution<double> > correct(nl, model);
     distribution<int> num_correct(nl);
 
-    /* Go through the training examples one by one, and record the
-       outputs. */
-    classifier.predict(training_data,
-                       Write_Output(outputs, nl, regression_problem),
-                       &opt_info);
-
-    //for (unsigned i = 0;  i < 10;  ++i)
-    //    cerr << "outputs[" << 0 << "][" << i << "] = "
-    //         << outputs[0][i] << endl;
-    
-    for (unsigned x = 0;  x < nx;  ++x) {
+    for (unsigned i = 0;  i < nx;  ++i) {
+        const Label & label = labels[examples[i]];
         if (regression_problem) {
-            correct[0][x] = labels[x].value();
+            correct[0][i] = label.value();
         }
         else {
-            num_correct[labels[x]] += 1;
+            num_correct[label] += 1;
             for (unsigned l = 0;  l < nl;  ++l) {
-                correct[l][x] = (float)(labels[x] == l);
+                correct[l][i] = (float)(label == l);
             }
         }
     }
@@ -830,10 +935,12 @@ void GLZ_Probabilizer::
 train(const Training_Data & training_data,
       const Classifier_Impl & classifier,
       const Optimization_Info & opt_info,
-      int mode, const string & link_name)
+      int mode, const string & link_name,
+      size_t max_examples)
 {
     distribution<float> weights(training_data.example_count(), 1.0);
-    train(training_data, classifier, opt_info, weights, mode, link_name);
+    train(training_data, classifier, opt_info, weights, mode, link_name,
+          max_examples);
 }
 
 void
@@ -12,6 +12,7 @@
 #include "jml/db/persistent.h"
 #include "jml/stats/distribution.h"
 #include "decoder.h"
+#include "label.h"
 #include <boost/multi_array.hpp>
 #include "jml/algebra/irls.h"
 
@@ -45,16 +46,53 @@ public:
     virtual distribution<float>
     apply(const distribution<float> & input) const;
 
+    /** Train the probabilizer from the output of the classifier over the
+        data.  The classifier is run over the data once, in parallel, and
+        the per-label fits of the modes that have them are also run in
+        parallel.
+
+        If max_examples is non-zero and there are more examples than that,
+        only a sample of about max_examples of them is used (see
+        stratified_sample()), with the weights scaled to make up for the
+        examples of each label that were left out.
+    */
     void train(const Training_Data & data,
                const Classifier_Impl & classifier,
                const Optimization_Info & opt_info,
-               int mode, const std::string & link_name);
+               int mode, const std::string & link_name,
+               size_t max_examples = 0);
 
     void train(const Training_Data & data,
                const Classifier_Impl & classifier,
                const Optimization_Info & opt_info,
                const distribution<float> & weights,
-               int mode, const std::string & link_name);
+               int mode, const std::string & link_name,
+               size_t max_examples = 0);
+
+    /** Choose about max_examples of the examples with the given labels,
+        stratified by label: each label with examples keeps at least a few
+        of them (up to 50, fewer if there are too many labels for that), and
+        the rest are shared out in proportion to how common each label is.
+        The examples are chosen at random with the given seed, and returned
+        in order.  Returns all of the examples if max_examples is zero or
+        there are no more examples than that.  If nl is one (regression),
+        the examples are sampled uniformly.
+    */
+    static std::vector<int>
+    stratified_sample(const std::vector<Label> & labels, size_t nl,
+                      size_t max_examples, int seed = 0);
+
+    /** Run the classifier over the given examples of the data, in
+        parallel, and return its output in the format used by the
+        train_mode functions: one column per example, with a row per label
+        followed by the maximum and a constant 1.0 term (for regression,
+        just the output and the 1.0 term).
+    */
+    static boost::multi_array<double, 2>
+    score(const Training_Data & data,
+          const Classifier_Impl & classifier,
+          const Optimization_Info & opt_info,
+          const std::vector<int> & examples);
 
     /** Initialize directly from parameters. */
     void init(const Classifier_Impl & classifier,
@@ -10,6 +10,7 @@
 #include "registry.h"
 #include "jml/utils/parse_context.h"
 #include "jml/utils/file_functions.h"
+#include "jml/utils/worker_task.h"
 #include <boost/utility.hpp>
 #include "config_impl.h"
 
@@ -222,101 +223,256 @@ Sparse_Training_Data::~Sparse_Training_Data()
 {
 }
 
-void
-Sparse_Training_Data::
-expect_feature(Parse_Context & c, Mutable_Feature_Set & features,
-               Sparse_Feature_Space & feature_space,
-               bool & guessed_wrong)
-{
-    //__builtin_prefetch(c.get_pos() + 128, 0, 0);
+namespace {
 
-    string name = expect_feature_name(c);
-    //cerr << "name = " << name << endl;
-    Feature feature = feature_space.make_feature(name);
-    //cerr << "feature = " << feature << endl;
-    int num = feature.type();
+/*****************************************************************************/
+/* LOADER                                                                    */
+/*****************************************************************************/
 
-    //cerr << "num = " << num << endl;
+/* The data files are loaded in three steps:
 
-    Mutable_Feature_Info & info
-        = feature_space.info_array[num];
+   1.  Each file is split into chunks of whole lines, which are parsed in
+       parallel.  Each chunk interns its own feature names, and records the
+       values exactly as they were found in the file, without deciding if
+       they are numbers or categories.
+   2.  The chunks are merged in file order.  This assigns the feature
+       numbers in order of first appearance, works out which features are
+       categorical (those with any non-numeric value) and numbers the
+       categories, again in order of first appearance.
+   3.  The feature sets are built from the raw values, in parallel.
 
-    bool categorical = !!info.categorical();
+   This means that the input is read only once, no matter how many of the
+   categorical features we would have guessed wrong about.
+*/
 
-    if (categorical && (!c || *c != ':')) {
-        /* A categorical feature can't have a missing label. */
-        c.exception("categorical feature " + name + " missing value");
+/** A value of a feature, as it was found in the file. */
+struct Raw_Value {
+    enum Kind {
+        NUMBER,      ///< Parsed as a number; text starts at begin
+        DEFAULTED,   ///< No value given; means 1.0 if not categorical
+        LABEL,       ///< Old-style label at the start of the line
+        CATEGORY     ///< Not a number; name is in the chunk's categories
+    };
+
+    int feature;         ///< Feature number within the chunk
+    Kind kind;
+    float value;
+    union {
+        const char * begin;
+        int category;
+    };
+};
+
+/** A line of the file, as a range of values. */
+struct Raw_Line {
+    Raw_Line(size_t begin = 0, size_t end = 0)
+        : begin(begin), end(end)
+    {
     }
-                                   
-    if (!categorical) {
-        float value = 1.0;
+
+    size_t begin, end;
+};
+
+/** Everything that was parsed from one chunk of a file. */
+struct Raw_Chunk {
+    std::string filename;
+    const char * start;
+    const char * finish;
+
+    std::vector<Raw_Value> values;
+    std::vector<Raw_Line> lines;
+    std::vector<std::string> categories;
+
+    /** Names of the features, in order of first appearance, and whether
+        the feature space already knew they were categorical. */
+    std::vector<std::string> names;
+    std::vector<char> known_categorical;
+    std::hash_map<std::string, int> name_lookup;
+
+    /** Global feature for each of the names.  Filled in by the merge. */
+    std::vector<Feature> features;
+
+    int intern(const std::string & name,
+               const Sparse_Feature_Space & feature_space,
+               const std::hash_map<std::string, int> & global_lookup,
+               const std::vector<Mutable_Feature_Info> & global_info)
+    {
+        std::hash_map<std::string, int>::const_iterator it
+            = name_lookup.find(name);
+        if (it != name_lookup.end()) return it->second;
+
+        int result = names.size();
+        name_lookup[name] = result;
+        names.push_back(name);
+
+        /* The global feature space is only read (never written) while
+           the chunks are being parsed, so this is safe. */
+        std::hash_map<std::string, int>::const_iterator jt
+            = global_lookup.find(name);
+        known_categorical.push_back
+            (jt != global_lookup.end()
+             && !!global_info[jt->second].categorical());
         
-        if (c && *c == ':') {
-            /* It has a value attached. */
-            ++c;
-            if (c.match_float(value))
-                features.add(feature, value);
-            else {
-                /* We guessed wrong... this is categorical */
-                cerr << "guessed_wrong" << endl;
-                cerr << "name = " << name << endl;
-                cerr << "line = " << c.get_line() << endl;
-                guessed_wrong = true;
-                info.make_categorical();
-                categorical = true;
-            }
+        return result;
+    }
 
-            /* Allow further values to be specified. */
-            while (!categorical && c && *c == ',') {
-                ++c;  // skip the ','
-                if (c.match_float(value))
-                    features.add(feature, value);
-                else {
-                    guessed_wrong = true;
-                    info.make_categorical();
-                    categorical = true;
-                }
-            }
-        }
-        else if (!c || *c == '\n' || isspace(*c)) {
-            /* Feature with defaulted value */
-            features.add(feature, 1.0);
+    void add_value(int feature, Raw_Value::Kind kind, float value = 1.0,
+                   const char * begin = 0)
+    {
+        Raw_Value v;
+        v.feature = feature;
+        v.kind = kind;
+        v.value = value;
+        v.begin = begin;
+        values.push_back(v);
+    }
+
+    void add_category(int feature, const std::string & name)
+    {
+        Raw_Value v;
+        v.feature = feature;
+        v.kind = Raw_Value::CATEGORY;
+        v.value = 0.0;
+        v.category = categories.size();
+        categories.push_back(name);
+        values.push_back(v);
+    }
+
+    /** Return the name of the category for a raw value of a feature that
+        turned out to be categorical.  Numbers are re-read as a name, as they
+        would have been had we known it was categorical when we parsed it;
+        this is rare, so we don't keep the names of all numbers around. */
+    std::string category_name(const Raw_Value & v) const
+    {
+        if (v.kind == Raw_Value::CATEGORY) return categories[v.category];
+        Parse_Context c(filename, v.begin, finish);
+        return expect_feature_name(c);
+    }
+};
+
+/** Split the given range (which starts at the beginning of a line) into
+    at most n chunks, each of which contains only whole lines. */
+void split_lines(const File_Read_Buffer & file, const char * start, int n,
+                 const std::string & filename,
+                 std::vector<Raw_Chunk> & chunks)
+{
+    const char * finish = file.end();
+    ssize_t chunk_size = (finish - start) / n + 1;
+
+    while (start < finish) {
+        const char * chunk_end = finish;
+        if (finish - start > chunk_size) {
+            chunk_end = (const char *)
+                memchr(start + chunk_size, '\n',
+                       finish - start - chunk_size);
+            if (chunk_end) ++chunk_end;
+            else chunk_end = finish;
         }
+
+        chunks.push_back(Raw_Chunk());
+        Raw_Chunk & chunk = chunks.back();
+        chunk.filename = format("%s (from byte %zd)", filename.c_str(),
+                                (size_t)(start - file.start()));
+        chunk.start = start;
+        chunk.finish = chunk_end;
+
+        start = chunk_end;
     }
-    
-    if (categorical) {
-        if (c && c.match_literal(':')) {
-            /* It has a value attached. */
-            string category = expect_feature_name(c);
-            float value = info.mutable_categorical()->parse_or_add(category);
-            features.add(feature, value);
+}
+
+/** Parse the value list of a feature.  This follows the same rules as the
+    parser always has for categorical and non-categorical features, but
+    records each value rather than interpreting it. */
+void parse_values(Parse_Context & c, Raw_Chunk & chunk, int feature,
+                  const std::string & name)
+{
+    if (chunk.known_categorical[feature]) {
+        if (!c || *c != ':') {
+            /* A categorical feature can't have a missing label. */
+            c.exception("categorical feature " + name + " missing value");
         }
         
-        /* Allow further values to be specified. */
-        while (c && c.match_literal(',')) {
-            string category = expect_feature_name(c);
-            float value = info.mutable_categorical()->parse_or_add(category);
-            features.add(feature, value);
-        }
+        while (c && (c.match_literal(':') || c.match_literal(',')))
+            chunk.add_category(feature, expect_feature_name(c));
+
+        return;
+    }
+    
+    if (c && *c == ':') {
+        /* It has a value (or a list of values) attached. */
+        do {
+            ++c;  // skip the ':' or ','
+            const char * begin = chunk.start + c.get_offset();
+            float value;
+            if (c.match_float(value))
+                chunk.add_value(feature, Raw_Value::NUMBER, value, begin);
+            else chunk.add_category(feature, expect_feature_name(c));
+        } while (c && *c == ',');
+    }
+    else if (!c || *c == '\n' || isspace(*c)) {
+        /* Feature with defaulted value */
+        chunk.add_value(feature, Raw_Value::DEFAULTED);
     }
 }
 
-namespace {
-
-bool match_label(Parse_Context & c, Mutable_Feature_Set & features,
-                 Sparse_Feature_Space & feature_space)
+void parse_chunk(Raw_Chunk & chunk,
+                 const Sparse_Feature_Space & feature_space,
+                 const std::hash_map<std::string, int> & global_lookup,
+                 const std::vector<Mutable_Feature_Info> & global_info)
 {
-    /* If the first part is numeric and doesn't include a ":", we assume that
-       it's a label.  This is for compatibility with old-format files.
-
-       The new files will have LABEL:xxx, so this will not be necessary.
-    */
-    float val;
-    if (c.match_float(val) && isspace(*c)) {
-        features.add(feature_space.make_feature("LABEL"), val);
-        return true;
+    Parse_Context c(chunk.filename, chunk.start, chunk.finish);
+
+    int label_feature = -1;
+
+    while (c) {
+        size_t first_value = chunk.values.size();
+
+        try {
+            c.skip_whitespace();
+            if (c.match_eol()) continue;   // skip blank lines
+            if (*c == '#') {
+                c.skip_line();  // skip comments
+                continue;
+            }
+            
+            /* If the first part is numeric and doesn't include a ":", we
+               assume that it's a label with the implicit feature name
+               "LABEL".  This is for compatibility with old-format files.
+               
+               The new files will have LABEL:xxx, so this will not be
+               necessary.
+            */
+            float val;
+            if (c.match_float(val) && isspace(*c)) {
+                if (label_feature == -1)
+                    label_feature = chunk.intern("LABEL", feature_space,
+                                                 global_lookup, global_info);
+                chunk.add_value(label_feature, Raw_Value::LABEL, val);
+                c.skip_whitespace();
+            }
+            
+            while (!c.match_eol()) {
+                if (*c == '#') {
+                    // skip comments after the data
+                    c.skip_line();
+                    break;
+                }
+                
+                string name = expect_feature_name(c);
+                int feature = chunk.intern(name, feature_space,
+                                           global_lookup, global_info);
+                parse_values(c, chunk, feature, name);
+                c.skip_whitespace();
+            }
+        }
+        catch (const Exception & exc) {
+            cerr << "warning: " << exc.what() << ": skipping line"
+                 << endl;
+            c.skip_line();
+        }
+
+        chunk.lines.push_back(Raw_Line(first_value, chunk.values.size()));
     }
-    return false;
 }
 
 } // file scope
@@ -338,71 +494,129 @@ init(const std::vector<std::string> & filenames,
     Training_Data::init(feature_space);
     sparse_fs = feature_space;
 
-    /* Did we guess wrongly about which are categorical?  If so, we need to
-       reparse the array.  We keep on going until we are right about which
-       are categorical. */
-    bool guessed_wrong = false;
+    clear();
+
+    /* Split the files up into chunks of lines.  The files stay mapped
+       until we have finished with the raw values, which point into them. */
+    vector<File_Read_Buffer> files(filenames.size());
+    vector<Raw_Chunk> chunks;
+
+    /* Enough chunks to balance the load, but not so many that each one has
+       only a few lines. */
+    enum { MIN_CHUNK_SIZE = 1024 * 1024 };
     
-    /* Keep on going until we get all the categorical values correct. */
-    do {
-        guessed_wrong = false;
+    for (unsigned i = 0;  i < filenames.size();  ++i) {
+        files[i].open(filenames[i]);
 
-        clear();
+        Parse_Context c(filenames[i], files[i].start(), files[i].end());
+        
+        /* Skip over the header. */
+        c.skip_line();
 
-        for (unsigned i = 0;  i < filenames.size();  ++i) {
-            string filename = filenames[i];
-            //cerr << "loading data from " << filename << endl;
-            /* We load the training data from the file. */
-            File_Read_Buffer file(filename);
-            
-            Parse_Context c(filename, file.start(), file.end());
-            
-            /* Skip over the header. */
-            c.skip_line();
-            
-            while (c) {
+        const char * start = files[i].start() + c.get_offset();
+        size_t length = files[i].end() - start;
+
+        int nchunks = std::max<int>(1, std::min<size_t>
+                                    (num_threads() * 4,
+                                     length / MIN_CHUNK_SIZE));
+
+        split_lines(files[i], start, nchunks, filenames[i], chunks);
+    }
+
+    /* 1.  Parse all of the chunks in parallel. */
+    auto parseChunk = [&] (int i)
+        {
+            parse_chunk(chunks[i], *feature_space,
+                        feature_space->string_lookup,
+                        feature_space->info_array);
+        };
+
+    run_in_parallel(0, chunks.size(), parseChunk);
+
+    /* 2.  Merge the chunks in order.  First, give each feature its number
+       and find out which of them are categorical. */
+    for (unsigned i = 0;  i < chunks.size();  ++i) {
+        Raw_Chunk & chunk = chunks[i];
+        chunk.features.resize(chunk.names.size());
+        for (unsigned j = 0;  j < chunk.names.size();  ++j)
+            chunk.features[j] = feature_space->make_feature(chunk.names[j]);
+    }
+
+    vector<char> categorical(feature_space->info_array.size());
+    for (unsigned i = 0;  i < categorical.size();  ++i)
+        categorical[i] = !!feature_space->info_array[i].categorical();
+
+    for (unsigned i = 0;  i < chunks.size();  ++i) {
+        const Raw_Chunk & chunk = chunks[i];
+        for (unsigned j = 0;  j < chunk.values.size();  ++j) {
+            const Raw_Value & v = chunk.values[j];
+            if (v.kind != Raw_Value::CATEGORY) continue;
+            int num = chunk.features[v.feature].type();
+            if (categorical[num]) continue;
+            categorical[num] = true;
+            feature_space->info_array[num].make_categorical();
+        }
+    }
+
+    /* Now number the categories, in the order that they appear. */
+    for (unsigned i = 0;  i < chunks.size();  ++i) {
+        Raw_Chunk & chunk = chunks[i];
+        for (unsigned j = 0;  j < chunk.values.size();  ++j) {
+            Raw_Value & v = chunk.values[j];
+            if (v.kind == Raw_Value::LABEL || v.kind == Raw_Value::DEFAULTED)
+                continue;
+            int num = chunk.features[v.feature].type();
+            if (!categorical[num]) continue;
+            v.value = feature_space->info_array[num].mutable_categorical()
+                ->parse_or_add(chunk.category_name(v));
+        }
+    }
+
+    /* 3.  Build the feature sets in parallel. */
+    vector<size_t> first_example(chunks.size() + 1);
+    for (unsigned i = 0;  i < chunks.size();  ++i)
+        first_example[i + 1] = first_example[i] + chunks[i].lines.size();
+
+    vector<std::shared_ptr<Mutable_Feature_Set> >
+        examples(first_example.back());
+
+    auto buildChunk = [&] (int i)
+        {
+            const Raw_Chunk & chunk = chunks[i];
+
+            for (unsigned l = 0;  l < chunk.lines.size();  ++l) {
+                const Raw_Line & line = chunk.lines[l];
                 std::shared_ptr<Mutable_Feature_Set>
                     features(new Mutable_Feature_Set());
-                
-                try {
-                    c.skip_whitespace();
-                    if (c.match_eol()) continue;   // skip blank lines
-                    if (*c == '#') {
-                        c.skip_line();  // skip comments
-                        continue;
-                    }
-                    
-                    /* Allow a label to be specified, with the implicit feature
-                       name "LABEL", in the first position. */
-                    if (match_label(c, *features, *feature_space))
-                        c.skip_whitespace();
-                    
-                    while (!c.match_eol()) {
-                        if (*c == '#') {
-                            // skip comments after the data
-                            c.skip_line();
-                            break;
-                        }
-                        else {
-                            expect_feature(c, *features, *feature_space,
-                                           guessed_wrong);
-                            c.skip_whitespace();
-                        }
+                features->reserve(line.end - line.begin);
+
+                for (unsigned j = line.begin;  j < line.end;  ++j) {
+                    const Raw_Value & v = chunk.values[j];
+                    const Feature & feature = chunk.features[v.feature];
+
+                    if (v.kind == Raw_Value::DEFAULTED
+                        && categorical[feature.type()]) {
+                        /* As if we had known it was categorical when we
+                           parsed the line: it's an error, and the rest of
+                           the line is skipped. */
+                        cerr << "warning: " << chunk.filename
+                             << ": categorical feature "
+                             << chunk.names[v.feature]
+                             << " missing value: skipping line" << endl;
+                        break;
                     }
-                }
-                catch (const Exception & exc) {
-                    cerr << "warning: " << exc.what() << ": skipping line"
-                         << endl;
-                    c.skip_line();
+
+                    features->add(feature, v.value);
                 }
 
-                //cerr << "features are " << feature_space->print(*features) << endl;
-                
-                add_example(features);
+                examples[first_example[i] + l] = features;
             }
-        }
+        };
+
+    run_in_parallel(0, chunks.size(), buildChunk);
 
-    } while (guessed_wrong);
+    for (unsigned i = 0;  i < examples.size();  ++i)
+        add_example(examples[i]);
 }
 
 void Sparse_Training_Data::
@@ -160,10 +160,6 @@ public:
     virtual Sparse_Training_Data * make_type() const;
 
 private:
-    void expect_feature(Parse_Context & c, Mutable_Feature_Set & features,
-                        Sparse_Feature_Space & feature_space,
-                        bool & guessed_wrong);
-
     std::shared_ptr<Sparse_Feature_Space> sparse_fs;
 };
 
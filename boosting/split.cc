@@ -61,11 +61,10 @@ void
 Split::
 optimize(const Optimization_Info & info)
 {
-    map<Feature, int>::const_iterator it
-        = info.feature_to_optimized_index.find(feature_);
-    if (it == info.feature_to_optimized_index.end())
+    int idx = info.find_optimized_index(feature_);
+    if (idx == -1)
         throw Exception("Split::optimize(): feature not found");
-    idx_ = it->second;
+    idx_ = idx;
     opt_ = true;
 }
 
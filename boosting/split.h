@@ -183,6 +183,15 @@ public:
     float split_val() const { return split_val_; }
     Op op() const { return (Op)op_; }
 
+    /** Index of our feature in the dense feature vector, once we have been
+        optimized. */
+    int optimized_index() const
+    {
+        if (!opt_)
+            throw Exception("Split::optimized_index(): not optimized");
+        return idx_;
+    }
+
     std::string print(const Feature_Space & fs, int branch = true) const;
 
     void serialize(DB::Store_Writer & store,
@@ -63,7 +63,7 @@ public:
     /** Apply and return a distribution */
     Label_Dist apply(const Split::Weights & weights) const
     {
-        Label_Dist result;
+        Label_Dist result(pred_false.size());
         apply(result, weights);
         return result;
     }
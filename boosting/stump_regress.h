@@ -308,6 +308,235 @@ struct C_regress {
 };
 
 
+/*****************************************************************************/
+/* W ARRAY (MULTIPLE TARGETS)                                                */
+/*****************************************************************************/
+
+/** W array for regression of several targets at once.  The variance of all
+    of the targets is accumulated in the same pass over the index.
+
+    As the stump trainer only knows about a single predicted feature, the
+    targets come in through the weights array instead: the row for each
+    example is its weight followed by the value of each of its targets, and
+    the number of targets is passed as the advance.  Since the trainer
+    constructs us from the label count of the predicted feature (which is
+    always one for a regression), the number of targets is only known once
+    the first example has been added.
+
+    Targets can be weighted in the variance by scaling their values by the
+    square root of the weight.
+*/
+
+struct W_regress_multi {
+    W_regress_multi(size_t nl = 0)
+        : nt(0)
+    {
+        for (unsigned i = 0;  i < 3;  ++i)
+            sqr[i] = wt[i] = 0.0;
+    }
+
+    double operator () (int, int, int) const { return 0.0; }
+
+    void swap(W_regress_multi & other)
+    {
+        std::swap(nt, other.nt);
+        dist.swap(other.dist);
+        for (unsigned i = 0;  i < 3;  ++i) {
+            std::swap(sqr[i], other.sqr[i]);
+            std::swap(wt[i], other.wt[i]);
+        }
+    }
+
+    std::string print() const
+    {
+        std::string result = "W_regress_multi: wt     wx^2   z\n";
+        const char * names[3] = { "FALSE:  ", "TRUE:   ", "MISSING:" };
+        for (unsigned i = 0;  i < 3;  ++i) {
+            result += format("%s  %8.5f  %8.5f %8.5f  wx", names[i], wt[i],
+                             sqr[i], z(i));
+            for (unsigned t = 0;  t < nt;  ++t)
+                result += format(" %8.5f", dist[i * nt + t]);
+            result += "\n";
+        }
+        return result;
+    }
+
+    /** The number of targets.  This is what goes into the constructor of
+        the empty W arrays for the buckets. */
+    size_t nl() const { return nt; }
+
+    /** Sum of squared errors around the mean of the bucket, over all of
+        the targets. */
+    double z(int bucket) const
+    {
+        if (wt[bucket] <= 1e-20) return 0.0;
+        const double * d = &dist[bucket * nt];
+        double total = 0.0;
+        for (unsigned t = 0;  t < nt;  ++t)
+            total += d[t] * d[t];
+        return sqr[bucket] - total / wt[bucket];
+    }
+
+    template<class Iterator>
+    void add(Label correct_label, int bucket, Iterator it, int advance)
+    {
+        add(correct_label, bucket, 1.0, it, advance);
+    }
+
+    /** Add the example whose row in the weights array starts at it to the
+        given bucket.  The label is ignored, as the targets are in the
+        row. */
+    template<class Iterator>
+    void add(Label correct_label, int bucket, float weight,
+             Iterator it, int advance)
+    {
+        accum(bucket, 1.0, weight, it, advance);
+    }
+
+    template<class Iterator>
+    void transfer(Label correct_label, int from, int to,
+                  float weight, Iterator it, int advance)
+    {
+        accum(from, -1.0, weight, it, advance);
+        accum(to, 1.0, weight, it, advance);
+    }
+
+    /** Transfer the contents of the true bucket of w from our "from" bucket
+        to our "to" bucket.  See W_regress::transfer(). */
+    void transfer(int from, int to, const W_regress_multi & w)
+    {
+        if (w.nt == 0) return;  // nothing was ever added to it
+        size_targets(w.nt);
+
+        const double * d = &w.dist[true * nt];
+        double * df = &dist[from * nt];
+        double * dt = &dist[to * nt];
+        for (unsigned t = 0;  t < nt;  ++t) {
+            df[t] -= d[t];
+            dt[t] += d[t];
+        }
+        sqr[from] -= w.sqr[true];
+        sqr[to] += w.sqr[true];
+        wt[from] -= w.wt[true];
+        wt[to] += w.wt[true];
+    }
+
+    /** Compensate for rounding errors in the given bucket. */
+    void clip(int bucket)
+    {
+        sqr[bucket] = std::max(sqr[bucket], 0.0);
+        wt[bucket] = std::max(wt[bucket], 0.0);
+
+        if (wt[bucket] == 0.0 || sqr[bucket] == 0.0) {
+            wt[bucket] = sqr[bucket] = 0.0;
+            std::fill(dist.begin() + bucket * nt,
+                      dist.begin() + (bucket + 1) * nt, 0.0);
+        }
+    }
+
+    void swap_buckets(int b1, int b2)
+    {
+        std::swap_ranges(dist.begin() + b1 * nt, dist.begin() + (b1 + 1) * nt,
+                         dist.begin() + b2 * nt);
+        std::swap(sqr[b1], sqr[b2]);
+        std::swap(wt[b1],  wt[b2]);
+    }
+
+    size_t nt;                  ///< Number of targets
+    std::vector<double> dist;   ///< Sum of value * weight; bucket x target
+    double sqr[3];              ///< Sum of weight * value^2 over targets
+    double wt[3];               ///< Sum of weight
+
+private:
+    void size_targets(size_t num_targets)
+    {
+        if (JML_LIKELY(num_targets == nt)) return;
+        if (nt != 0)
+            throw Exception("W_regress_multi: number of targets changed");
+        nt = num_targets;
+        dist.resize(3 * nt, 0.0);
+    }
+
+    template<class Iterator>
+    void accum(int bucket, double sign, float weight, Iterator it,
+               int num_targets)
+    {
+        size_targets(num_targets);
+
+        float w = *it * weight;
+        if (w < 0.0)
+            throw Exception("negative weight");
+
+        double * d = &dist[bucket * nt];
+        double ffw = 0.0;
+        ++it;
+        for (unsigned t = 0;  t < nt;  ++t, ++it) {
+            float fw = *it * w;
+            d[t] += sign * fw;
+            ffw += *it * fw;
+        }
+        sqr[bucket] += sign * ffw;
+        wt[bucket] += sign * w;
+    }
+};
+
+
+/*****************************************************************************/
+/* Z FORMULA (MULTIPLE TARGETS)                                              */
+/*****************************************************************************/
+
+/** The Z score for several targets is the sum over the targets of the
+    squared error around the mean of each bucket, so that minimizing it
+    maximizes the total variance reduction.
+*/
+
+struct Z_regress_multi {
+    static constexpr double worst   = 1e100;  // worst possible Z value
+    static constexpr double none    = -1.0;  // flag to indicate couldn't calculate
+    static constexpr double perfect = 0.0;  // best possible Z value
+
+    static bool equal(double z1, double z2)
+    {
+        return z1 == z2;
+    }
+
+    static bool better(double z1, double z2)
+    {
+        return z1 != none && z1 < z2;
+    }
+
+    template<class W>
+    double missing(const W & w, bool optional) const
+    {
+        return w.z(MISSING);
+    }
+
+    template<class W>
+    double non_missing(const W & w, double missing) const
+    {
+        return missing + w.z(false) + w.z(true);
+    }
+
+    template<class W>
+    double non_missing_presence(const W & w, double missing) const
+    {
+        return non_missing(w, missing);
+    }
+
+    template<class W>
+    double operator () (const W & w) const
+    {
+        return non_missing(w, missing(w, false));
+    }
+
+    template<class W>
+    bool can_beat(const W & w, double missing, double z_best) const
+    {
+        return missing <= (z_best * 1.0001);
+    }
+};
+
+
 } // namespace ML
 
 
@@ -20,6 +20,7 @@
 #include "jml/utils/pair_utils.h"
 #include "stump.h"
 #include "stump_training.h"
+#include "weighted_training.h"
 #include "training_index.h"
 #include "jml/utils/guard.h"
 #include <boost/bind.hpp>
@@ -43,15 +44,21 @@ inline bool z_equal(double z1, double z2, double tolerance = 1e-3)
 }
 
 /** Very lightweight array that calculates its offsets much more easily than a
-    multi array.  Can speed up some code by four times. */
+    multi array.  Can speed up some code by four times.  The stride is the
+    distance between examples and the advance between labels, which allows
+    for both example-major and label-major weights. */
 template<typename T>
 struct LW_Array {
     template<typename T2>
     LW_Array(const boost::multi_array<T2, 2> & array)
-        : base(array.data()), stride(array.shape()[1]) {}
+        : base(array.data()), stride(array.strides()[0]),
+          advance(array.shape()[1] == 1 ? 0 : array.strides()[1])
+    {
+    }
                                      
     T * base;
     size_t stride;
+    int advance;
     
     JML_ALWAYS_INLINE T * operator [] (size_t i) const { return base + i * stride; }
 };
@@ -142,13 +149,13 @@ struct LW_Array;
 */
 JML_ALWAYS_INLINE int get_advance(const boost::multi_array<float, 2> & weights)
 {
-    return (weights.shape()[1] == 1 ? 0 : 1);
+    return label_advance(weights);
 }
 
 template<class T>
 JML_ALWAYS_INLINE int get_advance(const LW_Array<T> & weights)
 {
-    return (weights.stride == 1 ? 0 : 1);
+    return weights.advance;
 }
 
 /** When the weights are like this, it's always regression or one
@@ -164,6 +171,87 @@ JML_ALWAYS_INLINE int get_advance(const std::vector<const float *> & weights)
     return 1;  // assume not binsym
 }
 
+/** Are the weights for each label contiguous over the examples?  Only
+    weights matrices can be. */
+template<class Weights>
+JML_ALWAYS_INLINE bool is_label_major(const Weights & weights)
+{
+    return false;
+}
+
+JML_ALWAYS_INLINE bool
+is_label_major(const boost::multi_array<float, 2> & weights)
+{
+    return weights_layout(weights) == WL_LABEL_MAJOR;
+}
+
+template<class T>
+JML_ALWAYS_INLINE bool is_label_major(const LW_Array<T> & weights)
+{
+    return weights.stride == 1 && weights.advance > 1;
+}
+
+/** Accumulate label-major weights into the MISSING bucket of w, one label
+    at a time so that the inner loop runs along contiguous memory.  Returns
+    false if the W type doesn't keep its weights by label, in which case
+    the caller needs to accumulate them example by example.
+*/
+template<class W, class Weights, class ExampleWeights>
+bool add_label_major(W & w, const std::vector<Label> & labels,
+                     const ExampleWeights & ex_weights,
+                     const Weights & weights, int advance)
+{
+    return false;
+}
+
+template<class W, class Weights, class ExampleWeights>
+void add_label_major_impl(W & w, const std::vector<Label> & labels,
+                          const ExampleWeights & ex_weights,
+                          const Weights & weights, int advance)
+{
+    size_t nx = labels.size(), nl = w.nl();
+    const float * base = &weights[0][0];
+
+    /* The weight of the correct label of each example goes to the correct
+       bucket, and is found in one pass over the examples. */
+    double correct[nl];
+    std::fill(correct, correct + nl, 0.0);
+    for (unsigned x = 0;  x < nx;  ++x) {
+        int l = labels[x];
+        correct[l] += ex_weights[x] * base[l * advance + x];
+    }
+
+    for (unsigned l = 0;  l < nl;  ++l) {
+        const float * column = base + l * advance;
+        double total = 0.0;
+        for (unsigned x = 0;  x < nx;  ++x)
+            total += ex_weights[x] * column[x];
+
+        w(l, MISSING, true) += correct[l];
+        w(l, MISSING, false) += total - correct[l];
+    }
+}
+
+template<class Float, class Weights, class ExampleWeights>
+bool add_label_major(W_normalT<Float> & w, const std::vector<Label> & labels,
+                     const ExampleWeights & ex_weights,
+                     const Weights & weights, int advance)
+{
+    add_label_major_impl(w, labels, ex_weights, weights, advance);
+    return true;
+}
+
+template<class Float> struct W_multi;
+
+template<class Float, class Weights, class ExampleWeights>
+bool add_label_major(W_multi<Float> & w, const std::vector<Label> & labels,
+                     const ExampleWeights & ex_weights,
+                     const Weights & weights, int advance)
+{
+    add_label_major_impl(w, labels, ex_weights, weights, advance);
+    return true;
+}
+
 template<class W, class Z, class Tracer=No_Trace>
 struct Stump_Trainer {
     Stump_Trainer() {}
@@ -430,7 +518,7 @@ struct Stump_Trainer {
         
         for (unsigned i = 0;  i < features.size();  ++i) {
             float z = test(features[i], data, predicted, weights, in_class,
-                           default_w, results);
+                           default_w, results, advance);
             //cerr << " feat " << features[i] << " z " << z << endl;
             if (z != Z::none) feature_scores.push_back(std::make_pair(i, z));
         }
@@ -558,6 +646,10 @@ struct Stump_Trainer {
         W result(nl);
 
         const std::vector<Label> & labels = data.index().labels(predicted);
+
+        if (is_label_major(weights)
+            && add_label_major(result, labels, ex_weights, weights, advance))
+            return result;
         
         for (unsigned i = 0;  i < data.example_count();  ++i) {
             if (ex_weights[i] == 0.0) continue;
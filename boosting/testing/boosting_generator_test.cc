@@ -0,0 +1,388 @@
+/* boosting_generator_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the models produced by the boosting generators and of their
+   early stopping.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/boosted_stumps_generator.h"
+#include "jml/boosting/boosting_generator.h"
+#include "jml/boosting/stump_generator.h"
+#include "jml/boosting/committee.h"
+#include "jml/boosting/thread_context.h"
+#include "jml/utils/configuration.h"
+#include "dense_testing.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace ML;
+using namespace std;
+
+vector<Feature> features = { Feature(1), Feature(2), Feature(3), Feature(4) };
+
+BOOST_AUTO_TEST_CASE( test_boosted_stumps_predict )
+{
+    unsigned nl = 3;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space(categorical_variables(), nl);
+    std::shared_ptr<Dense_Training_Data> data
+        = make_dense_data(fs, 1000, 1, categorical_rows(nl));
+    distribution<float> ex_weights(data->example_count(), 1.0);
+
+    Boosted_Stumps_Generator generator;
+    generator.init(fs, Feature(0));
+    generator.min_iter = 0;
+    generator.max_iter = 5;
+    generator.verbosity = 0;
+
+    Thread_Context context;
+    Boosted_Stumps stumps
+        = generator.generate_stumps(context, *data, *data, ex_weights,
+                                    ex_weights, features);
+    BOOST_CHECK(stumps.stumps.size() > 0);
+
+    /* Predict through the Feature_Set path, which goes via
+       Stump::Action::apply(), and check that it's consistent with the
+       per-label predict and better than chance. */
+    size_t correct = 0;
+    for (unsigned x = 0;  x < data->example_count();  ++x) {
+        Label_Dist dist = stumps.predict((*data)[x]);
+        BOOST_REQUIRE_EQUAL(dist.size(), nl);
+        for (unsigned l = 0;  l < nl;  ++l)
+            BOOST_CHECK_CLOSE(dist[l], stumps.predict(l, (*data)[x]), 0.001);
+
+        int label = (*data)[x][Feature(0)];
+        correct += (dist.max() == dist[label]);
+    }
+
+    BOOST_CHECK_GT(correct, data->example_count() / nl);
+}
+
+/* Stump generator that counts how many times boosting asked it for a weak
+   learner. */
+struct Counting_Stump_Generator : public Stump_Generator {
+    Counting_Stump_Generator() : calls(0) {}
+
+    using Stump_Generator::generate;
+
+    virtual std::shared_ptr<Classifier_Impl>
+    generate(Thread_Context & context,
+             const Training_Data & training_data,
+             const boost::multi_array<float, 2> & weights,
+             const std::vector<Feature> & features,
+             float & Z,
+             int recursion = 0) const
+    {
+        ++calls;
+        return Stump_Generator::generate(context, training_data, weights,
+                                         features, Z, recursion);
+    }
+
+    mutable int calls;
+};
+
+BOOST_AUTO_TEST_CASE( test_boosting_short_circuit )
+{
+    unsigned nl = 2;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space(categorical_variables(), nl);
+    std::shared_ptr<Dense_Training_Data> training
+        = make_dense_data(fs, 1000, 1, categorical_rows(nl));
+    std::shared_ptr<Dense_Training_Data> validation
+        = make_dense_data(fs, 500, 2, categorical_rows(nl));
+    distribution<float> training_weights(training->example_count(), 1.0);
+    distribution<float> validation_weights(validation->example_count(), 1.0);
+
+    std::shared_ptr<Counting_Stump_Generator>
+        weak_learner(new Counting_Stump_Generator());
+
+    Boosting_Generator generator;
+    generator.weak_learner = weak_learner;
+    generator.init(fs, Feature(0));
+    generator.min_iter = 0;
+    generator.max_iter = 200;
+    generator.verbosity = 0;
+
+    Thread_Context context;
+
+    /* Without a window, every iteration is run. */
+    generator.short_circuit_window = 0;
+    generator.generate(context, *training, *validation, training_weights,
+                       validation_weights, features, 0);
+    BOOST_CHECK_EQUAL(weak_learner->calls, generator.max_iter);
+
+    /* With one, training stops once the validation accuracy hasn't improved
+       for that many iterations after the best one, which the committee
+       finishes with. */
+    weak_learner->calls = 0;
+    generator.short_circuit_window = 5;
+    std::shared_ptr<Classifier_Impl> result
+        = generator.generate(context, *training, *validation,
+                             training_weights, validation_weights,
+                             features, 0);
+
+    const Committee & committee = dynamic_cast<const Committee &>(*result);
+    int best_iter = committee.classifiers.size() - 1;
+    BOOST_CHECK_LT(weak_learner->calls, generator.max_iter);
+    BOOST_CHECK_EQUAL(weak_learner->calls,
+                      best_iter + generator.short_circuit_window + 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_boosting_stats )
+{
+    /* Four examples labelled 0, 1, 1, 0. */
+    int labels[4] = { 0, 1, 1, 0 };
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space({ "LABEL", "a" }, 2);
+    int next = 0;
+    std::shared_ptr<Dense_Training_Data> data
+        = make_dense_data(fs, 4, 1, [&] (float * row, RNG &)
+                          {
+                              row[0] = labels[next];
+                              row[1] = next++;
+                          });
+
+    /* The scores of label 1, and the same as a binary symmetric problem
+       would keep them, as the scores of label 0. */
+    float label1[4] = { -1.0, 2.0, 0.5, 1.0 };
+    boost::multi_array<float, 2> output(boost::extents[4][2]);
+    boost::multi_array<float, 2> bin_sym_output(boost::extents[4][1]);
+    for (unsigned x = 0;  x < 4;  ++x) {
+        output[x][0] = bin_sym_output[x][0] = -label1[x];
+        output[x][1] = label1[x];
+    }
+
+    /* The margins of the correct labels are 1, 2, 0.5 and -1. */
+    distribution<float> ex_weights(4, 1.0);
+    double exp_loss = (exp(-1.0) + exp(-2.0) + exp(-0.5) + exp(1.0)) / 4;
+    double logistic_loss = (log1p(exp(-1.0)) + log1p(exp(-2.0))
+                            + log1p(exp(-0.5)) + log1p(exp(1.0))) / 4;
+
+    for (auto out: { &output, &bin_sym_output }) {
+        BOOST_CHECK_CLOSE(boosting_loss(*out, *data, Feature(0), ex_weights,
+                                        CF_EXPONENTIAL),
+                          exp_loss, 0.001);
+        BOOST_CHECK_CLOSE(boosting_loss(*out, *data, Feature(0), ex_weights,
+                                        CF_LOGISTIC),
+                          logistic_loss, 0.001);
+
+        /* Three of the four positive/negative pairs are in order for
+           either label. */
+        BOOST_CHECK_CLOSE(boosting_auc(*out, *data, Feature(0), ex_weights),
+                          0.75, 0.001);
+    }
+
+    /* Without the last example, everything is in order. */
+    ex_weights[3] = 0.0;
+    BOOST_CHECK_CLOSE(boosting_loss(output, *data, Feature(0), ex_weights,
+                                    CF_EXPONENTIAL),
+                      (exp(-1.0) + exp(-2.0) + exp(-0.5)) / 3, 0.001);
+    BOOST_CHECK_CLOSE(boosting_auc(output, *data, Feature(0), ex_weights),
+                      1.0, 0.001);
+
+    /* Only what the criterion needs is calculated, and lower losses
+       score higher. */
+    Boosting_Stats stats
+        = boosting_stats(0.5, output, *data, Feature(0), ex_weights,
+                         CF_EXPONENTIAL, SC_LOSS);
+    BOOST_CHECK_EQUAL(stats.accuracy, 0.5);
+    BOOST_CHECK_GT(stats.loss, 0.0);
+    BOOST_CHECK_EQUAL(stats.auc, 0.0);
+    BOOST_CHECK_EQUAL(stats.score(SC_ACCURACY), 0.5);
+    BOOST_CHECK_EQUAL(stats.score(SC_LOSS), -stats.loss);
+}
+
+/* Running scores of the data under the classifiers, as boosting keeps
+   them. */
+boost::multi_array<float, 2>
+running_scores(const std::vector<std::shared_ptr<Classifier_Impl> >
+                   & classifiers,
+               size_t n, const Training_Data & data, unsigned nl)
+{
+    boost::multi_array<float, 2> result
+        (boost::extents[data.example_count()][nl]);
+    for (unsigned i = 0;  i < n;  ++i) {
+        for (unsigned x = 0;  x < data.example_count();  ++x) {
+            Label_Dist dist = classifiers[i]->predict(data[x]);
+            for (unsigned l = 0;  l < nl;  ++l)
+                result[x][l] += dist[l];
+        }
+    }
+    return result;
+}
+
+/* Rows of categorical_rows(nl), labelled with what model predicts for
+   them.  As the model gets all of them right, the accuracy and AUC on them
+   soon stop improving but the loss keeps on going down while the margins
+   of the model grow. */
+Dense_Row_Generator
+labelled_rows(const Classifier_Impl & model, const Dense_Feature_Space & fs,
+              unsigned nl)
+{
+    Dense_Row_Generator generate = categorical_rows(nl);
+    return [=, &model, &fs] (float * row, RNG & rng)
+        {
+            generate(row, rng);
+            vector<float> values(row, row + fs.variable_count());
+            Label_Dist dist = model.predict(*fs.encode(values));
+            row[0] = std::max_element(dist.begin(), dist.end())
+                - dist.begin();
+        };
+}
+
+/* Validation score under the criterion of the scores in output. */
+double validation_score(const boost::multi_array<float, 2> & output,
+                        const Training_Data & data,
+                        const distribution<float> & ex_weights,
+                        Stopping_Criterion criterion)
+{
+    if (criterion == SC_LOSS)
+        return -boosting_loss(output, data, Feature(0), ex_weights,
+                              CF_EXPONENTIAL);
+    return boosting_auc(output, data, Feature(0), ex_weights);
+}
+
+BOOST_AUTO_TEST_CASE( test_boosting_stopping_criterion )
+{
+    unsigned nl = 3;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space(categorical_variables(), nl);
+    std::shared_ptr<Dense_Training_Data> training
+        = make_dense_data(fs, 1000, 1, categorical_rows(nl));
+    distribution<float> training_weights(training->example_count(), 1.0);
+
+    Boosting_Generator generator;
+    generator.weak_learner.reset(new Stump_Generator());
+    generator.init(fs, Feature(0));
+    generator.max_iter = 40;
+    generator.min_iter = generator.max_iter - 1;
+    generator.verbosity = 0;
+
+    /* Everything, to label the validation data and score each prefix of.
+       The validation data only chooses where to stop, so the committees
+       are the same whatever it is. */
+    Thread_Context context;
+    std::shared_ptr<Classifier_Impl> all
+        = generator.generate(context, *training, *training,
+                             training_weights, training_weights,
+                             features, 0);
+    const Committee & all_committee = dynamic_cast<const Committee &>(*all);
+    BOOST_REQUIRE_EQUAL(all_committee.classifiers.size(),
+                        generator.max_iter);
+
+    std::shared_ptr<Dense_Training_Data> validation
+        = make_dense_data(fs, 500, 2, labelled_rows(*all, *fs, nl));
+    distribution<float> validation_weights(validation->example_count(), 1.0);
+
+    for (Stopping_Criterion criterion: { SC_LOSS, SC_AUC }) {
+        BOOST_TEST_CHECKPOINT("criterion " << criterion);
+
+        /* Stop once there has been no improvement for a few iterations. */
+        generator.min_iter = 0;
+        generator.short_circuit_window = 5;
+        generator.stopping_criterion = criterion;
+        Thread_Context context2;
+        std::shared_ptr<Classifier_Impl> best
+            = generator.generate(context2, *training, *validation,
+                                 training_weights, validation_weights,
+                                 features, 0);
+        const Committee & committee = dynamic_cast<const Committee &>(*best);
+        int best_iter = committee.classifiers.size() - 1;
+
+        /* The committee finishes on the best of the iterations that were
+           run. */
+        int run = std::min<int>(best_iter + generator.short_circuit_window + 2,
+                                generator.max_iter);
+        vector<double> scores;
+        for (int i = 0;  i < run;  ++i)
+            scores.push_back(validation_score
+                             (running_scores(all_committee.classifiers, i + 1,
+                                             *validation, nl),
+                              *validation, validation_weights, criterion));
+        double best_score = *std::max_element(scores.begin(), scores.end());
+        BOOST_CHECK_CLOSE(scores[best_iter], best_score, 1e-4);
+
+        /* Stopping on the accuracy or AUC would have kept the first. */
+        if (criterion == SC_LOSS) {
+            BOOST_CHECK_GT(best_iter, 0);
+            BOOST_CHECK_GT(scores[best_iter], scores[0]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_boosted_stumps_stopping_criterion )
+{
+    unsigned nl = 3;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space(categorical_variables(), nl);
+    std::shared_ptr<Dense_Training_Data> training
+        = make_dense_data(fs, 1000, 1, categorical_rows(nl));
+    distribution<float> training_weights(training->example_count(), 1.0);
+
+    Configuration config;
+    config.parse_string("stopping_criterion=loss", "inbuilt config file");
+
+    Boosted_Stumps_Generator generator;
+    generator.configure(config);
+    BOOST_CHECK_EQUAL(generator.stopping_criterion, SC_LOSS);
+    generator.init(fs, Feature(0));
+    unsigned iterations = 40;
+    generator.max_iter = iterations;
+    generator.verbosity = 0;
+
+    Thread_Context context;
+    generator.min_iter = generator.max_iter - 1;
+    Boosted_Stumps all
+        = generator.generate_stumps(context, *training, *training,
+                                    training_weights, training_weights,
+                                    features);
+
+    std::shared_ptr<Dense_Training_Data> validation
+        = make_dense_data(fs, 500, 2, labelled_rows(all, *fs, nl));
+    distribution<float> validation_weights(validation->example_count(), 1.0);
+
+    /* Loss on the validation set of the predictions of model. */
+    auto validation_loss = [&] (const Boosted_Stumps & model)
+        {
+            boost::multi_array<float, 2> output
+                (boost::extents[validation->example_count()][nl]);
+            for (unsigned x = 0;  x < validation->example_count();  ++x) {
+                Label_Dist dist = model.predict((*validation)[x]);
+                for (unsigned l = 0;  l < nl;  ++l)
+                    output[x][l] = dist[l];
+            }
+            return boosting_loss(output, *validation, Feature(0),
+                                 validation_weights, CF_EXPONENTIAL);
+        };
+
+    generator.min_iter = 0;
+    Boosted_Stumps best
+        = generator.generate_stumps(context, *training, *validation,
+                                    training_weights, validation_weights,
+                                    features);
+
+    /* Each number of iterations, by stopping there. */
+    double lowest_loss = INFINITY;
+    for (unsigned n = 1;  n <= iterations;  ++n) {
+        generator.max_iter = n;
+        generator.min_iter = n - 1;
+        Boosted_Stumps prefix
+            = generator.generate_stumps(context, *training, *validation,
+                                        training_weights, validation_weights,
+                                        features);
+        lowest_loss = std::min(lowest_loss, validation_loss(prefix));
+    }
+
+    /* The model that was picked has the lowest loss on the validation set
+       of any number of iterations. */
+    BOOST_CHECK_CLOSE(validation_loss(best), lowest_loss, 1e-4);
+    BOOST_CHECK_LT(validation_loss(best), validation_loss(all));
+}
@@ -0,0 +1,179 @@
+/* boosting_loss_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the vectorized boosting loss functions against the scalar ones,
+   plus a benchmark.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/boosting_core.h"
+#include "jml/arch/tick_counter.h"
+#include "jml/arch/format.h"
+
+using namespace ML;
+using namespace std;
+
+/* Random-ish predictions and weights for nx examples of nl labels.  The
+   weights are kept small, as the logistic loss is badly conditioned for
+   weights near 1 (which don't occur in practice). */
+void make_row_data(int nx, int nl, vector<float> & pred,
+                   vector<float> & weights, vector<int> & corr)
+{
+    pred.resize(nx * nl);
+    weights.resize(nx * nl);
+    corr.resize(nx);
+
+    unsigned seed = 12345;
+    for (unsigned i = 0;  i < nx * nl;  ++i) {
+        seed = seed * 1103515245 + 12345;
+        pred[i] = ((int)((seed >> 8) % 2001) - 1000) / 1000.0;
+        seed = seed * 1103515245 + 12345;
+        weights[i] = ((seed >> 8) % 1000 + 1) / 100000.0;
+    }
+    for (unsigned x = 0;  x < nx;  ++x)
+        corr[x] = (x * 7) % nl;
+}
+
+template<class Loss>
+void check_loss(const Loss & loss, int nl)
+{
+    int nx = 100;
+    vector<float> pred, weights;
+    vector<int> corr;
+    make_row_data(nx, nl, pred, weights, corr);
+
+    vector<float> expected = weights;
+
+    for (unsigned x = 0;  x < nx;  ++x) {
+        float * w = &weights[x * nl];
+        float * e = &expected[x * nl];
+        const float * p = &pred[x * nl];
+
+        float expected_total = 0.0;
+        for (unsigned l = 0;  l < nl;  ++l) {
+            e[l] = loss(l, corr[x], p[l], e[l]);
+            expected_total += e[l];
+        }
+
+        float total = loss.update_row(corr[x], p, w, nl);
+        BOOST_CHECK_CLOSE(total, expected_total, 0.001);
+
+        for (unsigned l = 0;  l < nl;  ++l)
+            BOOST_CHECK_CLOSE(w[l], e[l], 0.001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_boosting_loss_row )
+{
+    for (unsigned nl = 1;  nl <= 18;  ++nl) {
+        BOOST_TEST_CHECKPOINT("nl = " << nl);
+        check_loss(Boosting_Loss(), nl);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_logistic_loss_row )
+{
+    for (unsigned nl = 1;  nl <= 18;  ++nl) {
+        BOOST_TEST_CHECKPOINT("nl = " << nl);
+        check_loss(Logistic_Loss(0.8), nl);
+    }
+}
+
+/* The same as check_loss, but a label at a time over all of the examples,
+   like the updates of label-major weights. */
+template<class Loss>
+void check_loss_column(const Loss & loss, int nx)
+{
+    int nl = 3;
+    vector<float> pred, weights;
+    vector<int> corr;
+    make_row_data(nx, nl, pred, weights, corr);
+
+    vector<Label> labels(corr.begin(), corr.end());
+
+    for (unsigned l = 0;  l < nl;  ++l) {
+        vector<float> p(nx), w(nx), e(nx);
+        float expected_total = 0.0;
+        for (unsigned x = 0;  x < nx;  ++x) {
+            p[x] = pred[x * nl + l];
+            w[x] = weights[x * nl + l];
+            e[x] = loss(l, corr[x], p[x], w[x]);
+            expected_total += e[x];
+        }
+
+        float total = loss.update_column(l, &labels[0], &p[0], &w[0], nx);
+        BOOST_CHECK_CLOSE(total, expected_total, 0.001);
+
+        for (unsigned x = 0;  x < nx;  ++x)
+            BOOST_CHECK_CLOSE(w[x], e[x], 0.001);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_boosting_loss_column )
+{
+    for (unsigned nx = 1;  nx <= 18;  ++nx) {
+        BOOST_TEST_CHECKPOINT("nx = " << nx);
+        check_loss_column(Boosting_Loss(), nx);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_logistic_loss_column )
+{
+    for (unsigned nx = 1;  nx <= 18;  ++nx) {
+        BOOST_TEST_CHECKPOINT("nx = " << nx);
+        check_loss_column(Logistic_Loss(0.8), nx);
+    }
+}
+
+template<class Loss>
+void benchmark_loss(const Loss & loss, const std::string & name, int nl)
+{
+    int nx = 1000000 / nl;
+    vector<float> pred, weights;
+    vector<int> corr;
+    make_row_data(nx, nl, pred, weights, corr);
+    vector<float> weights2 = weights;
+
+    double total = 0.0;
+    uint64_t before = ticks();
+    for (unsigned x = 0;  x < nx;  ++x)
+        for (unsigned l = 0;  l < nl;  ++l) {
+            float & w = weights[x * nl + l];
+            w = loss(l, corr[x], pred[x * nl + l], w);
+            total += w;
+        }
+    double scalar_ticks = ticks() - before;
+
+    double total2 = 0.0;
+    before = ticks();
+    for (unsigned x = 0;  x < nx;  ++x)
+        total2 += loss.update_row(corr[x], &pred[x * nl],
+                                  &weights2[x * nl], nl);
+    double simd_ticks = ticks() - before;
+
+    BOOST_CHECK_CLOSE(total, total2, 0.01);
+
+    cerr << format("%-10s nl = %3d: scalar %8.3fms simd %8.3fms (%5.2fx)",
+                   name.c_str(), nl,
+                   scalar_ticks * seconds_per_tick * 1000.0,
+                   simd_ticks * seconds_per_tick * 1000.0,
+                   scalar_ticks / simd_ticks)
+         << endl;
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_loss_row )
+{
+    benchmark_loss(Boosting_Loss(), "boosting", 2);
+    benchmark_loss(Boosting_Loss(), "boosting", 10);
+    benchmark_loss(Boosting_Loss(), "boosting", 100);
+    benchmark_loss(Logistic_Loss(0.8), "logistic", 2);
+    benchmark_loss(Logistic_Loss(0.8), "logistic", 10);
+    benchmark_loss(Logistic_Loss(0.8), "logistic", 100);
+}
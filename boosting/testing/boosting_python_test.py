@@ -0,0 +1,110 @@
+# boosting_python_test.py
+# Jeremy Barnes, 19 October 2026
+# Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+#
+# Test of scoring NumPy arrays with the boosting python module.
+
+import numpy
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+from os import getenv
+
+# WARNING: security risk; don't do this for anything that might be installed
+sys.path.append(getenv("BIN"))
+
+import boosting
+
+def expect_error(error, fn, *args):
+    try:
+        fn(*args)
+    except error:
+        pass
+    else:
+        assert False, "%s should have been raised" % error.__name__
+
+# The label depends noisily upon a and b; c is noise.
+rng = numpy.random.RandomState(1)
+nx = 1000
+a, b, c = rng.random_sample(nx), rng.random_sample(nx), rng.random_sample(nx)
+label = (0.7 * a + 0.3 * b + 0.2 * rng.random_sample(nx) > 0.6)
+rows = numpy.column_stack((label, a, b, c)).astype(numpy.float32)
+
+tmpdir = tempfile.mkdtemp()
+try:
+    data_file = os.path.join(tmpdir, "data.txt")
+    classifier_file = os.path.join(tmpdir, "classifier.cls")
+
+    numpy.savetxt(data_file, rows, fmt="%g",
+                  header="LABEL:k=BOOLEAN/o=BIASED a b c", comments="")
+
+    subprocess.check_call([os.path.join(getenv("BIN"),
+                                        "classifier_training_tool"),
+                           "-t", "boosted_stumps", "-L", "LABEL", "-p", "3",
+                           "-o", classifier_file, data_file])
+
+    classifier = boosting.load_classifier(classifier_file)
+finally:
+    shutil.rmtree(tmpdir)
+
+assert boosting.label_count(classifier) == 2
+
+# Scoring into a preallocated array gives one score per label
+output = numpy.empty((nx, 2), dtype=numpy.float32)
+assert boosting.predict_batch(classifier, rows, output) is output
+assert numpy.isfinite(output).all()
+assert (boosting.predict_batch(classifier, rows) == output).all()
+
+# Each row scores the same on its own
+for x in range(0, nx, 97):
+    assert (boosting.predict_batch(classifier, rows[x:x + 1]) == output[x]).all()
+
+# Scoring doesn't hold the GIL, so it can run in several threads at once
+outputs = [numpy.empty_like(output) for i in range(4)]
+threads = [threading.Thread(target=boosting.predict_batch,
+                            args=(classifier, rows, out)) for out in outputs]
+for thread in threads:
+    thread.start()
+for thread in threads:
+    thread.join()
+for out in outputs:
+    assert (out == output).all()
+
+# The arrays have to be usable in place
+expect_error(TypeError, boosting.predict_batch, classifier, rows.tolist(),
+             output)
+expect_error(TypeError, boosting.predict_batch, classifier,
+             rows.astype(numpy.float64), output)
+expect_error(ValueError, boosting.predict_batch, classifier, rows[:, 0], output)
+expect_error(ValueError, boosting.predict_batch, classifier,
+             numpy.asfortranarray(rows), output)
+expect_error(ValueError, boosting.predict_batch, classifier, rows[:, 1:],
+             output)
+expect_error(ValueError, boosting.predict_batch, classifier, rows,
+             output[1:])
+readonly = output.copy()
+readonly.setflags(write=False)
+expect_error(ValueError, boosting.predict_batch, classifier, rows, readonly)
+expect_error(TypeError, boosting.predict_batch, rows, rows, output)
+
+# The training data uses the array in place, and keeps it alive
+in_place = rows.copy()
+refs = sys.getrefcount(in_place)
+data = boosting.training_data(in_place, classifier)
+assert sys.getrefcount(in_place) == refs + 1
+del in_place
+
+# It's scored the same way as the array was
+correct = (output.argmax(axis=1) == label).mean()
+accuracy, margin = boosting.accuracy(classifier, data)
+assert abs(accuracy - correct) < 1e-5
+expect_error(TypeError, boosting.accuracy, classifier, rows)
+
+# Nor does it leak a reference when it can't be made
+too_few = rows[:, 1:].copy()
+refs = sys.getrefcount(too_few)
+expect_error(RuntimeError, boosting.training_data, too_few, classifier)
+assert sys.getrefcount(too_few) == refs
@@ -2,12 +2,28 @@ $(eval $(call test,decision_tree_xor_test,boosting utils arch worker_task,boost)
 $(eval $(call test,split_test,boosting,boost))
 $(eval $(call test,decision_tree_multithreaded_test,boosting utils arch worker_task,boost))
 $(eval $(call test,decision_tree_unlimited_depth_test,boosting utils arch worker_task,boost))
+$(eval $(call test,decision_tree_multi_regression_test,boosting utils arch worker_task,boost))
+$(eval $(call test,explain_top_k_test,boosting utils arch worker_task,boost))
+$(eval $(call test,label_major_weights_test,boosting utils arch worker_task,boost))
+$(eval $(call test,training_checkpoint_test,boosting utils arch worker_task,boost))
+$(eval $(call test,boosting_generator_test,boosting utils arch worker_task,boost))
 $(eval $(call test,glz_classifier_test,boosting utils arch worker_task,boost))
 $(eval $(call test,probabilizer_test,boosting utils arch,boost))
 $(eval $(call test,feature_info_test,boosting utils arch,boost))
+$(eval $(call test,compiled_scorer_test,boosting utils arch worker_task,boost))
+$(eval $(call test,feature_set_visitor_test,boosting utils arch,boost))
+$(eval $(call test,dataset_index_parallel_test,boosting utils arch worker_task,boost))
+$(eval $(call test,boosting_loss_test,boosting utils arch,boost))
+$(eval $(call test,sparse_training_data_test,boosting utils arch,boost))
+$(eval $(call test,optimized_predict_test,boosting utils arch,boost))
+$(eval $(call test,predict_batch_test,boosting utils arch worker_task,boost))
+$(eval $(call test,naive_bayes_update_test,boosting utils arch worker_task,boost))
+$(eval $(call test,tree_test,boosting utils arch,boost))
 
 $(eval $(call program,dataset_nan_test,boosting utils arch boosting_tools))
 
+$(eval $(call python_test,boosting_python_test,boosting classifier_training_tool))
+
 ifeq ($(CUDA_ENABLED),1)
 $(eval $(call test,split_cuda_test,boosting_cuda,boost))
 endif # CUDA_ENABLED
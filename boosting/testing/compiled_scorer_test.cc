@@ -0,0 +1,175 @@
+/* compiled_scorer_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the compiled scorer, plus a latency benchmark.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include "jml/boosting/compiled_scorer.h"
+#include "jml/boosting/decision_tree_generator.h"
+#include "jml/boosting/training_data.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/utils/smart_ptr_utils.h"
+#include "jml/utils/vector_utils.h"
+#include "jml/arch/tick_counter.h"
+
+using namespace ML;
+using namespace std;
+
+using boost::unit_test::test_suite;
+
+static const char * config_options = "\
+max_depth=8\n\
+";
+
+int nfv = 2000;
+
+/* Train a decision tree over a classifier feature space of LABEL + 3
+   features, and return the classifier along with a problem feature space
+   that has the features in a different order plus an extra one. */
+static Classifier
+train_classifier(std::shared_ptr<Dense_Feature_Space> & problem_fs)
+{
+    std::shared_ptr<Dense_Feature_Space> fs(new Dense_Feature_Space());
+    fs->add_feature("LABEL", Feature_Info(BOOLEAN, false, true));
+    fs->add_feature("feature1", REAL);
+    fs->add_feature("feature2", REAL);
+    fs->add_feature("feature3", REAL);
+
+    Training_Data data(fs);
+
+    for (unsigned i = 0;  i < nfv;  ++i) {
+        distribution<float> features;
+        features.push_back(i % 3 == 0 || i % 7 == 0);
+        features.push_back(i % 3);
+        features.push_back(i % 7);
+        features.push_back(i % 11);
+        data.add_example(fs->encode(features));
+    }
+
+    Configuration config;
+    config.parse_string(config_options, "inbuilt config file");
+
+    Decision_Tree_Generator generator;
+    generator.configure(config);
+    generator.init(fs, fs->features()[0]);
+
+    distribution<float> training_weights(nfv, 1);
+    vector<Feature> features = fs->features();
+    features.erase(features.begin(), features.begin() + 1);
+
+    Thread_Context context;
+
+    Classifier result(generator.generate(context, data, training_weights,
+                                         features));
+
+    problem_fs.reset(new Dense_Feature_Space());
+    problem_fs->add_feature("feature3", REAL);
+    problem_fs->add_feature("extra", REAL);
+    problem_fs->add_feature("feature1", REAL);
+    problem_fs->add_feature("feature2", REAL);
+
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_compiled_scorer_matches_predict )
+{
+    std::shared_ptr<Dense_Feature_Space> problem_fs;
+    Classifier classifier = train_classifier(problem_fs);
+
+    std::shared_ptr<const Dense_Feature_Space> classifier_fs
+        = classifier.feature_space<Dense_Feature_Space>();
+    Dense_Feature_Space::Mapping mapping;
+    classifier_fs->create_mapping(*problem_fs, mapping);
+
+    Compiled_Scorer scorer(classifier, problem_fs);
+
+    BOOST_CHECK_EQUAL(scorer.input_count(), 4);
+    BOOST_CHECK_EQUAL(scorer.label_count(), classifier.label_count());
+    BOOST_CHECK(scorer.allocation_free());
+
+    Compiled_Scorer::Scratch scratch;
+
+    for (unsigned i = 0;  i < 100;  ++i) {
+        vector<float> input;
+        input.push_back(i % 11);
+        input.push_back(1000.0);
+        input.push_back(i % 3);
+        input.push_back(i % 7);
+
+        Label_Dist expected
+            = classifier.predict(*classifier_fs->encode(input, *problem_fs,
+                                                        mapping));
+
+        float output[scorer.label_count()];
+        scorer.score(&input[0], output);
+
+        float output2[scorer.label_count()];
+        scorer.score(&input[0], output2, scratch);
+
+        for (unsigned l = 0;  l < scorer.label_count();  ++l) {
+            BOOST_CHECK_CLOSE(output[l], expected[l], 0.0001);
+            BOOST_CHECK_EQUAL(output[l], output2[l]);
+            BOOST_CHECK_CLOSE(scorer.score(l, &input[0]), expected[l], 0.0001);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_compiled_scorer_latency )
+{
+    std::shared_ptr<Dense_Feature_Space> problem_fs;
+    Classifier classifier = train_classifier(problem_fs);
+
+    std::shared_ptr<const Dense_Feature_Space> classifier_fs
+        = classifier.feature_space<Dense_Feature_Space>();
+    Dense_Feature_Space::Mapping mapping;
+    classifier_fs->create_mapping(*problem_fs, mapping);
+
+    Compiled_Scorer scorer(classifier, problem_fs);
+
+    int niter = 100000;
+
+    vector<double> compiled_ticks(niter), classic_ticks(niter);
+    float output[scorer.label_count()];
+    vector<float> input(4);
+
+    for (unsigned i = 0;  i < niter;  ++i) {
+        input[0] = i % 11;  input[2] = i % 3;  input[3] = i % 7;
+
+        uint64_t before = ticks();
+        scorer.score(&input[0], output);
+        compiled_ticks[i] = ticks() - before;
+
+        before = ticks();
+        Label_Dist result
+            = classifier.predict(*classifier_fs->encode(input, *problem_fs,
+                                                        mapping));
+        classic_ticks[i] = ticks() - before;
+    }
+
+    std::sort(compiled_ticks.begin(), compiled_ticks.end());
+    std::sort(classic_ticks.begin(), classic_ticks.end());
+
+    double p50c = compiled_ticks[niter / 2], p99c = compiled_ticks[niter * 99 / 100];
+    double p50o = classic_ticks[niter / 2], p99o = classic_ticks[niter * 99 / 100];
+
+    cerr << format("compiled scorer: p50 %8.0f ticks (%6.3fus) "
+                   "p99 %8.0f ticks (%6.3fus)",
+                   p50c, p50c * seconds_per_tick * 1000000.0,
+                   p99c, p99c * seconds_per_tick * 1000000.0)
+         << endl;
+    cerr << format("encode + predict: p50 %8.0f ticks (%6.3fus) "
+                   "p99 %8.0f ticks (%6.3fus)",
+                   p50o, p50o * seconds_per_tick * 1000000.0,
+                   p99o, p99o * seconds_per_tick * 1000000.0)
+         << endl;
+}
@@ -0,0 +1,141 @@
+/* dataset_index_parallel_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test that indexing a dataset in parallel gives the same result as doing
+   it serially.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/training_data.h"
+#include "jml/boosting/training_index.h"
+#include "jml/boosting/training_index_iterators.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_set.h"
+#include "jml/utils/environment.h"
+#include "jml/utils/worker_task.h"
+#include "jml/utils/parallel_sort.h"
+
+namespace ML {
+extern Env_Option<int> NUM_THREADS;
+} // namespace ML
+
+using namespace ML;
+using namespace std;
+
+/* Enough examples for several shards, and enough values to take the
+   parallel path of parallel_sort(). */
+int nx = 70000;
+
+void check_same_dist(const Joint_Index & dist1, const Joint_Index & dist2)
+{
+    BOOST_REQUIRE_EQUAL(dist1.size(), dist2.size());
+    for (unsigned i = 0;  i < dist1.size();  ++i) {
+        if (dist1[i].value() != dist2[i].value()
+            || dist1[i].example() != dist2[i].example()
+            || dist1[i].example_counts() != dist2[i].example_counts()) {
+            BOOST_CHECK_EQUAL(dist1[i].value(), dist2[i].value());
+            BOOST_CHECK_EQUAL(dist1[i].example(), dist2[i].example());
+            BOOST_CHECK_EQUAL(dist1[i].example_counts(),
+                              dist2[i].example_counts());
+            return;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_index_matches_serial )
+{
+    std::shared_ptr<Dense_Feature_Space> fs(new Dense_Feature_Space());
+    fs->add_feature("always", REAL);     // exactly once in each example
+    fs->add_feature("mostly", REAL);     // missing in a few examples
+    fs->add_feature("twice", REAL);      // twice in some examples
+    fs->add_feature("late", REAL);       // only towards the end
+    fs->add_feature("early", REAL);      // only towards the start
+
+    vector<Feature> features = fs->features();
+
+    Training_Data data(fs);
+
+    for (unsigned x = 0;  x < nx;  ++x) {
+        std::shared_ptr<Mutable_Feature_Set>
+            fset(new Mutable_Feature_Set());
+        fset->add(features[0], x % 17);
+        if (x % 1000 != 999)
+            fset->add(features[1], x % 5);
+        fset->add(features[2], x % 7);
+        if (x % 3 == 0)
+            fset->add(features[2], x % 11);
+        if (x >= 40000)
+            fset->add(features[3], 0.5 * (x % 13));
+        if (x < 10000)
+            fset->add(features[4], x % 2);
+        data.add_example(fset);
+    }
+
+    Dataset_Index serial;
+    NUM_THREADS.set(1);
+    serial.init(data);
+
+    /* Force several threads, even on a single CPU machine. */
+    Dataset_Index parallel;
+    NUM_THREADS.set(4);
+    parallel.init(data);
+
+    BOOST_REQUIRE(serial.all_features() == parallel.all_features());
+
+    for (unsigned i = 0;  i < features.size();  ++i) {
+        const Feature & feature = features[i];
+        BOOST_TEST_CHECKPOINT("feature " << i);
+
+        BOOST_CHECK_EQUAL(serial.count(feature), parallel.count(feature));
+        BOOST_CHECK_EQUAL(serial.exactly_one(feature),
+                          parallel.exactly_one(feature));
+        BOOST_CHECK_EQUAL(serial.dense(feature), parallel.dense(feature));
+        BOOST_CHECK_EQUAL(serial.only_one(feature),
+                          parallel.only_one(feature));
+        BOOST_CHECK_EQUAL(serial.integral(feature),
+                          parallel.integral(feature));
+        BOOST_CHECK(serial.range(feature) == parallel.range(feature));
+        BOOST_CHECK(serial.values(feature) == parallel.values(feature));
+
+        const Dataset_Index::Freqs & freqs1 = serial.freqs(feature);
+        const Dataset_Index::Freqs & freqs2 = parallel.freqs(feature);
+        typedef vector<pair<float, float> > Freq_Vec;
+        BOOST_CHECK(Freq_Vec(freqs1.begin(), freqs1.end())
+                    == Freq_Vec(freqs2.begin(), freqs2.end()));
+
+        unsigned contents = IC_VALUE | IC_EXAMPLE | IC_COUNT;
+        check_same_dist(serial.dist(feature, BY_EXAMPLE, contents),
+                        parallel.dist(feature, BY_EXAMPLE, contents));
+        check_same_dist(serial.dist(feature, BY_VALUE, contents),
+                        parallel.dist(feature, BY_VALUE, contents));
+    }
+
+    BOOST_CHECK(serial.exactly_one(features[0]));
+    BOOST_CHECK(!serial.exactly_one(features[1]));
+    BOOST_CHECK(!serial.only_one(features[2]));
+    BOOST_CHECK_EQUAL(serial.count(features[3]), nx - 40000);
+    BOOST_CHECK_EQUAL(serial.count(features[4]), 10000);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_sort )
+{
+    NUM_THREADS.set(4);
+
+    vector<pair<float, unsigned> > vals;
+    for (unsigned i = 0;  i < 200000;  ++i)
+        vals.push_back(make_pair((i * 7919) % 1013, i));
+
+    vector<pair<float, unsigned> > expected = vals;
+    std::sort(expected.begin(), expected.end());
+
+    parallel_sort(vals);
+
+    BOOST_CHECK(vals == expected);
+}
@@ -0,0 +1,185 @@
+/* decision_tree_multi_regression_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of regression trees that predict several targets at once.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "jml/boosting/decision_tree_generator.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/thread_context.h"
+#include "jml/db/persistent.h"
+#include "dense_testing.h"
+
+using namespace ML;
+using namespace ML::DB;
+using namespace std;
+
+/* Variables 0 and 1 are the targets; 2 to 4 the features.  The first
+   target depends upon x1 and the second upon x2; x3 is noise. */
+std::shared_ptr<Dense_Feature_Space> make_feature_space()
+{
+    return make_dense_feature_space({ "y1", "y2", "x1", "x2", "x3" });
+}
+
+std::shared_ptr<Dense_Training_Data>
+make_data(std::shared_ptr<Dense_Feature_Space> fs, size_t nx)
+{
+    auto generate = [] (float * row, RNG & rng)
+        {
+            row[2] = rng.random01();
+            row[3] = rng.random01();
+            row[4] = rng.random01();
+            row[0] = (row[2] > 0.5 ? 1.0 : 0.0);
+            row[1] = (row[3] > 0.3 ? 5.0 : -5.0);
+        };
+
+    return make_dense_data(fs, nx, 1, generate);
+}
+
+vector<Feature> targets = { Feature(0), Feature(1) };
+
+distribution<float> target_weights(float w1, float w2)
+{
+    distribution<float> result(2);
+    result[0] = w1;
+    result[1] = w2;
+    return result;
+}
+
+vector<Feature> features = { Feature(2), Feature(3), Feature(4) };
+
+BOOST_AUTO_TEST_CASE( test_multi_regression )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 1000);
+
+    Decision_Tree_Generator generator;
+    generator.init(fs, Feature(0));
+
+    Thread_Context context;
+    distribution<float> ex_weights(data->example_count(), 1.0);
+
+    Decision_Tree tree
+        = generator.train_weighted_multi(context, *data, targets,
+                                         distribution<float>(), ex_weights,
+                                         features, 4);
+    BOOST_CHECK_EQUAL(tree.label_count(), 2);
+    BOOST_CHECK_EQUAL(tree.predicted(), Feature(0));
+
+    /* Both targets are step functions of one feature, so a couple of levels
+       are enough to predict them both nearly exactly (the split points are
+       found over buckets of values, so they aren't quite exact). */
+    double error[2] = { 0.0, 0.0 };
+    size_t nx = data->example_count();
+    for (unsigned x = 0;  x < nx;  ++x) {
+        const Feature_Set & example = (*data)[x];
+        distribution<float> pred = tree.predict(example);
+        BOOST_REQUIRE_EQUAL(pred.size(), 2);
+        for (unsigned t = 0;  t < 2;  ++t)
+            error[t] += fabs(pred[t] - example[Feature(t)]);
+    }
+
+    BOOST_CHECK_LT(error[0] / nx, 0.01);
+    BOOST_CHECK_LT(error[1] / nx, 0.05);
+
+    /* It survives a round trip through a store with both outputs. */
+    ostringstream stream_out;
+    {
+        Store_Writer store(stream_out);
+        tree.serialize(store);
+    }
+
+    istringstream stream_in(stream_out.str());
+    Store_Reader store(stream_in);
+    Decision_Tree reconstituted;
+    reconstituted.reconstitute(store, fs);
+    BOOST_CHECK_EQUAL(reconstituted.label_count(), 2);
+    BOOST_CHECK_EQUAL(reconstituted.predict((*data)[0]),
+                      tree.predict((*data)[0]));
+}
+
+BOOST_AUTO_TEST_CASE( test_same_as_single_target )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 500);
+
+    Decision_Tree_Generator generator;
+    generator.init(fs, Feature(1));
+
+    Thread_Context context;
+    size_t nx = data->example_count();
+
+    /* The second target's feature splits it imperfectly when it's
+       restricted to one level, which makes for non-trivial leaves. */
+    vector<Feature> noisy = { Feature(2), Feature(4) };
+
+    boost::multi_array<float, 2> weights(boost::extents[nx][1]);
+    std::fill(weights.data(), weights.data() + nx, 1.0);
+    Decision_Tree single
+        = generator.train_weighted(context, *data, weights, noisy, 2);
+
+    Decision_Tree multi
+        = generator.train_weighted_multi(context, *data, { Feature(1) },
+                                         distribution<float>(),
+                                         distribution<float>(nx, 1.0),
+                                         noisy, 2);
+    BOOST_CHECK_EQUAL(multi.label_count(), 1);
+
+    for (unsigned x = 0;  x < nx;  ++x)
+        BOOST_CHECK_CLOSE(multi.predict((*data)[x])[0],
+                          single.predict((*data)[x])[0], 0.01);
+}
+
+BOOST_AUTO_TEST_CASE( test_target_weights )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 1000);
+
+    Decision_Tree_Generator generator;
+    generator.init(fs, Feature(0));
+
+    Thread_Context context;
+    distribution<float> ex_weights(data->example_count(), 1.0);
+
+    /* With a single split, the target with the most weight chooses it. */
+    Decision_Tree tree1
+        = generator.train_weighted_multi(context, *data, targets,
+                                         target_weights(1.0, 0.0),
+                                         ex_weights, features, 1);
+    BOOST_REQUIRE(tree1.tree.root.node());
+    BOOST_CHECK_EQUAL(tree1.tree.root.node()->split.feature(), Feature(2));
+
+    Decision_Tree tree2
+        = generator.train_weighted_multi(context, *data, targets,
+                                         target_weights(0.0, 1.0),
+                                         ex_weights, features, 1);
+    BOOST_REQUIRE(tree2.tree.root.node());
+    BOOST_CHECK_EQUAL(tree2.tree.root.node()->split.feature(), Feature(3));
+
+    /* The targets with no weight are still predicted. */
+    const Feature_Set & example = (*data)[0];
+    BOOST_CHECK_SMALL(tree1.predict(example)[0] - example[Feature(0)],
+                      0.01f);
+
+    /* Through the generator interface. */
+    generator.targets = targets;
+    generator.max_depth = 3;
+    std::shared_ptr<Classifier_Impl> generated
+        = generator.generate(context, *data, *data, ex_weights, ex_weights,
+                             features, 0);
+    BOOST_CHECK_EQUAL(generated->label_count(), 2);
+
+    BOOST_CHECK_THROW(generator.train_weighted_multi
+                      (context, *data, targets,
+                       distribution<float>(1, 1.0), ex_weights, features, 1),
+                      ML::Exception);
+}
@@ -0,0 +1,109 @@
+/* dense_testing.h                                                 -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Synthetic dense datasets for the tests of the classifiers and their
+   generators.
+*/
+
+#ifndef __boosting__dense_testing_h__
+#define __boosting__dense_testing_h__
+
+
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/utils/rng.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace ML {
+
+
+/** Make a dense feature space with the given variables, all of them real,
+    as for regression. */
+inline std::shared_ptr<Dense_Feature_Space>
+make_dense_feature_space(const std::vector<std::string> & names)
+{
+    return std::make_shared<Dense_Feature_Space>(names);
+}
+
+/** Make a dense feature space with the given variables, the first of which
+    is a label described by label_info. */
+inline std::shared_ptr<Dense_Feature_Space>
+make_dense_feature_space(const std::vector<std::string> & names,
+                         const Feature_Info & label_info)
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_dense_feature_space(names);
+    fs->set_info(Feature(0), label_info);
+    return fs;
+}
+
+/** Make a dense feature space with the given variables, the first of which
+    is a categorical label with label_values values. */
+inline std::shared_ptr<Dense_Feature_Space>
+make_dense_feature_space(const std::vector<std::string> & names,
+                         unsigned label_values)
+{
+    std::shared_ptr<Categorical_Info> labels
+        (new Fixed_Categorical_Info(label_values));
+    return make_dense_feature_space(names, Feature_Info(labels));
+}
+
+/** Fills in the variables of one example, drawing from rng. */
+typedef std::function<void (float * row, RNG & rng)> Dense_Row_Generator;
+
+/** Make nx examples over the variables of fs, each filled in by calling
+    generate() with a random number generator seeded with seed.  The
+    examples are stored one after the other in a single block, which the
+    returned training data uses in place and keeps alive.
+*/
+inline std::shared_ptr<Dense_Training_Data>
+make_dense_data(std::shared_ptr<Dense_Feature_Space> fs, size_t nx,
+                int seed, const Dense_Row_Generator & generate)
+{
+    size_t nv = fs->variable_count();
+    std::shared_ptr<std::vector<float> >
+        values(new std::vector<float>(nx * nv));
+    RNG rng(seed);
+    for (unsigned x = 0;  x < nx;  ++x)
+        generate(&(*values)[x * nv], rng);
+
+    return std::make_shared<Dense_Training_Data>
+        (&(*values)[0], nx, nv, fs, values);
+}
+
+
+/** Variables for categorical_rows(). */
+inline std::vector<std::string> categorical_variables()
+{
+    return { "LABEL", "a", "b", "c", "d" };
+}
+
+/** Generator for the variables LABEL, a, b, c, d, where the label has nl
+    values and depends noisily upon a and b; c is noise that is sometimes
+    missing and d is mostly noise.
+*/
+inline Dense_Row_Generator categorical_rows(unsigned nl)
+{
+    return [=] (float * row, RNG & rng)
+        {
+            float a = rng.random01(), b = rng.random01(), c = rng.random01();
+            row[1] = a;
+            row[2] = b;
+            row[3] = (c < 0.1 ? std::numeric_limits<float>::quiet_NaN() : c);
+            row[4] = rng.random01();
+            int label = (int)((a * 0.6 + b * 0.2 + 0.2 * row[4]) * nl);
+            row[0] = std::min<int>(label, nl - 1);
+        };
+}
+
+
+} // namespace ML
+
+
+#endif /* __boosting__dense_testing_h__ */
@@ -0,0 +1,335 @@
+/* explain_top_k_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the top-k explanation of dense rows.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <set>
+#include <iostream>
+
+#include "jml/boosting/decision_tree_generator.h"
+#include "jml/boosting/boosted_stumps.h"
+#include "jml/boosting/committee.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/thread_context.h"
+#include "dense_testing.h"
+
+using namespace ML;
+using namespace std;
+
+/* Variable 0 is the label; the rest are features.  The label depends upon
+   x1 and x2 and interactions between them; x3 is noise. */
+size_t nv = 4;
+
+std::shared_ptr<Dense_Feature_Space> make_feature_space()
+{
+    return make_dense_feature_space({ "y", "x1", "x2", "x3" });
+}
+
+std::shared_ptr<Dense_Training_Data>
+make_data(std::shared_ptr<Dense_Feature_Space> fs, size_t nx)
+{
+    auto generate = [] (float * row, RNG & rng)
+        {
+            row[1] = rng.random01();
+            row[2] = rng.random01();
+            row[3] = rng.random01();
+            row[0] = (row[1] > 0.5 ? 2.0 : 0.0) + (row[2] > 0.3 ? 1.0 : -1.0)
+                + (row[1] > 0.8 && row[2] > 0.6 ? 3.0 : 0.0)
+                + 0.1 * row[3];
+        };
+
+    return make_dense_data(fs, nx, 1, generate);
+}
+
+Decision_Tree train_tree(std::shared_ptr<Dense_Feature_Space> fs,
+                         const Training_Data & data, int max_depth)
+{
+    Decision_Tree_Generator generator;
+    generator.init(fs, Feature(0));
+
+    size_t nx = data.example_count();
+    boost::multi_array<float, 2> weights(boost::extents[nx][1]);
+    std::fill(weights.data(), weights.data() + nx, 1.0);
+
+    vector<Feature> features = { Feature(1), Feature(2), Feature(3) };
+
+    Thread_Context context;
+    return generator.train_weighted(context, data, weights, features,
+                                    max_depth);
+}
+
+/* Expected value of the tree when the features in known take their value
+   from the row and the rest are averaged over the training examples that
+   went down each branch. */
+double conditional_expectation(const Tree::Ptr & ptr, const float * features,
+                               const set<Feature> & known)
+{
+    if (!ptr) return 0.0;
+    if (!ptr.node()) return ptr.leaf()->pred.at(0);
+
+    const Tree::Node & node = *ptr.node();
+    const Tree::Ptr * children[3];
+    children[false] = &node.child_false;
+    children[true] = &node.child_true;
+    children[MISSING] = &node.child_missing;
+
+    Split::Weights weights = node.split.apply(features);
+    bool is_known = known.count(node.split.feature());
+
+    double result = 0.0;
+    for (unsigned b = 0;  b < 3;  ++b) {
+        if (!*children[b]) continue;
+        double w = (is_known ? weights[b]
+                    : children[b]->examples() / node.examples);
+        if (w == 0.0) continue;
+        result += w * conditional_expectation(*children[b], features, known);
+    }
+    return result;
+}
+
+double factorial(int n)
+{
+    return n <= 1 ? 1.0 : n * factorial(n - 1);
+}
+
+/* Shapley values of each of the features by enumerating all subsets. */
+map<Feature, double>
+brute_force_shapley(const Decision_Tree & tree, const float * features,
+                    const vector<Feature> & all)
+{
+    int m = all.size();
+    map<Feature, double> result;
+
+    for (unsigned i = 0;  i < m;  ++i) {
+        double phi = 0.0;
+        for (unsigned subset = 0;  subset < (1 << m);  ++subset) {
+            if (subset & (1 << i)) continue;
+            set<Feature> known;
+            for (unsigned j = 0;  j < m;  ++j)
+                if (subset & (1 << j)) known.insert(all[j]);
+            int s = known.size();
+            double before
+                = conditional_expectation(tree.tree.root, features, known);
+            known.insert(all[i]);
+            double after
+                = conditional_expectation(tree.tree.root, features, known);
+            phi += factorial(s) * factorial(m - s - 1) / factorial(m)
+                * (after - before);
+        }
+        result[all[i]] = phi;
+    }
+
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_tree_shap )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 1000);
+
+    /* Deep enough that features are split on more than once on a path. */
+    Decision_Tree tree = train_tree(fs, *data, 5);
+
+    const vector<Feature> & features = fs->dense_features();
+    Optimization_Info info = tree.optimize(features);
+    BOOST_REQUIRE(info);
+
+    vector<Feature> used = { Feature(1), Feature(2), Feature(3) };
+    Explain_Workspace workspace;
+    int top_features[nv];
+    float top_weights[nv];
+
+    for (unsigned x = 0;  x < 50;  ++x) {
+        const float * row
+            = dynamic_cast<const Dense_Feature_Set &>((*data)[x]).values;
+        float optimized[info.features_out()];
+        info.apply(row, optimized);
+
+        double bias = tree.explain_top_k(row, info, 0, nv, top_features,
+                                         top_weights, workspace);
+
+        /* The bias is the expectation with nothing known. */
+        BOOST_CHECK_CLOSE(bias,
+                          conditional_expectation(tree.tree.root, optimized,
+                                                  set<Feature>()), 0.001);
+
+        /* The contributions and the bias add up to the prediction. */
+        double total = bias;
+        for (unsigned i = 0;  i < nv;  ++i)
+            total += top_weights[i];
+        BOOST_CHECK_CLOSE(total + 10.0,
+                          tree.predict(0, (*data)[x]) + 10.0, 0.001);
+
+        /* And they are exactly the Shapley values. */
+        map<Feature, double> expected
+            = brute_force_shapley(tree, optimized, used);
+        for (unsigned i = 0;  i < nv;  ++i) {
+            if (top_features[i] == -1) continue;
+            BOOST_CHECK_CLOSE(top_weights[i] + 10.0,
+                              expected[Feature(top_features[i])] + 10.0,
+                              0.001);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_top_k_order )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 1000);
+    Decision_Tree tree = train_tree(fs, *data, 3);
+
+    Optimization_Info info = tree.optimize(fs->dense_features());
+    const float * row
+        = dynamic_cast<const Dense_Feature_Set &>((*data)[0]).values;
+
+    Explain_Workspace workspace;
+
+    /* More than the number of columns pads with nothing. */
+    int all_features[6];
+    float all_weights[6];
+    double bias = tree.explain_top_k(row, info, 0, 6, all_features,
+                                     all_weights, workspace);
+
+    int nonzero = 0;
+    for (unsigned i = 0;  i < 6;  ++i) {
+        if (all_features[i] == -1) {
+            BOOST_CHECK_EQUAL(all_weights[i], 0.0);
+            continue;
+        }
+        ++nonzero;
+        BOOST_CHECK(all_features[i] > 0 && all_features[i] < nv);
+        BOOST_CHECK(all_weights[i] != 0.0);
+        if (i > 0)
+            BOOST_CHECK_GE(fabs(all_weights[i - 1]), fabs(all_weights[i]));
+    }
+    BOOST_CHECK_GE(nonzero, 1);
+    BOOST_CHECK_EQUAL(all_features[5], -1);
+
+    /* The top 1 is the first of them, and the bias doesn't change. */
+    int top_feature;
+    float top_weight;
+    BOOST_CHECK_EQUAL(tree.explain_top_k(row, info, 0, 1, &top_feature,
+                                         &top_weight, workspace),
+                      bias);
+    BOOST_CHECK_EQUAL(top_feature, all_features[0]);
+    BOOST_CHECK_EQUAL(top_weight, all_weights[0]);
+
+    BOOST_CHECK_THROW(tree.explain_top_k(row, info, 1, 1, &top_feature,
+                                         &top_weight, workspace),
+                      ML::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( test_explain_batch )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 2500);
+    Decision_Tree tree = train_tree(fs, *data, 4);
+
+    Optimization_Info info = tree.optimize(fs->dense_features());
+    const float * rows
+        = dynamic_cast<const Dense_Feature_Set &>((*data)[0]).values;
+
+    size_t nx = data->example_count();
+    int k = 2;
+    vector<int> top_features(nx * k);
+    vector<float> top_weights(nx * k), bias(nx);
+    tree.explain_batch(rows, nx, info, 0, k, &top_features[0],
+                       &top_weights[0], &bias[0]);
+
+    Explain_Workspace workspace;
+    for (unsigned x = 0;  x < nx;  ++x) {
+        int expected_features[k];
+        float expected_weights[k];
+        float expected_bias
+            = tree.explain_top_k(rows + x * nv, info, 0, k,
+                                 expected_features, expected_weights,
+                                 workspace);
+        BOOST_CHECK_EQUAL(bias[x], expected_bias);
+        for (unsigned i = 0;  i < k;  ++i) {
+            BOOST_CHECK_EQUAL(top_features[x * k + i], expected_features[i]);
+            BOOST_CHECK_EQUAL(top_weights[x * k + i], expected_weights[i]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_stumps_and_committee )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 100);
+
+    Feature label(0);
+    std::shared_ptr<Boosted_Stumps> stumps
+        (new Boosted_Stumps(fs, label));
+
+    RNG rng(2);
+    for (unsigned i = 1;  i < nv;  ++i) {
+        for (unsigned j = 0;  j < 2;  ++j) {
+            Label_Dist pred_true(1), pred_false(1), pred_missing(1);
+            pred_true[0] = rng.random01() - 0.5;
+            pred_false[0] = rng.random01() - 0.5;
+            pred_missing[0] = rng.random01() - 0.5;
+            stumps->insert(Stump(label, Feature(i), rng.random01(),
+                                 pred_true, pred_false, pred_missing,
+                                 Stump::NORMAL, fs));
+        }
+    }
+    stumps->bias = Label_Dist(1, 0.25);
+    stumps->output = Boosted_Stumps::RAW;
+
+    /* A committee of the stumps and a tree explains with the weights. */
+    std::shared_ptr<Decision_Tree> tree
+        (new Decision_Tree(train_tree(fs, *data, 2)));
+    Committee committee(fs, label);
+    committee.add(stumps, 0.5);
+    committee.add(tree, 2.0);
+
+    const vector<Feature> & features = fs->dense_features();
+    Optimization_Info stumps_info = stumps->optimize(features);
+    Optimization_Info committee_info = committee.optimize(features);
+
+    Explain_Workspace stumps_workspace, committee_workspace;
+    int top_features[nv];
+    float top_weights[nv];
+
+    for (unsigned x = 0;  x < data->example_count();  ++x) {
+        const Feature_Set & example = (*data)[x];
+        const float * row
+            = dynamic_cast<const Dense_Feature_Set &>(example).values;
+
+        /* The stumps explain the raw output exactly, the same as the
+           Feature_Set interface does. */
+        double bias = stumps->explain_top_k(row, stumps_info, 0, nv,
+                                            top_features, top_weights,
+                                            stumps_workspace);
+        BOOST_CHECK_CLOSE(bias, 0.25, 0.001);
+
+        Explanation explanation = stumps->explain(example, 0);
+        double total = bias;
+        for (unsigned i = 0;  i < nv;  ++i) {
+            total += top_weights[i];
+            if (top_features[i] == -1) continue;
+            BOOST_CHECK_CLOSE(top_weights[i] + 10.0,
+                              explanation.feature_weights
+                                  [Feature(top_features[i])] + 10.0,
+                              0.001);
+        }
+        BOOST_CHECK_CLOSE(total + 10.0, stumps->predict(0, example) + 10.0,
+                          0.001);
+
+        bias = committee.explain_top_k(row, committee_info, 0, nv,
+                                       top_features, top_weights,
+                                       committee_workspace);
+        total = bias;
+        for (unsigned i = 0;  i < nv;  ++i)
+            total += top_weights[i];
+        BOOST_CHECK_CLOSE(total + 10.0,
+                          committee.predict(0, example) + 10.0, 0.001);
+    }
+}
@@ -0,0 +1,123 @@
+/* feature_set_visitor_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the for_each_feature() visitors over the feature set types.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/feature_set.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/utils/smart_ptr_utils.h"
+
+using namespace ML;
+using namespace std;
+
+typedef vector<pair<Feature, float> > Visited;
+
+struct Collect {
+    Collect(Visited & visited) : visited(visited) {}
+    Visited & visited;
+    void operator () (const Feature & feature, float value) const
+    {
+        visited.push_back(make_pair(feature, value));
+    }
+};
+
+/* Compare the visitor with the iterator interface. */
+void check_visit(const Feature_Set & fs, const Visited & visited)
+{
+    BOOST_REQUIRE_EQUAL(visited.size(), fs.size());
+    Feature_Set::const_iterator it = fs.begin();
+    for (unsigned i = 0;  i < visited.size();  ++i, ++it) {
+        BOOST_CHECK_EQUAL(visited[i].first, it.feature());
+        BOOST_CHECK_EQUAL(visited[i].second, it.value());
+    }
+}
+
+/* A feature set with a layout that doesn't match any of the fast paths,
+   to exercise the strided fallback. */
+struct Strided_Feature_Set : public Feature_Set {
+    struct Entry {
+        float value;
+        int padding;
+        Feature feature;
+    };
+
+    vector<Entry> entries;
+
+    virtual boost::tuple<const Feature *, const float *, int, int, size_t>
+    get_data(bool need_sorted = false) const
+    {
+        return boost::make_tuple(&entries[0].feature, &entries[0].value,
+                                 sizeof(Entry), sizeof(Entry),
+                                 entries.size());
+    }
+
+    virtual void sort() {}
+    virtual Strided_Feature_Set * make_copy() const
+    {
+        return new Strided_Feature_Set(*this);
+    }
+};
+
+BOOST_AUTO_TEST_CASE( test_visit_mutable )
+{
+    Mutable_Feature_Set fs;
+    fs.add(Feature(3), 3.0);
+    fs.add(Feature(1), 1.0);
+    fs.add(Feature(2), 2.0);
+    fs.add(Feature(1), 0.5);
+
+    /* Static type is known; resolved at compile time.  Must sort. */
+    Visited visited;
+    for_each_feature(fs, Collect(visited));
+    check_visit(fs, visited);
+
+    /* Through the base class. */
+    Visited visited2;
+    for_each_feature((const Feature_Set &)fs, Collect(visited2));
+    BOOST_CHECK(visited == visited2);
+}
+
+BOOST_AUTO_TEST_CASE( test_visit_dense )
+{
+    std::shared_ptr<vector<Feature> > features(new vector<Feature>());
+    float values[5];
+    for (unsigned i = 0;  i < 5;  ++i) {
+        features->push_back(Feature(i));
+        values[i] = i * 1.5;
+    }
+
+    Dense_Feature_Set fs(features, values);
+
+    Visited visited;
+    for_each_feature(fs, Collect(visited));
+    check_visit(fs, visited);
+
+    Visited visited2;
+    for_each_feature((const Feature_Set &)fs, Collect(visited2));
+    BOOST_CHECK(visited == visited2);
+}
+
+BOOST_AUTO_TEST_CASE( test_visit_strided )
+{
+    Strided_Feature_Set fs;
+    for (unsigned i = 0;  i < 4;  ++i) {
+        Strided_Feature_Set::Entry entry;
+        entry.feature = Feature(i);
+        entry.value = i * 2;
+        entry.padding = 0;
+        fs.entries.push_back(entry);
+    }
+
+    Visited visited;
+    for_each_feature(fs, Collect(visited));
+    check_visit(fs, visited);
+}
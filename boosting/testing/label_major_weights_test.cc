@@ -0,0 +1,116 @@
+/* label_major_weights_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test that boosting with label-major weights gives the same result as
+   with the usual example-major weights.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/boosted_stumps_generator.h"
+#include "jml/boosting/weighted_training.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/boosting/thread_context.h"
+#include "dense_testing.h"
+
+using namespace ML;
+using namespace std;
+
+/* Variable 0 is the label, with nl values; the rest are features. */
+unsigned nl = 7;
+
+std::shared_ptr<Dense_Feature_Space> make_feature_space()
+{
+    return make_dense_feature_space({ "LABEL", "a", "b", "c", "d" }, nl);
+}
+
+/* The label depends upon a and b; c is noise that is sometimes missing and
+   d is mostly noise. */
+std::shared_ptr<Dense_Training_Data>
+make_data(std::shared_ptr<Dense_Feature_Space> fs, size_t nx)
+{
+    auto generate = [] (float * row, RNG & rng)
+        {
+            float a = rng.random01(), b = rng.random01(), c = rng.random01();
+            row[1] = a;
+            row[2] = b;
+            row[3] = (c < 0.1 ? std::numeric_limits<float>::quiet_NaN() : c);
+            row[4] = rng.random01();
+            int label = (int)((a * 0.7 + b * 0.3 + 0.1 * row[4]) * nl);
+            row[0] = std::min<int>(label, nl - 1);
+        };
+
+    return make_dense_data(fs, nx, 1, generate);
+}
+
+BOOST_AUTO_TEST_CASE( test_expand_weights_layout )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 100);
+    distribution<float> ex_weights(100, 1.0);
+
+    boost::multi_array<float, 2> example_major
+        = expand_weights(*data, ex_weights, Feature(0));
+    boost::multi_array<float, 2> label_major
+        = expand_weights(*data, ex_weights, Feature(0), WL_LABEL_MAJOR);
+
+    BOOST_CHECK_EQUAL(weights_layout(example_major), WL_EXAMPLE_MAJOR);
+    BOOST_CHECK_EQUAL(weights_layout(label_major), WL_LABEL_MAJOR);
+    BOOST_CHECK_EQUAL(label_advance(example_major), 1);
+    BOOST_CHECK_EQUAL(label_advance(label_major), 100);
+
+    /* Same values, just stored differently. */
+    for (unsigned x = 0;  x < 100;  ++x)
+        for (unsigned l = 0;  l < nl;  ++l)
+            BOOST_CHECK_EQUAL(example_major[x][l], label_major[x][l]);
+}
+
+BOOST_AUTO_TEST_CASE( test_same_as_example_major )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+
+    /* Enough examples for the updates to be done in several chunks. */
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 5000);
+
+    Boosted_Stumps_Generator generator;
+    generator.init(fs, Feature(0));
+    generator.max_iter = 20;
+    generator.min_iter = 20;
+    generator.verbosity = 0;
+
+    Thread_Context context;
+    distribution<float> ex_weights(data->example_count(), 1.0);
+    vector<Feature> features = { Feature(1), Feature(2), Feature(3),
+                                 Feature(4) };
+
+    generator.label_major_min_labels = 0;
+    Boosted_Stumps example_major
+        = generator.generate_stumps(context, *data, *data, ex_weights,
+                                    ex_weights, features);
+
+    generator.label_major_min_labels = 2;
+    Boosted_Stumps label_major
+        = generator.generate_stumps(context, *data, *data, ex_weights,
+                                    ex_weights, features);
+
+    BOOST_CHECK_EQUAL(example_major.label_count(), nl);
+    BOOST_REQUIRE_EQUAL(label_major.stumps.size(),
+                        example_major.stumps.size());
+
+    /* The weights are summed in a different order, so the same stumps
+       should be chosen but the values may differ very slightly. */
+    for (unsigned x = 0;  x < data->example_count();  x += 7) {
+        distribution<float> p1 = example_major.predict((*data)[x]);
+        distribution<float> p2 = label_major.predict((*data)[x]);
+        BOOST_REQUIRE_EQUAL(p1.size(), nl);
+        for (unsigned l = 0;  l < nl;  ++l)
+            BOOST_CHECK_SMALL(p1[l] - p2[l], 1e-3f);
+    }
+}
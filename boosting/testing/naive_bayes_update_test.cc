@@ -0,0 +1,179 @@
+/* naive_bayes_update_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of incremental updates of Naive Bayes classifiers from their
+   sufficient statistics.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "jml/boosting/naive_bayes_generator.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/boosting/thread_context.h"
+#include "jml/db/persistent.h"
+#include "dense_testing.h"
+
+using namespace ML;
+using namespace ML::DB;
+using namespace std;
+
+std::shared_ptr<Dense_Feature_Space> make_feature_space()
+{
+    return make_dense_feature_space({ "LABEL", "a", "b", "c" },
+                                    Feature_Info(BOOLEAN, false, true));
+}
+
+/* The label depends upon a and b; c is noise that is sometimes missing. */
+std::shared_ptr<Dense_Training_Data>
+make_data(std::shared_ptr<Dense_Feature_Space> fs, size_t nx, int seed)
+{
+    auto generate = [] (float * row, RNG & rng)
+        {
+            float a = rng.random01(), b = rng.random01(), c = rng.random01();
+            row[0] = (a + 0.5 * b + 0.2 * rng.random01() > 0.9);
+            row[1] = a;
+            row[2] = b;
+            row[3] = (c < 0.1 ? std::numeric_limits<float>::quiet_NaN() : c);
+        };
+
+    return make_dense_data(fs, nx, seed, generate);
+}
+
+Naive_Bayes train(std::shared_ptr<Dense_Feature_Space> fs,
+                  const Training_Data & data)
+{
+    Naive_Bayes_Generator generator;
+    generator.init(fs, Feature(0));
+
+    /* Weights that don't sum to the number of examples, to check that the
+       statistics are properly scaled. */
+    size_t nx = data.example_count();
+    boost::multi_array<float, 2> weights(boost::extents[nx][1]);
+    std::fill(weights.data(), weights.data() + nx, 1.0 / nx);
+
+    vector<Feature> features = { Feature(1), Feature(2), Feature(3) };
+
+    Thread_Context context;
+    return generator.train_weighted(context, data, weights, features);
+}
+
+void check_stats_close(const Naive_Bayes::Bayes_Stats & s1,
+                       const Naive_Bayes::Bayes_Stats & s2)
+{
+    BOOST_REQUIRE_EQUAL(s1.counts.num_elements(), s2.counts.num_elements());
+    for (unsigned i = 0;  i < s1.counts.num_elements();  ++i)
+        BOOST_CHECK_CLOSE(s1.counts.data()[i] + 1.0,
+                          s2.counts.data()[i] + 1.0, 0.01);
+    for (unsigned l = 0;  l < s1.label_weights.size();  ++l)
+        BOOST_CHECK_CLOSE(s1.label_weights[l], s2.label_weights[l], 0.01);
+    BOOST_CHECK_EQUAL(s1.example_count, s2.example_count);
+}
+
+void check_same_model(const Naive_Bayes & m1, const Naive_Bayes & m2)
+{
+    BOOST_REQUIRE_EQUAL(m1.probs.num_elements(), m2.probs.num_elements());
+    for (unsigned i = 0;  i < m1.probs.num_elements();  ++i)
+        BOOST_CHECK_CLOSE(m1.probs.data()[i] + 1.0, m2.probs.data()[i] + 1.0,
+                          0.01);
+    for (unsigned l = 0;  l < m1.label_priors.size();  ++l)
+        BOOST_CHECK_CLOSE(m1.label_priors[l], m2.label_priors[l], 0.01);
+}
+
+BOOST_AUTO_TEST_CASE( test_stats_from_training )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 2000, 1);
+
+    Naive_Bayes model = train(fs, *data);
+    BOOST_REQUIRE_EQUAL(model.features.size(), 3);
+    BOOST_REQUIRE(!model.stats.empty());
+
+    /* Counting the data again gives the same statistics as training. */
+    check_stats_close(model.stats, model.accumulate(*data));
+
+    /* And the probabilities calculated from them are the same as the ones
+       that training came up with. */
+    Naive_Bayes recalculated = model;
+    recalculated.calc_from_stats();
+    check_same_model(model, recalculated);
+}
+
+BOOST_AUTO_TEST_CASE( test_update_and_merge )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> day1 = make_data(fs, 3000, 1);
+    std::shared_ptr<Dense_Training_Data> day2 = make_data(fs, 5000, 2);
+
+    Naive_Bayes model = train(fs, *day1);
+
+    /* Updating with the second day's data adds its statistics. */
+    Naive_Bayes updated = model;
+    updated.update(*day2);
+
+    Naive_Bayes::Bayes_Stats expected = model.stats;
+    expected.add(model.accumulate(*day2));
+    check_stats_close(updated.stats, expected);
+    BOOST_CHECK_EQUAL(updated.stats.example_count, 8000);
+
+    /* The same as a model with the same features counted over both days. */
+    Naive_Bayes both = model;
+    both.stats = model.accumulate(*day1);
+    both.stats.add(model.accumulate(*day2));
+    both.calc_from_stats();
+    check_same_model(updated, both);
+
+    /* Merging a model of the second day into one of the first does the
+       same thing. */
+    Naive_Bayes second = model;
+    second.stats = model.accumulate(*day2);
+    second.calc_from_stats();
+
+    Naive_Bayes merged = model;
+    second.merge_into(merged);
+    check_same_model(updated, merged);
+
+    /* Predictions reflect the new probabilities. */
+    Label_Dist p1 = updated.predict((*day2)[0]);
+    Label_Dist p2 = merged.predict((*day2)[0]);
+    BOOST_CHECK_CLOSE(p1[1], p2[1], 0.01);
+
+    /* Models without statistics can't be updated. */
+    Naive_Bayes no_stats = model;
+    no_stats.stats = Naive_Bayes::Bayes_Stats();
+    BOOST_CHECK_THROW(no_stats.update(*day2), ML::Exception);
+    BOOST_CHECK_THROW(no_stats.merge_into(merged), ML::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( test_serialize_stats )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    std::shared_ptr<Dense_Training_Data> data = make_data(fs, 1000, 3);
+
+    Naive_Bayes model = train(fs, *data);
+
+    ostringstream stream_out;
+    {
+        Store_Writer store(stream_out);
+        model.serialize(store);
+    }
+
+    istringstream stream_in(stream_out.str());
+    Store_Reader store(stream_in);
+    Naive_Bayes reconstituted(store, fs);
+
+    BOOST_REQUIRE(!reconstituted.stats.empty());
+    check_stats_close(model.stats, reconstituted.stats);
+    check_same_model(model, reconstituted);
+
+    /* It can still be updated after being loaded. */
+    reconstituted.update(*data);
+    BOOST_CHECK_EQUAL(reconstituted.stats.example_count, 2000);
+}
@@ -0,0 +1,184 @@
+/* optimized_predict_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test that the optimized predict of sparse feature sets gives the same
+   answers as the normal predict.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/sparse_features.h"
+#include "jml/boosting/boosted_stumps.h"
+#include "jml/boosting/naive_bayes.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/arch/format.h"
+
+using namespace ML;
+using namespace std;
+
+/* Features 0 (the label) to nf - 1; the classifiers use every third one,
+   and the rows contain a random subset of all of them. */
+int nf = 300;
+
+std::shared_ptr<Sparse_Feature_Space> make_feature_space()
+{
+    std::shared_ptr<Sparse_Feature_Space> fs(new Sparse_Feature_Space());
+    fs->make_feature("LABEL", Feature_Info(BOOLEAN, false, true));
+    for (unsigned i = 1;  i < nf;  ++i)
+        fs->make_feature(format("f%d", i), REAL);
+    return fs;
+}
+
+float random_value(unsigned & seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) % 1000) / 1000.0;
+}
+
+/* A sparse row with each feature present with probability density, and
+   (to test missing values) the odd NaN. */
+Mutable_Feature_Set make_row(const Sparse_Feature_Space & fs, unsigned & seed,
+                             float density)
+{
+    Mutable_Feature_Set result;
+    for (unsigned i = 1;  i < nf;  ++i) {
+        if (random_value(seed) >= density) continue;
+        float value = random_value(seed);
+        if (value < 0.05) value = std::numeric_limits<float>::quiet_NaN();
+        result.add(Feature(i), value);
+    }
+    return result;
+}
+
+void check_optimized(Classifier_Impl & classifier,
+                     const Sparse_Feature_Space & fs)
+{
+    vector<Feature> all_features;
+    for (unsigned i = 0;  i < nf;  ++i)
+        all_features.push_back(Feature(i));
+
+    Optimization_Info info = classifier.optimize(all_features);
+    BOOST_REQUIRE(info);
+    BOOST_REQUIRE(classifier.predict_is_optimized());
+
+    BOOST_CHECK_EQUAL(info.find_optimized_index(Feature(0)), -1);
+    BOOST_CHECK_EQUAL(info.find_optimized_index(MISSING_FEATURE), -1);
+
+    unsigned seed = 1;
+    float densities[] = { 0.0, 0.01, 0.1, 0.5, 1.0 };
+
+    for (unsigned d = 0;  d < 5;  ++d) {
+        for (unsigned i = 0;  i < 20;  ++i) {
+            Mutable_Feature_Set row = make_row(fs, seed, densities[d]);
+            BOOST_TEST_CHECKPOINT("density " << densities[d] << " row " << i);
+
+            Label_Dist expected = classifier.predict(row);
+            Label_Dist optimized = classifier.predict(row, info);
+
+            BOOST_REQUIRE_EQUAL(expected.size(), optimized.size());
+            for (unsigned l = 0;  l < expected.size();  ++l) {
+                BOOST_CHECK_CLOSE(expected[l], optimized[l], 0.01);
+                BOOST_CHECK_CLOSE(classifier.predict(l, row),
+                                  classifier.predict(l, row, info), 0.01);
+            }
+        }
+    }
+
+    /* A row with a repeated feature can't be put in the dense vector, so it
+       must fall back to the normal predict, which weights each value. */
+    for (unsigned i = 0;  i < 5;  ++i) {
+        Mutable_Feature_Set row = make_row(fs, seed, 0.1);
+        row.add(Feature(1), 0.0);
+        row.add(Feature(1), 1.0);
+        row.add(Feature(4), random_value(seed));
+        row.add(Feature(4), random_value(seed));
+
+        float fv[info.features_out()];
+        BOOST_CHECK(!info.apply(row, fv));
+
+        Label_Dist expected = classifier.predict(row);
+        Label_Dist optimized = classifier.predict(row, info);
+
+        BOOST_REQUIRE_EQUAL(expected.size(), optimized.size());
+        for (unsigned l = 0;  l < expected.size();  ++l) {
+            BOOST_CHECK_EQUAL(expected[l], optimized[l]);
+            BOOST_CHECK_EQUAL(classifier.predict(l, row),
+                              classifier.predict(l, row, info));
+        }
+    }
+
+    /* A row with exactly the features that we optimized for goes through
+       the positional path. */
+    Mutable_Feature_Set full;
+    for (unsigned i = 0;  i < nf;  ++i)
+        full.add(Feature(i), random_value(seed));
+
+    Label_Dist expected = classifier.predict(full);
+    Label_Dist optimized = classifier.predict(full, info);
+    for (unsigned l = 0;  l < expected.size();  ++l)
+        BOOST_CHECK_CLOSE(expected[l], optimized[l], 0.01);
+}
+
+BOOST_AUTO_TEST_CASE( test_boosted_stumps_optimized )
+{
+    std::shared_ptr<Sparse_Feature_Space> fs = make_feature_space();
+    Feature label(0);
+
+    Boosted_Stumps stumps(fs, label);
+
+    unsigned seed = 42;
+    for (unsigned i = 1;  i < nf;  i += 3) {
+        Label_Dist pred_true(2), pred_false(2), pred_missing(2);
+        for (unsigned l = 0;  l < 2;  ++l) {
+            pred_true[l] = random_value(seed) - 0.5;
+            pred_false[l] = random_value(seed) - 0.5;
+            pred_missing[l] = random_value(seed) - 0.5;
+        }
+
+        stumps.insert(Stump(label, Feature(i), random_value(seed),
+                            pred_true, pred_false, pred_missing,
+                            Stump::NORMAL, fs));
+    }
+
+    stumps.bias = Label_Dist(2, 0.1);
+    stumps.output = Boosted_Stumps::LOGIT;
+
+    check_optimized(stumps, *fs);
+
+    /* Adding another stump means that it needs to be optimized again. */
+    stumps.insert(Stump(label, Feature(2), 0.5, Label_Dist(2, 0.1),
+                        Label_Dist(2, 0.2), Label_Dist(2, 0.3),
+                        Stump::NORMAL, fs));
+    BOOST_CHECK(!stumps.predict_is_optimized());
+}
+
+BOOST_AUTO_TEST_CASE( test_naive_bayes_optimized )
+{
+    std::shared_ptr<Sparse_Feature_Space> fs = make_feature_space();
+    Feature label(0);
+
+    Naive_Bayes bayes(fs, label);
+
+    unsigned seed = 1234;
+    for (unsigned i = 1;  i < nf;  i += 3)
+        bayes.features.push_back
+            (Naive_Bayes::Bayes_Feature(Feature(i), random_value(seed)));
+
+    int nl = bayes.label_count();
+    bayes.probs.resize(boost::extents[bayes.features.size()][3][nl]);
+    for (unsigned f = 0;  f < bayes.features.size();  ++f)
+        for (unsigned j = 0;  j < 3;  ++j)
+            for (unsigned l = 0;  l < nl;  ++l)
+                bayes.probs[f][j][l] = log(random_value(seed) + 0.01);
+
+    bayes.label_priors = distribution<float>(nl, 1.0 / nl);
+    bayes.calc_missing_total();
+
+    check_optimized(bayes, *fs);
+}
@@ -0,0 +1,144 @@
+/* predict_batch_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of batch prediction over dense blocks of data, and of dense training
+   data that is used in place.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/boosted_stumps.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/arch/format.h"
+#include "dense_testing.h"
+
+using namespace ML;
+using namespace std;
+
+/* Variable 0 is the label; the stumps use the odd ones. */
+int nv = 20;
+
+float random_value(unsigned & seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) % 1000) / 1000.0;
+}
+
+std::shared_ptr<Dense_Feature_Space> make_feature_space()
+{
+    vector<string> names;
+    for (unsigned i = 0;  i < nv;  ++i)
+        names.push_back(format("v%d", i));
+    return make_dense_feature_space(names, Feature_Info(BOOLEAN, false, true));
+}
+
+Boosted_Stumps make_stumps(std::shared_ptr<Dense_Feature_Space> fs)
+{
+    Feature label(0);
+    Boosted_Stumps stumps(fs, label);
+
+    unsigned seed = 42;
+    for (unsigned i = 1;  i < nv;  i += 2) {
+        Label_Dist pred_true(2), pred_false(2), pred_missing(2);
+        for (unsigned l = 0;  l < 2;  ++l) {
+            pred_true[l] = random_value(seed) - 0.5;
+            pred_false[l] = random_value(seed) - 0.5;
+            pred_missing[l] = random_value(seed) - 0.5;
+        }
+
+        stumps.insert(Stump(label, Feature(i), random_value(seed),
+                            pred_true, pred_false, pred_missing,
+                            Stump::NORMAL, fs));
+    }
+
+    stumps.bias = Label_Dist(2, 0.1);
+    stumps.output = Boosted_Stumps::LOGIT;
+    return stumps;
+}
+
+BOOST_AUTO_TEST_CASE( test_predict_batch )
+{
+    std::shared_ptr<Dense_Feature_Space> fs = make_feature_space();
+    Boosted_Stumps stumps = make_stumps(fs);
+
+    /* More than one job's worth of rows, with the odd missing value. */
+    size_t nx = 2500;
+    unsigned seed = 1;
+    auto generate = [&] (float * row, RNG &)
+        {
+            for (unsigned i = 0;  i < nv;  ++i) {
+                float value = random_value(seed);
+                if (value < 0.05)
+                    value = std::numeric_limits<float>::quiet_NaN();
+                row[i] = value;
+            }
+        };
+
+    std::shared_ptr<Dense_Training_Data> data
+        = make_dense_data(fs, nx, 1, generate);
+    BOOST_REQUIRE_EQUAL(data->example_count(), nx);
+    BOOST_CHECK_EQUAL(data->variable_count(), nv);
+
+    /* The rows are used in place, one after the other. */
+    const float * rows
+        = dynamic_cast<const Dense_Feature_Set &>((*data)[0]).values;
+    BOOST_CHECK_EQUAL
+        (dynamic_cast<const Dense_Feature_Set &>((*data)[7]).values,
+         rows + 7 * nv);
+    BOOST_CHECK_THROW(data->modify_feature(0, Feature(1), 0.0),
+                      ML::Exception);
+
+    /* Copies keep the data alive. */
+    std::shared_ptr<Training_Data> copy(data->make_copy());
+    data.reset();
+    BOOST_CHECK_EQUAL
+        (dynamic_cast<const Dense_Feature_Set &>((*copy)[0]).values, rows);
+
+    const vector<Feature> & features = fs->dense_features();
+
+    vector<float> output(nx * 2, -1.0), optimized_output(nx * 2, -1.0);
+    stumps.predict_batch(rows, nx, features, &output[0]);
+
+    Optimization_Info info = stumps.optimize(features);
+    BOOST_REQUIRE(info);
+    stumps.predict_batch(rows, nx, features, &optimized_output[0], &info);
+
+    for (unsigned x = 0;  x < nx;  ++x) {
+        Label_Dist expected = stumps.predict((*copy)[x]);
+        BOOST_REQUIRE_EQUAL(expected.size(), 2);
+        for (unsigned l = 0;  l < 2;  ++l) {
+            BOOST_CHECK_EQUAL(output[x * 2 + l], expected[l]);
+            BOOST_CHECK_CLOSE(optimized_output[x * 2 + l], expected[l], 0.01);
+        }
+    }
+
+    /* Nothing to do is fine. */
+    stumps.predict_batch(rows, 0, features, 0);
+
+    vector<Feature> too_few(features.begin(), features.begin() + 3);
+    BOOST_CHECK_THROW(stumps.predict_batch(rows, nx, too_few, &output[0],
+                                           &info),
+                      ML::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( test_in_place_feature_space )
+{
+    float values[6] = { 1, 2, 3, 4, 5, 6 };
+
+    /* An empty feature space gets one variable per column. */
+    std::shared_ptr<Dense_Feature_Space> fs(new Dense_Feature_Space());
+    Dense_Training_Data data(values, 2, 3, fs);
+    BOOST_CHECK_EQUAL(fs->variable_count(), 3);
+    BOOST_CHECK_EQUAL(data[1][Feature(2)], 6);
+
+    /* A feature space with the wrong number of variables is an error. */
+    std::shared_ptr<Dense_Feature_Space> fs2(new Dense_Feature_Space(2));
+    BOOST_CHECK_THROW(Dense_Training_Data(values, 2, 3, fs2), ML::Exception);
+}
@@ -18,7 +18,12 @@
 #include <limits>
 
 #include "jml/boosting/probabilizer.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/boosted_stumps.h"
+#include "jml/boosting/feature_info.h"
 #include "jml/utils/vector_utils.h"
+#include "jml/utils/rng.h"
+#include "dense_testing.h"
 
 using namespace ML;
 using namespace std;
@@ -124,3 +129,113 @@ BOOST_AUTO_TEST_CASE( test_probabilizer_single_dof_mode2 )
     BOOST_CHECK_GT(true_probs.mean(), 0.20);
     BOOST_CHECK_LT(false_probs.mean(), 0.20);
 }
+
+BOOST_AUTO_TEST_CASE( test_stratified_sample )
+{
+    /* 10000 examples of label 0, 1000 of label 1, 10 of label 2 and none of
+       label 3. */
+    vector<Label> labels;
+    for (unsigned i = 0;  i < 11010;  ++i)
+        labels.push_back(Label(i < 10000 ? 0 : (i < 11000 ? 1 : 2)));
+
+    vector<int> all = GLZ_Probabilizer::stratified_sample(labels, 4, 0);
+    BOOST_CHECK_EQUAL(all.size(), labels.size());
+    all = GLZ_Probabilizer::stratified_sample(labels, 4, 20000);
+    BOOST_CHECK_EQUAL(all.size(), labels.size());
+
+    vector<int> sample = GLZ_Probabilizer::stratified_sample(labels, 4, 1000);
+    BOOST_CHECK_LE(sample.size(), 1000);
+    BOOST_CHECK_GE(sample.size(), 990);
+
+    vector<int> counts(4);
+    for (unsigned i = 0;  i < sample.size();  ++i) {
+        if (i > 0) BOOST_REQUIRE_LT(sample[i - 1], sample[i]);
+        counts[labels[sample[i]]] += 1;
+    }
+
+    /* The rare label is kept in full, and the others are in proportion. */
+    BOOST_CHECK_EQUAL(counts[2], 10);
+    BOOST_CHECK_EQUAL(counts[3], 0);
+    BOOST_CHECK_GE(counts[1], 50);
+    BOOST_CHECK_GT(counts[0], 6 * counts[1]);
+
+    /* The same seed gives the same sample. */
+    BOOST_CHECK(sample
+                == GLZ_Probabilizer::stratified_sample(labels, 4, 1000));
+}
+
+BOOST_AUTO_TEST_CASE( test_train_parallel )
+{
+    /* Variable 0 is the label, which is noisily given by variable 1. */
+    size_t nx = 5000;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space({ "LABEL", "v", "noise" },
+                                   Feature_Info(BOOLEAN, false, true));
+    auto generate = [] (float * row, RNG & rng)
+        {
+            float v = rng.random01();
+            row[0] = (v + 0.3 * rng.random01() > 0.65);
+            row[1] = v;
+            row[2] = rng.random01();
+        };
+    std::shared_ptr<Dense_Training_Data> data
+        = make_dense_data(fs, nx, 12, generate);
+
+    Boosted_Stumps stumps(fs, Feature(0));
+    Label_Dist pred_true(2), pred_false(2), pred_missing(2, 0.0);
+    pred_true[0] = 0.3;    pred_true[1] = -0.3;   // v < 0.5
+    pred_false[0] = -0.4;  pred_false[1] = 0.4;
+    stumps.insert(Stump(Feature(0), Feature(1), 0.5, pred_true, pred_false,
+                        pred_missing, Stump::NORMAL, fs));
+    stumps.bias = Label_Dist(2, 0.0);
+
+    Optimization_Info opt_info = stumps.optimize(fs->dense_features());
+
+    /* The scores are the same as the classifier's. */
+    vector<int> examples = { 3, 10, 4000 };
+    boost::multi_array<double, 2> outputs
+        = GLZ_Probabilizer::score(*data, stumps, opt_info, examples);
+    BOOST_REQUIRE_EQUAL(outputs.shape()[0], 4);
+    BOOST_REQUIRE_EQUAL(outputs.shape()[1], 3);
+    for (unsigned i = 0;  i < 3;  ++i) {
+        Label_Dist expected = stumps.predict((*data)[examples[i]]);
+        BOOST_CHECK_EQUAL(outputs[0][i], expected[0]);
+        BOOST_CHECK_EQUAL(outputs[1][i], expected[1]);
+        BOOST_CHECK_EQUAL(outputs[2][i], expected.max());
+        BOOST_CHECK_EQUAL(outputs[3][i], 1.0);
+    }
+
+    /* Examples that are very likely to be labelled 1 and 0. */
+    int high = -1, low = -1;
+    for (unsigned x = 0;  x < nx;  ++x) {
+        if ((*data)[x][Feature(1)] > 0.9) high = x;
+        if ((*data)[x][Feature(1)] < 0.1) low = x;
+    }
+    BOOST_REQUIRE(high != -1 && low != -1);
+
+    for (int mode = 0;  mode <= 4;  ++mode) {
+        BOOST_TEST_CHECKPOINT("mode " << mode);
+
+        GLZ_Probabilizer full, capped, sampled;
+        full.train(*data, stumps, opt_info, mode, "logit");
+        capped.train(*data, stumps, opt_info, mode, "logit", nx);
+        sampled.train(*data, stumps, opt_info, mode, "logit", 1000);
+
+        /* A cap that isn't hit changes nothing. */
+        BOOST_REQUIRE_EQUAL(full.params.size(), capped.params.size());
+        for (unsigned l = 0;  l < full.params.size();  ++l) {
+            BOOST_REQUIRE_EQUAL(full.params[l].size(),
+                                capped.params[l].size());
+            for (unsigned i = 0;  i < full.params[l].size();  ++i)
+                BOOST_CHECK_EQUAL(full.params[l][i], capped.params[l][i]);
+        }
+
+        /* Training on a sample still gives a sensible probabilizer. */
+        distribution<float> likely_true = stumps.predict((*data)[high]);
+        distribution<float> likely_false = stumps.predict((*data)[low]);
+        BOOST_CHECK_GT(sampled.apply(likely_true)[1],
+                       sampled.apply(likely_false)[1]);
+        BOOST_CHECK_GT(full.apply(likely_true)[1],
+                       full.apply(likely_false)[1]);
+    }
+}
@@ -0,0 +1,121 @@
+/* sparse_training_data_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of loading sparse training data, in particular the discovery of
+   categorical features and loading with several threads.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+#include "jml/boosting/sparse_features.h"
+#include "jml/utils/environment.h"
+#include "jml/arch/format.h"
+
+namespace ML {
+extern Env_Option<int> NUM_THREADS;
+} // namespace ML
+
+using namespace ML;
+using namespace std;
+
+/* Big enough to be split into several chunks. */
+int nx = 200000;
+
+/* Write a file where "mixed" is numeric until near the end, where it gets
+   a non-numeric value and so must become categorical.  "late" is only
+   seen at the end of the file. */
+string write_data_file()
+{
+    string filename = format("/tmp/sparse_training_data_test-%d.txt",
+                             (int)getpid());
+    ofstream stream(filename.c_str());
+    stream << "LABEL x mixed color late" << endl;
+
+    for (unsigned x = 0;  x < nx;  ++x) {
+        if (x % 1000 == 10) stream << "# a comment" << endl;
+        if (x % 1000 == 20) stream << endl;
+
+        stream << (x % 2) << " x:" << (x % 13) << " mixed:";
+        if (x == nx - 100) stream << "abc";
+        else stream << (x % 5);
+        if (x % 3 == 0) stream << " color:" << (x % 6 == 0 ? "red" : "blue");
+        if (x % 7 == 0) stream << " flag";
+        if (x >= nx - 10) stream << " late:" << x;
+        if (x % 11 == 0) stream << "  # trailing comment";
+        stream << endl;
+    }
+
+    return filename;
+}
+
+void load(const string & filename, int nthreads,
+          std::shared_ptr<Sparse_Feature_Space> & fs,
+          std::shared_ptr<Sparse_Training_Data> & data)
+{
+    NUM_THREADS.set(nthreads);
+    fs.reset(new Sparse_Feature_Space());
+    data.reset(new Sparse_Training_Data());
+    data->init(filename, fs);
+}
+
+BOOST_AUTO_TEST_CASE( test_sparse_training_data_load )
+{
+    string filename = write_data_file();
+
+    std::shared_ptr<Sparse_Feature_Space> fs1, fs4;
+    std::shared_ptr<Sparse_Training_Data> data1, data4;
+
+    load(filename, 1, fs1, data1);
+    load(filename, 4, fs4, data4);
+
+    unlink(filename.c_str());
+
+    BOOST_CHECK_EQUAL(data1->example_count(), nx);
+    BOOST_CHECK_EQUAL(data4->example_count(), nx);
+
+    /* Features are numbered in order of first appearance. */
+    BOOST_CHECK_EQUAL(fs1->print(), fs4->print());
+    BOOST_CHECK_EQUAL(fs1->print(Feature(0)), "LABEL");
+    BOOST_CHECK_EQUAL(fs1->print(Feature(1)), "x");
+    BOOST_CHECK_EQUAL(fs1->print(Feature(2)), "mixed");
+    BOOST_CHECK_EQUAL(fs1->print(Feature(3)), "color");
+    BOOST_CHECK_EQUAL(fs1->print(Feature(4)), "flag");
+    BOOST_CHECK_EQUAL(fs1->print(Feature(5)), "late");
+
+    BOOST_CHECK(!fs1->info(fs1->get_feature("x")).categorical());
+    BOOST_CHECK(!fs1->info(fs1->get_feature("late")).categorical());
+    BOOST_CHECK(!fs1->info(fs1->get_feature("flag")).categorical());
+
+    /* Mixed became categorical; its numeric values are categories too, in
+       order of first appearance. */
+    Feature_Info mixed = fs1->info(fs1->get_feature("mixed"));
+    BOOST_REQUIRE(mixed.categorical());
+    BOOST_CHECK_EQUAL(mixed.categorical()->count(), 6);
+    BOOST_CHECK_EQUAL(mixed.categorical()->print(0), "0");
+    BOOST_CHECK_EQUAL(mixed.categorical()->print(4), "4");
+    BOOST_CHECK_EQUAL(mixed.categorical()->print(5), "abc");
+
+    Feature_Info color = fs1->info(fs1->get_feature("color"));
+    BOOST_REQUIRE(color.categorical());
+    BOOST_CHECK_EQUAL(color.categorical()->print(0), "red");
+    BOOST_CHECK_EQUAL(color.categorical()->print(1), "blue");
+
+    for (unsigned x = 0;  x < nx;  ++x) {
+        string s1 = fs1->print((*data1)[x]);
+        string s4 = fs4->print((*data4)[x]);
+        if (s1 != s4) {
+            BOOST_CHECK_EQUAL(s1, s4);
+            break;
+        }
+    }
+
+    BOOST_CHECK_EQUAL(fs4->print((*data4)[nx - 100]),
+                      "LABEL:0 x:12 mixed:abc");
+}
@@ -0,0 +1,196 @@
+/* training_checkpoint_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test that boosting runs resumed from a checkpoint finish the same way as
+   runs that were never interrupted.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include "jml/boosting/boosted_stumps_generator.h"
+#include "jml/boosting/boosting_generator.h"
+#include "jml/boosting/stump_generator.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/boosting/thread_context.h"
+#include "jml/db/persistent.h"
+#include "jml/arch/format.h"
+#include "dense_testing.h"
+
+using namespace ML;
+using namespace ML::DB;
+using namespace std;
+
+vector<Feature> features = { Feature(1), Feature(2), Feature(3), Feature(4) };
+
+std::string serialized(const Classifier_Impl & classifier)
+{
+    ostringstream stream;
+    {
+        Store_Writer store(stream);
+        classifier.poly_serialize(store, false);
+    }
+    return stream.str();
+}
+
+/** Train with the given generator three times: once straight through, once
+    stopping part of the way through but writing checkpoints, and once
+    resuming from the last of those checkpoints.  The first and last should
+    come out the same.  The generator's min_iter should be past stop_iter,
+    so that the result depends upon the iterations after the checkpoint. */
+template<class Generator>
+void check_resume(Generator & generator,
+                  const Training_Data & data,
+                  unsigned max_iter, unsigned stop_iter,
+                  const std::string & filename)
+{
+    distribution<float> train_weights(data.example_count(), 1.0);
+    distribution<float> validate_weights(data.example_count(), 0.0);
+    for (unsigned x = 0;  x < data.example_count();  x += 3) {
+        train_weights[x] = 0.0;
+        validate_weights[x] = 1.0;
+    }
+
+    generator.max_iter = max_iter;
+    generator.checkpoint.file = "";
+    generator.checkpoint.resume_from = "";
+
+    Thread_Context context1(Worker_Task::instance(num_threads() - 1), -1, 1);
+    std::shared_ptr<Classifier_Impl> uninterrupted
+        = generator.generate(context1, data, data, train_weights,
+                             validate_weights, features, 0);
+
+    ::unlink(filename.c_str());
+
+    /* Nothing is found to be the best before min_iter, so lowering it to
+       stop_iter (which it can't be above) leaves the state the same. */
+    unsigned min_iter = generator.min_iter;
+    generator.max_iter = generator.min_iter = stop_iter;
+    generator.checkpoint.file = filename;
+    generator.checkpoint.interval = 5;
+
+    Thread_Context context2(Worker_Task::instance(num_threads() - 1), -1, 1);
+    std::shared_ptr<Classifier_Impl> interrupted
+        = generator.generate(context2, data, data, train_weights,
+                             validate_weights, features, 0);
+
+    /* Otherwise there would be nothing to test. */
+    BOOST_CHECK(serialized(*interrupted) != serialized(*uninterrupted));
+
+    /* Checkpoints are written atomically, so no temporary file is left. */
+    BOOST_CHECK_EQUAL(::access(filename.c_str(), R_OK), 0);
+    BOOST_CHECK(::access((filename + ".tmp").c_str(), R_OK) != 0);
+
+    generator.max_iter = max_iter;
+    generator.min_iter = min_iter;
+    generator.checkpoint.file = "";
+    generator.checkpoint.resume_from = filename;
+
+    /* The random numbers that the checkpoint was written with are put back,
+       so the context's seed shouldn't matter. */
+    Thread_Context context3(Worker_Task::instance(num_threads() - 1), -1, 99);
+    std::shared_ptr<Classifier_Impl> resumed
+        = generator.generate(context3, data, data, train_weights,
+                             validate_weights, features, 0);
+
+    BOOST_CHECK(serialized(*resumed) == serialized(*uninterrupted));
+
+    generator.checkpoint.resume_from = "";
+    ::unlink(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( test_boosted_stumps_resume )
+{
+    for (unsigned nl = 2;  nl <= 5;  nl += 3) {
+        BOOST_TEST_CHECKPOINT("nl = " << nl);
+        std::shared_ptr<Dense_Feature_Space> fs
+            = make_dense_feature_space(categorical_variables(), nl);
+        std::shared_ptr<Dense_Training_Data> data
+            = make_dense_data(fs, 3000, 1, categorical_rows(nl));
+
+        Boosted_Stumps_Generator generator;
+        generator.init(fs, Feature(0));
+        generator.min_iter = 30;
+        generator.verbosity = 0;
+
+        check_resume(generator, *data, 40, 23,
+                     format("training_checkpoint_test_stumps_%d.ckpt", nl));
+
+        /* Also with label-major weights, which need to keep their layout. */
+        generator.label_major_min_labels = 2;
+        check_resume(generator, *data, 40, 23,
+                     format("training_checkpoint_test_stumps_lm_%d.ckpt", nl));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_boosting_resume )
+{
+    unsigned nl = 3;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space(categorical_variables(), nl);
+    std::shared_ptr<Dense_Training_Data> data
+        = make_dense_data(fs, 3000, 1, categorical_rows(nl));
+
+    Boosting_Generator generator;
+    generator.weak_learner.reset(new Stump_Generator());
+    generator.init(fs, Feature(0));
+    generator.min_iter = 20;
+    generator.verbosity = 0;
+
+    check_resume(generator, *data, 30, 12,
+                 "training_checkpoint_test_boosting.ckpt");
+}
+
+BOOST_AUTO_TEST_CASE( test_wrong_checkpoint )
+{
+    unsigned nl = 3;
+    std::shared_ptr<Dense_Feature_Space> fs
+        = make_dense_feature_space(categorical_variables(), nl);
+    std::shared_ptr<Dense_Training_Data> data
+        = make_dense_data(fs, 1000, 1, categorical_rows(nl));
+    distribution<float> ex_weights(data->example_count(), 1.0);
+    string filename = "training_checkpoint_test_wrong.ckpt";
+
+    Boosted_Stumps_Generator stumps_generator;
+    stumps_generator.init(fs, Feature(0));
+    stumps_generator.min_iter = stumps_generator.max_iter = 5;
+    stumps_generator.verbosity = 0;
+    stumps_generator.checkpoint.file = filename;
+    stumps_generator.checkpoint.interval = 5;
+
+    Thread_Context context;
+    stumps_generator.generate_stumps(context, *data, *data, ex_weights,
+                                     ex_weights, features);
+
+    /* A checkpoint from one generator can't be used to resume another. */
+    Boosting_Generator boosting_generator;
+    boosting_generator.weak_learner.reset(new Stump_Generator());
+    boosting_generator.init(fs, Feature(0));
+    boosting_generator.verbosity = 0;
+    boosting_generator.checkpoint.resume_from = filename;
+    BOOST_CHECK_THROW(boosting_generator.generate(context, *data, *data,
+                                                  ex_weights, ex_weights,
+                                                  features, 0),
+                      ML::Exception);
+
+    /* Nor from one with a different number of examples. */
+    std::shared_ptr<Dense_Training_Data> data2
+        = make_dense_data(fs, 500, 1, categorical_rows(nl));
+    distribution<float> ex_weights2(data2->example_count(), 1.0);
+    stumps_generator.checkpoint.file = "";
+    stumps_generator.checkpoint.resume_from = filename;
+    BOOST_CHECK_THROW(stumps_generator.generate_stumps(context, *data2, *data2,
+                                                       ex_weights2,
+                                                       ex_weights2, features),
+                      ML::Exception);
+
+    ::unlink(filename.c_str());
+}
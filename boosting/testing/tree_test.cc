@@ -0,0 +1,121 @@
+/* tree_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the memory management of the tree structure.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+
+#include "jml/boosting/tree.h"
+
+using namespace ML;
+using namespace std;
+
+/* Build a complete tree of the given depth, with the leafs numbered from
+   left to right. */
+Tree::Ptr build(Tree & tree, int depth, int & leaf_num)
+{
+    if (depth == 0)
+        return tree.new_leaf(distribution<float>(2, leaf_num++), depth);
+
+    Tree::Node * node = tree.new_node();
+    node->examples = depth;
+    node->pred = distribution<float>(2, -depth);
+    node->child_true = build(tree, depth - 1, leaf_num);
+    node->child_false = build(tree, depth - 1, leaf_num);
+    node->child_missing = build(tree, depth - 1, leaf_num);
+    return node;
+}
+
+/* Check that the tree has the structure built above, counting the leafs
+   in leaf_num. */
+void check(const Tree::Ptr & ptr, int depth, int & leaf_num)
+{
+    BOOST_REQUIRE(ptr);
+    if (depth == 0) {
+        BOOST_REQUIRE(ptr.leaf());
+        BOOST_CHECK_EQUAL(ptr.pred()[0], leaf_num++);
+        return;
+    }
+
+    BOOST_REQUIRE(ptr.node());
+    BOOST_CHECK_EQUAL(ptr.examples(), depth);
+    BOOST_CHECK_EQUAL(ptr.pred()[1], -depth);
+    check(ptr.node()->child_true, depth - 1, leaf_num);
+    check(ptr.node()->child_false, depth - 1, leaf_num);
+    check(ptr.node()->child_missing, depth - 1, leaf_num);
+}
+
+BOOST_AUTO_TEST_CASE( test_tree_copy_clear_swap )
+{
+    int depth = 6;
+
+    Tree tree;
+    int n = 0;
+    tree.root = build(tree, depth, n);
+
+    Tree copy(tree);
+    n = 0;
+    check(copy.root, depth, n);
+    BOOST_CHECK_EQUAL(n, 729);
+
+    /* The copy is independent of the original. */
+    tree.clear();
+    BOOST_CHECK(!tree.root);
+    n = 0;
+    check(copy.root, depth, n);
+
+    /* Clearing then refilling reuses the memory. */
+    n = 0;
+    tree.root = build(tree, 2, n);
+    n = 0;
+    check(tree.root, 2, n);
+
+    tree.swap(copy);
+    n = 0;
+    check(tree.root, depth, n);
+    n = 0;
+    check(copy.root, 2, n);
+
+    copy = tree;
+    tree.clear();
+    n = 0;
+    check(copy.root, depth, n);
+}
+
+BOOST_AUTO_TEST_CASE( test_tree_parallel_allocation )
+{
+    /* Subtrees of the same tree are built in parallel during training. */
+    Tree tree;
+    Tree::Node * root = tree.new_node();
+    root->examples = 5;
+    root->pred = distribution<float>(2, -5);
+    tree.root = root;
+
+    int depth = 4;
+    Tree::Ptr * children[3] = { &root->child_true, &root->child_false,
+                                &root->child_missing };
+
+    vector<std::thread> threads;
+    for (unsigned i = 0;  i < 3;  ++i) {
+        threads.emplace_back([&,i] ()
+                             {
+                                 int n = i * 81;
+                                 for (unsigned j = 0;  j < 100;  ++j) {
+                                     n = i * 81;
+                                     *children[i] = build(tree, depth, n);
+                                 }
+                             });
+    }
+    for (auto & t: threads) t.join();
+
+    int n = 0;
+    check(tree.root, depth + 1, n);
+    BOOST_CHECK_EQUAL(n, 243);
+}
@@ -30,6 +30,7 @@
 #include <boost/random/uniform_int.hpp>
 #include <boost/random/uniform_01.hpp>
 #include "jml/arch/exception.h"
+#include <sstream>
 
 namespace ML {
 
@@ -112,6 +113,26 @@ public:
     typedef RNG_Adaptor<boost::mt19937> RNG_Type;
     RNG_Type rng() { return RNG_Type(rng_); }
 
+    /** Return the state of the random number generators, so that they can
+        be put back later with set_rng_state() to continue the same
+        sequence (for example, when resuming training from a checkpoint). */
+    std::string rng_state() const
+    {
+        std::ostringstream stream;
+        stream << rng_ << " " << uniform01_.base();
+        return stream.str();
+    }
+
+    void set_rng_state(const std::string & state)
+    {
+        /* The engines leave the stream's fail bit set once they reach the
+           end, so check that it was all read by writing it back out. */
+        std::istringstream stream(state);
+        stream >> rng_ >> uniform01_.base();
+        if (rng_state() != state)
+            throw Exception("Thread_Context::set_rng_state(): invalid state");
+    }
+
     /** What level are we recursed to? */
     int recursion() const { return recursion_; }
 
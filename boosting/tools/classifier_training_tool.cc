@@ -63,6 +63,7 @@ try
     int probabilize_mode    = 1;
     int probabilize_data    = 0;
     bool probabilize_weighted = false;
+    size_t probabilize_max_examples = 0;
     bool data_is_sparse     = false;
     float equalize_beta     = 0.0;
     string weight_spec      = "";
@@ -154,7 +155,10 @@ try
             ( "probabilize-data,P", value(&probabilize_data),
               "data for prob: 0 = train, 1 = validate" )
             ( "probabilize-weighted,Q", value(&probabilize_weighted),
-              "train probabilizer using weights also" );
+              "train probabilizer using weights also" )
+            ( "probabilize-max-examples", value(&probabilize_max_examples),
+              "train prob on a stratified sample of at most NUM examples "
+              "(0 = all)" );
 
         output_options.add_options()
             ( "output-file,o", value(&output_file),
@@ -404,7 +408,8 @@ try
         
         GLZ_Probabilizer prob;
         prob.train(*prob_set, *current, opt_info, pr_weights,
-                   probabilize_mode, probabilize_link);
+                   probabilize_mode, probabilize_link,
+                   probabilize_max_examples);
 
         cerr << prob.print() << endl;
 
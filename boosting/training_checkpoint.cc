@@ -0,0 +1,240 @@
+/* training_checkpoint.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Periodic checkpoints of the state of long training runs.
+*/
+
+#include "training_checkpoint.h"
+#include "weighted_training.h"
+#include "feature_space.h"
+#include "jml/db/persistent.h"
+#include "jml/db/compact_size_types.h"
+#include "jml/arch/exception.h"
+#include "jml/arch/format.h"
+#include <fstream>
+#include <cstdio>
+#include <errno.h>
+
+
+using namespace std;
+using namespace ML::DB;
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* CHECKPOINT_CONFIG                                                         */
+/*****************************************************************************/
+
+Checkpoint_Config::
+Checkpoint_Config()
+{
+    defaults();
+}
+
+void
+Checkpoint_Config::
+configure(const Configuration & config)
+{
+    config.find(file,        "checkpoint_file");
+    config.find(interval,    "checkpoint_interval");
+    config.find(resume_from, "resume_from");
+}
+
+void
+Checkpoint_Config::
+defaults()
+{
+    file = "";
+    interval = 10;
+    resume_from = "";
+}
+
+Config_Options
+Checkpoint_Config::
+options() const
+{
+    Config_Options result;
+    result
+        .add("checkpoint_file", file, "<filename>",
+             "periodically write the training state here (empty for never)")
+        .add("checkpoint_interval", interval, "1-",
+             "number of iterations between checkpoints")
+        .add("resume_from", resume_from, "<filename>",
+             "continue training from the given checkpoint");
+    return result;
+}
+
+
+/*****************************************************************************/
+/* TRAINING_CHECKPOINTER                                                     */
+/*****************************************************************************/
+
+Training_Checkpointer::
+Training_Checkpointer(const Checkpoint_Config & config)
+    : config(config)
+{
+}
+
+Training_Checkpointer::
+~Training_Checkpointer()
+{
+    if (thread.joinable())
+        thread.join();
+}
+
+void
+Training_Checkpointer::
+save(const Writer & writer)
+{
+    wait();
+
+    thread = std::thread([=] ()
+                         {
+                             try {
+                                 this->write(writer);
+                             } catch (...) {
+                                 this->error = std::current_exception();
+                             }
+                         });
+}
+
+void
+Training_Checkpointer::
+wait()
+{
+    if (thread.joinable())
+        thread.join();
+
+    if (error) {
+        std::exception_ptr exc = error;
+        error = std::exception_ptr();
+        std::rethrow_exception(exc);
+    }
+}
+
+void
+Training_Checkpointer::
+write(const Writer & writer)
+{
+    string tmp_file = config.file + ".tmp";
+
+    {
+        std::ofstream stream(tmp_file.c_str(),
+                             ios::out | ios::binary | ios::trunc);
+        if (!stream)
+            throw Exception(errno, "couldn't open checkpoint " + tmp_file,
+                            "Training_Checkpointer::write()");
+
+        {
+            Store_Writer store(stream);
+            writer(store);
+        }
+
+        stream.close();
+        if (!stream)
+            throw Exception("Training_Checkpointer::write(): error writing "
+                            "checkpoint " + tmp_file);
+    }
+
+    if (std::rename(tmp_file.c_str(), config.file.c_str()) == -1)
+        throw Exception(errno, "couldn't rename checkpoint to " + config.file,
+                        "Training_Checkpointer::write()");
+}
+
+
+/*****************************************************************************/
+/* CHECKPOINT STATE                                                          */
+/*****************************************************************************/
+
+namespace {
+
+const std::string CHECKPOINT_MAGIC = "TRAINING_CHECKPOINT";
+const compact_size_t CHECKPOINT_VERSION = 0;
+
+} // file scope
+
+void save_checkpoint_header(DB::Store_Writer & store,
+                            const std::string & generator,
+                            unsigned iter)
+{
+    store << CHECKPOINT_MAGIC << CHECKPOINT_VERSION << generator
+          << compact_size_t(iter);
+}
+
+unsigned load_checkpoint_header(DB::Store_Reader & store,
+                                const std::string & generator)
+{
+    string magic, stored_generator;
+    compact_size_t version;
+    store >> magic >> version;
+    if (magic != CHECKPOINT_MAGIC)
+        throw Exception("attempt to resume from \"" + magic
+                        + "\", which isn't a training checkpoint");
+    if (version > CHECKPOINT_VERSION)
+        throw Exception(format("attempt to resume from checkpoint version "
+                               "%zd, only <= %zd supported",
+                               version.size_, CHECKPOINT_VERSION.size_));
+
+    store >> stored_generator;
+    if (stored_generator != generator)
+        throw Exception("attempt to resume " + generator
+                        + " from a checkpoint written by "
+                        + stored_generator);
+
+    compact_size_t iter(store);
+    return iter;
+}
+
+void save_checkpoint_matrix(DB::Store_Writer & store,
+                            const boost::multi_array<float, 2> & matrix)
+{
+    store << compact_size_t(weights_layout(matrix)) << matrix;
+}
+
+void load_checkpoint_matrix(DB::Store_Reader & store,
+                            boost::multi_array<float, 2> & matrix,
+                            const char * what)
+{
+    compact_size_t layout(store);
+
+    /* Loading resizes the matrix but keeps its storage order, so the
+       values go back where they were as long as the layout is the same.
+       Binary symmetric problems are trained with a single column (which
+       is the same in either layout) rather than two. */
+    size_t nx = matrix.shape()[0], nl = matrix.shape()[1];
+    store >> matrix;
+
+    size_t nl2 = matrix.shape()[1];
+    if (matrix.shape()[0] != nx || (nl2 != nl && !(nl2 == 1 && nl == 2)))
+        throw Exception(format("checkpoint has %s of shape %zdx%zd, but "
+                               "training needs %zdx%zd", what,
+                               matrix.shape()[0], nl2, nx, nl));
+
+    if (nl2 > 1 && layout != weights_layout(matrix))
+        throw Exception(format("checkpoint has %s in a different layout",
+                               what));
+}
+
+void save_checkpoint_features(DB::Store_Writer & store,
+                              const Feature_Space & fs,
+                              const std::vector<Feature> & features)
+{
+    store << compact_size_t(features.size());
+    for (unsigned i = 0;  i < features.size();  ++i)
+        fs.serialize(store, features[i]);
+}
+
+void load_checkpoint_features(DB::Store_Reader & store,
+                              const Feature_Space & fs,
+                              std::vector<Feature> & features)
+{
+    compact_size_t nf(store);
+    features.resize(nf);
+    for (unsigned i = 0;  i < nf;  ++i)
+        fs.reconstitute(store, features[i]);
+}
+
+} // namespace ML
@@ -0,0 +1,144 @@
+/* training_checkpoint.h                                           -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Periodic checkpoints of the state of long training runs, so that they can
+   be resumed after they are killed.
+*/
+
+#ifndef __boosting__training_checkpoint_h__
+#define __boosting__training_checkpoint_h__
+
+
+#include "config_options.h"
+#include "feature.h"
+#include "jml/db/persistent_fwd.h"
+#include "jml/utils/configuration.h"
+#include <boost/multi_array.hpp>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace ML {
+
+
+class Feature_Space;
+
+
+/*****************************************************************************/
+/* CHECKPOINT_CONFIG                                                         */
+/*****************************************************************************/
+
+/** The options controlling the checkpoints of a generator.  They are shared
+    by the generators that support checkpoints, which forward their
+    configure(), defaults() and options() calls to this.
+*/
+
+struct Checkpoint_Config {
+    Checkpoint_Config();
+
+    void configure(const Configuration & config);
+    void defaults();
+    Config_Options options() const;
+
+    std::string file;         ///< Where to write checkpoints; empty for none
+    unsigned interval;        ///< Write one every this many iterations
+    std::string resume_from;  ///< Checkpoint to continue training from
+};
+
+
+/*****************************************************************************/
+/* TRAINING_CHECKPOINTER                                                     */
+/*****************************************************************************/
+
+/** Writes checkpoints of a training run from a background thread.
+
+    The training loop takes a snapshot of its state (copies of its weights,
+    model, etc) between iterations and hands a function that serializes it
+    to save(), which returns straight away.  The serialization and writing
+    happen on another thread while the next iterations run.  Checkpoints are
+    written to a temporary file that is renamed over the previous one, so
+    that a run that dies while writing still leaves the last complete one.
+*/
+
+class Training_Checkpointer {
+public:
+    typedef std::function<void (DB::Store_Writer & store)> Writer;
+
+    Training_Checkpointer(const Checkpoint_Config & config);
+
+    /** Waits for any checkpoint being written, ignoring errors. */
+    ~Training_Checkpointer();
+
+    /** Is a checkpoint due once the given (zero-based) iteration is
+        done? */
+    bool due(unsigned iter) const
+    {
+        return !config.file.empty() && config.interval > 0
+            && (iter + 1) % config.interval == 0;
+    }
+
+    /** Write a checkpoint in the background.  The writer must own all of
+        the state that it writes.  If the previous checkpoint is still being
+        written, this waits for it to finish first. */
+    void save(const Writer & writer);
+
+    /** Wait for the checkpoint being written to finish.  Rethrows any error
+        that occurred while writing it. */
+    void wait();
+
+private:
+    Checkpoint_Config config;
+    std::thread thread;
+    std::exception_ptr error;
+
+    void write(const Writer & writer);
+};
+
+
+/*****************************************************************************/
+/* CHECKPOINT STATE                                                          */
+/*****************************************************************************/
+
+/** Helpers to write the pieces of state that the generators have in
+    common. */
+
+/** Write the header of a checkpoint, which identifies the generator that
+    wrote it and the iteration it was written after. */
+void save_checkpoint_header(DB::Store_Writer & store,
+                            const std::string & generator,
+                            unsigned iter);
+
+/** Read the header of a checkpoint, checking that it was written by the
+    given generator.  Returns the iteration that it was written after. */
+unsigned load_checkpoint_header(DB::Store_Reader & store,
+                                const std::string & generator);
+
+/** Save a weights or output matrix along with its layout. */
+void save_checkpoint_matrix(DB::Store_Writer & store,
+                            const boost::multi_array<float, 2> & matrix);
+
+/** Load a matrix saved by save_checkpoint_matrix() into one that already
+    has the same shape and layout, so that training can carry on with it.
+    Throws if the saved matrix doesn't match. */
+void load_checkpoint_matrix(DB::Store_Reader & store,
+                            boost::multi_array<float, 2> & matrix,
+                            const char * what);
+
+/** Save and load the list of features being trained on, which some weak
+    learners re-rank as they go. */
+void save_checkpoint_features(DB::Store_Writer & store,
+                              const Feature_Space & fs,
+                              const std::vector<Feature> & features);
+
+void load_checkpoint_features(DB::Store_Reader & store,
+                              const Feature_Space & fs,
+                              std::vector<Feature> & features);
+
+} // namespace ML
+
+
+#endif /* __boosting__training_checkpoint_h__ */
@@ -16,6 +16,8 @@
 #include <boost/timer.hpp>
 #include "jml/utils/string_functions.h"
 #include "jml/arch/demangle.h"
+#include "jml/utils/worker_task.h"
+#include "jml/utils/hash_map.h"
 #include <set>
 
 
@@ -35,8 +37,82 @@ struct Dataset_Index::Itl {
     index_type index;
     std::shared_ptr<const Feature_Space> feature_space;
     std::vector<Feature> all_features;
+
+    /** Scan the examples from x_start to x_end, adding them to the given
+        index.  The index can be either the main one or a partial one for a
+        shard of the examples. */
+    void index_examples(index_type & index,
+                        const Training_Data & data,
+                        unsigned x_start, unsigned x_end,
+                        const std::set<Feature> & keep_features,
+                        bool sparse) const;
 };
 
+void
+Dataset_Index::Itl::
+index_examples(index_type & index,
+               const Training_Data & data,
+               unsigned x_start, unsigned x_end,
+               const std::set<Feature> & keep_features,
+               bool sparse) const
+{
+    /* Number of examples we will see; used to reserve memory. */
+    unsigned nx = x_end - x_start;
+
+    vector<Index_Entry *> entries;
+    vector<Feature> features;
+
+    for (unsigned x = x_start;  x < x_end;  ++x) {
+        //cerr << "x = " << x << " of " << nx << endl;
+        const Feature_Set & fs = data[x];
+        if (x == x_start) {
+            for_each_feature(fs, [&] (const Feature & feat, float val)
+                {
+                    Index_Entry & entry = index[feat];
+                    entry.used = keep_features.empty()
+                        || keep_features.count(feat);
+                    entry.feature = feat;
+                    entry.feature_space = feature_space;
+                    entry.initialized = true;
+                    features.push_back(feat);
+                    entries.push_back(&entry);
+                });
+        }
+        
+        int i = 0;
+        for_each_feature(fs, [&] (const Feature & feat, float val)
+            {
+                /* Save a map lookup for the common case of always the same
+                   features or always the same ones at the start. */
+                if (i < features.size() && features[i] == feat) {
+                    if (entries[i]->used)
+                        entries[i]->insert(val, x, nx, sparse, fs);
+                }
+                else {
+                    Index_Entry & entry = index[feat];
+                    if (!entry.initialized) {
+                        entry.initialized = true;
+                        entry.used = (keep_features.empty()
+                                      || keep_features.count(feat));
+                        entry.feature = feat;
+                        entry.feature_space = feature_space;
+                    }
+                    if (entry.used)
+                        entry.insert(val, x, nx, sparse, fs);
+                }
+                ++i;
+            });
+    }
+}
+
+namespace {
+
+/** Minimum number of examples in a shard before we index in parallel.
+    Below this the cost of merging the partial indexes dominates. */
+enum { MIN_EXAMPLES_PER_SHARD = 16384 };
+
+} // file scope
+
 void
 Dataset_Index::
 init(const Training_Data & data,
@@ -52,76 +128,81 @@ init(const Training_Data & data,
 
     //cerr << "sparse = " << sparse << endl;
     
-    /* Iterate through the data and index it one by one. */
-
-    vector<Index_Entry *> entries;
-    vector<Feature> features;
-
     std::set<Feature> keep_features(features_.begin(), features_.end());
-    
-    for (unsigned x = 0;  x < nx;  ++x) {
-        //cerr << "x = " << x << " of " << nx << endl;
-        const Feature_Set & fs = data[x];
-        if (x == 0) {
-            for (Feature_Set::const_iterator it = fs.begin();
-                 it != fs.end();  ++it) {
-                const Feature & feat = it.feature();
-                
-                itl->index[feat].used = keep_features.empty() || keep_features.count(feat);
-                itl->index[feat].feature = feat;
-                itl->index[feat].feature_space = itl->feature_space;
-                itl->index[feat].initialized = true;
-                features.push_back(feat);
-                entries.push_back(&itl->index[feat]);
-            }
-        }
-        
-        //std::set<Feature> doneFeatures;
-
-        int i = 0;
-        for (Feature_Set::const_iterator it = fs.begin();
-             it != fs.end();  ++it, ++i) {
-            const Feature & feat = it.feature();
-            float val = it.value();
-
-#if 0 // debugging sort() problem               
-            if (doneFeatures.count(feat)) {
-                //sleep(1);
-
-                std::set<Feature> doneFeatures2;
-                for (Feature_Set::const_iterator it = fs.begin();
-                     it != fs.end();  ++it) {
-                    const Feature & feat = it.feature();
-                    if (doneFeatures2.count(feat))
-                        throw Exception("doubled up twice on feature " + itl->feature_space->print(feat)
-                                        + " on " + type_name(fs));  // debug
-                    doneFeatures2.insert(feat);
-                }
 
-                throw Exception("doubled up temporarily feature " + itl->feature_space->print(feat)
-                                + " on " + type_name(fs));  // debug
-            }
-            doneFeatures.insert(feat);
-#endif
+    int nshards = std::min<size_t>(num_threads(),
+                                   nx / MIN_EXAMPLES_PER_SHARD);
 
-            /* Save a map lookup for the common case of always the same
-               features or always the same ones at the start. */
-            if (i < features.size() && features[i] == feat) {
-                if (entries[i]->used)
-                    entries[i]->insert(val, x, nx, sparse, fs);
-            }
-            else {
-                Index_Entry & entry = itl->index[feat];
-                if (!entry.initialized) {
+    if (nshards < 2) {
+        /* Iterate through the data and index it one by one. */
+        itl->index_examples(itl->index, data, 0, nx, keep_features, sparse);
+    }
+    else {
+        /* Each shard indexes a contiguous range of examples into its own
+           partial index.  These are then merged in example order, so that
+           the result is identical to the serial version. */
+        vector<unsigned> bounds(nshards + 1);
+        for (unsigned i = 0;  i <= nshards;  ++i)
+            bounds[i] = nx * i / nshards;
+
+        vector<std::shared_ptr<Itl::index_type> > partial(nshards);
+
+        auto indexShard = [&] (int shard)
+            {
+                partial[shard].reset(new Itl::index_type());
+                itl->index_examples(*partial[shard], data,
+                                    bounds[shard], bounds[shard + 1],
+                                    keep_features, sparse);
+            };
+
+        run_in_parallel(0, nshards, indexShard);
+
+        /* Find the list of shard entries that make up each feature.  This
+           needs to be done serially as it modifies the index. */
+        vector<vector<Index_Entry *> > to_merge;
+        vector<Index_Entry *> merge_into;
+        hash_map<Feature, int> merge_index;
+
+        for (unsigned shard = 0;  shard < nshards;  ++shard) {
+            for (Itl::index_type::iterator
+                     it = partial[shard]->begin(),
+                     end = partial[shard]->end();
+                 it != end;  ++it) {
+                const Feature & feature = it.key();
+                hash_map<Feature, int>::const_iterator jt
+                    = merge_index.find(feature);
+                int n;
+                if (jt == merge_index.end()) {
+                    n = merge_into.size();
+                    merge_index[feature] = n;
+
+                    Index_Entry & entry = itl->index[feature];
                     entry.initialized = true;
-                    entry.used = (keep_features.empty() || keep_features.count(feat));
-                    entry.feature = feat;
+                    entry.used = it->used;
+                    entry.feature = feature;
                     entry.feature_space = itl->feature_space;
+
+                    merge_into.push_back(&entry);
+                    to_merge.push_back(vector<Index_Entry *>());
                 }
-                if (entry.used)
-                    entry.insert(val, x, nx, sparse, fs);
+                else n = jt->second;
+
+                to_merge[n].push_back(&*it);
             }
         }
+
+        auto mergeFeature = [&] (int n)
+            {
+                Index_Entry & entry = *merge_into[n];
+                if (!entry.used) return;
+                size_t nvalues = 0;
+                for (unsigned i = 0;  i < to_merge[n].size();  ++i)
+                    nvalues += to_merge[n][i]->values.size();
+                for (unsigned i = 0;  i < to_merge[n].size();  ++i)
+                    entry.append(*to_merge[n][i], nvalues);
+            };
+
+        run_in_parallel_blocked(0, (int)merge_into.size(), mergeFeature);
     }
     
     itl->all_features.clear();
@@ -15,6 +15,8 @@
 #include "jml/utils/pair_utils.h"
 #include <boost/timer.hpp>
 #include "jml/utils/exc_assert.h"
+#include "jml/utils/parallel_sort.h"
+#include "jml/arch/numa.h"
 
 using namespace std;
 
@@ -146,6 +148,74 @@ insert(float value, unsigned example, unsigned example_count, bool sparse,
     last_example = example;
 }
 
+void Dataset_Index::Index_Entry::
+append(Index_Entry & other, size_t total_values)
+{
+    check_used();
+    if (other.seen == 0) return;
+
+    if (seen == 0) {
+        /* Nothing here yet; simply take over the other one's data. */
+        seen = other.seen;
+        found_in = other.found_in;
+        found_twice = other.found_twice;
+        zeros = other.zeros;
+        ones = other.ones;
+        non_integral = other.non_integral;
+        min_value = other.min_value;
+        max_value = other.max_value;
+        last_example = other.last_example;
+        in_this_ex = other.in_this_ex;
+        values.swap(other.values);
+        examples.swap(other.examples);
+        values.reserve(total_values);
+        if (!examples.empty()) examples.reserve(total_values);
+        return;
+    }
+
+    if (other.examples.empty() || examples.empty()) {
+        /* One of the two is using the implicit representation; we need to
+           make it explicit before we can join them. */
+        if (examples.empty()) {
+            examples.reserve(std::max(total_values,
+                                      values.size() + other.values.size()));
+            examples.resize(values.size());
+            std::iota(examples.begin(), examples.end(), 0);
+        }
+        if (other.examples.empty()) {
+            other.examples.resize(other.values.size());
+            std::iota(other.examples.begin(), other.examples.end(), 0);
+        }
+    }
+
+    if (other.examples.front() <= examples.back())
+        throw Exception("Index_Entry::append(): example ranges overlap");
+
+    seen += other.seen;
+    found_in += other.found_in;
+    found_twice += other.found_twice;
+    zeros += other.zeros;
+    ones += other.ones;
+    non_integral += other.non_integral;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+    last_example = other.last_example;
+    in_this_ex = other.in_this_ex;
+
+    values.insert(values.end(), other.values.begin(), other.values.end());
+    examples.insert(examples.end(),
+                    other.examples.begin(), other.examples.end());
+
+    vector<float>().swap(other.values);
+    vector<unsigned>().swap(other.examples);
+
+    /* If it was found exactly once in each of the examples so far, then
+       we go back to the implicit representation that insert() would have
+       produced. */
+    if (seen == found_in && examples.back() == examples.size() - 1)
+        vector<unsigned>().swap(examples);
+}
+
 void Dataset_Index::Index_Entry::
 finalize(unsigned example_count, const Feature & feature,
          std::shared_ptr<const Feature_Space> feature_space)
@@ -191,6 +261,10 @@ finalize(unsigned example_count, const Feature & feature,
             examples = vector<unsigned>(examples);
     }
 
+    /* The index is scanned by training threads on every node. */
+    numa_place_array(values, NUMA_INTERLEAVED);
+    numa_place_array(examples, NUMA_INTERLEAVED);
+
 #if 0
     if (found_twice == 0) return;
 
@@ -228,8 +302,7 @@ get_values(Sort_By sort_by)
     else if (sort_by == BY_VALUE) {
         if (has_values_sorted) return values_sorted;
         vector<float> new_values_sorted = values;
-        std::sort(new_values_sorted.begin(), new_values_sorted.end());
-        //safe_less<float>());
+        parallel_sort(new_values_sorted);
         
         Guard guard(lock);
         if (has_values_sorted) return values_sorted;
@@ -262,7 +335,10 @@ get_examples(Sort_By sort_by)
         vector<pair<float, unsigned> > pairs
             (pair_merger(values.begin(), examples3.begin()),
              pair_merger(values.end(), examples3.end()));
-        sort_on_first_ascending(pairs);
+
+        /* Sort on the full pair so that the order of examples with equal
+           values doesn't depend upon how the parallel sort was split up. */
+        parallel_sort(pairs);
         
         if (values_sorted.size()) {
             /* Should be the same whether pre-calculated or not. */
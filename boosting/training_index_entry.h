@@ -158,6 +158,14 @@ struct Dataset_Index::Index_Entry {
     void insert(float value, unsigned example, unsigned example_count,
                 bool sparse, const Feature_Set & fset);
 
+    /** Append the information from another entry for the same feature,
+        which was built over a later (disjoint) range of examples.  The
+        other entry's data is moved out of it.  Used to merge the partial
+        indexes built in parallel by Dataset_Index::init().  The
+        total_values argument is used to reserve memory up front.
+    */
+    void append(Index_Entry & other, size_t total_values = 0);
+
     /** Copy the data structures to allow unused space on the end of vectors
         to be reclaimed. */
     void finalize(unsigned example_count, const Feature & feature,
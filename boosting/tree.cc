@@ -133,11 +133,24 @@ reconstitute(DB::Store_Reader & store, const Feature_Space & fs,
 /*****************************************************************************/
 
 Tree::Tree()
-    : nodes_allocated(0), leafs_allocated(0),
-      nodes_destroyed(0), leafs_destroyed(0)
 {
 }
 
+namespace {
+
+void count_recursive(const Tree::Ptr & ptr, size_t & nodes, size_t & leafs)
+{
+    if (ptr.node()) {
+        ++nodes;
+        count_recursive(ptr.node()->child_true, nodes, leafs);
+        count_recursive(ptr.node()->child_false, nodes, leafs);
+        count_recursive(ptr.node()->child_missing, nodes, leafs);
+    }
+    else if (ptr.leaf()) ++leafs;
+}
+
+} // file scope
+
 Tree::Ptr 
 tree_copy_recursive(const Tree::Ptr & from,
                     Tree & to)
@@ -157,10 +170,8 @@ tree_copy_recursive(const Tree::Ptr & from,
 }
 
 Tree::Tree(const Tree & other)
-    : nodes_allocated(0), leafs_allocated(0),
-      nodes_destroyed(0), leafs_destroyed(0)
 {
-    root = tree_copy_recursive(other.root, *this);
+    *this = other;
 }
 
 Tree &
@@ -170,6 +181,14 @@ operator = (const Tree & other)
     if (&other == this) return *this;
 
     clear();
+
+    /* Count first so that the copy goes into a single block of each type,
+       in depth-first order, rather than into lots of little ones. */
+    size_t nodes = 0, leafs = 0;
+    count_recursive(other.root, nodes, leafs);
+    node_arena.reserve(nodes);
+    leaf_arena.reserve(leafs);
+
     root = tree_copy_recursive(other.root, *this);
     
     return *this;
@@ -177,62 +196,42 @@ operator = (const Tree & other)
 
 Tree::~Tree()
 {
-    //clear();
 }
 
-static Lock tree_alloc_lock;
-
 void
 Tree::
-clear_recursive(Tree::Ptr & root)
+swap(Tree & other)
 {
-    Guard guard(tree_alloc_lock);
-    if (root.node()) {
-        Node * nroot = root.node();
-        clear_recursive(nroot->child_true);
-        clear_recursive(nroot->child_false);
-        clear_recursive(nroot->child_missing);
-        node_pool.destroy(nroot);
-        ++nodes_destroyed;
-    }
-    else if (root.leaf()) {
-        leaf_pool.destroy(root.leaf());
-        ++leafs_destroyed;
-    }
-    
-    root = Tree::Ptr();
+    std::swap(root, other.root);
+    node_arena.swap(other.node_arena);
+    leaf_arena.swap(other.leaf_arena);
 }
 
 void Tree::clear()
 {
-    clear_recursive(root);
-
-    //cerr << "Tree::clear(): after clear: alloc " << nodes_allocated
-    //     << "/" << leafs_allocated << " destr "
-    //     << nodes_destroyed << "/" << leafs_destroyed << endl;
+    root = Ptr();
+    node_arena.clear();
+    leaf_arena.clear();
 }
 
 Tree::Node * Tree::new_node()
 {
-    Guard guard(tree_alloc_lock);
-    ++nodes_allocated;
-    return node_pool.construct();
+    std::unique_lock<Spinlock> guard(alloc_lock);
+    return node_arena.construct();
 }
 
 Tree::Leaf *
 Tree::new_leaf(const distribution<float> & dist, float examples)
 {
-    Guard guard(tree_alloc_lock);
-    ++leafs_allocated;
-    return leaf_pool.construct(dist, examples);
+    std::unique_lock<Spinlock> guard(alloc_lock);
+    return leaf_arena.construct(dist, examples);
 }
 
 Tree::Leaf *
 Tree::new_leaf()
 {
-    Guard guard(tree_alloc_lock);
-    ++leafs_allocated;
-    return leaf_pool.construct();
+    std::unique_lock<Spinlock> guard(alloc_lock);
+    return leaf_arena.construct();
 }
 
 void Tree::
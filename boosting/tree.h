@@ -11,7 +11,8 @@
 
 #include "config.h"
 #include "feature_set.h"
-#include <boost/pool/object_pool.hpp>
+#include "jml/utils/object_arena.h"
+#include "jml/arch/spinlock.h"
 #include "jml/stats/distribution.h"
 #include "split.h"
 
@@ -33,6 +34,10 @@ struct Tree {
     Tree & operator = (const Tree & other);
     ~Tree();
 
+    /** Exchange the contents of two trees without copying them. */
+    void swap(Tree & other);
+
+    /** Destroy all of the nodes and leafs in the tree at once. */
     void clear();
 
     struct Base;
@@ -120,7 +125,9 @@ struct Tree {
 
     Ptr root;  ///< The root node of the tree
 
-    /** Allocate a new tree node. */
+    /** Allocate a new tree node.  The nodes and leafs belong to the tree
+        and are only freed when the whole tree is cleared.  This can be
+        called from several threads at once. */
     Node * new_node();
         
     /** Allocate a new tree leaf. */
@@ -143,18 +150,14 @@ private:
     /* We make the tree object responsible for holding the entire amount
        of memory for its leafs and nodes.  This gives us the advantage
        of having everything close together in memory, which lets us make
-       better use of the cache.
+       better use of the cache, and means that clearing the tree doesn't
+       need to walk it.
     */
-    boost::object_pool<Node> node_pool; ///< Allocator for nodes
-    boost::object_pool<Leaf> leaf_pool; ///< Allocator for leafs
-
-    size_t nodes_allocated;
-    size_t leafs_allocated;
-
-    size_t nodes_destroyed;
-    size_t leafs_destroyed;
+    Object_Arena<Node> node_arena; ///< Allocator for nodes
+    Object_Arena<Leaf> leaf_arena; ///< Allocator for leafs
 
-    void clear_recursive(Tree::Ptr & root);
+    /** Protects the arenas, as subtrees are trained in parallel. */
+    Spinlock alloc_lock;
 };
 
 std::string print_outcome(const ML::Tree::Leaf & outcome);
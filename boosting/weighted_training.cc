@@ -12,6 +12,7 @@
 #include "training_index.h"
 #include "jml/utils/floating_point.h"
 #include "jml/math/xdiv.h"
+#include "jml/arch/numa.h"
 
 
 using namespace std;
@@ -286,16 +287,27 @@ apply_weight_spec(const Training_Data & data,
 boost::multi_array<float, 2>
 expand_weights(const Training_Data & data,
                const distribution<float> & weights,
-               const Feature & predicted)
+               const Feature & predicted,
+               Weights_Layout layout)
 {
     if (weights.size() != data.example_count())
         throw Exception("expand_weights(): weights and data "
                         "sizes don't match");
     
     int nl = data.label_count(predicted);
-    
+
     boost::multi_array<float, 2> result
-        (boost::extents[data.example_count()][nl]);
+        (boost::extents[data.example_count()][nl],
+         (layout == WL_LABEL_MAJOR
+          ? boost::general_storage_order<2>(boost::fortran_storage_order())
+          : boost::general_storage_order<2>(boost::c_storage_order())));
+
+    /* The weights are updated in blocks of examples, with each block's
+       job preferring the node that holds it.  Label-major weights have
+       a block of each label in every page, so there is nothing to gain. */
+    if (layout == WL_EXAMPLE_MAJOR)
+        numa_place_array(result, NUMA_PARTITIONED);
+
     double recip = 1.0 / (nl * weights.total());
 
     for (unsigned x = 0;  x < data.example_count();  ++x)
@@ -119,10 +119,44 @@ distribution<float>
 apply_weight_spec(const Training_Data & data,
                   const std::vector<Weight_Spec> & specs);
     
+/** How a weights matrix, which is indexed as weights[example][label], is
+    laid out in memory.  Example-major keeps the weights of the labels of
+    each example together, which is best when there are few labels.
+    Label-major keeps the weights of each label together, so that the loops
+    over the examples for one label run along contiguous memory; this is
+    better once there are enough labels that an example's weights span
+    several cache lines.
+*/
+enum Weights_Layout {
+    WL_EXAMPLE_MAJOR,   ///< weights[x][l] is at x * nl + l
+    WL_LABEL_MAJOR      ///< weights[x][l] is at l * nx + x
+};
+
+/** Return the layout of the given weights matrix.  A matrix with a single
+    column (regression or binary symmetric) is always example-major. */
+inline Weights_Layout
+weights_layout(const boost::multi_array<float, 2> & weights)
+{
+    if (weights.shape()[1] > 1 && weights.strides()[0] == 1)
+        return WL_LABEL_MAJOR;
+    return WL_EXAMPLE_MAJOR;
+}
+
+/** Distance in memory between the weights of successive labels of one
+    example.  A single column has an advance of 0, so that all labels see
+    the same weight. */
+inline int label_advance(const boost::multi_array<float, 2> & weights)
+{
+    return (weights.shape()[1] == 1 ? 0 : weights.strides()[1]);
+}
+
+/** Expand the example weights into a weights matrix with one column per
+    label, laid out as given. */
 boost::multi_array<float, 2>
 expand_weights(const Training_Data & data,
                const distribution<float> & weights,
-               const Feature & predicted);
+               const Feature & predicted,
+               Weights_Layout layout = WL_EXAMPLE_MAJOR);
 
 /** Parse a weight spec.  Note that this method returns an untrained weight
     spec; you need to call train_weight_spec before using it. */
@@ -33,6 +33,7 @@
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <type_traits>
 #include <boost/array.hpp>
 #include "jml/utils/string_functions.h"
 
@@ -253,12 +254,8 @@ public:
         compact_size_t sz(*this);
 
         std::vector<T, A> v;
-        v.reserve(sz);
-        for (unsigned i = 0;  i < sz;  ++i) {
-            T t;
-            *this >> t;
-            v.push_back(t);
-        }
+        load_array(v, sz, std::integral_constant
+                   <bool, Is_Bulk_Serializable<T>::value>());
         vec.swap(v);
     }
 
@@ -337,10 +334,7 @@ public:
 
         arr.resize(sizes);
 
-        size_t ne = arr.num_elements();
-        T * el = arr.data();
-        for (unsigned i = 0;  i < ne;  ++i, ++el)
-            *this >> *el;
+        load_array(arr.data(), arr.num_elements());
     }
 
     void load_binary(void * address, size_t size)
@@ -351,6 +345,18 @@ public:
         skip(size);
     }
 
+    /** Load n contiguous elements.  When the serialized representation is
+        the in-memory one, the bytes are copied straight into place in
+        chunks of at most BULK_CHUNK bytes, so that reading from a stream
+        doesn't need to buffer the whole array first.
+    */
+    template<typename T>
+    void load_array(T * el, size_t n)
+    {
+        load_array(el, n, std::integral_constant
+                   <bool, Is_Bulk_Serializable<T>::value>());
+    }
+
     // Anything with a serialize() method gets to be serialized
     template<typename T>
     void load(T & obj,
@@ -366,6 +372,58 @@ public:
         obj.reconstitute(*this);
     }
 #endif
+
+private:
+    enum { BULK_CHUNK = 1024 * 1024 };
+
+    template<typename T>
+    void load_array(T * el, size_t n, std::true_type)
+    {
+        char * p = reinterpret_cast<char *>(el);
+        size_t left = n * sizeof(T);
+        while (left > 0) {
+            if (avail() == 0)
+                must_have(std::min<size_t>(left, BULK_CHUNK));
+            size_t todo = std::min(left, avail());
+            std::copy(pos(), pos() + todo, p);
+            skip(todo);
+            p += todo;
+            left -= todo;
+        }
+    }
+
+    template<typename T>
+    void load_array(T * el, size_t n, std::false_type)
+    {
+        for (size_t i = 0;  i < n;  ++i, ++el)
+            *this >> *el;
+    }
+
+    /* The vector versions don't size the vector until they know how much
+       data there is, so that a corrupt length can't make us allocate
+       far more than the archive could possibly contain. */
+    template<typename T, class A>
+    void load_array(std::vector<T, A> & v, size_t n, std::true_type)
+    {
+        v.reserve(std::min<size_t>(n, BULK_CHUNK / sizeof(T)));
+        while (v.size() < n) {
+            size_t done = v.size();
+            size_t todo = std::min<size_t>(n - done, BULK_CHUNK / sizeof(T));
+            v.resize(done + todo);
+            load_array(&v[done], todo, std::true_type());
+        }
+    }
+
+    template<typename T, class A>
+    void load_array(std::vector<T, A> & v, size_t n, std::false_type)
+    {
+        v.reserve(n);
+        for (size_t i = 0;  i < n;  ++i) {
+            T t;
+            *this >> t;
+            v.push_back(t);
+        }
+    }
 };
 
 } // namespace DB
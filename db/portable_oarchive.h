@@ -36,6 +36,7 @@
 #include <map>
 #include <unordered_map>
 #include <set>
+#include <type_traits>
 #include <string.h>
 
 namespace boost {
@@ -194,8 +195,8 @@ public:
     {
         compact_size_t size(vec.size());
         size.serialize(*this);
-        for (unsigned i = 0;  i < vec.size();  ++i)
-            *this << vec[i];
+        save_array(vec, std::integral_constant
+                   <bool, Is_Bulk_Serializable<T>::value>());
     }
 
     template<class K, class V, class L, class A>
@@ -243,10 +244,7 @@ public:
             dim.serialize(*this);
         }
 
-        size_t ne = arr.num_elements();
-        const T * el = arr.data();
-        for (unsigned i = 0;  i < ne;  ++i, ++el)
-            *this << *el;
+        save_array(arr.data(), arr.num_elements());
     }
 
     template<typename T1, typename T2>
@@ -275,6 +273,17 @@ public:
         save_binary(&val, sizeof(T));
     }
 
+    /** Save n contiguous elements.  When their in-memory representation
+        is already the serialized one, this is a single write; otherwise
+        they are saved one by one.  Either way the output is the same.
+    */
+    template<typename T>
+    void save_array(const T * el, size_t n)
+    {
+        save_array(el, n, std::integral_constant
+                   <bool, Is_Bulk_Serializable<T>::value>());
+    }
+
     // Anything with a serialize() method gets to be serialized
     template<typename T>
     void save(const T & obj,
@@ -294,6 +303,34 @@ public:
     size_t offset() const { return offset_; }
 
 private:
+    template<typename T>
+    void save_array(const T * el, size_t n, std::true_type)
+    {
+        save_binary(el, n * sizeof(T));
+    }
+
+    template<typename T>
+    void save_array(const T * el, size_t n, std::false_type)
+    {
+        for (size_t i = 0;  i < n;  ++i, ++el)
+            *this << *el;
+    }
+
+    template<typename T, class A>
+    void save_array(const std::vector<T, A> & vec, std::true_type)
+    {
+        save_array(vec.data(), vec.size(), std::true_type());
+    }
+
+    /* Element by element, which also covers vector<bool> as it has no
+       underlying array to point to. */
+    template<typename T, class A>
+    void save_array(const std::vector<T, A> & vec, std::false_type)
+    {
+        for (unsigned i = 0;  i < vec.size();  ++i)
+            *this << vec[i];
+    }
+
     std::ostream * stream;
     std::shared_ptr<std::ostream> owned_stream;
     size_t offset_;
@@ -113,6 +113,45 @@ JML_ALWAYS_INLINE int64_t serialization_order(int64_t val)
     return val;
 }
 
+
+/*****************************************************************************/
+/* IS_BULK_SERIALIZABLE                                                      */
+/*****************************************************************************/
+
+/** Tells if an array of T is serialized as exactly its bytes in memory,
+    in which case the whole array can be copied to or from the archive in
+    one go instead of element by element.  This holds for the fixed size
+    numeric types whenever the host order is the serialization order.
+    Types with a compact encoding (long, long long) or a conversion (bool)
+    are never bulk serializable.
+*/
+template<typename T>
+struct Is_Bulk_Serializable {
+    enum { value = false };
+};
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+#define JML_BULK_SERIALIZABLE(T) \
+template<> \
+struct Is_Bulk_Serializable<T> { \
+    enum { value = true }; \
+}
+
+JML_BULK_SERIALIZABLE(char);
+JML_BULK_SERIALIZABLE(signed char);
+JML_BULK_SERIALIZABLE(unsigned char);
+JML_BULK_SERIALIZABLE(signed short);
+JML_BULK_SERIALIZABLE(unsigned short);
+JML_BULK_SERIALIZABLE(signed int);
+JML_BULK_SERIALIZABLE(unsigned int);
+JML_BULK_SERIALIZABLE(float);
+JML_BULK_SERIALIZABLE(double);
+
+#undef JML_BULK_SERIALIZABLE
+
+#endif /* little endian */
+
 } // namespace DB
 } // namespace ML
 
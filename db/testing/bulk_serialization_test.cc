@@ -0,0 +1,210 @@
+/* bulk_serialization_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test that vectors and multi arrays of numbers, which are saved and
+   loaded as a single block, round trip and keep the same format as when
+   they were written element by element.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "jml/db/persistent.h"
+#include "jml/db/compact_size_types.h"
+#include "jml/utils/rng.h"
+#include "jml/arch/timers.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/multi_array.hpp>
+#include <sstream>
+#include <iostream>
+
+
+using namespace ML;
+using namespace ML::DB;
+using namespace std;
+
+template<typename T>
+vector<T> random_vector(size_t n, int seed)
+{
+    RNG rng(seed);
+    vector<T> result(n);
+    for (unsigned i = 0;  i < n;  ++i)
+        result[i] = (T)((rng.random01() - 0.5) * 200.0);
+    return result;
+}
+
+/* Save the way that vectors were saved before they were written in bulk,
+   so that we can check that the format hasn't changed. */
+template<typename T>
+string save_element_by_element(const vector<T> & vec)
+{
+    ostringstream stream;
+    {
+        Store_Writer writer(stream);
+        compact_size_t size(vec.size());
+        size.serialize(writer);
+        for (unsigned i = 0;  i < vec.size();  ++i)
+            writer << vec[i];
+    }
+    return stream.str();
+}
+
+template<typename X>
+string save(const X & x)
+{
+    ostringstream stream;
+    {
+        Store_Writer writer(stream);
+        writer << x;
+    }
+    return stream.str();
+}
+
+template<typename T>
+void test_vector(size_t n)
+{
+    BOOST_TEST_CHECKPOINT("vector of " << sizeof(T) << " bytes, size " << n);
+
+    vector<T> vec = random_vector<T>(n, n + 1);
+
+    string saved = save(vec);
+    BOOST_CHECK(saved == save_element_by_element(vec));
+
+    /* From a stream, which is read in chunks. */
+    {
+        istringstream stream(saved);
+        Store_Reader reader(stream);
+        vector<T> loaded;
+        reader >> loaded;
+        BOOST_CHECK(loaded == vec);
+    }
+
+    /* From a buffer, which has all of the data available at once. */
+    {
+        Store_Reader reader(saved.c_str(), saved.size());
+        vector<T> loaded(3);
+        reader >> loaded;
+        BOOST_CHECK(loaded == vec);
+    }
+
+    /* Truncated input must be detected. */
+    if (n > 0) {
+        string truncated(saved, 0, saved.size() - 1);
+        istringstream stream(truncated);
+        Store_Reader reader(stream);
+        vector<T> loaded;
+        BOOST_CHECK_THROW(reader >> loaded, std::exception);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_bulk_vectors )
+{
+    size_t sizes[] = { 0, 1, 7, 1000, 1000000 };
+
+    for (unsigned i = 0;  i < sizeof(sizes) / sizeof(sizes[0]);  ++i) {
+        test_vector<char>(sizes[i]);
+        test_vector<unsigned char>(sizes[i]);
+        test_vector<short>(sizes[i]);
+        test_vector<int>(sizes[i]);
+        test_vector<unsigned int>(sizes[i]);
+        test_vector<float>(sizes[i]);
+        test_vector<double>(sizes[i]);
+    }
+}
+
+/* These aren't bulk serializable, but go through the same code. */
+BOOST_AUTO_TEST_CASE( test_element_vectors )
+{
+    test_vector<long>(1000);
+    test_vector<unsigned long long>(1000);
+
+    vector<string> strings;
+    strings.push_back("hello");
+    strings.push_back("");
+    strings.push_back("world");
+
+    string saved = save(strings);
+    Store_Reader reader(saved.c_str(), saved.size());
+    vector<string> loaded;
+    reader >> loaded;
+    BOOST_CHECK(loaded == strings);
+}
+
+/* vector<bool> has no contiguous storage, so it can only go element by
+   element. */
+BOOST_AUTO_TEST_CASE( test_bool_vector )
+{
+    vector<bool> bools;
+    for (unsigned i = 0;  i < 1000;  ++i)
+        bools.push_back(i % 3 == 0 || i % 7 == 0);
+
+    string saved = save(bools);
+    BOOST_CHECK(saved == save_element_by_element(bools));
+
+    Store_Reader reader(saved.c_str(), saved.size());
+    vector<bool> loaded;
+    reader >> loaded;
+    BOOST_CHECK(loaded == bools);
+}
+
+BOOST_AUTO_TEST_CASE( test_bulk_multi_array )
+{
+    boost::multi_array<float, 2> arr(boost::extents[300][1000]);
+    RNG rng(42);
+    for (unsigned i = 0;  i < 300;  ++i)
+        for (unsigned j = 0;  j < 1000;  ++j)
+            arr[i][j] = rng.random01();
+
+    string saved = save(arr);
+
+    /* Version, number of dimensions, the dimensions and then the
+       elements. */
+    ostringstream expected_stream;
+    {
+        Store_Writer writer(expected_stream);
+        writer << (char)1 << (char)2;
+        compact_size_t(300).serialize(writer);
+        compact_size_t(1000).serialize(writer);
+        for (unsigned i = 0;  i < 300;  ++i)
+            for (unsigned j = 0;  j < 1000;  ++j)
+                writer << arr[i][j];
+    }
+    BOOST_CHECK(saved == expected_stream.str());
+
+    istringstream stream(saved);
+    Store_Reader reader(stream);
+    boost::multi_array<float, 2> loaded;
+    reader >> loaded;
+
+    BOOST_REQUIRE_EQUAL(loaded.shape()[0], 300);
+    BOOST_REQUIRE_EQUAL(loaded.shape()[1], 1000);
+    BOOST_CHECK(loaded == arr);
+}
+
+BOOST_AUTO_TEST_CASE( test_bulk_timing )
+{
+    vector<float> vec = random_vector<float>(10000000, 1);
+
+    Timer t;
+    string saved = save(vec);
+    double save_time = t.elapsed_wall();
+
+    t.restart();
+    string saved_slow = save_element_by_element(vec);
+    double save_slow_time = t.elapsed_wall();
+
+    BOOST_CHECK(saved == saved_slow);
+
+    t.restart();
+    istringstream stream(saved);
+    Store_Reader reader(stream);
+    vector<float> loaded;
+    reader >> loaded;
+    double load_time = t.elapsed_wall();
+
+    BOOST_CHECK(loaded == vec);
+
+    cerr << "10M floats: bulk save " << save_time << "s, element save "
+         << save_slow_time << "s, bulk load " << load_time << "s" << endl;
+}
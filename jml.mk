@@ -1,2 +1,2 @@
 HAS_EXCEPTION_HOOK := 1
-$(eval $(call include_sub_makes,math arch utils db algebra stats judy boosting python neural tsne))
+$(eval $(call include_sub_makes,math arch utils db algebra stats judy boosting python neural tsne bench))
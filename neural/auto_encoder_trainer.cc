@@ -54,6 +54,8 @@ defaults()
     weight_decay_l1 = 0.0;
     weight_decay_l2 = 0.0;
     dump_testing_output = 0;
+    hogwild = false;
+    hogwild_batch_size = 16;
 }
 
 void
@@ -74,6 +76,8 @@ configure(const std::string & name, const Configuration & config)
     config.get(weight_decay_l1, "weight_decay_l1");
     config.get(weight_decay_l2, "weight_decay_l2");
     config.get(dump_testing_output, "dump_testing_output");
+    config.get(hogwild, "hogwild");
+    config.get(hogwild_batch_size, "hogwild_batch_size");
 }
 
 template<typename Float>
@@ -232,6 +236,10 @@ train_iter(Auto_Encoder & encoder,
            Thread_Context & thread_context,
            double learning_rate) const
 {
+    if (hogwild)
+        return train_iter_hogwild(encoder, data, thread_context,
+                                  learning_rate, 0);
+
     Worker_Task & worker = thread_context.worker();
 
     int nx = data.size();
@@ -329,6 +337,10 @@ train_iter(Auto_Encoder & encoder,
            Thread_Context & thread_context,
            const Parameters_Copy<float> & learning_rates) const
 {
+    if (hogwild)
+        return train_iter_hogwild(encoder, data, thread_context,
+                                  0.0, &learning_rates);
+
     Worker_Task & worker = thread_context.worker();
 
     int nx = data.size();
@@ -414,6 +426,181 @@ train_iter(Auto_Encoder & encoder,
     return make_pair(sqrt(total_mse_exact / nx2), sqrt(total_mse_noisy / nx2));
 }
 
+namespace {
+
+struct Hogwild_Train_Job {
+
+    const Auto_Encoder_Trainer & trainer;
+    Auto_Encoder & encoder;
+    const vector<distribution<float> > & data;
+    int first;
+    int last;
+    const vector<int> & examples;
+    const Thread_Context & context;
+    int random_seed;
+    double learning_rate;
+    const Parameters_Copy<float> * learning_rates;
+    Lock & stats_lock;
+    double & error_exact;
+    double & error_noisy;
+    boost::progress_display * progress;
+
+    Hogwild_Train_Job(const Auto_Encoder_Trainer & trainer,
+                      Auto_Encoder & encoder,
+                      const vector<distribution<float> > & data,
+                      int first, int last,
+                      const vector<int> & examples,
+                      const Thread_Context & context,
+                      int random_seed,
+                      double learning_rate,
+                      const Parameters_Copy<float> * learning_rates,
+                      Lock & stats_lock,
+                      double & error_exact,
+                      double & error_noisy,
+                      boost::progress_display * progress)
+        : trainer(trainer),
+          encoder(encoder), data(data), first(first), last(last),
+          examples(examples),
+          context(context), random_seed(random_seed),
+          learning_rate(learning_rate), learning_rates(learning_rates),
+          stats_lock(stats_lock),
+          error_exact(error_exact), error_noisy(error_noisy),
+          progress(progress)
+    {
+    }
+
+    void operator () ()
+    {
+        Thread_Context thread_context(context);
+        thread_context.seed(random_seed);
+        
+        double total_error_exact = 0.0, total_error_noisy = 0.0;
+
+        Parameters_Copy<double> local_updates(encoder, 0.0);
+
+        int batch_size = std::max(1, trainer.hogwild_batch_size);
+        int stats_done = first;
+
+        for (int x = first;  x < last;  /* no inc */) {
+
+            for (int end = std::min(last, x + batch_size);  x < end;  ++x) {
+                double eex, eno;
+                boost::tie(eex, eno)
+                    = trainer.train_example(encoder, data[examples[x]],
+                                            local_updates,
+                                            thread_context);
+                
+                total_error_exact += eex;
+                total_error_noisy += eno;
+            }
+
+            // Apply straight to the shared parameters.  There is no lock;
+            // the other threads are reading and updating them at the same
+            // time.
+            if (learning_rates) {
+                local_updates.values *= -1.0 / trainer.minibatch_size;
+                encoder.parameters().update(local_updates, *learning_rates);
+            }
+            else encoder.parameters().update(local_updates, -learning_rate);
+
+            std::fill(local_updates.values.begin(), local_updates.values.end(),
+                      0.0);
+
+            // Only synchronize the statistics once per minibatch
+            if (x - stats_done < trainer.minibatch_size && x != last)
+                continue;
+
+            Guard guard(stats_lock);
+
+            error_exact += total_error_exact;
+            error_noisy += total_error_noisy;
+            total_error_exact = total_error_noisy = 0.0;
+
+            if (progress)
+                (*progress) += (x - stats_done);
+            stats_done = x;
+        }
+    }
+};
+
+} // file scope
+
+std::pair<double, double>
+Auto_Encoder_Trainer::
+train_iter_hogwild(Auto_Encoder & encoder,
+                   const std::vector<distribution<float> > & data,
+                   Thread_Context & thread_context,
+                   double learning_rate,
+                   const Parameters_Copy<float> * learning_rates) const
+{
+    Worker_Task & worker = thread_context.worker();
+
+    int nx = data.size();
+
+    Lock stats_lock;
+
+    double total_mse_exact = 0.0, total_mse_noisy = 0.0;
+    
+    vector<int> examples;
+    for (unsigned x = 0;  x < nx;  ++x) {
+        // Randomly exclude some samples
+        if (thread_context.random01() >= sample_proportion)
+            continue;
+        examples.push_back(x);
+    }
+    
+    if (randomize_order) {
+        Thread_Context::RNG_Type rng = thread_context.rng();
+        std::random_shuffle(examples.begin(), examples.end(), rng);
+    }
+    
+    int nx2 = examples.size();
+
+    std::auto_ptr<boost::progress_display> progress;
+    if (verbosity >= 3) progress.reset(new boost::progress_display(nx2, cerr));
+
+    // One job per thread, each taking its share of the examples, with no
+    // synchronization until the end of the iteration
+    int njobs = num_threads();
+    int per_job = (nx2 + njobs - 1) / njobs;
+
+    int group;
+    {
+        int parent = -1;  // no parent group
+        group = worker.get_group(NO_JOB, "hogwild training task", parent);
+        
+        // Make sure the group gets unlocked once we've populated
+        // everything
+        Call_Guard guard(boost::bind(&Worker_Task::unlock_group,
+                                     boost::ref(worker),
+                                     group));
+        
+        for (int x = 0;  x < nx2;  x += per_job) {
+            Hogwild_Train_Job job(*this,
+                                  encoder,
+                                  data,
+                                  x,
+                                  min(nx2, x + per_job),
+                                  examples,
+                                  thread_context,
+                                  thread_context.random(),
+                                  learning_rate,
+                                  learning_rates,
+                                  stats_lock,
+                                  total_mse_exact,
+                                  total_mse_noisy,
+                                  progress.get());
+            
+            // Send it to a thread to be processed
+            worker.add(job, "hogwild job", group);
+        }
+    }
+    
+    worker.run_until_finished(group);
+
+    return make_pair(sqrt(total_mse_exact / nx2), sqrt(total_mse_noisy / nx2));
+}
+
 void
 Auto_Encoder_Trainer::
 train(Auto_Encoder & encoder,
@@ -50,6 +50,15 @@ struct Auto_Encoder_Trainer {
     float weight_decay_l2;
     int dump_testing_output;
 
+    /** Train asynchronously ("hogwild").  Instead of waiting for all of
+        the threads at the end of each minibatch, each thread applies its
+        updates directly to the shared parameters every hogwild_batch_size
+        examples, without taking a lock.  This scales to many more threads,
+        but updates can be lost or interleaved so the results are no longer
+        deterministic. */
+    bool hogwild;
+    int hogwild_batch_size;
+
     /** Add noise to the distribution, according to the noise parameters that
         have been set above. */
     template<typename Float>
@@ -81,6 +90,16 @@ struct Auto_Encoder_Trainer {
                Thread_Context & thread_context,
                const Parameters_Copy<float> & learning_rates) const;
 
+    /** Trains a single iteration asynchronously; see hogwild above.  If
+        learning_rates is non-null, it gives individual learning rates and
+        learning_rate is ignored. */
+    std::pair<double, double>
+    train_iter_hogwild(Auto_Encoder & encoder,
+                       const std::vector<distribution<float> > & data,
+                       Thread_Context & thread_context,
+                       double learning_rate,
+                       const Parameters_Copy<float> * learning_rates) const;
+
     /** Calculate the optimal learning rate for the given training data */
     double
     calc_learning_rate(const Auto_Encoder & layer,
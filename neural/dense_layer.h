@@ -71,6 +71,10 @@ struct Dense_Layer : public Layer {
 
     virtual const Transfer_Function & transfer() const;
 
+    /** Change how accurately the (standard) transfer function is
+        calculated.  Throws if the transfer function isn't a standard one. */
+    void set_transfer_accuracy(Transfer_Accuracy accuracy);
+
     /// How to treat missing values in the input
     Missing_Values missing_values;
         
@@ -202,8 +206,60 @@ struct Dense_Layer : public Layer {
                 F * d2input_errors,
                 Parameters & gradient,
                 Parameters * dgradient,
-                double example_weight) const;    
-    
+                double example_weight) const;
+
+
+    /*************************************************************************/
+    /* SPARSE INPUT                                                          */
+    /*************************************************************************/
+
+    /* These only look at the rows of the weight matrix for the non-zero
+       inputs, so they take time proportional to n * outputs() rather than
+       inputs() * outputs(). */
+
+    template<class F>
+    void sparse_activation(const int * indexes, const F * values, size_t n,
+                           F * activation) const;
+
+    virtual void sparse_apply(const int * indexes, const float * values,
+                              size_t n, float * output) const;
+    virtual void sparse_apply(const int * indexes, const double * values,
+                              size_t n, double * output) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const float * values, size_t n,
+                 float * temp_space, size_t temp_space_size,
+                 float * outputs) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const double * values, size_t n,
+                 double * temp_space, size_t temp_space_size,
+                 double * outputs) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const float * values, size_t n,
+                 const float * outputs,
+                 const float * temp_space, size_t temp_space_size,
+                 const float * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const double * values, size_t n,
+                 const double * outputs,
+                 const double * temp_space, size_t temp_space_size,
+                 const double * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
+    template<typename F>
+    void sparse_bprop(const int * indexes, const F * values, size_t n,
+                      const F * outputs,
+                      const F * temp_space, size_t temp_space_size,
+                      const F * output_errors,
+                      Parameters & gradient,
+                      double example_weight) const;
+
     /** Add in our parameters to the params object. */
     virtual void add_parameters(Parameters & params);
 
@@ -149,6 +149,22 @@ transfer() const
     return *transfer_function;
 }
 
+template<typename Float>
+void
+Dense_Layer<Float>::
+set_transfer_accuracy(Transfer_Accuracy accuracy)
+{
+    const Standard_Transfer_Function * standard
+        = dynamic_cast<const Standard_Transfer_Function *>
+            (transfer_function.get());
+    if (!standard)
+        throw Exception("Dense_Layer::set_transfer_accuracy(): "
+                        "transfer function " + transfer_function->print()
+                        + " is not a standard one");
+    transfer_function
+        = create_transfer_function(standard->transfer_function, accuracy);
+}
+
 template<typename Float>
 void
 Dense_Layer<Float>::
@@ -662,6 +678,191 @@ bbprop(const double * inputs,
                           example_weight);
 }
 
+template<typename Float>
+template<class F>
+void
+Dense_Layer<Float>::
+sparse_activation(const int * indexes, const F * values, size_t n,
+                  F * activations) const
+{
+    int ni = this->inputs(), no = this->outputs();
+    double accum[no];
+    std::copy(bias.begin(), bias.end(), accum);
+
+    for (unsigned j = 0;  j < n;  ++j) {
+        int i = indexes[j];
+        if (i < 0 || i >= ni)
+            throw Exception("Dense_Layer::sparse_activation(): index out "
+                            "of range");
+
+        const Float * w;
+        double input;
+        if (!isnan(values[j])) {
+            input = values[j];
+            w = &weights[i][0];
+        }
+        else {
+            switch (missing_values) {
+            case MV_NONE:
+                throw Exception("missing value with MV_NONE");
+
+            case MV_ZERO:
+                continue;
+
+            case MV_INPUT:
+                input = missing_replacements[i];  w = &weights[i][0];  break;
+
+            case MV_DENSE:
+                input = 1.0;  w = &missing_activations[i][0];  break;
+
+            default:
+                throw Exception("unknown missing values");
+            }
+        }
+
+        SIMD::vec_add(accum, input, w, accum, no);
+    }
+
+    std::copy(accum, accum + no, activations);
+}
+
+template<typename Float>
+void
+Dense_Layer<Float>::
+sparse_apply(const int * indexes, const float * values, size_t n,
+             float * output) const
+{
+    int no = outputs();
+    float act[no];
+    sparse_activation(indexes, values, n, act);
+    transfer_function->transfer(act, output, no);
+}
+
+template<typename Float>
+void
+Dense_Layer<Float>::
+sparse_apply(const int * indexes, const double * values, size_t n,
+             double * output) const
+{
+    int no = outputs();
+    double act[no];
+    sparse_activation(indexes, values, n, act);
+    transfer_function->transfer(act, output, no);
+}
+
+template<typename Float>
+void
+Dense_Layer<Float>::
+sparse_fprop(const int * indexes, const float * values, size_t n,
+             float * temp_space, size_t temp_space_size,
+             float * outputs) const
+{
+    if (temp_space_size != 0)
+        throw Exception("Dense_Layer::sparse_fprop(): wrong temp space size");
+
+    sparse_apply(indexes, values, n, outputs);
+}
+
+template<typename Float>
+void
+Dense_Layer<Float>::
+sparse_fprop(const int * indexes, const double * values, size_t n,
+             double * temp_space, size_t temp_space_size,
+             double * outputs) const
+{
+    if (temp_space_size != 0)
+        throw Exception("Dense_Layer::sparse_fprop(): wrong temp space size");
+
+    sparse_apply(indexes, values, n, outputs);
+}
+
+template<typename Float>
+template<typename F>
+void
+Dense_Layer<Float>::
+sparse_bprop(const int * indexes, const F * values, size_t n,
+             const F * outputs,
+             const F * temp_space, size_t temp_space_size,
+             const F * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    int ni = this->inputs(), no = this->outputs();
+
+    if (temp_space_size != 0)
+        throw Exception("Dense_Layer::sparse_bprop(): wrong temp size");
+
+    F derivs[no];
+    transfer_function->derivative(outputs, derivs, no);
+
+    F dbias[no];
+    SIMD::vec_prod(derivs, &output_errors[0], dbias, no);
+    gradient.vector(1, "bias").update(dbias, example_weight);
+
+    Matrix_Parameter & dweights = gradient.matrix(0, "weights");
+
+    /* Only the rows for the non-zero inputs have a non-zero gradient. */
+    for (unsigned j = 0;  j < n;  ++j) {
+        int i = indexes[j];
+        if (i < 0 || i >= ni)
+            throw Exception("Dense_Layer::sparse_bprop(): index out of range");
+
+        if (!isnan(values[j])) {
+            if (values[j] == 0.0) continue;
+            dweights.update_row(i, dbias, values[j] * example_weight);
+        }
+        else if (missing_values == MV_NONE)
+            throw Exception("MV_NONE but missing value");
+        else if (missing_values == MV_ZERO) {
+            // No update as everything is multiplied by zero
+        }
+        else if (missing_values == MV_DENSE) {
+            gradient.matrix(3, "missing_activations")
+                .update_row(i, dbias, example_weight);
+        }
+        else if (missing_values == MV_INPUT) {
+            dweights.update_row(i, dbias,
+                                missing_replacements[i] * example_weight);
+
+            gradient.vector(2, "missing_replacements")
+                .update_element(i,
+                                (example_weight
+                                 * SIMD::vec_dotprod_dp(&weights[i][0], dbias,
+                                                        no)));
+        }
+    }
+}
+
+template<typename Float>
+void
+Dense_Layer<Float>::
+sparse_bprop(const int * indexes, const float * values, size_t n,
+             const float * outputs,
+             const float * temp_space, size_t temp_space_size,
+             const float * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    sparse_bprop<float>(indexes, values, n, outputs, temp_space,
+                        temp_space_size, output_errors, gradient,
+                        example_weight);
+}
+
+template<typename Float>
+void
+Dense_Layer<Float>::
+sparse_bprop(const int * indexes, const double * values, size_t n,
+             const double * outputs,
+             const double * temp_space, size_t temp_space_size,
+             const double * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    sparse_bprop<double>(indexes, values, n, outputs, temp_space,
+                         temp_space_size, output_errors, gradient,
+                         example_weight);
+}
+
 namespace {
 
 template<typename Float>
@@ -389,6 +389,96 @@ bbprop(const double * inputs,
                                    example_weight);
 }
 
+namespace {
+
+/** Expand a sparse input into a dense one of ni values. */
+template<typename F>
+void expand_sparse(const int * indexes, const F * values, size_t n,
+                   F * dense, size_t ni)
+{
+    std::fill(dense, dense + ni, F(0.0));
+    for (unsigned i = 0;  i < n;  ++i) {
+        if (indexes[i] < 0 || indexes[i] >= ni)
+            throw Exception(format("sparse input index %d out of range 0-%zd",
+                                   indexes[i], ni));
+        dense[indexes[i]] = values[i];
+    }
+}
+
+} // file scope
+
+void
+Layer::
+sparse_apply(const int * indexes, const float * values, size_t n,
+             float * output) const
+{
+    float dense[inputs()];
+    expand_sparse(indexes, values, n, dense, inputs());
+    apply(dense, output);
+}
+
+void
+Layer::
+sparse_apply(const int * indexes, const double * values, size_t n,
+             double * output) const
+{
+    double dense[inputs()];
+    expand_sparse(indexes, values, n, dense, inputs());
+    apply(dense, output);
+}
+
+void
+Layer::
+sparse_fprop(const int * indexes, const float * values, size_t n,
+             float * temp_space, size_t temp_space_size,
+             float * outputs) const
+{
+    float dense[inputs()];
+    expand_sparse(indexes, values, n, dense, inputs());
+    fprop(dense, temp_space, temp_space_size, outputs);
+}
+
+void
+Layer::
+sparse_fprop(const int * indexes, const double * values, size_t n,
+             double * temp_space, size_t temp_space_size,
+             double * outputs) const
+{
+    double dense[inputs()];
+    expand_sparse(indexes, values, n, dense, inputs());
+    fprop(dense, temp_space, temp_space_size, outputs);
+}
+
+void
+Layer::
+sparse_bprop(const int * indexes, const float * values, size_t n,
+             const float * outputs,
+             const float * temp_space, size_t temp_space_size,
+             const float * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    float dense[inputs()];
+    expand_sparse(indexes, values, n, dense, inputs());
+    bprop(dense, outputs, temp_space, temp_space_size, output_errors,
+          0 /* input_errors */, gradient, example_weight);
+}
+
+void
+Layer::
+sparse_bprop(const int * indexes, const double * values, size_t n,
+             const double * outputs,
+             const double * temp_space, size_t temp_space_size,
+             const double * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    double dense[inputs()];
+    expand_sparse(indexes, values, n, dense, inputs());
+    bprop(dense, outputs, temp_space, temp_space_size, output_errors,
+          0 /* input_errors */, gradient, example_weight);
+}
+
 void
 Layer::
 validate() const
@@ -595,8 +595,69 @@ public:
                          F * d2input_errors,
                          Parameters & gradient,
                          Parameters * dgradient,
-                         double example_weight) const; 
- 
+                         double example_weight) const;
+
+    ///@}
+
+
+    /*************************************************************************/
+    /* SPARSE INPUT                                                          */
+    /*************************************************************************/
+
+    /** \name Sparse Input
+
+        These functions are equivalent to apply(), fprop() and bprop() for
+        an input that is mostly zero.  The input is given as the n
+        (index, value) pairs of its non-zero elements; each index must be
+        less than inputs() and may appear only once.  The value may be NaN
+        for a missing input.
+
+        A sparse input is always the input to the whole network, and so the
+        errors with respect to it are never calculated.
+
+        The default implementations expand the input and call the dense
+        versions.  Layers that can do better (ie, with a cost proportional
+        to n rather than inputs()) should override them.
+
+        @{
+    */
+
+    virtual void sparse_apply(const int * indexes, const float * values,
+                              size_t n, float * output) const;
+    virtual void sparse_apply(const int * indexes, const double * values,
+                              size_t n, double * output) const;
+
+    /** Forward propagation for a sparse input.  Uses the same temporary
+        space as fprop(). */
+    virtual void
+    sparse_fprop(const int * indexes, const float * values, size_t n,
+                 float * temp_space, size_t temp_space_size,
+                 float * outputs) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const double * values, size_t n,
+                 double * temp_space, size_t temp_space_size,
+                 double * outputs) const;
+
+    /** Backward propagation for a sparse input.  The same as bprop() with
+        a null input_errors; only the parts of the gradient that depend upon
+        the non-zero inputs need to be updated. */
+    virtual void
+    sparse_bprop(const int * indexes, const float * values, size_t n,
+                 const float * outputs,
+                 const float * temp_space, size_t temp_space_size,
+                 const float * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const double * values, size_t n,
+                 const double * outputs,
+                 const double * temp_space, size_t temp_space_size,
+                 const double * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
     ///@}
 
 
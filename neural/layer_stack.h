@@ -270,6 +270,62 @@ struct Layer_Stack : public Layer {
                         Parameters * dgradient,
                         double example_weight) const;
 
+
+    /*************************************************************************/
+    /* SPARSE INPUT                                                          */
+    /*************************************************************************/
+
+    /* The sparse input goes to the first layer; the rest of the stack is
+       dense. */
+
+    template<typename F>
+    void sparse_apply(const int * indexes, const F * values, size_t n,
+                      F * output) const;
+
+    virtual void sparse_apply(const int * indexes, const float * values,
+                              size_t n, float * output) const;
+    virtual void sparse_apply(const int * indexes, const double * values,
+                              size_t n, double * output) const;
+
+    template<typename F>
+    void sparse_fprop(const int * indexes, const F * values, size_t n,
+                      F * temp_space, size_t temp_space_size,
+                      F * outputs) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const float * values, size_t n,
+                 float * temp_space, size_t temp_space_size,
+                 float * outputs) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const double * values, size_t n,
+                 double * temp_space, size_t temp_space_size,
+                 double * outputs) const;
+
+    template<typename F>
+    void sparse_bprop(const int * indexes, const F * values, size_t n,
+                      const F * outputs,
+                      const F * temp_space, size_t temp_space_size,
+                      const F * output_errors,
+                      Parameters & gradient,
+                      double example_weight) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const float * values, size_t n,
+                 const float * outputs,
+                 const float * temp_space, size_t temp_space_size,
+                 const float * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const double * values, size_t n,
+                 const double * outputs,
+                 const double * temp_space, size_t temp_space_size,
+                 const double * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
     virtual void random_fill(float limit, Thread_Context & context);
 
     virtual void zero_fill();
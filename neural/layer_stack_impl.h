@@ -586,6 +586,205 @@ bbprop(const double * inputs,
                    d2input_errors, gradient, dgradient, example_weight);
 }
 
+template<class LayerT>
+template<typename F>
+void
+Layer_Stack<LayerT>::
+sparse_apply(const int * indexes, const F * values, size_t n,
+             F * output) const
+{
+    if (empty())
+        throw Exception("Layer_Stack::sparse_apply(): no layers");
+
+    F tmp[max_internal_width_];
+
+    for (unsigned l = 0;  l < layers_.size();  ++l) {
+        F * o = (l == layers_.size() - 1 ? output : tmp);
+
+        if (l == 0) layers_[l]->sparse_apply(indexes, values, n, o);
+        else layers_[l]->apply(tmp, o);
+    }
+}
+
+template<class LayerT>
+void
+Layer_Stack<LayerT>::
+sparse_apply(const int * indexes, const float * values, size_t n,
+             float * output) const
+{
+    sparse_apply<float>(indexes, values, n, output);
+}
+
+template<class LayerT>
+void
+Layer_Stack<LayerT>::
+sparse_apply(const int * indexes, const double * values, size_t n,
+             double * output) const
+{
+    sparse_apply<double>(indexes, values, n, output);
+}
+
+template<class LayerT>
+template<class F>
+void
+Layer_Stack<LayerT>::
+sparse_fprop(const int * indexes, const F * values, size_t n,
+             F * temp_space, size_t temp_space_size,
+             F * outputs) const
+{
+    if (empty())
+        throw Exception("Layer_Stack::sparse_fprop(): no layers");
+
+    F * temp_space_start = temp_space;
+    F * temp_space_end = temp_space_start + temp_space_size;
+
+    const F * curr_inputs = 0;
+
+    for (unsigned i = 0;  i < size();  ++i) {
+        int layer_temp_space_size
+            = layers_[i]->fprop_temporary_space_required();
+
+        F * curr_outputs
+            = (i == size() - 1
+               ? outputs
+               : temp_space + layer_temp_space_size);
+
+        if (i == 0)
+            layers_[i]->sparse_fprop(indexes, values, n, temp_space,
+                                     layer_temp_space_size, curr_outputs);
+        else
+            layers_[i]->fprop(curr_inputs, temp_space, layer_temp_space_size,
+                              curr_outputs);
+
+        curr_inputs = curr_outputs;
+
+        temp_space += layer_temp_space_size;
+        if (i != size() - 1) temp_space += layers_[i]->outputs();
+
+        if (temp_space > temp_space_end
+            || (i == size() - 1 && temp_space != temp_space_end))
+            throw Exception("temp space out of sync");
+    }
+}
+
+template<class LayerT>
+void
+Layer_Stack<LayerT>::
+sparse_fprop(const int * indexes, const float * values, size_t n,
+             float * temp_space, size_t temp_space_size,
+             float * outputs) const
+{
+    sparse_fprop<float>(indexes, values, n, temp_space, temp_space_size,
+                        outputs);
+}
+
+template<class LayerT>
+void
+Layer_Stack<LayerT>::
+sparse_fprop(const int * indexes, const double * values, size_t n,
+             double * temp_space, size_t temp_space_size,
+             double * outputs) const
+{
+    sparse_fprop<double>(indexes, values, n, temp_space, temp_space_size,
+                         outputs);
+}
+
+template<class LayerT>
+template<typename F>
+void
+Layer_Stack<LayerT>::
+sparse_bprop(const int * indexes, const F * values, size_t n,
+             const F * outputs,
+             const F * temp_space, size_t temp_space_size,
+             const F * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    if (empty())
+        throw Exception("Layer_Stack::sparse_bprop(): no layers");
+
+    const F * temp_space_start = temp_space;
+    const F * temp_space_end = temp_space_start + temp_space_size;
+    const F * curr_temp_space = temp_space_end;
+
+    const F * curr_outputs = outputs;
+
+    // Storage for the errors kept between the layers
+    F error_storage[max_internal_width() + 1];
+    error_storage[max_internal_width()] = F(0.1234567);
+
+    for (int i = size() - 1;  i >= 0;  --i) {
+        int layer_temp_space_size
+            = layers_[i]->fprop_temporary_space_required();
+
+        curr_temp_space -= layer_temp_space_size;
+
+        if (curr_temp_space < temp_space_start)
+            throw Exception("Layer temp space was out of sync");
+
+        const F * curr_output_errors
+            = (i == size() - 1 ? output_errors : error_storage);
+
+        if (i == 0) {
+            layers_[i]->sparse_bprop(indexes, values, n, curr_outputs,
+                                     curr_temp_space, layer_temp_space_size,
+                                     curr_output_errors,
+                                     gradient.subparams(i, layers_[i]->name()),
+                                     example_weight);
+            break;
+        }
+
+        const F * curr_inputs = curr_temp_space - layers_[i]->inputs();
+
+        layers_[i]->bprop(curr_inputs, curr_outputs, curr_temp_space,
+                          layer_temp_space_size, curr_output_errors,
+                          error_storage,
+                          gradient.subparams(i, layers_[i]->name()),
+                          example_weight);
+
+        // Make sure that we didn't write outside of where we should have
+        if (error_storage[max_internal_width()] != F(0.1234567))
+            throw Exception("Layer_Stack::sparse_bprop(): layer bprop wrote "
+                            "too far");
+
+        curr_outputs = curr_inputs;
+        curr_temp_space -= layers_[i]->inputs();
+    }
+
+    if (curr_temp_space != temp_space_start)
+        throw Exception("Layer_Stack::sparse_bprop(): out of sync");
+}
+
+template<class LayerT>
+void
+Layer_Stack<LayerT>::
+sparse_bprop(const int * indexes, const float * values, size_t n,
+             const float * outputs,
+             const float * temp_space, size_t temp_space_size,
+             const float * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    sparse_bprop<float>(indexes, values, n, outputs, temp_space,
+                        temp_space_size, output_errors, gradient,
+                        example_weight);
+}
+
+template<class LayerT>
+void
+Layer_Stack<LayerT>::
+sparse_bprop(const int * indexes, const double * values, size_t n,
+             const double * outputs,
+             const double * temp_space, size_t temp_space_size,
+             const double * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    sparse_bprop<double>(indexes, values, n, outputs, temp_space,
+                         temp_space_size, output_errors, gradient,
+                         example_weight);
+}
+
 template<class LayerT>
 void
 Layer_Stack<LayerT>::
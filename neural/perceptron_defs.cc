@@ -35,6 +35,23 @@ std::ostream & operator << (std::ostream & stream, Transfer_Function_Type act)
 
 BYTE_PERSISTENT_ENUM_IMPL(Transfer_Function_Type);
 
+std::string print(Transfer_Accuracy accuracy)
+{
+    switch (accuracy) {
+    case TA_ACCURATE: return "ACCURATE";
+    case TA_FAST:     return "FAST";
+
+    default: return format("Transfer_Accuracy(%d)", accuracy);
+    }
+}
+
+std::ostream & operator << (std::ostream & stream, Transfer_Accuracy accuracy)
+{
+    return stream << print(accuracy);
+}
+
+BYTE_PERSISTENT_ENUM_IMPL(Transfer_Accuracy);
+
 std::ostream & operator << (std::ostream & stream, Sampling smp)
 {
     switch (smp) {
@@ -66,6 +83,16 @@ OPT[Enum_Info<ML::Transfer_Function_Type>::NUM] = {
 const char * Enum_Info<ML::Transfer_Function_Type>::NAME
     = "Transfer_Function_Type";
 
+const Enum_Opt<ML::Transfer_Accuracy>
+Enum_Info<ML::Transfer_Accuracy>::
+OPT[Enum_Info<ML::Transfer_Accuracy>::NUM] = {
+    { "accurate",    ML::TA_ACCURATE },
+    { "fast",        ML::TA_FAST     }
+};
+
+const char * Enum_Info<ML::Transfer_Accuracy>::NAME
+    = "Transfer_Accuracy";
+
 const Enum_Opt<ML::Sampling>
 Enum_Info<ML::Sampling>::OPT[Enum_Info<ML::Sampling>::NUM] = {
     { "deterministic", ML::SAMP_DETERMINISTIC },
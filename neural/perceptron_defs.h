@@ -30,6 +30,18 @@ std::ostream & operator << (std::ostream & stream, Transfer_Function_Type fn);
 
 BYTE_PERSISTENT_ENUM_DECL(Transfer_Function_Type);
 
+/** How accurately a transfer function needs to be calculated */
+enum Transfer_Accuracy {
+    TA_ACCURATE,    ///< Within a rounding error or two of the libm functions
+    TA_FAST         ///< Faster single precision approximations
+};
+
+std::string print(Transfer_Accuracy accuracy);
+
+std::ostream & operator << (std::ostream & stream, Transfer_Accuracy accuracy);
+
+BYTE_PERSISTENT_ENUM_DECL(Transfer_Accuracy);
+
 enum Sampling {
     SAMP_DETERMINISTIC,     /// Deterministic; always the same value
     SAMP_BINARY_STOCHASTIC, /// Stochastic; transfer is P(output == 1)
@@ -43,6 +55,7 @@ BYTE_PERSISTENT_ENUM_DECL(Sampling);
 } // namespace ML
 
 DECLARE_ENUM_INFO(ML::Transfer_Function_Type, 6);
+DECLARE_ENUM_INFO(ML::Transfer_Accuracy, 2);
 DECLARE_ENUM_INFO(ML::Sampling, 3);
 
 
@@ -29,6 +29,7 @@
 #include "jml/utils/pair_utils.h"
 #include "jml/neural/dense_layer.h"
 #include "discriminative_trainer.h"
+#include "jml/db/persistent.h"
 
 using namespace std;
 
@@ -66,6 +67,49 @@ struct Stats {
     }
 } stats;
 
+/** Everything that Perceptron_Generator::generate() carries from one
+    iteration to the next. */
+struct Perceptron_Checkpoint {
+    Perceptron_Checkpoint(unsigned iter,
+                          const Perceptron & current, const Perceptron & best,
+                          float best_acc, float best_rmse, int best_iter,
+                          double last_best_acc,
+                          const std::string & rng_state)
+        : iter(iter), current(current), best(best), best_acc(best_acc),
+          best_rmse(best_rmse), best_iter(best_iter),
+          last_best_acc(last_best_acc), rng_state(rng_state)
+    {
+    }
+
+    unsigned iter;
+    Perceptron current;
+    Perceptron best;
+    float best_acc;
+    float best_rmse;
+    int best_iter;
+    double last_best_acc;
+    std::string rng_state;
+
+    void serialize(DB::Store_Writer & store) const
+    {
+        save_checkpoint_header(store, "perceptron", iter);
+        current.serialize(store);
+        best.serialize(store);
+        store << best_acc << best_rmse << best_iter << last_best_acc
+              << rng_state;
+    }
+
+    void reconstitute(DB::Store_Reader & store,
+                      const std::shared_ptr<const Feature_Space> & fs)
+    {
+        iter = load_checkpoint_header(store, "perceptron");
+        current.reconstitute(store, fs);
+        best.reconstitute(store, fs);
+        store >> best_acc >> best_rmse >> best_iter >> last_best_acc
+              >> rng_state;
+    }
+};
+
 } // file scope
 
 
@@ -96,9 +140,11 @@ configure(const Configuration & config)
     config.find(batch_size, "batch_size");
     config.find(activation, "activation");
     config.find(output_activation, "output_activation");
+    config.find(transfer_accuracy, "transfer_accuracy");
     config.find(do_decorrelate, "decorrelate");
     config.find(do_normalize, "normalize");
     config.find(target_value, "target_value");
+    checkpoint.configure(config);
 }
 
 void
@@ -111,10 +157,12 @@ defaults()
     learning_rate = 0.01;
     arch_str = "%i";
     activation = output_activation = TF_TANH;
+    transfer_accuracy = TA_ACCURATE;
     do_decorrelate = true;
     do_normalize = true;
     batch_size = 1024;
     target_value = 0.8;
+    checkpoint.defaults();
 }
 
 Config_Options
@@ -135,13 +183,16 @@ options() const
              "activation function for neurons")
         .add("output_activation", output_activation,
              "activation function for output layer of neurons")
+        .add("transfer_accuracy", transfer_accuracy,
+             "accuracy of activation functions; fast is approximate")
         .add("decorrelate", do_decorrelate,
              "decorrelate the features before training")
         .add("normalize", do_normalize,
              "normalize to zero mean and unit std before training")
         .add("batch_size", batch_size, "0.0-1.0 or 1 - nvectors",
              "number of samples in each \"mini batch\" for stochastic")
-        .add("target_value", target_value, "0.0-1.0", "the output for a 1 that we ask the network to provide");
+        .add("target_value", target_value, "0.0-1.0", "the output for a 1 that we ask the network to provide")
+        .add(checkpoint.options());
     
     return result;
 }
@@ -253,6 +304,32 @@ generate(Thread_Context & context,
             *= -1.0 * training_ex_weights.size() / training_ex_weights.total();
     }
 
+    /* The decorrelation above is repeated on resuming, as it's cheaper than
+       storing the decorrelated data, but the network trained from it and
+       the random numbers are put back the way they were. */
+    unsigned first_iter = 0;
+    if (!checkpoint.resume_from.empty()) {
+        Perceptron_Checkpoint state(0, current, best, best_acc, best_rmse,
+                                    best_iter, last_best_acc,
+                                    context.rng_state());
+        DB::Store_Reader store(checkpoint.resume_from);
+        state.reconstitute(store, model.feature_space());
+
+        current = state.current;
+        best = state.best;
+        best_acc = state.best_acc;
+        best_rmse = state.best_rmse;
+        best_iter = state.best_iter;
+        last_best_acc = state.last_best_acc;
+        context.set_rng_state(state.rng_state);
+
+        first_iter = state.iter + 1;
+        log("perceptron_generator", 1)
+            << "resuming from iteration " << first_iter << endl;
+    }
+
+    Training_Checkpointer checkpointer(checkpoint);
+
     // Create a layer stack without the decorrelation layer to be trained
     Layer_Stack<Layer> train_stack;
     for (unsigned i = 1;  i < current.layers.size();  ++i)
@@ -277,7 +354,7 @@ generate(Thread_Context & context,
                              train_stack, target_value);
 
 
-    for (unsigned i = 0;  i < max_iter;  ++i) {
+    for (unsigned i = first_iter;  i < max_iter;  ++i) {
 
         //cerr << "params = " << Parameters_Copy<float>(train_stack.parameters()).values << endl;
 
@@ -329,7 +406,21 @@ generate(Thread_Context & context,
 
                 
         log("perceptron_generator", 5) << current.print() << endl;
+
+        if (checkpointer.due(i)) {
+            std::shared_ptr<Perceptron_Checkpoint> state
+                (new Perceptron_Checkpoint(i, current, best, best_acc,
+                                           best_rmse, best_iter,
+                                           last_best_acc,
+                                           context.rng_state()));
+            checkpointer.save([=] (DB::Store_Writer & store)
+                              {
+                                  state->serialize(store);
+                              });
+        }
     }
+
+    checkpointer.wait();
     
     if (profile)
         log("perceptron_generator", 1)
@@ -728,18 +819,20 @@ init(const Training_Data & data,
              << units << " units and activation function "
              << activation << endl;
 
-        std::shared_ptr<Layer>
+        std::shared_ptr<Dense_Layer<float> >
             layer(new Dense_Layer<float>(format("hidden%d", i),
                                          nunits, units, activation,
                                          MV_NONE, context));
+        layer->set_transfer_accuracy(transfer_accuracy);
         result.add_layer(layer);
         nunits = units;
     }
     
     /* Add the output units. */
-    std::shared_ptr<Layer> layer
+    std::shared_ptr<Dense_Layer<float> > layer
         (new Dense_Layer<float>("output", nunits, nout, output_activation,
                                 MV_NONE, context));
+    layer->set_transfer_accuracy(transfer_accuracy);
     result.add_layer(layer);
 
     cerr << "adding output layer with " << nout << " units and activation "
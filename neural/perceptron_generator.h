@@ -11,6 +11,7 @@
 
 
 #include "jml/boosting/early_stopping_generator.h"
+#include "jml/boosting/training_checkpoint.h"
 #include "perceptron.h"
 
 
@@ -61,6 +62,7 @@ public:
     unsigned min_iter;
     float learning_rate;
     Transfer_Function_Type activation, output_activation;
+    Transfer_Accuracy transfer_accuracy;
     bool do_decorrelate;
     bool do_normalize;
     float batch_size;
@@ -68,6 +70,10 @@ public:
 
     std::string arch_str;
 
+    /** Where and how often generate() writes checkpoints of its state, and
+        which one to resume from. */
+    Checkpoint_Config checkpoint;
+
     /* Once init has been called, we clone our potential models from this
        one. */
     Perceptron model;
@@ -0,0 +1,143 @@
+/* auto_encoder_trainer_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Tests for the auto-encoder trainer.
+*/
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#undef NDEBUG
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include "jml/neural/auto_encoder_trainer.h"
+#include "jml/neural/twoway_layer.h"
+#include "jml/arch/timers.h"
+#include <cmath>
+
+using namespace ML;
+using namespace std;
+
+using boost::unit_test::test_suite;
+
+namespace {
+
+/* Data that lives on a low dimensional manifold, so that an auto-encoder
+   with fewer hidden units than inputs can learn to reconstruct it. */
+vector<distribution<float> >
+make_data(int nx, int ni, int nlatent, Thread_Context & context)
+{
+    boost::multi_array<float, 2> mixing(boost::extents[nlatent][ni]);
+    for (unsigned i = 0;  i < nlatent;  ++i)
+        for (unsigned j = 0;  j < ni;  ++j)
+            mixing[i][j] = context.random01() * 2.0 - 1.0;
+
+    vector<distribution<float> > result;
+    for (unsigned x = 0;  x < nx;  ++x) {
+        distribution<float> latent(nlatent);
+        for (unsigned i = 0;  i < nlatent;  ++i)
+            latent[i] = context.random01() * 2.0 - 1.0;
+
+        distribution<float> example(ni);
+        for (unsigned j = 0;  j < ni;  ++j) {
+            double total = 0.0;
+            for (unsigned i = 0;  i < nlatent;  ++i)
+                total += latent[i] * mixing[i][j];
+            example[j] = tanh(total);
+        }
+
+        result.push_back(example);
+    }
+
+    return result;
+}
+
+double train_and_test(Auto_Encoder_Trainer & trainer,
+                      Twoway_Layer & layer,
+                      const vector<distribution<float> > & training_data,
+                      const vector<distribution<float> > & testing_data)
+{
+    Thread_Context context;
+    context.seed(42);
+
+    Timer timer;
+    trainer.train(layer, training_data, testing_data, context);
+    cerr << (trainer.hogwild ? "hogwild" : "synchronous") << " training: "
+         << timer.elapsed() << endl;
+
+    return trainer.test(layer, testing_data, context).first;
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_hogwild_converges )
+{
+    Thread_Context context;
+    context.seed(1);
+
+    vector<distribution<float> > training_data
+        = make_data(2500, 20, 4, context);
+    vector<distribution<float> > testing_data
+        (training_data.begin() + 2000, training_data.end());
+    training_data.resize(2000);
+
+    Twoway_Layer layer("test", 20, 10, TF_TANH, MV_INPUT, context);
+
+    Auto_Encoder_Trainer trainer;
+    trainer.verbosity = 0;
+    trainer.niter = 20;
+    trainer.minibatch_size = 64;
+    trainer.prob_cleared = 0.0;
+
+    double initial_rmse = trainer.test(layer, testing_data, context).first;
+
+    Twoway_Layer synchronous = layer;
+    double sync_rmse
+        = train_and_test(trainer, synchronous, training_data, testing_data);
+
+    trainer.hogwild = true;
+    Twoway_Layer hogwild = layer;
+    double hogwild_rmse
+        = train_and_test(trainer, hogwild, training_data, testing_data);
+
+    cerr << "initial rmse " << initial_rmse << " synchronous " << sync_rmse
+         << " hogwild " << hogwild_rmse << endl;
+
+    // Both should have learnt something, and about as much as each other
+    BOOST_CHECK_LT(sync_rmse, initial_rmse * 0.75);
+    BOOST_CHECK_LT(hogwild_rmse, initial_rmse * 0.75);
+    BOOST_CHECK_LT(hogwild_rmse, sync_rmse * 1.1);
+}
+
+BOOST_AUTO_TEST_CASE( test_hogwild_individual_learning_rates )
+{
+    Thread_Context context;
+    context.seed(2);
+
+    vector<distribution<float> > training_data
+        = make_data(1200, 10, 3, context);
+    vector<distribution<float> > testing_data
+        (training_data.begin() + 1000, training_data.end());
+    training_data.resize(1000);
+
+    Twoway_Layer layer("test", 10, 6, TF_TANH, MV_INPUT, context);
+
+    Auto_Encoder_Trainer trainer;
+    trainer.verbosity = 0;
+    trainer.niter = 10;
+    trainer.minibatch_size = 64;
+    trainer.prob_cleared = 0.0;
+    trainer.individual_learning_rates = true;
+    trainer.hogwild = true;
+
+    double initial_rmse = trainer.test(layer, testing_data, context).first;
+    double rmse = train_and_test(trainer, layer, training_data, testing_data);
+
+    cerr << "initial rmse " << initial_rmse << " hogwild individual "
+         << rmse << endl;
+
+    BOOST_CHECK(!isnan(rmse));
+    BOOST_CHECK_LT(rmse, initial_rmse);
+}
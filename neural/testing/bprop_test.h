@@ -604,5 +604,69 @@ void bbprop_test_reconstruct(Layer & layerfwd, Thread_Context & context, double
     bbprop_test<Float>(layer, context, tolerance);
 }
 
+/** Check that the sparse input functions give the same answers as the
+    dense ones for an input with every third value non-zero. */
+template<typename Float, class Layer>
+void sparse_input_test(Layer & layer, Thread_Context & context)
+{
+    int ni = layer.inputs(), no = layer.outputs();
+
+    BOOST_REQUIRE(ni > 0);
+    BOOST_REQUIRE(no > 0);
+
+    std::vector<int> indexes;
+    std::vector<Float> values;
+    distribution<Float> input(ni, 0.0);
+    for (unsigned i = 0;  i < ni;  i += 3) {
+        Float value = 0.5 - context.random01();
+        if (i == 3 && layer.supports_missing_inputs())
+            value = numeric_limits<float>::quiet_NaN();
+        indexes.push_back(i);
+        values.push_back(value);
+        input[i] = value;
+    }
+    int n = indexes.size();
+
+    distribution<Float> output = layer.apply(input);
+    distribution<Float> sparse_output(no);
+    layer.sparse_apply(&indexes[0], &values[0], n, &sparse_output[0]);
+
+    for (unsigned o = 0;  o < no;  ++o)
+        BOOST_CHECK_CLOSE(output[o], sparse_output[o], 0.001);
+
+    size_t temp_space_size = layer.fprop_temporary_space_required();
+    Float temp_space[temp_space_size + 1];
+    Float sparse_temp_space[temp_space_size + 1];
+
+    distribution<Float> fprop_output(no), sparse_fprop_output(no);
+    layer.fprop(&input[0], temp_space, temp_space_size, &fprop_output[0]);
+    layer.sparse_fprop(&indexes[0], &values[0], n, sparse_temp_space,
+                       temp_space_size, &sparse_fprop_output[0]);
+
+    for (unsigned o = 0;  o < no;  ++o)
+        BOOST_CHECK_CLOSE(fprop_output[o], sparse_fprop_output[o], 0.001);
+
+    distribution<Float> output_errors(no);
+    for (unsigned o = 0;  o < no;  ++o)
+        output_errors[o] = 0.5 - context.random01();
+
+    Parameters_Copy<Float> gradient(layer, 0.0), sparse_gradient(layer, 0.0);
+    layer.bprop(&input[0], &fprop_output[0], temp_space, temp_space_size,
+                &output_errors[0], 0, gradient, 1.0);
+    layer.sparse_bprop(&indexes[0], &values[0], n, &sparse_fprop_output[0],
+                       sparse_temp_space, temp_space_size, &output_errors[0],
+                       sparse_gradient, 1.0);
+
+    BOOST_REQUIRE_EQUAL(gradient.values.size(),
+                        sparse_gradient.values.size());
+    for (unsigned i = 0;  i < gradient.values.size();  ++i) {
+        BOOST_TEST_CHECKPOINT("parameter " << i);
+        if (fabs(gradient.values[i]) < 1e-10)
+            BOOST_CHECK_SMALL(sparse_gradient.values[i], (Float)1e-6);
+        else BOOST_CHECK_CLOSE(gradient.values[i], sparse_gradient.values[i],
+                               0.01);
+    }
+}
+
 #endif /* __jml__neural__testing__bprop_test_h__ */
 
@@ -545,3 +545,17 @@ BOOST_AUTO_TEST_CASE( test_bbprop_tanh_double_none2 )
     bbprop_test<double>(layer, context);
 }
 
+BOOST_AUTO_TEST_CASE( test_sparse_input )
+{
+    Thread_Context context;
+
+    Missing_Values mvs[4] = { MV_NONE, MV_ZERO, MV_INPUT, MV_DENSE };
+    for (unsigned i = 0;  i < 4;  ++i) {
+        BOOST_TEST_CHECKPOINT("missing values " << mvs[i]);
+        Dense_Layer<float> layer("test", 20, 10, TF_TANH, mvs[i], context);
+        sparse_input_test<float>(layer, context);
+
+        Dense_Layer<double> layer2("test", 20, 10, TF_TANH, mvs[i], context);
+        sparse_input_test<double>(layer2, context);
+    }
+}
@@ -411,3 +411,24 @@ BOOST_AUTO_TEST_CASE( test_bprop_three_nonlinear_layers )
 
     bprop_test<double>(layers, context, 0.1);
 }
+
+BOOST_AUTO_TEST_CASE( test_sparse_input_layer_stack )
+{
+    Thread_Context context;
+    Dense_Layer<double> layer1("test1", 50, 10, TF_TANH, MV_DENSE, context);
+    Dense_Layer<double> layer2("test2", 10, 20, TF_TANH, MV_NONE, context);
+    Dense_Layer<double> layer3("test3", 20, 5, TF_TANH, MV_NONE,  context);
+
+    Layer_Stack<Dense_Layer<double> > layers("test_layers");
+    layers.add(make_unowned_sp(layer1));
+    sparse_input_test<double>(layers, context);
+
+    layers.add(make_unowned_sp(layer2));
+    layers.add(make_unowned_sp(layer3));
+    sparse_input_test<double>(layers, context);
+    sparse_input_test<float>(layers, context);
+
+    /* Through the generic layer interface. */
+    Layer_Stack<Layer> generic(layers);
+    sparse_input_test<double>(generic, context);
+}
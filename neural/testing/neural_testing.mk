@@ -8,5 +8,8 @@ $(eval $(call test,layer_stack_test,neural utils arch db worker_task,boost))
 $(eval $(call test,discriminative_trainer_test,neural,boost))
 $(eval $(call test,twoway_layer_test,neural utils arch db worker_task,boost manual))
 $(eval $(call test,perceptron_test,neural utils boosting worker_task,boost manual))
+$(eval $(call test,perceptron_checkpoint_test,neural utils boosting worker_task,boost))
 $(eval $(call test,output_encoder_test,neural,boost))
 
+$(eval $(call test,transfer_function_test,neural utils arch db worker_task,boost))
+$(eval $(call test,auto_encoder_trainer_test,neural utils arch worker_task,boost))
@@ -0,0 +1,116 @@
+/* perceptron_checkpoint_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test that perceptron training resumed from a checkpoint finishes the same
+   way as training that was never interrupted.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include "jml/neural/perceptron_generator.h"
+#include "jml/boosting/dense_features.h"
+#include "jml/boosting/feature_info.h"
+#include "jml/boosting/thread_context.h"
+#include "jml/db/persistent.h"
+#include "jml/utils/rng.h"
+
+using namespace ML;
+using namespace ML::DB;
+using namespace std;
+
+size_t nv = 4;
+
+std::string serialized(const Classifier_Impl & classifier)
+{
+    ostringstream stream;
+    {
+        Store_Writer store(stream);
+        classifier.serialize(store);
+    }
+    return stream.str();
+}
+
+/* The updates from each minibatch are added up in whatever order the
+   threads finish, so training is only repeatable without them. */
+Thread_Context single_threaded_context(uint32_t seed)
+{
+    return Thread_Context(std::make_shared<Worker_Task>(0), -1, seed);
+}
+
+BOOST_AUTO_TEST_CASE( test_perceptron_resume )
+{
+    std::shared_ptr<Dense_Feature_Space>
+        fs(new Dense_Feature_Space(vector<string>({ "LABEL", "a", "b",
+                                                    "c" })));
+    fs->set_info(Feature(0), Feature_Info(BOOLEAN, false, true));
+
+    size_t nx = 1000;
+    std::shared_ptr<vector<float> > values(new vector<float>(nx * nv));
+    RNG rng(1);
+    for (unsigned x = 0;  x < nx;  ++x) {
+        float * row = &(*values)[x * nv];
+        row[1] = rng.random01();
+        row[2] = rng.random01();
+        row[3] = rng.random01();
+        row[0] = (row[1] + 0.5 * row[2] + 0.3 * rng.random01() > 0.9);
+    }
+    Dense_Training_Data data(&(*values)[0], nx, nv, fs, values);
+
+    vector<Feature> features = { Feature(1), Feature(2), Feature(3) };
+
+    distribution<float> train_weights(nx, 1.0), validate_weights(nx, 0.0);
+    for (unsigned x = 0;  x < nx;  x += 3) {
+        train_weights[x] = 0.0;
+        validate_weights[x] = 1.0;
+    }
+
+    Perceptron_Generator generator;
+    generator.init(fs, Feature(0));
+    generator.arch_str = "4";
+    generator.batch_size = 50;
+    generator.max_iter = 12;
+    generator.min_iter = 10;
+    generator.verbosity = 0;
+
+    Thread_Context context1 = single_threaded_context(1);
+    std::shared_ptr<Classifier_Impl> uninterrupted
+        = generator.generate(context1, data, data, train_weights,
+                             validate_weights, features);
+
+    /* Stop after 7 iterations, which leaves a checkpoint from after the
+       6th.  The iteration that min_iter picks as the best isn't reached
+       either way. */
+    string filename = "perceptron_checkpoint_test.ckpt";
+    ::unlink(filename.c_str());
+    generator.max_iter = generator.min_iter = 7;
+    generator.checkpoint.file = filename;
+    generator.checkpoint.interval = 3;
+
+    Thread_Context context2 = single_threaded_context(1);
+    generator.generate(context2, data, data, train_weights,
+                       validate_weights, features);
+    BOOST_REQUIRE_EQUAL(::access(filename.c_str(), R_OK), 0);
+
+    generator.max_iter = 12;
+    generator.min_iter = 10;
+    generator.checkpoint.file = "";
+    generator.checkpoint.resume_from = filename;
+
+    /* The random numbers come from the checkpoint, not the seed. */
+    Thread_Context context3 = single_threaded_context(99);
+    std::shared_ptr<Classifier_Impl> resumed
+        = generator.generate(context3, data, data, train_weights,
+                             validate_weights, features);
+
+    BOOST_CHECK(serialized(*resumed) == serialized(*uninterrupted));
+
+    ::unlink(filename.c_str());
+}
@@ -0,0 +1,272 @@
+/* transfer_function_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Unit tests for the vectorized transfer functions.
+*/
+
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#undef NDEBUG
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include "jml/neural/transfer_function.h"
+#include "jml/neural/dense_layer.h"
+#include "jml/db/persistent.h"
+#include "jml/arch/timers.h"
+#include "jml/utils/vector_utils.h"
+#include <boost/assign/list_of.hpp>
+#include <limits>
+#include <cmath>
+
+using namespace ML;
+using namespace ML::DB;
+using namespace std;
+
+using boost::unit_test::test_suite;
+
+namespace {
+
+double reference(Transfer_Function_Type tf, double x)
+{
+    switch (tf) {
+    case TF_IDENTITY: return x;
+    case TF_LOGSIG:   return 1.0 / (1.0 + exp(-x));
+    case TF_TANH:     return tanh(x);
+    case TF_TANHS:    return 1.7159 * tanh(0.66666666666666666666 * x);
+    default:
+        throw Exception("reference(): unknown transfer function");
+    }
+}
+
+/* Activations spread out over the interesting range, including ones near
+   zero and ones that saturate. */
+template<typename Float>
+vector<Float> test_activations()
+{
+    vector<Float> result;
+    for (int i = -2000;  i <= 2000;  ++i)
+        result.push_back(i * 0.01);
+    for (int i = -20;  i <= 20;  ++i)
+        result.push_back(i * 1e-6);
+    result.push_back(-200.0);
+    result.push_back(200.0);
+    result.push_back(-1000.0);
+    result.push_back(1000.0);
+    return result;
+}
+
+template<typename Float>
+void check_transfer(Transfer_Function_Type tf, Transfer_Accuracy accuracy,
+                    double abs_tolerance)
+{
+    vector<Float> act = test_activations<Float>();
+    vector<Float> out(act.size());
+
+    Standard_Transfer_Function fn(tf, accuracy);
+    fn.transfer(&act[0], &out[0], act.size());
+
+    for (unsigned i = 0;  i < act.size();  ++i) {
+        double expected = reference(tf, act[i]);
+        double error = fabs(out[i] - expected);
+        if (error > abs_tolerance)
+            BOOST_CHECK_MESSAGE(false,
+                                "tf " << tf << " accuracy " << accuracy
+                                << " x " << act[i] << " got " << out[i]
+                                << " expected " << expected);
+    }
+}
+
+template<typename Float>
+void check_all(Transfer_Accuracy accuracy, double abs_tolerance)
+{
+    check_transfer<Float>(TF_IDENTITY, accuracy, 0.0);
+    check_transfer<Float>(TF_LOGSIG, accuracy, abs_tolerance);
+    check_transfer<Float>(TF_TANH, accuracy, abs_tolerance);
+    check_transfer<Float>(TF_TANHS, accuracy, 2 * abs_tolerance);
+}
+
+} // file scope
+
+BOOST_AUTO_TEST_CASE( test_accurate_transfer )
+{
+    // Accurate floats are rounded once from the double result
+    check_all<float>(TA_ACCURATE, 2e-7);
+    check_all<double>(TA_ACCURATE, 1e-15);
+}
+
+BOOST_AUTO_TEST_CASE( test_fast_transfer )
+{
+    check_all<float>(TA_FAST, 1e-6);
+    check_all<double>(TA_FAST, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( test_transfer_lengths )
+{
+    // Make sure that the partial vectors at the end are handled properly
+    // and that nothing is written past the end of the output
+    Transfer_Function_Type tfs[4] = { TF_LOGSIG, TF_TANH, TF_TANHS, TF_SOFTMAX };
+    Transfer_Accuracy accuracies[2] = { TA_ACCURATE, TA_FAST };
+
+    for (unsigned t = 0;  t < 4;  ++t) {
+        for (unsigned a = 0;  a < 2;  ++a) {
+            Standard_Transfer_Function fn(tfs[t], accuracies[a]);
+
+            for (unsigned n = 1;  n <= 9;  ++n) {
+                distribution<float> act(n), out(n + 1, -42.0);
+                distribution<double> actd(n), outd(n + 1, -42.0);
+                for (unsigned i = 0;  i < n;  ++i)
+                    act[i] = actd[i] = 0.3 * i - 1.0;
+
+                fn.transfer(&act[0], &out[0], n);
+                fn.transfer(&actd[0], &outd[0], n);
+
+                BOOST_CHECK_EQUAL(out[n], -42.0);
+                BOOST_CHECK_EQUAL(outd[n], -42.0);
+
+                for (unsigned i = 0;  i < n;  ++i) {
+                    BOOST_CHECK_SMALL(out[i] - outd[i], 2e-6);
+                    if (tfs[t] == TF_SOFTMAX) continue;
+                    BOOST_CHECK_SMALL(outd[i] - reference(tfs[t], actd[i]),
+                                      1e-6);
+                }
+
+                if (tfs[t] == TF_SOFTMAX) {
+                    out.pop_back();
+                    outd.pop_back();
+                    BOOST_CHECK_CLOSE(out.total(), 1.0, 1e-4);
+                    BOOST_CHECK_CLOSE(outd.total(), 1.0, 1e-4);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_softmax )
+{
+    distribution<double> act = boost::assign::list_of<double>
+        (0.0)(1.0)(-1.0)(2.5)(-20.0)(3.0)(0.5);
+
+    distribution<double> expected(act.size());
+    double total = 0.0;
+    for (unsigned i = 0;  i < act.size();  ++i)
+        total += expected[i] = exp(act[i]);
+    expected /= total;
+
+    Standard_Transfer_Function accurate(TF_SOFTMAX, TA_ACCURATE);
+    Standard_Transfer_Function fast(TF_SOFTMAX, TA_FAST);
+
+    distribution<double> out1 = accurate.transfer(act);
+    distribution<double> out2 = fast.transfer(act);
+
+    for (unsigned i = 0;  i < act.size();  ++i) {
+        BOOST_CHECK_CLOSE(out1[i], expected[i], 1e-12);
+        BOOST_CHECK_CLOSE(out2[i], expected[i], 1e-4);  // percent
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_transfer_nan )
+{
+    float nan = numeric_limits<float>::quiet_NaN();
+    Transfer_Function_Type tfs[3] = { TF_LOGSIG, TF_TANH, TF_TANHS };
+    Transfer_Accuracy accuracies[2] = { TA_ACCURATE, TA_FAST };
+
+    for (unsigned t = 0;  t < 3;  ++t) {
+        for (unsigned a = 0;  a < 2;  ++a) {
+            Standard_Transfer_Function fn(tfs[t], accuracies[a]);
+            distribution<float> act(5, 0.5), out(5);
+            act[1] = nan;
+            act[4] = nan;
+            fn.transfer(&act[0], &out[0], 5);
+            BOOST_CHECK(isnan(out[1]));
+            BOOST_CHECK(isnan(out[4]));
+            BOOST_CHECK(!isnan(out[0]));
+            BOOST_CHECK_SMALL(out[0] - reference(tfs[t], 0.5), 1e-6);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_serialize_reconstitute_accuracy )
+{
+    Transfer_Accuracy accuracies[2] = { TA_ACCURATE, TA_FAST };
+
+    for (unsigned a = 0;  a < 2;  ++a) {
+        Standard_Transfer_Function fn(TF_TANH, accuracies[a]);
+
+        ostringstream stream_out;
+        {
+            DB::Store_Writer writer(stream_out);
+            fn.poly_serialize(writer);
+        }
+
+        // Accurate ones keep the old format
+        if (accuracies[a] == TA_ACCURATE) {
+            ostringstream stream_new, stream_old;
+            {
+                DB::Store_Writer writer(stream_new);
+                fn.serialize(writer);
+            }
+            {
+                DB::Store_Writer writer(stream_old);
+                writer << (char)0 << TF_TANH;
+            }
+            BOOST_CHECK_EQUAL(stream_new.str(), stream_old.str());
+        }
+
+        istringstream stream_in(stream_out.str());
+        DB::Store_Reader reader(stream_in);
+        std::shared_ptr<Transfer_Function> fn2
+            = Transfer_Function::poly_reconstitute(reader);
+
+        BOOST_CHECK(*fn2 == fn);
+        BOOST_CHECK_EQUAL(fn2->print(), fn.print());
+    }
+
+    BOOST_CHECK(Standard_Transfer_Function(TF_TANH, TA_FAST)
+                != Standard_Transfer_Function(TF_TANH, TA_ACCURATE));
+}
+
+BOOST_AUTO_TEST_CASE( test_dense_layer_transfer_accuracy )
+{
+    Thread_Context context;
+    Dense_Layer<float> layer("test", 20, 10, TF_LOGSIG, MV_ZERO, context);
+    Dense_Layer<float> fast = layer;
+    fast.set_transfer_accuracy(TA_FAST);
+
+    BOOST_CHECK(layer != fast);
+
+    distribution<float> input(20);
+    for (unsigned i = 0;  i < 20;  ++i)
+        input[i] = 0.1 * i - 1.0;
+
+    distribution<float> out1 = layer.apply(input);
+    distribution<float> out2 = fast.apply(input);
+
+    for (unsigned i = 0;  i < 10;  ++i)
+        BOOST_CHECK_SMALL(out1[i] - out2[i], 1e-6f);
+
+    fast.set_transfer_accuracy(TA_ACCURATE);
+    BOOST_CHECK_EQUAL(layer, fast);
+}
+
+BOOST_AUTO_TEST_CASE( test_transfer_speed )
+{
+    distribution<float> act(1000000), out(1000000);
+    for (unsigned i = 0;  i < act.size();  ++i)
+        act[i] = (i % 2000) * 0.01 - 10.0;
+
+    Transfer_Function_Type tfs[3] = { TF_LOGSIG, TF_TANH, TF_SOFTMAX };
+    Transfer_Accuracy accuracies[2] = { TA_ACCURATE, TA_FAST };
+
+    for (unsigned t = 0;  t < 3;  ++t) {
+        for (unsigned a = 0;  a < 2;  ++a) {
+            Standard_Transfer_Function fn(tfs[t], accuracies[a]);
+            Timer timer;
+            fn.transfer(&act[0], &out[0], act.size());
+            cerr << tfs[t] << " " << accuracies[a] << ": "
+                 << timer.elapsed() << endl;
+        }
+    }
+}
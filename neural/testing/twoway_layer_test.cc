@@ -414,3 +414,11 @@ BOOST_AUTO_TEST_CASE( test_bbprop_tanh_double_none3 )
     bbprop_test_reconstruct<double>(layer, context, 3.0);
 }
 #endif
+
+BOOST_AUTO_TEST_CASE( test_sparse_input_twoway )
+{
+    Thread_Context context;
+    Twoway_Layer layer("test", 30, 10, TF_TANH, MV_DENSE, context);
+    sparse_input_test<float>(layer, context);
+    sparse_input_test<double>(layer, context);
+}
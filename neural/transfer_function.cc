@@ -10,6 +10,7 @@
 #include "jml/db/persistent.h"
 #include "jml/boosting/registry.h"
 #include "jml/utils/smart_ptr_utils.h"
+#include "jml/arch/sse2_exp.h"
 
 #include <boost/static_assert.hpp>
 
@@ -113,8 +114,9 @@ second_derivative(const distribution<double> & outputs) const
 /*****************************************************************************/
 
 Standard_Transfer_Function::
-Standard_Transfer_Function(Transfer_Function_Type transfer_function)
-    : transfer_function(transfer_function)
+Standard_Transfer_Function(Transfer_Function_Type transfer_function,
+                           Transfer_Accuracy accuracy)
+    : transfer_function(transfer_function), accuracy(accuracy)
 {
 }
 
@@ -122,7 +124,9 @@ std::string
 Standard_Transfer_Function::
 print() const
 {
-    return ML::print(transfer_function);
+    if (accuracy == TA_ACCURATE)
+        return ML::print(transfer_function);
+    return ML::print(transfer_function) + " (" + ML::print(accuracy) + ")";
 }
 
 Range
@@ -167,8 +171,14 @@ void
 Standard_Transfer_Function::
 serialize(DB::Store_Writer & store) const
 {
-    store << (char)0 // version
-          << transfer_function;
+    // Accurate ones are written in the old format, so that they can still
+    // be read by old code
+    if (accuracy == TA_ACCURATE)
+        store << (char)0 // version
+              << transfer_function;
+    else
+        store << (char)1 // version
+              << transfer_function << accuracy;
 }
 
 void
@@ -177,10 +187,15 @@ reconstitute(DB::Store_Reader & store)
 {
     char version;
     store >> version;
-    if (version != 0)
+    if (version == 0) {
+        store >> transfer_function;
+        accuracy = TA_ACCURATE;
+    }
+    else if (version == 1)
+        store >> transfer_function >> accuracy;
+    else
         throw Exception("Standard_Transfer_Function::reconstitute(): "
                         "unknown version");
-    store >> transfer_function;
 }
 
 std::string
@@ -199,14 +214,206 @@ equal(const Transfer_Function & other) const
     if (!other_cast)
         return false;  // not a standard transfer function...
 
-    return transfer_function == other_cast->transfer_function;
+    return transfer_function == other_cast->transfer_function
+        && accuracy == other_cast->accuracy;
+}
+
+namespace {
+
+using namespace ML::SIMD;
+
+JML_ALWAYS_INLINE v2df select(v2df mask, v2df if_true, v2df if_false)
+{
+    return _mm_or_pd(_mm_and_pd(mask, if_true),
+                     _mm_andnot_pd(mask, if_false));
+}
+
+JML_ALWAYS_INLINE v4sf select(v4sf mask, v4sf if_true, v4sf if_false)
+{
+    return _mm_or_ps(_mm_and_ps(mask, if_true),
+                     _mm_andnot_ps(mask, if_false));
+}
+
+JML_ALWAYS_INLINE v2df vec_abs(v2df x)
+{
+    return _mm_andnot_pd(vec_splat(-0.0), x);
+}
+
+JML_ALWAYS_INLINE v4sf vec_abs(v4sf x)
+{
+    return _mm_andnot_ps(vec_splat(-0.0f), x);
+}
+
+/* Double precision versions, used for TA_ACCURATE. */
+
+inline v2df exp_dp(v2df x)
+{
+    return sse2_exp(x);
+}
+
+inline v2df logsig_dp(v2df x)
+{
+    v2df one = vec_splat(1.0);
+    return one / (one + sse2_exp(-x));
+}
+
+inline v2df tanh_dp(v2df x)
+{
+    // tanh(x) = 1 - 2 / (exp(2x) + 1).  This loses relative precision as
+    // x approaches zero, so there we use the start of the Taylor series,
+    // x - x^3/3, whose error is below 2x^5/15.
+    v2df one = vec_splat(1.0), two = vec_splat(2.0);
+    v2df result = one - two / (sse2_exp(two * x) + one);
+    v2df taylor = x - x * x * x * vec_splat(1.0 / 3.0);
+    return select(_mm_cmplt_pd(vec_abs(x), vec_splat(1e-4)), taylor, result);
+}
+
+inline v2df tanhs_dp(v2df x)
+{
+    return vec_splat(1.7159) * tanh_dp(vec_splat(0.66666666666666666666) * x);
+}
+
+/* Single precision versions, used for TA_FAST. */
+
+inline v4sf exp_sp(v4sf x)
+{
+    return sse2_expf(x);
+}
+
+inline v4sf logsig_sp(v4sf x)
+{
+    v4sf one = vec_splat(1.0f);
+    return one / (one + sse2_expf(-x));
+}
+
+inline v4sf tanh_sp(v4sf x)
+{
+    v4sf one = vec_splat(1.0f), two = vec_splat(2.0f);
+    v4sf result = one - two / (sse2_expf(two * x) + one);
+    v4sf taylor = x - x * x * x * vec_splat(1.0f / 3.0f);
+    return select(_mm_cmplt_ps(vec_abs(x), vec_splat(0.01f)), taylor, result);
+}
+
+inline v4sf tanhs_sp(v4sf x)
+{
+    return vec_splat(1.7159f) * tanh_sp(vec_splat(0.6666666666f) * x);
+}
+
+/* Apply a double precision function to n values, two at a time.  The input
+   and output may be the same array. */
+
+template<v2df (*Fn) (v2df)>
+void apply_dp(const double * input, double * output, int n)
+{
+    int i = 0;
+    for (;  i + 2 <= n;  i += 2)
+        _mm_storeu_pd(output + i, Fn(_mm_loadu_pd(input + i)));
+
+    if (i < n)
+        output[i] = _mm_cvtsd_f64(Fn(vec_splat(input[i])));
+}
+
+template<v2df (*Fn) (v2df)>
+void apply_dp(const float * input, float * output, int n)
+{
+    int i = 0;
+    for (;  i + 4 <= n;  i += 4) {
+        v4sf x = _mm_loadu_ps(input + i);
+        v2df lo = Fn(_mm_cvtps_pd(x));
+        v2df hi = Fn(_mm_cvtps_pd(_mm_movehl_ps(x, x)));
+        _mm_storeu_ps(output + i,
+                      _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi)));
+    }
+
+    for (;  i < n;  ++i)
+        output[i] = _mm_cvtsd_f64(Fn(vec_splat((double)input[i])));
+}
+
+/* Apply a single precision function to n values, four at a time. */
+
+template<v4sf (*Fn) (v4sf)>
+void apply_sp(const float * input, float * output, int n)
+{
+    int i = 0;
+    for (;  i + 4 <= n;  i += 4)
+        _mm_storeu_ps(output + i, Fn(_mm_loadu_ps(input + i)));
+
+    for (;  i < n;  ++i)
+        output[i] = _mm_cvtss_f32(Fn(vec_splat(input[i])));
+}
+
+template<v4sf (*Fn) (v4sf)>
+void apply_sp(const double * input, double * output, int n)
+{
+    int i = 0;
+    for (;  i + 4 <= n;  i += 4) {
+        v4sf x = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(input + i)),
+                               _mm_cvtpd_ps(_mm_loadu_pd(input + i + 2)));
+        x = Fn(x);
+        _mm_storeu_pd(output + i, _mm_cvtps_pd(x));
+        _mm_storeu_pd(output + i + 2, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+
+    for (;  i < n;  ++i)
+        output[i] = _mm_cvtss_f32(Fn(vec_splat((float)input[i])));
+}
+
+template<typename F>
+void logsig_batch(const F * input, F * output, int n,
+                  Transfer_Accuracy accuracy)
+{
+    if (accuracy == TA_FAST) apply_sp<logsig_sp>(input, output, n);
+    else apply_dp<logsig_dp>(input, output, n);
+}
+
+template<typename F>
+void exp_batch(const F * input, F * output, int n,
+               Transfer_Accuracy accuracy)
+{
+    if (accuracy == TA_FAST) apply_sp<exp_sp>(input, output, n);
+    else apply_dp<exp_dp>(input, output, n);
+}
+
+/* The double precision tanh loses a few bits near zero, which matters for
+   double outputs but not for float ones; double outputs use libm. */
+
+void tanh_batch(const float * input, float * output, int n,
+                Transfer_Accuracy accuracy)
+{
+    if (accuracy == TA_FAST) apply_sp<tanh_sp>(input, output, n);
+    else apply_dp<tanh_dp>(input, output, n);
+}
+
+void tanh_batch(const double * input, double * output, int n,
+                Transfer_Accuracy accuracy)
+{
+    if (accuracy == TA_FAST) apply_sp<tanh_sp>(input, output, n);
+    else for (unsigned i = 0;  i < n;  ++i) output[i] = tanh(input[i]);
+}
+
+void tanhs_batch(const float * input, float * output, int n,
+                 Transfer_Accuracy accuracy)
+{
+    if (accuracy == TA_FAST) apply_sp<tanhs_sp>(input, output, n);
+    else apply_dp<tanhs_dp>(input, output, n);
+}
+
+void tanhs_batch(const double * input, double * output, int n,
+                 Transfer_Accuracy accuracy)
+{
+    if (accuracy == TA_FAST) apply_sp<tanhs_sp>(input, output, n);
+    else for (unsigned i = 0;  i < n;  ++i)
+        output[i] = 1.7159 * tanh(0.66666666666666666666 * input[i]);
 }
 
+} // file scope
+
 template<typename FloatIn>
 void
 Standard_Transfer_Function::
 transfer(const FloatIn * activation, FloatIn * outputs, int nvals,
-         Transfer_Function_Type transfer_function)
+         Transfer_Function_Type transfer_function,
+         Transfer_Accuracy accuracy)
 {
     switch (transfer_function) {
     case TF_IDENTITY:
@@ -214,33 +421,25 @@ transfer(const FloatIn * activation, FloatIn * outputs, int nvals,
         return;
         
     case TF_LOGSIG:
-        for (unsigned i = 0;  i < nvals;  ++i) {
-            // See https://bugzilla.redhat.com/show_bug.cgi?id=521190
-            // for why we use double version of exp
-            outputs[i] = 1.0 / (1.0 + exp((double)-activation[i]));
-        }
+        logsig_batch(activation, outputs, nvals, accuracy);
         break;
         
     case TF_TANH:
-        for (unsigned i = 0;  i < nvals;  ++i)
-            outputs[i] = tanh(activation[i]);
+        tanh_batch(activation, outputs, nvals, accuracy);
         break;
         
     case TF_TANHS:
-        for (unsigned i = 0;  i < nvals;  ++i)
-            outputs[i] = 1.7159 * tanh(0.66666666666666666666 * activation[i]);
+        tanhs_batch(activation, outputs, nvals, accuracy);
         break;
         
     case TF_SOFTMAX: {
+        exp_batch(activation, outputs, nvals, accuracy);
+
         double total = 0.0;
-        
-        for (unsigned i = 0;  i < nvals;  ++i) {
-            // See https://bugzilla.redhat.com/show_bug.cgi?id=521190
-            // for why we use double version of exp
-            total += (outputs[i] = exp((double)activation[i]));
-        }
+        for (unsigned i = 0;  i < nvals;  ++i)
+            total += outputs[i];
 
-        double factor = 1.0 / total;
+        FloatIn factor = 1.0 / total;
 
         for (unsigned i = 0;  i < nvals;  ++i)
             outputs[i] *= factor;
@@ -257,14 +456,14 @@ void
 Standard_Transfer_Function::
 transfer(const float * activation, float * outputs, size_t n) const
 {
-    transfer(activation, outputs, n, transfer_function);
+    transfer(activation, outputs, n, transfer_function, accuracy);
 }
 
 void
 Standard_Transfer_Function::
 transfer(const double * activation, double * outputs, size_t n) const
 {
-    transfer(activation, outputs, n, transfer_function);
+    transfer(activation, outputs, n, transfer_function, accuracy);
 }
 
 template<typename FloatIn>
@@ -391,9 +590,10 @@ Register_Factory<Transfer_Function, Standard_Transfer_Function>
 /*****************************************************************************/
 
 std::shared_ptr<Transfer_Function>
-create_transfer_function(const Transfer_Function_Type & function)
+create_transfer_function(const Transfer_Function_Type & function,
+                         Transfer_Accuracy accuracy)
 {
-    return make_sp(new Standard_Transfer_Function(function));
+    return make_sp(new Standard_Transfer_Function(function, accuracy));
 }
 
 std::shared_ptr<Transfer_Function>
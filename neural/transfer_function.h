@@ -186,15 +186,29 @@ struct Transfer_Function {
 /*****************************************************************************/
 
 /** A transfer function that implements, in a switched manner, the standard
-    ones.  The only parameter is the Transfer_Function_Type which tells
-    us which one is being used.
+    ones.  The Transfer_Function_Type tells us which one is being used.
+
+    The functions are calculated four (float) or two (double) values at a
+    time using SSE2.  The accuracy tells us how:
+
+    - TA_ACCURATE calculates in double precision.  The results are within
+      a rounding error or two of those of the libm functions.
+    - TA_FAST calculates the exponentials in single precision, even for
+      double inputs.  The outputs of logsig and tanh are within 1e-6 of the
+      accurate ones (2e-6 for tanhs), and those of softmax within 1e-6
+      relative.
+
+    The derivatives are simple functions of the outputs and are the same
+    in both cases.
 */
 
 struct Standard_Transfer_Function : public Transfer_Function {
     Standard_Transfer_Function(Transfer_Function_Type transfer_function
-                                   = TF_IDENTITY);
+                                   = TF_IDENTITY,
+                               Transfer_Accuracy accuracy = TA_ACCURATE);
 
     Transfer_Function_Type transfer_function;
+    Transfer_Accuracy accuracy;
 
     virtual ~Standard_Transfer_Function() {}
 
@@ -220,7 +234,8 @@ struct Standard_Transfer_Function : public Transfer_Function {
     template<typename FloatIn>
     static void transfer(const FloatIn * activation, FloatIn * outputs,
                          int nvals,
-                         Transfer_Function_Type transfer_function);
+                         Transfer_Function_Type transfer_function,
+                         Transfer_Accuracy accuracy = TA_ACCURATE);
         
     virtual void transfer(const float * activation, float * outputs,
                           size_t n) const;
@@ -274,7 +289,8 @@ struct Standard_Transfer_Function : public Transfer_Function {
 /*****************************************************************************/
 
 std::shared_ptr<Transfer_Function>
-create_transfer_function(const Transfer_Function_Type & function);
+create_transfer_function(const Transfer_Function_Type & function,
+                         Transfer_Accuracy accuracy = TA_ACCURATE);
 
 std::shared_ptr<Transfer_Function>
 create_transfer_function(const std::string & name);
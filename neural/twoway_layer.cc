@@ -205,6 +205,70 @@ bbprop(const double * inputs,
                           example_weight);
 }
 
+void
+Twoway_Layer::
+sparse_apply(const int * indexes, const float * values, size_t n,
+             float * output) const
+{
+    forward.sparse_apply(indexes, values, n, output);
+}
+
+void
+Twoway_Layer::
+sparse_apply(const int * indexes, const double * values, size_t n,
+             double * output) const
+{
+    forward.sparse_apply(indexes, values, n, output);
+}
+
+void
+Twoway_Layer::
+sparse_fprop(const int * indexes, const float * values, size_t n,
+             float * temp_space, size_t temp_space_size,
+             float * outputs) const
+{
+    forward.sparse_fprop(indexes, values, n, temp_space, temp_space_size,
+                         outputs);
+}
+
+void
+Twoway_Layer::
+sparse_fprop(const int * indexes, const double * values, size_t n,
+             double * temp_space, size_t temp_space_size,
+             double * outputs) const
+{
+    forward.sparse_fprop(indexes, values, n, temp_space, temp_space_size,
+                         outputs);
+}
+
+void
+Twoway_Layer::
+sparse_bprop(const int * indexes, const float * values, size_t n,
+             const float * outputs,
+             const float * temp_space, size_t temp_space_size,
+             const float * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    forward.sparse_bprop(indexes, values, n, outputs, temp_space,
+                         temp_space_size, output_errors, gradient,
+                         example_weight);
+}
+
+void
+Twoway_Layer::
+sparse_bprop(const int * indexes, const double * values, size_t n,
+             const double * outputs,
+             const double * temp_space, size_t temp_space_size,
+             const double * output_errors,
+             Parameters & gradient,
+             double example_weight) const
+{
+    forward.sparse_bprop(indexes, values, n, outputs, temp_space,
+                         temp_space_size, output_errors, gradient,
+                         example_weight);
+}
+
 std::pair<float, float>
 Twoway_Layer::
 itargets(float maximum) const
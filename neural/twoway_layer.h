@@ -139,6 +139,37 @@ struct Twoway_Layer : public Auto_Encoder {
                         Parameters & gradient,
                         Parameters * dgradient,
                         double example_weight) const;
+
+    virtual void sparse_apply(const int * indexes, const float * values,
+                              size_t n, float * output) const;
+    virtual void sparse_apply(const int * indexes, const double * values,
+                              size_t n, double * output) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const float * values, size_t n,
+                 float * temp_space, size_t temp_space_size,
+                 float * outputs) const;
+
+    virtual void
+    sparse_fprop(const int * indexes, const double * values, size_t n,
+                 double * temp_space, size_t temp_space_size,
+                 double * outputs) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const float * values, size_t n,
+                 const float * outputs,
+                 const float * temp_space, size_t temp_space_size,
+                 const float * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
+
+    virtual void
+    sparse_bprop(const int * indexes, const double * values, size_t n,
+                 const double * outputs,
+                 const double * temp_space, size_t temp_space_size,
+                 const double * output_errors,
+                 Parameters & gradient,
+                 double example_weight) const;
     
 
     /*************************************************************************/
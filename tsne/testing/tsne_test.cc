@@ -59,6 +59,35 @@ BOOST_AUTO_TEST_CASE( test_vectors_to_distances )
                               tolerance);
 }
 
+/* Enough points that X is processed in several cache tiles. */
+BOOST_AUTO_TEST_CASE( test_vectors_to_distances_tiled )
+{
+    int dims[] = { 3, 40 };
+
+    for (unsigned t = 0;  t < 2;  ++t) {
+        int n = 2000, d = dims[t];
+        BOOST_TEST_CHECKPOINT("d = " << d);
+
+        boost::multi_array<float, 2> vectors(boost::extents[n][d]);
+        for (unsigned i = 0;  i < n;  ++i)
+            for (unsigned j = 0;  j < d;  ++j)
+                vectors[i][j] = ((i * 37 + j * 11) % 101) / 50.0 - 1.0;
+
+        boost::multi_array<float, 2> distances
+            = vectors_to_distances(vectors);
+
+        for (unsigned i = 0;  i < n;  i += 7) {
+            for (unsigned j = 0;  j < n;  ++j) {
+                double expected = 0.0;
+                for (unsigned k = 0;  k < d;  ++k)
+                    expected += sqr(vectors[i][k] - vectors[j][k]);
+                if (abs(distances[i][j] - expected) > 1e-3 * (1.0 + expected))
+                    BOOST_CHECK_CLOSE(distances[i][j], expected, 0.1);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE( test_perplexity_and_prob1 )
 {
     static const double D [100] = {
@@ -23,6 +23,7 @@
 #include "jml/arch/sse2.h"
 #include "jml/arch/sse2_log.h"
 #include "jml/arch/cache.h"
+#include "jml/arch/tile_tuning.h"
 #include "jml/utils/guard.h"
 #include <boost/bind.hpp>
 #include "jml/utils/environment.h"
@@ -37,12 +38,13 @@ struct V2D_Job {
     boost::multi_array<Float, 2> & D;
     const Float * sum_X;
     int i0, i1;
+    int j_tile;
     
     V2D_Job(const boost::multi_array<Float, 2> & X,
             boost::multi_array<Float, 2> & D,
             const Float * sum_X,
-            int i0, int i1)
-        : X(X), D(D), sum_X(sum_X), i0(i0), i1(i1)
+            int i0, int i1, int j_tile)
+        : X(X), D(D), sum_X(sum_X), i0(i0), i1(i1), j_tile(j_tile)
     {
     }
 
@@ -89,33 +91,76 @@ struct V2D_Job {
                 }
             }
         }
-        else if (d < 8) {
-            for (unsigned i = i0;  i < i1;  ++i) {
-                D[i][i] = 0.0f;
-                for (unsigned j = 0;  j < i;  ++j) {
-                    float XXT = 0.0;
-                    for (unsigned k = 0;  k < d;  ++k)
-                        XXT += X[i][k] * X[j][k];
-                    
-                    Float val = sum_X[i] + sum_X[j] - 2.0f * XXT;
-                    D[i][j] = val;
-                }
-            }
-        }
         else {
-            for (unsigned i = i0;  i < i1;  ++i) {
+            for (unsigned i = i0;  i < i1;  ++i)
                 D[i][i] = 0.0f;
-                for (unsigned j = 0;  j < i;  ++j) {
-                    // accum in double precision for accuracy
-                    Float XXT = SIMD::vec_dotprod_dp(&X[i][0], &X[j][0], d);
-                    Float val = sum_X[i] + sum_X[j] - 2.0f * XXT;
-                    D[i][j] = val;
+
+            /* Walk through the rows of X a tile at a time, doing all of our
+               rows against each tile while it's in the cache rather than
+               streaming all of X once per row. */
+            for (unsigned j0 = 0;  j0 < i1;  j0 += j_tile) {
+                unsigned j1 = std::min<unsigned>(i1, j0 + j_tile);
+                for (unsigned i = std::max<unsigned>(i0, j0 + 1);  i < i1;
+                     ++i) {
+                    unsigned jend = std::min(j1, i);
+                    if (d < 8) {
+                        for (unsigned j = j0;  j < jend;  ++j) {
+                            float XXT = 0.0;
+                            for (unsigned k = 0;  k < d;  ++k)
+                                XXT += X[i][k] * X[j][k];
+                    
+                            Float val = sum_X[i] + sum_X[j] - 2.0f * XXT;
+                            D[i][j] = val;
+                        }
+                    }
+                    else {
+                        for (unsigned j = j0;  j < jend;  ++j) {
+                            // accum in double precision for accuracy
+                            Float XXT
+                                = SIMD::vec_dotprod_dp(&X[i][0], &X[j][0], d);
+                            Float val = sum_X[i] + sum_X[j] - 2.0f * XXT;
+                            D[i][j] = val;
+                        }
+                    }
                 }
             }
         }
     }
 };
 
+/* Run the V2D jobs over the whole of D, with the given tile size. */
+template<typename Float>
+void run_v2d_jobs(const boost::multi_array<Float, 2> & X,
+                  boost::multi_array<Float, 2> & D,
+                  const Float * sum_X,
+                  int j_tile)
+{
+    int n = X.shape()[0];
+
+    Worker_Task & worker = Worker_Task::instance(num_threads() - 1);
+
+    int group;
+    {
+        int parent = -1;  // no parent group
+        group = worker.get_group(NO_JOB, "", parent);
+        Call_Guard guard(boost::bind(&Worker_Task::unlock_group,
+                                     boost::ref(worker),
+                                     group));
+        
+        int chunk_size = 64;
+        
+        for (int i = n;  i > 0;  i -= chunk_size) {
+            int i0 = max(0, i - chunk_size);
+            int i1 = i;
+            
+            worker.add(V2D_Job<Float>(X, D, sum_X, i0, i1, j_tile),
+                       "", group);
+        }
+    }
+    
+    worker.run_until_finished(group);
+}
+
 template<typename Float>
 void
 vectors_to_distances(const boost::multi_array<Float, 2> & X,
@@ -149,29 +194,17 @@ vectors_to_distances(const boost::multi_array<Float, 2> & X,
         for (unsigned i = 0;  i < n;  ++i)
             sum_X[i] = SIMD::vec_dotprod_dp(&X[i][0], &X[i][0], d);
     }
-    
-    Worker_Task & worker = Worker_Task::instance(num_threads() - 1);
 
-    int group;
-    {
-        int parent = -1;  // no parent group
-        group = worker.get_group(NO_JOB, "", parent);
-        Call_Guard guard(boost::bind(&Worker_Task::unlock_group,
-                                     boost::ref(worker),
-                                     group));
-        
-        int chunk_size = 64;
-        
-        for (int i = n;  i > 0;  i -= chunk_size) {
-            int i0 = max(0, i - chunk_size);
-            int i1 = i;
-            
-            worker.add(V2D_Job<Float>(X, D, &sum_X[0], i0, i1),
-                       "", group);
-        }
-    }
-    
-    worker.run_until_finished(group);
+    /* Tiles of X take half of the L1 cache. */
+    size_t row_bytes = d * sizeof(Float);
+    int j_tile = cache_tile_items(row_bytes, l1_cache_size(), 16, 1 << 20);
+    if (tile_autotune_enabled() && d > 2)
+        j_tile = tuned_tile_size
+            (format("vectors_to_distances/%d", tile_size_class(row_bytes)),
+             j_tile, tile_candidates(j_tile, 16, 1 << 20),
+             [&] (size_t tile) { run_v2d_jobs(X, D, &sum_X[0], tile); });
+
+    run_v2d_jobs(X, D, &sum_X[0], j_tile);
 
     if (fill_upper)
         copy_lower_to_upper(D);
@@ -7,7 +7,9 @@
 
 #include "csv.h"
 #include "parse_context.h"
+#include "fast_float_parsing.h"
 #include "jml/arch/format.h"
+#include "jml/arch/sse2_scan.h"
 
 using namespace std;
 
@@ -76,16 +78,62 @@ std::string expect_csv_field(Parse_Context & context, bool & another,
     return result;
 }
 
-std::vector<std::string>
-expect_csv_row(Parse_Context & context, int length, char separator)
+namespace {
+
+/** Parse a CSV row directly out of the text between begin and end, which
+    is a contiguous buffer.  Returns a pointer to the end of line
+    character that finishes the row, or zero if the row doesn't finish
+    within the text or has an error (which the character by character
+    parser will then report). */
+const char * parse_csv_row(const char * begin, const char * end,
+                           char separator, std::vector<Csv_Field> & fields)
 {
-    //    cerr << "*** parsing" << endl;
+    fields.clear();
 
-    context.skip_whitespace();
+    const char * p = begin;
+    if (p == end) return 0;
+    if (*p == '\n' || *p == '\r') return p;  // empty row
+
+    for (;;) {
+        if (p == end) return 0;
+
+        if (*p == '\"') {
+            const char * start = p + 1;
+            const char * q = start;
+            bool escaped = false;
+
+            for (;;) {
+                q = SIMD::find_first_of(q, end, '\"');
+                if (q == end || q + 1 == end) return 0;
+                if (q[1] != '\"') break;
+                escaped = true;
+                q += 2;
+            }
+
+            fields.push_back(Csv_Field(start, q, escaped));
+            p = q + 1;
+            if (*p == separator) {
+                ++p;
+                continue;
+            }
+            if (*p == '\n' || *p == '\r') return p;
+            return 0;
+        }
+
+        const char * q
+            = SIMD::find_first_of(p, end, separator, '\n', '\r', '\"');
+        if (q == end || *q == '\"') return 0;
+
+        fields.push_back(Csv_Field(p, q));
+        if (*q != separator) return q;
+        p = q + 1;
+    }
+}
 
+std::vector<std::string>
+expect_csv_row_slow(Parse_Context & context, char separator)
+{
     vector<string> result;
-    if (length != -1)
-        result.reserve(length);
 
     bool another = false;
     while (another || (context && !context.match_eol())) {
@@ -93,15 +141,102 @@ expect_csv_row(Parse_Context & context, int length, char separator)
         //cerr << "read " << result.back() << " another = " << another << endl;
     }
 
-    if (length != -1 && result.size() != length)
+    return result;
+}
+
+} // file scope
+
+void expect_csv_row(Parse_Context & context,
+                    std::vector<Csv_Field> & fields,
+                    std::string & storage,
+                    int length, char separator)
+{
+    context.skip_whitespace();
+
+    const char * end = context.buffered_end();
+    const char * eol
+        = parse_csv_row(context.buffered_begin(), end, separator, fields);
+
+    /* Matching the end of line mustn't take us into the next buffer, as
+       that can free the one that the fields point into. */
+    if (eol && end - eol > 2) {
+        context.advance_to(eol);
+        context.match_eol();
+    }
+    else {
+        vector<string> row = expect_csv_row_slow(context, separator);
+
+        size_t total = 0;
+        for (unsigned i = 0;  i < row.size();  ++i)
+            total += row[i].size();
+
+        storage.clear();
+        storage.reserve(total);
+        for (unsigned i = 0;  i < row.size();  ++i)
+            storage += row[i];
+
+        fields.clear();
+        const char * p = storage.data();
+        for (unsigned i = 0;  i < row.size();  ++i) {
+            fields.push_back(Csv_Field(p, p + row[i].size()));
+            p += row[i].size();
+        }
+    }
+
+    if (length != -1 && fields.size() != length)
         context.exception(format("Wrong CSV length: expected %d, got %zd",
-                                 length, result.size()));
-    
-    //cerr << "returning result" << endl;
+                                 length, fields.size()));
+}
+
+std::vector<std::string>
+expect_csv_row(Parse_Context & context, int length, char separator)
+{
+    vector<Csv_Field> fields;
+    string storage;
+    expect_csv_row(context, fields, storage, length, separator);
+
+    vector<string> result;
+    result.reserve(fields.size());
+    for (unsigned i = 0;  i < fields.size();  ++i)
+        result.push_back(fields[i].str());
 
     return result;
 }
 
+
+/*****************************************************************************/
+/* CSV_FIELD                                                                 */
+/*****************************************************************************/
+
+std::string
+Csv_Field::
+str() const
+{
+    if (!escaped) return string(start, finish);
+
+    string result;
+    result.reserve(length());
+    for (const char * p = start;  p < finish;  ++p) {
+        result += *p;
+        if (*p == '\"') ++p;  // skip the second of the pair
+    }
+    return result;
+}
+
+bool
+Csv_Field::
+match_float(float & val) const
+{
+    return !escaped && ML::match_float(val, start, finish);
+}
+
+bool
+Csv_Field::
+match_double(double & val) const
+{
+    return !escaped && ML::match_float(val, start, finish);
+}
+
 std::string csv_escape(const std::string & s)
 {
     int quote_pos = s.find('"');
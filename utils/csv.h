@@ -26,6 +26,42 @@ std::string expect_csv_field(Parse_Context & context, bool & another,
 std::vector<std::string>
 expect_csv_row(Parse_Context & context, int length = -1, char separator = ',');
 
+/** A field of a CSV row that points into the text that was parsed rather
+    than being copied out of it.  Quoted fields don't include the quotes,
+    but any doubled quotes inside are still doubled. */
+struct Csv_Field {
+    Csv_Field(const char * start = 0, const char * finish = 0,
+              bool escaped = false)
+        : start(start), finish(finish), escaped(escaped)
+    {
+    }
+
+    const char * start;   ///< First character of the field
+    const char * finish;  ///< One past the last character of the field
+    bool escaped;         ///< Contains doubled quotes that need unescaping
+
+    size_t length() const { return finish - start; }
+    bool empty() const { return start == finish; }
+
+    /** Return the (unescaped) contents of the field. */
+    std::string str() const;
+
+    /** Parse the field as a number.  Returns false unless the whole field
+        is a number. */
+    bool match_float(float & val) const;
+    bool match_double(double & val) const;
+};
+
+/** Expect a row of CSV from the given parse context, returning views of
+    the fields rather than copies.  The views point into the context's
+    buffer where possible, and otherwise into storage.  They are valid
+    until the context or storage is next used.  If length is not -1, then
+    the exact number of fields required is given in that parameter. */
+void expect_csv_row(Parse_Context & context,
+                    std::vector<Csv_Field> & fields,
+                    std::string & storage,
+                    int length = -1, char separator = ',');
+
 /** Convert the string to a CSV representation, escaping everything that
     needs to be escaped. */
 std::string csv_escape(const std::string & s);
@@ -26,11 +26,13 @@
 
 #include "jml/utils/parse_context.h"
 #include <limits>
+#include <algorithm>
 #include <errno.h>
+#include <limits.h>
 
 namespace ML {
 
-double binary_exp10 [10] = {
+static const double binary_exp10 [10] = {
     10,
     100,
     1e4,
@@ -43,7 +45,7 @@ double binary_exp10 [10] = {
     INFINITY
 };
 
-double binary_exp10_neg [10] = {
+static const double binary_exp10_neg [10] = {
     0.1,
     0.01,
     1e-4,
@@ -56,7 +58,7 @@ double binary_exp10_neg [10] = {
     0.0
 };
 
-double
+inline double
 exp10_int(int val)
 {
     double result = 1.0;
@@ -84,9 +86,162 @@ exp10_int(int val)
     return result;
 }
 
+/** Match a floating point number at the start of the text between p and
+    end, with the same syntax as the Parse_Context version below.  If there
+    is a number, result is set, p is moved past it and true is returned.
+    Otherwise neither is modified.  at_end is set if the text ran out while
+    matching, in which case a longer text may have matched differently.
+*/
+template<typename Float>
+inline bool match_float(Float & result, const char * & p, const char * end,
+                        bool & at_end)
+{
+    const char * c = p;
+    unsigned long num = 0;
+    unsigned long den2 = 0;
+    int den2_digits = 0;
+    double sign = 1;
+    int digits = 0;
+
+    at_end = false;
+
+    if (c < end && *c == '+') ++c;
+    else if (c < end && *c == '-') { sign = -1.0;  ++c; }
+
+    if (c == end) {
+        at_end = true;
+        return false;
+    }
+
+    if (*c == 'n' || *c == 'N') {
+        ++c;
+        if (end - c < 2) {
+            at_end = true;
+            return false;
+        }
+        if (c[0] != 'a' || (c[1] != 'n' && c[1] != 'N'))
+            return false;
+        result = sign * std::numeric_limits<Float>::quiet_NaN();
+        p = c + 2;
+        return true;
+    }
+    else if (*c == 'i') {
+        ++c;
+        if (end - c < 2) {
+            at_end = true;
+            return false;
+        }
+        if (c[0] != 'n' || c[1] != 'f')
+            return false;
+        result = sign * INFINITY;
+        p = c + 2;
+        return true;
+    }
+
+    for (; c < end;  ++c) {
+        unsigned digit = (unsigned char)*c - '0';
+        if (digit < 10) {
+            if (digits <= 17) {
+                num = 10*num + digit;
+                den2 *= 10;
+                ++den2_digits;
+            }
+            ++digits;
+        }
+        else if (*c == '.') {
+            if (den2 != 0) break;
+            else {
+                den2 = 1;
+                den2_digits = 0;
+            }
+        }
+        else if (digits && (*c == 'e' || *c == 'E')) {
+            /* Optional plus, then an integer with an optional sign. */
+            const char * e = c + 1;
+            if (e < end && *e == '+') ++e;
+            long esign = 1;
+            if (e < end && *e == '+') ++e;
+            else if (e < end && *e == '-') { esign = -1;  ++e; }
+
+            unsigned long mag = 0;
+            int edigits = 0;
+            for (; e < end && (unsigned char)*e - '0' < 10u;  ++e, ++edigits)
+                mag = mag * 10 + (*e - '0');
+
+            if (e == end) at_end = true;
+
+            long expi = (long)mag * esign;
+            if (edigits && expi >= -INT_MAX && expi <= INT_MAX) {
+                sign *= exp10(expi);
+                c = e;
+            }
+            break;
+        }
+        else break;
+    }
+
+    if (c == end) at_end = true;
+
+    if (!digits) return false;
+
+    if (digits > 15) {
+        // we need to parse using strtod since rounding bites us otherwise
+        size_t nchars = c - p;
+        char buf[nchars + 1];
+        std::copy(p, c, buf);
+        buf[nchars] = 0;
+
+        char * endptr;
+        double parsed = strtod(buf, &endptr);
+
+        if (endptr != buf + nchars)
+            throw Exception("wrong endptr");
+
+        result = parsed;
+        p = c;
+        return true;
+    }
+
+    if (den2 == 0) result = sign * num;
+    else result = sign * (double)num / den2;
+
+    p = c;
+    return true;
+}
+
+/** Match a floating point number that takes up the whole of the text
+    between begin and end. */
+template<typename Float>
+inline bool match_float(Float & result, const char * begin, const char * end)
+{
+    bool at_end;
+    Float val;
+    const char * p = begin;
+    if (!match_float(val, p, end, at_end) || p != end)
+        return false;
+    result = val;
+    return true;
+}
+
 template<typename Float>
 inline bool match_float(Float & result, Parse_Context & c)
 {
+    /* Most of the time, the number is entirely within the current buffer
+       and can be parsed directly from there. */
+    {
+        const char * p = c.buffered_begin();
+        bool at_end;
+        Float val;
+        if (match_float(val, p, c.buffered_end(), at_end)) {
+            if (!at_end) {
+                result = val;
+                c.advance_to(p);
+                return true;
+            }
+        }
+        else if (!at_end) return false;
+    }
+
     Parse_Context::Revert_Token tok(c);
 
     unsigned long num = 0;
@@ -39,6 +39,8 @@
 #include <unordered_map>
 #include "lzma.h"
 #include "lz4_filter.h"
+#include "parallel_compression.h"
+#include "jml/arch/cpu_info.h"
 
 
 using namespace std;
@@ -142,17 +144,60 @@ bool ends_with(const std::string & str, const std::string & what)
         && result == str.size() - what.size();
 }
 
+/** Size of the blocks that are compressed independently when compressing
+    with several threads.  Bigger blocks compress slightly better; smaller
+    ones need less memory. */
+enum { PARALLEL_BLOCK_SIZE = 4 * 1024 * 1024 };
+
+/** Compress a block of data into a complete stream with the given boost
+    iostreams compressor. */
+template<typename Compressor>
+std::string compressBlock(const Compressor & compressor,
+                          const char * data, size_t n)
+{
+    using namespace boost::iostreams;
+
+    std::string result;
+    filtering_ostream stream;
+    stream.push(compressor);
+    stream.push(boost::iostreams::back_inserter(result));
+    stream.write(data, n);
+    stream.reset();
+    return result;
+}
+
 void addCompression(streambuf & buf,
                     boost::iostreams::filtering_ostream & stream,
                     const std::string & resource,
                     const std::string & compression,
-                    int compressionLevel)
+                    int compressionLevel,
+                    int compressionThreads)
 {
     using namespace boost::iostreams;
 
+    bool parallel = compressionThreads > 1;
+
     if (compression == "gz" || compression == "gzip"
         || (compression == ""
             && (ends_with(resource, ".gz") || ends_with(resource, ".gz~")))) {
+        if (parallel) {
+            /* Each block is a gzip member of its own; gzip readers
+               concatenate them.  The compressors share their state when
+               copied, so each block needs a new one. */
+            int level = (compressionLevel == -1
+                         ? zlib::default_compression : compressionLevel);
+            auto compress = [=] (const char * data, size_t n)
+                {
+                    gzip_compressor member(level);
+                    std::stringbuf header;
+                    member.write(header, "", 0);
+                    return header.str() + compressBlock(member, data, n);
+                };
+            stream.push(parallel_compressor(compress, PARALLEL_BLOCK_SIZE,
+                                            compressionThreads));
+            return;
+        }
+
         gzip_compressor compressor;
         if (compressionLevel != -1) {
             compressor = gzip_compressor(compressionLevel);
@@ -163,27 +208,74 @@ void addCompression(streambuf & buf,
     else if (compression == "bz2" || compression == "bzip2"
         || (compression == ""
             && (ends_with(resource, ".bz2") || ends_with(resource, ".bz2~")))) {
-        if (compressionLevel == -1)
+        if (parallel) {
+            /* Each block is a complete bzip2 stream; bzip2 readers
+               concatenate them. */
+            int blockSize = (compressionLevel == -1
+                             ? bzip2::default_block_size : compressionLevel);
+            auto compress = [=] (const char * data, size_t n)
+                {
+                    return compressBlock(bzip2_compressor(blockSize),
+                                         data, n);
+                };
+            stream.push(parallel_compressor(compress, PARALLEL_BLOCK_SIZE,
+                                            compressionThreads));
+        }
+        else if (compressionLevel == -1)
             stream.push(bzip2_compressor());
         else stream.push(bzip2_compressor(compressionLevel));
     }
     else if (compression == "lzma" || compression == "xz"
         || (compression == ""
             && (ends_with(resource, ".xz") || ends_with(resource, ".xz~")))) {
-        if (compressionLevel == -1)
-            stream.push(lzma_compressor());
-        else stream.push(lzma_compressor(compressionLevel));
+        /* liblzma does its own threading, writing independent blocks
+           within a single stream. */
+        lzma_params params;
+        if (compressionLevel != -1)
+            params.level = compressionLevel;
+        params.threads = compressionThreads;
+        stream.push(lzma_compressor(params));
     }
     else if (compression == "lz4"
         || (compression == ""
             && (ends_with(resource, ".lz4") || ends_with(resource, ".lz4~")))) {
-        stream.push(lz4_compressor(compressionLevel));
+        if (parallel) {
+            /* The blocks of an lz4 frame are independent, so they can be
+               compressed in parallel inside a single frame. */
+            lz4::Header head(7, true, true, false);
+            lz4::CompressFn compressFn
+                = lz4::compressFnForLevel(compressionLevel);
+            auto compress = [=] (const char * data, size_t n)
+                {
+                    if (n == 0) return std::string();
+                    return lz4::compressBlock(head, compressFn, data, n);
+                };
+            const uint32_t eos = 0;
+            stream.push(parallel_compressor
+                        (compress, head.blockSize(), compressionThreads,
+                         std::string((const char *)&head, sizeof(head)),
+                         std::string((const char *)&eos, sizeof(eos))));
+        }
+        else stream.push(lz4_compressor(compressionLevel));
     }
     else if (compression != "" && compression != "none")
         throw ML::Exception("unknown filter compression " + compression);
     
 }
 
+/** Number of threads to use for compression; "compressionThreads" can be
+    zero or negative to mean one per CPU. */
+int getCompressionThreads(const std::map<std::string, std::string> & options)
+{
+    auto it = options.find("compressionThreads");
+    if (it == options.end())
+        return 1;
+    int result = boost::lexical_cast<int>(it->second);
+    if (result <= 0)
+        result = num_cpus();
+    return result;
+}
+
 void addCompression(streambuf & buf,
                     boost::iostreams::filtering_ostream & stream,
                     const std::string & resource,
@@ -199,7 +291,8 @@ void addCompression(streambuf & buf,
     if (it != options.end())
         compressionLevel = boost::lexical_cast<int>(it->second);
     
-    addCompression(buf, stream, resource, compression, compressionLevel);
+    addCompression(buf, stream, resource, compression, compressionLevel,
+                   getCompressionThreads(options));
 }
 
 
@@ -445,6 +538,14 @@ filter_istream(const std::string & file, std::ios_base::openmode mode,
     open(file, mode, compression);
 }
 
+filter_istream::
+filter_istream(const std::string & uri,
+               const std::map<std::string, std::string> & options)
+    : istream(std::cin.rdbuf())
+{
+    open(uri, options);
+}
+
 filter_istream::
 filter_istream(filter_istream && other) noexcept
     : istream(other.rdbuf()),
@@ -479,19 +580,30 @@ filter_istream::
 open(const std::string & uri,
      std::ios_base::openmode mode,
      const std::string & compression)
+{
+    open(uri, createOptions(mode, compression, -1));
+}
+
+void
+filter_istream::
+open(const std::string & uri,
+     const std::map<std::string, std::string> & options)
 {
     exceptions(ios::badbit);
 
     string scheme, resource;
     std::tie(scheme, resource) = getScheme(uri);
 
+    std::ios_base::openmode mode = getMode(options);
+    if (!mode)
+        mode = std::ios_base::in;
+
     const auto & handler = getUriHandler(scheme);
     std::streambuf * buf;
     bool weOwnBuf;
-    std::tie(buf, weOwnBuf) = handler(scheme, resource, mode,
-                                      createOptions(mode, compression, -1));
+    std::tie(buf, weOwnBuf) = handler(scheme, resource, mode, options);
 
-    openFromStreambuf(buf, weOwnBuf, resource, compression);
+    openFromStreambuf(buf, weOwnBuf, resource, options);
 }
 
 void
@@ -500,6 +612,18 @@ openFromStreambuf(std::streambuf * buf,
                   bool weOwnBuf,
                   const std::string & resource,
                   const std::string & compression)
+{
+    openFromStreambuf(buf, weOwnBuf, resource,
+                      createOptions(std::ios_base::openmode(0),
+                                    compression, -1));
+}
+
+void
+filter_istream::
+openFromStreambuf(std::streambuf * buf,
+                  bool weOwnBuf,
+                  const std::string & resource,
+                  const std::map<std::string, std::string> & options)
 {
     // TODO: exception safety for buf
 
@@ -512,6 +636,13 @@ openFromStreambuf(std::streambuf * buf,
     unique_ptr<filtering_istream> new_stream
         (new filtering_istream());
 
+    string compression;
+    auto it = options.find("compression");
+    if (it != options.end())
+        compression = it->second;
+
+    int compressionThreads = getCompressionThreads(options);
+
     bool gzip = (compression == "gz" || compression == "gzip"
                  || (compression == ""
                      && (ends_with(resource, ".gz")
@@ -532,8 +663,16 @@ openFromStreambuf(std::streambuf * buf,
 
     if (gzip) new_stream->push(gzip_decompressor());
     if (bzip2) new_stream->push(bzip2_decompressor());
-    if (lzma) new_stream->push(lzma_decompressor());
-    if (lz4) new_stream->push(lz4_decompressor());
+    if (lzma) {
+        lzma_params params;
+        params.threads = compressionThreads;
+        new_stream->push(lzma_decompressor(params));
+    }
+    if (lz4) {
+        if (compressionThreads > 1)
+            new_stream->push(parallel_lz4_decompressor(compressionThreads));
+        else new_stream->push(lz4_decompressor());
+    }
 
     new_stream->push(*buf);
 
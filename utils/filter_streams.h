@@ -86,6 +86,10 @@ public:
 
         mode = comma separated list of out,append,create
         compression = string (gz, bz2, xz, ...)
+        compressionLevel = compression level, in the compressor's units
+        compressionThreads = number of threads to compress with; the output
+            is cut into independent blocks (multiple gzip members or bzip2
+            streams, xz blocks or lz4 blocks).  0 means one per CPU.
         resource = string to be used in error messages
     */
     void open(const std::string & uri,
@@ -121,6 +125,9 @@ public:
                    std::ios_base::openmode mode = std::ios_base::in,
                    const std::string & compression = "");
 
+    filter_istream(const std::string & uri,
+                   const std::map<std::string, std::string> & options);
+
     filter_istream(filter_istream && other) noexcept;
 
     filter_istream & operator = (filter_istream && other);
@@ -136,6 +143,22 @@ public:
                            const std::string & resource = "",
                            const std::string & compression = "");
 
+    /** Open with the given options.  Option keys are interpreted by plugins,
+        but include:
+
+        mode = comma separated list of in,binary
+        compression = string (gz, bz2, xz, ...)
+        compressionThreads = number of threads to decompress with (lz4 and
+            xz streams with independent blocks only); 0 means one per CPU
+    */
+    void open(const std::string & uri,
+              const std::map<std::string, std::string> & options);
+
+    void openFromStreambuf(std::streambuf * buf,
+                           bool weOwnBuf,
+                           const std::string & resource,
+                           const std::map<std::string, std::string> & options);
+
     void close();
 
 private:
@@ -861,7 +861,7 @@ private:
     {
         if (bucket < 0 || bucket > this->capacity())
             throw Exception("dereferencing invalid iterator");
-        if (!this->storage_[bucket].first) {
+        if (!Ops::bucketIsFull(this->storage_[bucket])) {
             using namespace std;
             cerr << "bucket = " << bucket << endl;
             dump(cerr);
@@ -880,7 +880,7 @@ private:
                    << Ops::hashKey(this->storage_[i], this->capacity(),
                                    this->storage_)
                    << " key " << this->storage_[i].first;
-            if (this->storage_[i].first)
+            if (Ops::bucketIsFull(this->storage_[i]))
                 stream << " value " << this->storage_[i].second;
             stream << endl;
         }
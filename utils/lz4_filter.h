@@ -158,6 +158,83 @@ private:
 
 static_assert(sizeof(Header) == 7, "sizeof(lz4::Header) == 7");
 
+
+/******************************************************************************/
+/* BLOCKS                                                                     */
+/******************************************************************************/
+
+typedef int (*CompressFn)(const char*, char*, int);
+
+inline CompressFn compressFnForLevel(int level)
+{
+    return level < 3 ? LZ4_compress : LZ4_compressHC;
+}
+
+/** Compress a block of at most head.blockSize() bytes into its framed form:
+    size, data and optional checksum.  Blocks are independent, so this can be
+    called from several threads at once.
+ */
+inline std::string
+compressBlock(const Header& head, CompressFn compressFn,
+              const char* data, size_t n)
+{
+    size_t bytesToAlloc = LZ4_compressBound(n);
+    ExcAssert(bytesToAlloc);
+    std::string result(sizeof(uint32_t) + bytesToAlloc, '\0');
+    char* compressed = &result[sizeof(uint32_t)];
+
+    auto compressedSize = compressFn(data, compressed, n);
+
+    uint32_t size;
+    if (compressedSize > 0) size = compressedSize;
+    else {
+        size = n | NotCompressedMask; // uncompressed flag.
+        std::memcpy(compressed, data, n);
+        compressedSize = n;
+    }
+
+    std::memcpy(&result[0], &size, sizeof(size));
+    result.resize(sizeof(uint32_t) + compressedSize);
+
+    if (head.blockChecksum()) {
+        uint32_t checksum = XXH32(compressed, compressedSize, ChecksumSeed);
+        result.append((const char*) &checksum, sizeof(checksum));
+    }
+
+    return result;
+}
+
+/** Decompress a block read from the stream into output, which must have
+    room for head.blockSize() bytes.  The size is as it was read from the
+    stream, including the uncompressed flag.  Returns the number of bytes in
+    the block.  Thread safe.
+ */
+inline size_t
+decompressBlock(const Header& head, uint32_t size,
+                const char* compressed, const uint32_t* expectedChecksum,
+                char* output)
+{
+    bool notCompressed = size & NotCompressedMask;
+    size &= ~NotCompressedMask;
+
+    if (expectedChecksum) {
+        uint32_t checksum = XXH32(compressed, size, ChecksumSeed);
+        if (checksum != *expectedChecksum) throw lz4_error("invalid checksum");
+    }
+
+    if (notCompressed) {
+        if (size > head.blockSize()) throw lz4_error("block too large");
+        std::memcpy(output, compressed, size);
+        return size;
+    }
+
+    auto decompressed = LZ4_decompress_safe(
+            compressed, output, size, head.blockSize());
+
+    if (decompressed < 0) throw lz4_error("malformed lz4 stream");
+    return decompressed;
+}
+
 } // namespace lz4
 
 
@@ -171,7 +248,7 @@ struct lz4_compressor : public boost::iostreams::multichar_output_filter
         head(blockSizeId, true, true, false), writeHeader(true), pos(0)
     {
         buffer.resize(head.blockSize());
-        compressFn = level < 3 ? LZ4_compress : LZ4_compressHC;
+        compressFn = lz4::compressFnForLevel(level);
 
         if (head.streamChecksum())
             streamChecksumState = XXH32_init(lz4::ChecksumSeed);
@@ -223,37 +300,15 @@ private:
         if (head.streamChecksum())
             XXH32_update(streamChecksumState, buffer.data(), pos);
 
-        size_t bytesToAlloc = LZ4_compressBound(pos);
-        ExcAssert(bytesToAlloc);
-        char* compressed = new char[bytesToAlloc];
-        ML::Call_Guard guard([&] () { delete[] compressed; });
-        
-        auto compressedSize = compressFn(buffer.data(), compressed, pos);
-
-        auto writeChecksum = [&](const char* data, size_t n) {
-            if (!head.blockChecksum()) return;
-            uint32_t checksum = XXH32(data, n, lz4::ChecksumSeed);
-            lz4::write(sink, &checksum, sizeof(checksum));
-        };
-
-        if (compressedSize > 0) {
-            uint32_t head = compressedSize;
-            lz4::write(sink, &head, sizeof(head));
-            lz4::write(sink, compressed, compressedSize);
-            writeChecksum(compressed, compressedSize);
-        }
-        else {
-            uint32_t head = pos | lz4::NotCompressedMask; // uncompressed flag.
-            lz4::write(sink, &head, sizeof(uint32_t));
-            lz4::write(sink, buffer.data(), pos);
-            writeChecksum(buffer.data(), pos);
-        }
+        std::string block = lz4::compressBlock(head, compressFn,
+                                               buffer.data(), pos);
+        lz4::write(sink, block.data(), block.size());
 
         pos = 0;
     }
 
     lz4::Header head;
-    int (*compressFn)(const char*, char*, int);
+    lz4::CompressFn compressFn;
 
     bool writeHeader;
     std::vector<char> buffer;
@@ -321,37 +376,21 @@ private:
             return;
         }
 
-        bool notCompressed = compressedSize & lz4::NotCompressedMask;
-        compressedSize &= ~lz4::NotCompressedMask;
-
-        char* compressed = (char*) malloc(compressedSize);
+        uint32_t size = compressedSize & ~lz4::NotCompressedMask;
+        char* compressed = (char*) malloc(size);
         ML::Call_Guard guard([=] () { free(compressed); });
-        lz4::read(src, compressed, compressedSize);
+        lz4::read(src, compressed, size);
 
-        if (head.blockChecksum()) {
-            uint32_t expected;
+        uint32_t expected;
+        if (head.blockChecksum())
             lz4::read(src, &expected, sizeof(expected));
-            uint32_t checksum = XXH32(compressed, compressedSize, lz4::ChecksumSeed);
-            if (checksum != expected) throw lz4_error("invalid checksum");
-        }
 
+        buffer.resize(head.blockSize());
+        toRead = lz4::decompressBlock(
+                head, compressedSize, compressed,
+                head.blockChecksum() ? &expected : nullptr, buffer.data());
         pos = 0;
 
-        if (notCompressed) {
-            std::memcpy(buffer.data(), compressed, compressedSize);
-            toRead = compressedSize;
-        }
-        else {
-            buffer.resize(head.blockSize());
-
-            auto decompressed = LZ4_decompress_safe(
-                    compressed,     buffer.data(),
-                    compressedSize, buffer.size());
-
-            if (decompressed < 0) throw lz4_error("malformed lz4 stream");
-            toRead = decompressed;
-        }
-
         if (head.streamChecksum())
             XXH32_update(streamChecksumState, buffer.data(), toRead);
     }
@@ -21,6 +21,7 @@
 #include <boost/iostreams/filter/zlib.hpp> 
 #include <boost/lexical_cast.hpp>
 #include <lzma.h>
+#include <string.h>
 
 namespace boost { namespace iostreams {
 
@@ -103,9 +104,30 @@ lzma_base::lzma_base(bool compress, const lzma_params & params)
     stream_ = init;
     
     lzma_ret res;
-    if (compress_)
+    if (compress_ && params.threads > 1) {
+        // Each block is compressed independently on its own thread
+        lzma_mt mt;
+        memset(&mt, 0, sizeof(mt));
+        mt.threads = params.threads;
+        mt.preset = params.level;
+        mt.check = (lzma_check)params.crc;
+        res = lzma_stream_encoder_mt(&stream_, &mt);
+    }
+    else if (compress_)
         res = lzma_easy_encoder(&stream_, params.level,
                                 (lzma_check)params.crc);
+#if LZMA_VERSION >= 50040002
+    else if (params.threads > 1) {
+        // Only streams with the block sizes in their headers (as written
+        // by the threaded encoder) are actually decoded in parallel
+        lzma_mt mt;
+        memset(&mt, 0, sizeof(mt));
+        mt.threads = params.threads;
+        mt.memlimit_threading = params.threads * 256ULL * 1024 * 1024;
+        mt.memlimit_stop = UINT64_MAX;
+        res = lzma_stream_decoder_mt(&stream_, &mt);
+    }
+#endif
     else
         res = lzma_stream_decoder(&stream_, 100 * 1024 * 1024, 0 /* flags */);
     
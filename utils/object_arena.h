@@ -0,0 +1,176 @@
+/* object_arena.h                                                  -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Arena that allocates objects of one type from large blocks.
+*/
+
+#ifndef __utils__object_arena_h__
+#define __utils__object_arena_h__
+
+#include <vector>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <cstdlib>
+#include <type_traits>
+#include <boost/noncopyable.hpp>
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* OBJECT_ARENA                                                              */
+/*****************************************************************************/
+
+/** Allocates objects of type T by bumping a pointer through large blocks of
+    memory.  Objects can't be freed individually; instead, clear() destroys
+    all of them at once and keeps the biggest block for reuse.  Objects that
+    were allocated one after the other end up next to each other in memory.
+
+    Not thread safe; callers that allocate from several threads need to
+    provide their own locking.
+*/
+template<typename T>
+struct Object_Arena : boost::noncopyable {
+
+    enum {
+        MIN_BLOCK_OBJECTS = 16,
+        MAX_BLOCK_OBJECTS = 65536
+    };
+
+    Object_Arena()
+        : allocated(0)
+    {
+    }
+
+    ~Object_Arena()
+    {
+        destroy_all();
+        for (unsigned i = 0;  i < blocks.size();  ++i)
+            free(blocks[i].storage);
+    }
+
+    /** Construct a new object in the arena, forwarding the arguments to its
+        constructor. */
+    template<typename... Args>
+    T * construct(Args &&... args)
+    {
+        Block & block = current_block();
+        T * result = block.storage + block.used;
+        new (result) T(std::forward<Args>(args)...);
+        ++block.used;
+        ++allocated;
+        return result;
+    }
+
+    /** Make sure that the next n objects can be allocated contiguously in a
+        single block. */
+    void reserve(size_t n)
+    {
+        if (n == 0) return;
+        if (!blocks.empty()) {
+            const Block & block = blocks.back();
+            if (block.capacity - block.used >= n) return;
+        }
+        add_block(n);
+    }
+
+    /** Destroy all of the objects.  The biggest block is kept so that
+        filling the arena up again doesn't need to allocate. */
+    void clear()
+    {
+        destroy_all();
+        if (blocks.empty()) return;
+
+        unsigned biggest = 0;
+        for (unsigned i = 1;  i < blocks.size();  ++i)
+            if (blocks[i].capacity > blocks[biggest].capacity)
+                biggest = i;
+
+        for (unsigned i = 0;  i < blocks.size();  ++i)
+            if (i != biggest) free(blocks[i].storage);
+
+        Block kept = blocks[biggest];
+        kept.used = 0;
+        blocks.clear();
+        blocks.push_back(kept);
+    }
+
+    /** Exchange the contents of two arenas.  Pointers to the objects in
+        either arena stay valid. */
+    void swap(Object_Arena & other)
+    {
+        blocks.swap(other.blocks);
+        std::swap(allocated, other.allocated);
+    }
+
+    /** Number of objects currently allocated. */
+    size_t size() const { return allocated; }
+
+    /** Number of bytes of memory held by the arena. */
+    size_t memusage() const
+    {
+        size_t result = sizeof(*this) + blocks.capacity() * sizeof(Block);
+        for (unsigned i = 0;  i < blocks.size();  ++i)
+            result += blocks[i].capacity * sizeof(T);
+        return result;
+    }
+
+private:
+    struct Block {
+        T * storage;
+        size_t capacity;
+        size_t used;
+    };
+
+    std::vector<Block> blocks;
+    size_t allocated;
+
+    Block & current_block()
+    {
+        if (blocks.empty() || blocks.back().used == blocks.back().capacity) {
+            /* Grow geometrically so that the number of blocks stays small
+               for big trees, but small ones don't waste much memory. */
+            size_t n = MIN_BLOCK_OBJECTS;
+            if (!blocks.empty())
+                n = std::min<size_t>(blocks.back().capacity * 2,
+                                     MAX_BLOCK_OBJECTS);
+            add_block(n);
+        }
+        return blocks.back();
+    }
+
+    void add_block(size_t n)
+    {
+        Block block;
+        block.storage = (T *)malloc(n * sizeof(T));
+        if (!block.storage) throw std::bad_alloc();
+        block.capacity = n;
+        block.used = 0;
+
+        try {
+            blocks.push_back(block);
+        } catch (...) {
+            free(block.storage);
+            throw;
+        }
+    }
+
+    void destroy_all()
+    {
+        if (!std::is_trivially_destructible<T>::value) {
+            for (unsigned i = 0;  i < blocks.size();  ++i)
+                for (size_t j = 0;  j < blocks[i].used;  ++j)
+                    blocks[i].storage[j].~T();
+        }
+        for (unsigned i = 0;  i < blocks.size();  ++i)
+            blocks[i].used = 0;
+        allocated = 0;
+    }
+};
+
+} // namespace ML
+
+#endif /* __utils__object_arena_h__ */
@@ -0,0 +1,297 @@
+/* parallel_compression.h                                          -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Boost iostreams filters that compress and decompress independent blocks
+   of a stream on several threads at once.
+*/
+
+#ifndef __utils__parallel_compression_h__
+#define __utils__parallel_compression_h__
+
+#include "lz4_filter.h"
+#include "jml/arch/exception.h"
+#include <boost/iostreams/concepts.hpp>
+#include <boost/iostreams/operations.hpp>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <deque>
+
+
+namespace ML {
+
+
+/*****************************************************************************/
+/* PARALLEL_COMPRESSOR                                                       */
+/*****************************************************************************/
+
+/** Output filter that cuts its input into blocks of blockSize bytes, and
+    compresses each block on its own thread with the given function.  The
+    compressed blocks are written out in order, surrounded by the given
+    header and trailer.
+
+    The compression function must produce something that can be
+    concatenated: for example a complete gzip member, or a block of an lz4
+    frame.  It will be called on an empty block if the stream is empty.
+
+    At most numThreads blocks are in flight at once, which bounds the
+    memory used to about 2 * numThreads * blockSize.
+*/
+struct parallel_compressor : public boost::iostreams::multichar_output_filter {
+
+    typedef std::function<std::string (const char * data, size_t n)>
+        CompressBlock;
+
+    parallel_compressor(const CompressBlock & compressBlock,
+                        size_t blockSize,
+                        int numThreads,
+                        const std::string & header = "",
+                        const std::string & trailer = "")
+        : itl(new Itl(compressBlock, blockSize, numThreads, header, trailer))
+    {
+    }
+
+    template<typename Sink>
+    std::streamsize write(Sink & sink, const char * s, std::streamsize n)
+    {
+        writeHeader(sink);
+
+        size_t toWrite = n;
+        while (toWrite > 0) {
+            size_t toCopy = std::min(toWrite,
+                                     itl->blockSize - itl->current.size());
+            itl->current.append(s, toCopy);
+            s += toCopy;
+            toWrite -= toCopy;
+
+            if (itl->current.size() == itl->blockSize)
+                submit(sink);
+        }
+
+        return n;
+    }
+
+    template<typename Sink>
+    void close(Sink & sink)
+    {
+        writeHeader(sink);
+        if (!itl->current.empty() || !itl->submitted)
+            submit(sink);
+        while (!itl->pending.empty())
+            writeFront(sink);
+        writeAll(sink, itl->trailer);
+    }
+
+private:
+    /* Filters are copied when they are pushed onto a stream, so the state
+       (which includes the futures) is shared. */
+    struct Itl {
+        Itl(const CompressBlock & compressBlock,
+            size_t blockSize, int numThreads,
+            const std::string & header, const std::string & trailer)
+            : compressBlock(compressBlock),
+              blockSize(blockSize), numThreads(std::max(numThreads, 1)),
+              header(header), trailer(trailer),
+              headerWritten(false), submitted(false)
+        {
+            if (blockSize == 0)
+                throw Exception("parallel_compressor: zero block size");
+            current.reserve(blockSize);
+        }
+
+        CompressBlock compressBlock;
+        size_t blockSize;
+        size_t numThreads;
+        std::string header;
+        std::string trailer;
+        bool headerWritten;
+        bool submitted;
+        std::string current;
+        std::deque<std::future<std::string> > pending;
+    };
+
+    std::shared_ptr<Itl> itl;
+
+    template<typename Sink>
+    static void writeAll(Sink & sink, const std::string & data)
+    {
+        const char * p = data.data();
+        size_t n = data.size();
+        while (n > 0) {
+            std::streamsize written = boost::iostreams::write(sink, p, n);
+            if (written <= 0)
+                throw Exception("parallel_compressor: unable to write bytes");
+            p += written;
+            n -= written;
+        }
+    }
+
+    template<typename Sink>
+    void writeHeader(Sink & sink)
+    {
+        if (itl->headerWritten) return;
+        writeAll(sink, itl->header);
+        itl->headerWritten = true;
+    }
+
+    template<typename Sink>
+    void writeFront(Sink & sink)
+    {
+        std::string block = itl->pending.front().get();
+        itl->pending.pop_front();
+        writeAll(sink, block);
+    }
+
+    template<typename Sink>
+    void submit(Sink & sink)
+    {
+        if (itl->pending.size() >= itl->numThreads)
+            writeFront(sink);
+
+        std::shared_ptr<std::string> block(new std::string());
+        block->swap(itl->current);
+        itl->current.reserve(itl->blockSize);
+
+        CompressBlock compressBlock = itl->compressBlock;
+        itl->pending.push_back
+            (std::async(std::launch::async,
+                        [=] () { return compressBlock(block->data(),
+                                                      block->size()); }));
+        itl->submitted = true;
+    }
+};
+
+
+/*****************************************************************************/
+/* PARALLEL_LZ4_DECOMPRESSOR                                                 */
+/*****************************************************************************/
+
+/** Input filter for lz4 streams that reads ahead and decompresses up to
+    numThreads blocks at once.  The blocks of an lz4 frame are always
+    independent, so this works for any stream that lz4_decompressor can
+    read.
+*/
+struct parallel_lz4_decompressor
+    : public boost::iostreams::multichar_input_filter {
+
+    parallel_lz4_decompressor(int numThreads)
+        : itl(new Itl(numThreads))
+    {
+    }
+
+    template<typename Source>
+    std::streamsize read(Source & src, char * s, std::streamsize n)
+    {
+        if (!itl->head) {
+            itl->head = lz4::Header::read(src);
+            if (itl->head.streamChecksum())
+                itl->streamChecksumState = XXH32_init(lz4::ChecksumSeed);
+        }
+
+        size_t written = 0;
+        while (written < n) {
+            if (itl->pos == itl->current.size()) {
+                readAhead(src);
+                if (itl->pending.empty()) break;
+                itl->current = itl->pending.front().get();
+                itl->pending.pop_front();
+                itl->pos = 0;
+
+                if (itl->head.streamChecksum())
+                    XXH32_update(itl->streamChecksumState,
+                                 itl->current.data(), itl->current.size());
+
+                if (itl->pending.empty() && itl->endOfStream)
+                    checkStreamChecksum();
+            }
+
+            size_t toCopy = std::min(n - written,
+                                     itl->current.size() - itl->pos);
+            std::memcpy(s, itl->current.data() + itl->pos, toCopy);
+
+            s += toCopy;
+            itl->pos += toCopy;
+            written += toCopy;
+        }
+
+        return written == 0 && n > 0 ? -1 : written;
+    }
+
+private:
+    struct Itl {
+        Itl(int numThreads)
+            : numThreads(std::max(numThreads, 1)),
+              endOfStream(false), expectedStreamChecksum(0), pos(0),
+              streamChecksumState(0)
+        {
+        }
+
+        size_t numThreads;
+        lz4::Header head;
+        bool endOfStream;
+        uint32_t expectedStreamChecksum;
+        std::deque<std::future<std::string> > pending;
+        std::string current;
+        size_t pos;
+        void * streamChecksumState;
+    };
+
+    std::shared_ptr<Itl> itl;
+
+    /** Read blocks until there are numThreads being decompressed. */
+    template<typename Source>
+    void readAhead(Source & src)
+    {
+        while (!itl->endOfStream && itl->pending.size() < itl->numThreads) {
+            uint32_t size;
+            lz4::read(src, &size, sizeof(size));
+
+            // EOS marker.
+            if (size == 0) {
+                itl->endOfStream = true;
+                if (itl->head.streamChecksum())
+                    lz4::read(src, &itl->expectedStreamChecksum,
+                              sizeof(itl->expectedStreamChecksum));
+                if (itl->pending.empty()) checkStreamChecksum();
+                break;
+            }
+
+            std::shared_ptr<std::string> compressed
+                (new std::string(size & ~lz4::NotCompressedMask, '\0'));
+            lz4::read(src, &(*compressed)[0], compressed->size());
+
+            bool haveChecksum = itl->head.blockChecksum();
+            uint32_t expected = 0;
+            if (haveChecksum)
+                lz4::read(src, &expected, sizeof(expected));
+
+            lz4::Header head = itl->head;
+            auto decompress = [=] ()
+                {
+                    std::string result(head.blockSize(), '\0');
+                    size_t n = lz4::decompressBlock
+                        (head, size, compressed->data(),
+                         haveChecksum ? &expected : nullptr, &result[0]);
+                    result.resize(n);
+                    return result;
+                };
+
+            itl->pending.push_back(std::async(std::launch::async,
+                                              decompress));
+        }
+    }
+
+    void checkStreamChecksum()
+    {
+        if (!itl->head.streamChecksum()) return;
+        uint32_t checksum = XXH32_digest(itl->streamChecksumState);
+        if (checksum != itl->expectedStreamChecksum)
+            throw lz4_error("invalid checksum");
+    }
+};
+
+} // namespace ML
+
+#endif /* __utils__parallel_compression_h__ */
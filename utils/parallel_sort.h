@@ -0,0 +1,80 @@
+/* parallel_sort.h                                                 -*- C++ -*-
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Sort a vector using multiple threads from the worker task.
+*/
+
+#pragma once
+
+#include "jml/utils/worker_task.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+
+namespace ML {
+
+/** Sort the given vector in parallel.
+
+    The vector is split into one chunk per thread; each chunk is sorted
+    independently, and then the chunks are merged pairwise (each round of
+    merges also running in parallel).  Vectors smaller than min_parallel
+    elements are simply passed to std::sort.
+
+    Like std::sort, this is not stable.  For a result that doesn't depend
+    on the number of threads, use a comparison that is a total order.
+*/
+template<typename T, typename Alloc, typename Compare>
+void parallel_sort(std::vector<T, Alloc> & vec, Compare compare,
+                   size_t min_parallel = 65536)
+{
+    size_t n = vec.size();
+    int nthreads = num_threads();
+
+    if (n < min_parallel || nthreads < 2) {
+        std::sort(vec.begin(), vec.end(), compare);
+        return;
+    }
+
+    int nchunks = std::min<size_t>(nthreads, n / (min_parallel / 4) + 1);
+
+    /* Chunk boundaries.  Chunk i covers [bounds[i], bounds[i + 1]). */
+    std::vector<size_t> bounds(nchunks + 1);
+    for (int i = 0;  i <= nchunks;  ++i)
+        bounds[i] = n * i / nchunks;
+
+    auto sortChunk = [&] (int i)
+        {
+            std::sort(vec.begin() + bounds[i], vec.begin() + bounds[i + 1],
+                      compare);
+        };
+
+    run_in_parallel(0, nchunks, sortChunk);
+
+    /* Merge pairs of adjacent runs until there is only one left. */
+    for (int width = 1;  width < nchunks;  width *= 2) {
+        auto mergeRuns = [&] (int i)
+            {
+                int first = i * 2 * width;
+                int middle = first + width;
+                int last = std::min(first + 2 * width, nchunks);
+                if (middle >= last) return;
+                std::inplace_merge(vec.begin() + bounds[first],
+                                   vec.begin() + bounds[middle],
+                                   vec.begin() + bounds[last],
+                                   compare);
+            };
+
+        int nmerges = (nchunks + 2 * width - 1) / (2 * width);
+        run_in_parallel(0, nmerges, mergeRuns);
+    }
+}
+
+template<typename T, typename Alloc>
+void parallel_sort(std::vector<T, Alloc> & vec)
+{
+    parallel_sort(vec, std::less<T>());
+}
+
+} // namespace ML
@@ -15,6 +15,7 @@
 #include "fast_int_parsing.h"
 #include "fast_float_parsing.h"
 #include "jml/utils/file_functions.h"
+#include "jml/arch/sse2_scan.h"
 #include <cassert>
 #include <boost/scoped_array.hpp>
 
@@ -171,6 +172,16 @@ struct MatchAnyCharLots {
 
 } // file scope
 
+bool
+Parse_Context::
+match_text(std::string & text, char delimiter)
+{
+    return match_text_scan(text, [=] (const char * p, const char * e)
+                           {
+                               return SIMD::find_first_of(p, e, delimiter);
+                           });
+}
+
 bool
 Parse_Context::
 match_text(std::string & text, const char * delimiters)
@@ -180,7 +191,15 @@ match_text(std::string & text, const char * delimiters)
     if (nd == 0)
         throw Exception("Parse_Context::match_text(): no characters");
 
-    if (nd <= 4) return match_text(text, MatchAnyChar(delimiters, nd));
+    if (nd <= 4) {
+        MatchAnyChar match(delimiters, nd);
+        const char * c = match.chars;
+        return match_text_scan(text, [&] (const char * p, const char * e)
+                               {
+                                   return SIMD::find_first_of
+                                       (p, e, c[0], c[1], c[2], c[3]);
+                               });
+    }
     else return match_text(text, MatchAnyCharLots(delimiters, nd));
 }
 
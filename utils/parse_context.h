@@ -106,6 +106,45 @@ struct Parse_Context {
         the current character? */
     size_t total_buffered() const;
 
+    /** Direct access to the text that is buffered contiguously from the
+        current position onwards, so that it can be scanned without going
+        through the character by character interface.  The text may
+        continue in another buffer after buffered_end().  The pointers are
+        invalidated by anything that moves past buffered_end().
+    */
+    const char * buffered_begin() const { return cur_; }
+    const char * buffered_end() const { return ebuf_; }
+
+    /** Move forward to the given position, which must be between
+        buffered_begin() and buffered_end(), keeping the line and column
+        numbers up to date.  Moving to buffered_end() loads the next
+        buffer. */
+    void advance_to(const char * pos)
+    {
+        if (JML_UNLIKELY(pos < cur_ || pos > ebuf_))
+            exception("advance_to(): position is outside of the buffer");
+        if (pos == cur_) return;
+
+        const char * nl = (const char *)memchr(cur_, '\n', pos - cur_);
+        if (nl) {
+            for (;;) {
+                ++line_;
+                const char * next
+                    = (const char *)memchr(nl + 1, '\n', pos - nl - 1);
+                if (!next) break;
+                nl = next;
+            }
+            col_ = pos - nl;
+        }
+        else col_ += pos - cur_;
+
+        ofs_ += pos - cur_;
+        cur_ = pos;
+
+        if (JML_UNLIKELY(cur_ == ebuf_))
+            next_buffer();
+    }
+
     /** Increment.  Note that it always sets up the buffer such that more
         characters are available. */
     JML_ALWAYS_INLINE Parse_Context & operator ++ ()
@@ -199,52 +238,11 @@ struct Parse_Context {
     template<class FoundEnd>
     bool match_text(std::string & text, const FoundEnd & found)
     {
-#if 0 // buggy        
-        /* We do each buffer separately, to avoid overhead. */
-        while (!eof()) {
-            const char * text_start = cur_;
-
-            /* Go to an EOF or the end of the buffer, whatever first. */
-            while (cur_ < ebuf_ && !found(*cur_)) ++cur_;
-            
-            /* Copy the text. */
-            text.append(text_start, cur_);
-            
-            /* Did we find the end of line? */
-            if (cur_ < ebuf_) break;
-            
-            /* We need a new buffer. */
-            --cur_;  // make sure the operator ++ will return a new buffer
-            operator ++ ();  // get the new buffer
-        }
-#else
-        char internalBuffer[4096];
-        
-        char * buffer = internalBuffer;
-        size_t bufferSize = 4096;
-        size_t pos = 0;
-        char c;
-        
-        while (!eof() && !found(c = operator *())) {
-            if (pos == bufferSize) {
-                size_t newBufferSize = bufferSize * 8;
-                char * newBuffer = new char[newBufferSize];
-                std::copy(buffer, buffer + bufferSize, newBuffer);
-                if (buffer != internalBuffer)
-                    delete[] buffer;
-                buffer = newBuffer;
-                bufferSize = newBufferSize;
-            }
-            buffer[pos++] = c;
-            operator ++();
-        }
-
-        text = std::string(buffer, buffer + pos);
-        if (buffer != internalBuffer)
-            delete[] buffer;
-#endif
-
-        return true;
+        return match_text_scan(text, [&] (const char * p, const char * e)
+                               {
+                                   while (p < e && !found(*p)) ++p;
+                                   return p;
+                               });
     }
 
     struct Matches_Char {
@@ -260,10 +258,7 @@ struct Parse_Context {
         at the delimiter.  Always returns true, as the empty string counts as
         being matched.
     */
-    bool match_text(std::string & text, char delimiter)
-    {
-        return match_text(text, Matches_Char(delimiter));
-    }
+    bool match_text(std::string & text, char delimiter);
 
     bool match_text(std::string & text, const char * delimiters);
 
@@ -337,10 +332,12 @@ struct Parse_Context {
     bool match_whitespace()
     {
         bool result = false;
-        while (!eof() && isblank(*cur_)) {
-        // while (!eof() && isspace(*cur_) && *cur_ != '\n') {
+        while (!eof()) {
+            const char * p = cur_;
+            while (p < ebuf_ && (*p == ' ' || *p == '\t')) ++p;
+            if (p == cur_) break;
             result = true;
-            operator ++ ();
+            advance_to(p);
         }
         return result;
     }
@@ -695,6 +692,23 @@ private:
         necessary. */
     void next_buffer();
 
+    /** Match text up to a delimiter, using the given function to find
+        the first delimiter (or the end) in each buffer. */
+    template<class Scan>
+    bool match_text_scan(std::string & text, const Scan & scan)
+    {
+        text.clear();
+        while (!eof()) {
+            const char * start = cur_;
+            const char * found = scan(cur_, ebuf_);
+            bool at_delimiter = found != ebuf_;
+            text.append(start, found);
+            advance_to(found);
+            if (at_delimiter) break;
+        }
+        return true;
+    }
+
     /** Go to a given offset.  It must be within the current set of buffers. */
     void goto_ofs(uint64_t ofs, size_t line, size_t col);
 
@@ -3,7 +3,8 @@
    Copyright (c) 2012 Datacratic.  All rights reserved.
 
    Ring buffer for when there are one or more producers and one consumer
-   chasing each other.
+   chasing each other.  There is also a lock-free version for multiple
+   producers and multiple consumers.
 */
 
 #ifndef __jml_utils__ring_buffer_h__
@@ -14,6 +15,9 @@
 #include "jml/arch/spinlock.h"
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
 
 namespace ML {
 
@@ -324,6 +328,241 @@ struct RingBufferSRMW : public RingBufferBase<Request> {
     }
 };
 
+/*****************************************************************************/
+/* RING BUFFER MULTIPLE WRITERS MULTIPLE READERS                             */
+/*****************************************************************************/
+
+/** Lock-free bounded ring buffer for multiple producers and multiple
+    consumers.
+
+    Each cell carries a sequence number that says whether it is ready to
+    be written (sequence == position) or read (sequence == position + 1)
+    for the lap of the ring that a thread is on, so producers and consumers
+    only contend on a compare and swap of their own position.  The read
+    and write positions live on their own cache lines.
+
+    The blocking and timed functions wait on a futex, which is only woken
+    when there is a thread waiting on it.  The size is rounded up to a
+    power of two.
+*/
+template<typename Request>
+struct RingBufferMWMR {
+
+    RingBufferMWMR(size_t size)
+    {
+        init(size);
+    }
+
+    void init(size_t numEntries)
+    {
+        size_t n = 1;
+        while (n < numEntries) n *= 2;
+
+        cells.reset(new Cell[n]);
+        mask = n - 1;
+        for (size_t i = 0;  i < n;  ++i)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+
+        writePosition.store(0, std::memory_order_relaxed);
+        readPosition.store(0, std::memory_order_relaxed);
+        pushed = popped = 0;
+        pushWaiters = popWaiters = 0;
+    }
+
+    size_t size() const { return mask + 1; }
+
+    void push(const Request & request)
+    {
+        Request copy(request);
+        push(std::move(copy));
+    }
+
+    void push(Request && request)
+    {
+        waitFor(popped, pushWaiters,
+                [&] () { return tryPush(std::move(request)); },
+                -1.0);
+    }
+
+    bool tryPush(const Request & request)
+    {
+        Request copy(request);
+        return tryPush(std::move(copy));
+    }
+
+    /** Push, but don't wait for space.  The request is only moved from if
+        true is returned. */
+    bool tryPush(Request && request)
+    {
+        size_t pos = writePosition.load(std::memory_order_relaxed);
+        Cell * cell;
+
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            ssize_t diff = (ssize_t)seq - (ssize_t)pos;
+            if (diff == 0) {
+                if (writePosition.compare_exchange_weak
+                    (pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) return false;  // full
+            else pos = writePosition.load(std::memory_order_relaxed);
+        }
+
+        cell->value = std::move(request);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        notify(pushed, popWaiters);
+        return true;
+    }
+
+    bool tryPush(const Request & request, double maxWaitTime)
+    {
+        Request copy(request);
+        return tryPush(std::move(copy), maxWaitTime);
+    }
+
+    /** Push, waiting up to maxWaitTime seconds for space. */
+    bool tryPush(Request && request, double maxWaitTime)
+    {
+        return waitFor(popped, pushWaiters,
+                       [&] () { return tryPush(std::move(request)); },
+                       maxWaitTime);
+    }
+
+    Request pop()
+    {
+        Request result;
+        waitFor(pushed, popWaiters,
+                [&] () { return tryPop(result); },
+                -1.0);
+        return result;
+    }
+
+    /** Pop, but don't wait for anything to be pushed. */
+    bool tryPop(Request & result)
+    {
+        size_t pos = readPosition.load(std::memory_order_relaxed);
+        Cell * cell;
+
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            ssize_t diff = (ssize_t)seq - (ssize_t)(pos + 1);
+            if (diff == 0) {
+                if (readPosition.compare_exchange_weak
+                    (pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) return false;  // empty
+            else pos = readPosition.load(std::memory_order_relaxed);
+        }
+
+        result = std::move(cell->value);
+        cell->value = Request();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+
+        notify(popped, pushWaiters);
+        return true;
+    }
+
+    /** Pop, waiting up to maxWaitTime seconds for something to be
+        pushed. */
+    bool tryPop(Request & result, double maxWaitTime)
+    {
+        return waitFor(pushed, popWaiters,
+                       [&] () { return tryPop(result); },
+                       maxWaitTime);
+    }
+
+    bool couldPop() const
+    {
+        size_t pos = readPosition.load(std::memory_order_relaxed);
+        const Cell & cell = cells[pos & mask];
+        return cell.sequence.load(std::memory_order_acquire) == pos + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        Request value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+
+    /* Each of these is on its own cache line, so that producers and
+       consumers don't slow each other down. */
+    char pad0[64];
+    std::atomic<size_t> writePosition;
+    char pad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> readPosition;
+    char pad2[64 - sizeof(std::atomic<size_t>)];
+
+    /* Generation counts (used as futexes), bumped after each push and
+       pop, and the number of threads waiting for each of them to change.
+       These are only touched when a thread needs to wait or there is a
+       thread waiting. */
+    int pushed;
+    int popped;
+    int pushWaiters;
+    int popWaiters;
+
+    void notify(int & generation, int & waiters)
+    {
+        if (__sync_fetch_and_add(&waiters, 0) == 0) return;
+        __sync_add_and_fetch(&generation, 1);
+        futex_wake(generation, 1);
+    }
+
+    /** Call fn until it succeeds, sleeping on the given generation count
+        between attempts.  A negative maxWaitTime waits forever. */
+    template<typename Fn>
+    bool waitFor(int & generation, int & waiters, const Fn & fn,
+                 double maxWaitTime)
+    {
+        if (fn()) return true;
+        if (maxWaitTime == 0.0) return false;
+
+        typedef std::chrono::steady_clock Clock;
+        Clock::time_point deadline = Clock::now()
+            + std::chrono::duration_cast<Clock::duration>
+            (std::chrono::duration<double>(std::max(maxWaitTime, 0.0)));
+
+        __sync_add_and_fetch(&waiters, 1);
+
+        bool result = false;
+        for (;;) {
+            /* Read the generation before trying, so that anything that
+               happens after our attempt makes the futex_wait return. */
+            int gen = __sync_fetch_and_add(&generation, 0);
+            if (fn()) {
+                result = true;
+                break;
+            }
+            
+            if (maxWaitTime < 0.0)
+                futex_wait(generation, gen);
+            else {
+                double remaining
+                    = std::chrono::duration<double>
+                    (deadline - Clock::now()).count();
+                if (remaining <= 0.0) break;
+                futex_wait(generation, gen, remaining);
+            }
+        }
+
+        __sync_add_and_fetch(&waiters, -1);
+
+        /* We may have consumed a wakeup meant for someone else after we
+           gave up; pass it on. */
+        if (!result) notify(generation, waiters);
+
+        return result;
+    }
+};
+
 } // namespace ML
 
 #endif /* __jml_utils__ring_buffer_h__ */
@@ -12,6 +12,9 @@
 #include "jml/utils/csv.h"
 #include "jml/utils/vector_utils.h"
 #include "jml/utils/parse_context.h"
+#include "jml/utils/fast_float_parsing.h"
+#include "jml/arch/tick_counter.h"
+#include "jml/arch/format.h"
 
 #include <sstream>
 #include <fstream>
@@ -42,3 +45,163 @@ BOOST_AUTO_TEST_CASE (test1)
     testCsvLine("\"\",", {"",""});
     testCsvLine("\"\",\"\"", {"",""});
 }
+
+/* Parse the text as CSV rows with the field view interface, with the
+   given chunk size (or all in one buffer if 0). */
+vector<vector<string> > parseCsvViews(const std::string & text,
+                                      int chunk_size)
+{
+    istringstream stream(text);
+    std::shared_ptr<Parse_Context> context;
+    if (chunk_size)
+        context.reset(new Parse_Context("test", stream, 1, 1, chunk_size));
+    else context.reset(new Parse_Context("test", text.c_str(),
+                                         text.c_str() + text.size()));
+
+    vector<vector<string> > result;
+    vector<Csv_Field> fields;
+    string storage;
+    while (*context) {
+        expect_csv_row(*context, fields, storage);
+        vector<string> row;
+        for (unsigned i = 0;  i < fields.size();  ++i)
+            row.push_back(fields[i].str());
+        result.push_back(row);
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_csv_field_views )
+{
+    string text = "a,b,c\n"
+        "\"quoted, with comma\",\"with \"\"escaped\"\" quotes\",\n"
+        "\n"
+        "1.5,-2e3,nan\r\n"
+        "\"\"\"\"\"\",x\n"
+        "last,row";
+
+    vector<vector<string> > expected = {
+        { "a", "b", "c" },
+        { "quoted, with comma", "with \"escaped\" quotes", "" },
+        { },
+        { "1.5", "-2e3", "nan" },
+        { "\"\"", "x" },
+        { "last", "row" } };
+
+    for (int chunk_size: { 0, 1, 2, 3, 5, 7, 16, 1000 }) {
+        BOOST_TEST_CHECKPOINT("chunk size " << chunk_size);
+        BOOST_CHECK_EQUAL(parseCsvViews(text, chunk_size), expected);
+    }
+
+    /* Numbers are parsed straight out of the fields. */
+    ML::Parse_Context context("test", text.c_str(),
+                              text.c_str() + text.size());
+    vector<Csv_Field> fields;
+    string storage;
+    for (unsigned i = 0;  i < 4;  ++i)
+        expect_csv_row(context, fields, storage);
+    BOOST_REQUIRE_EQUAL(fields.size(), 3);
+
+    float f;
+    double d;
+    BOOST_CHECK(fields[0].match_float(f));
+    BOOST_CHECK_EQUAL(f, 1.5);
+    BOOST_CHECK(fields[1].match_double(d));
+    BOOST_CHECK_CLOSE(d, -2000.0, 1e-6);
+    BOOST_CHECK(fields[2].match_float(f));
+    BOOST_CHECK(isnan(f));
+
+    expect_csv_row(context, fields, storage);
+    BOOST_CHECK(!fields[1].match_float(f));
+
+    /* Errors are still reported. */
+    string bad = "a\"b,c\n";
+    ML::Parse_Context context2("test", bad.c_str(),
+                               bad.c_str() + bad.size());
+    BOOST_CHECK_THROW(expect_csv_row(context2, fields, storage),
+                      std::exception);
+}
+
+BOOST_AUTO_TEST_CASE( test_float_parsing_buffer )
+{
+    /* Parsing out of the buffer must give exactly the same answer as
+       parsing character by character (which happens with a chunk size of
+       one). */
+    vector<string> numbers = {
+        "0", "1", "-1", "+1.5", "3.14159", ".5", "5.", "1e10", "1E-5",
+        "1e+5", "2.5e", "1.2.3", "12345678901234567890",
+        "0.1234567890123456789", "nan", "-NaN", "inf", "-inf", "abc",
+        "-", "1e99999999999" };
+
+    for (auto & n: numbers) {
+        string text = n + " ";
+
+        ML::Parse_Context context1("test", text.c_str(),
+                                   text.c_str() + text.size());
+        istringstream stream(text);
+        ML::Parse_Context context2("test", stream, 1, 1, 1);
+
+        double d1 = 0.0, d2 = 0.0;
+        bool matched1 = match_float(d1, context1);
+        bool matched2 = match_float(d2, context2);
+
+        BOOST_CHECK_EQUAL(matched1, matched2);
+        BOOST_CHECK_EQUAL(context1.get_offset(), context2.get_offset());
+        if (matched1 && matched2 && !isnan(d1))
+            BOOST_CHECK_EQUAL(d1, d2);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_csv_parsing )
+{
+    /* 100 numeric columns */
+    string text;
+    for (unsigned i = 0;  i < 20000;  ++i) {
+        for (unsigned j = 0;  j < 100;  ++j) {
+            if (j != 0) text += ',';
+            text += format("%.4f", (i * 100 + j) * 0.001);
+        }
+        text += '\n';
+    }
+
+    double total = 0.0, total2 = 0.0;
+    int unmatched = 0;
+
+    uint64_t before = ticks();
+    {
+        ML::Parse_Context context("test", text.c_str(),
+                                  text.c_str() + text.size());
+        while (context) {
+            vector<string> row = expect_csv_row(context);
+            for (unsigned i = 0;  i < row.size();  ++i)
+                total += atof(row[i].c_str());
+        }
+    }
+    double strings_ticks = ticks() - before;
+
+    before = ticks();
+    {
+        ML::Parse_Context context("test", text.c_str(),
+                                  text.c_str() + text.size());
+        vector<Csv_Field> fields;
+        string storage;
+        while (context) {
+            expect_csv_row(context, fields, storage);
+            for (unsigned i = 0;  i < fields.size();  ++i) {
+                float f;
+                if (fields[i].match_float(f)) total2 += f;
+                else ++unmatched;
+            }
+        }
+    }
+    double views_ticks = ticks() - before;
+
+    BOOST_CHECK_EQUAL(unmatched, 0);
+    BOOST_CHECK_CLOSE(total, total2, 0.001);
+
+    double mb = text.size() / 1000000.0;
+    cerr << format("%.1fMB: strings %.1fMB/s, views %.1fMB/s",
+                   mb, mb / (strings_ticks * seconds_per_tick),
+                   mb / (views_ticks * seconds_per_tick))
+         << endl;
+}
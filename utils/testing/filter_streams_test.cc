@@ -26,6 +26,7 @@
 #include "jml/utils/guard.h"
 #include "jml/arch/exception_handler.h"
 #include "jml/arch/demangle.h"
+#include "jml/arch/format.h"
 
 using namespace std;
 namespace fs = boost::filesystem;
@@ -374,3 +375,68 @@ BOOST_AUTO_TEST_CASE( test_mem_scheme_in )
     BOOST_CHECK_EQUAL(text, result);
 }
 #endif
+
+/* ensures that compressing with several threads gives a standard stream
+   that reads back the same, both with one and several threads */
+BOOST_AUTO_TEST_CASE( test_parallel_compression )
+{
+    string text;
+    for (unsigned i = 0;  text.size() < 10000000;  ++i)
+        text += format("line %d value %d\n", i, (i * 7919) % 1000);
+
+    string fileprefix = format("/tmp/filter_streams_test-%d.", getpid());
+    vector<pair<string, string> > formats = {
+        { "gz", "gzip -dc" }, { "bz2", "bzip2 -dc" },
+        { "xz", "xz -dc" }, { "lz4", "" } };
+
+    for (const auto & f: formats) {
+        const string & ext = f.first;
+        BOOST_TEST_CHECKPOINT("compressing " + ext);
+        
+        string filename = fileprefix + ext;
+        FileCleanup cleanup(filename);
+
+        {
+            ML::filter_ostream stream(filename,
+                                      { { "compressionThreads", "4" } });
+            stream << text;
+        }
+
+        for (int threads: { 1, 4 }) {
+            BOOST_TEST_CHECKPOINT("decompressing " + ext + " with "
+                                  + to_string(threads));
+            ML::filter_istream stream(filename,
+                                      { { "compressionThreads",
+                                          to_string(threads) } });
+            string result;
+            char buf[16384];
+            while (stream) {
+                stream.read(buf, 16384);
+                result.append(buf, stream.gcount());
+            }
+            BOOST_CHECK(result == text);
+        }
+
+        if (f.second != "") {
+            string decompressed = filename + ".out";
+            FileCleanup cleanup2(decompressed);
+            system(f.second + " " + filename + " > " + decompressed);
+            BOOST_CHECK_EQUAL(get_file_size(decompressed), text.size());
+        }
+    }
+
+    /* Empty streams are still valid */
+    for (const auto & f: formats) {
+        string filename = fileprefix + f.first;
+        FileCleanup cleanup(filename);
+        {
+            ML::filter_ostream stream(filename,
+                                      { { "compressionThreads", "4" } });
+        }
+        ML::filter_istream stream(filename,
+                                  { { "compressionThreads", "4" } });
+        string line;
+        stream >> line;
+        BOOST_CHECK_EQUAL(line.size(), 0);
+    }
+}
@@ -0,0 +1,179 @@
+/* ring_buffer_test.cc
+   Jeremy Barnes, 19 October 2026
+   Copyright (c) 2026 Jeremy Barnes.  All rights reserved.
+
+   Test of the ring buffers, plus a benchmark of the lock-free multiple
+   writer, multiple reader version against the single writer one.
+*/
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include "jml/utils/ring_buffer.h"
+#include "jml/arch/tick_counter.h"
+#include "jml/arch/format.h"
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace ML;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE( test_mwmr_single_thread )
+{
+    RingBufferMWMR<int> buffer(5);
+    BOOST_CHECK_EQUAL(buffer.size(), 8);
+
+    int val;
+    BOOST_CHECK(!buffer.couldPop());
+    BOOST_CHECK(!buffer.tryPop(val));
+
+    for (unsigned i = 0;  i < 8;  ++i)
+        BOOST_CHECK(buffer.tryPush(i));
+    BOOST_CHECK(!buffer.tryPush(8));
+    BOOST_CHECK(!buffer.tryPush(8, 0.01));
+    BOOST_CHECK(buffer.couldPop());
+
+    for (unsigned i = 0;  i < 8;  ++i) {
+        BOOST_CHECK(buffer.tryPop(val));
+        BOOST_CHECK_EQUAL(val, i);
+    }
+
+    BOOST_CHECK(!buffer.tryPop(val, 0.01));
+
+    /* Go around the ring a few times. */
+    for (unsigned i = 0;  i < 100;  ++i) {
+        buffer.push(i);
+        buffer.push(i + 1000);
+        BOOST_CHECK_EQUAL(buffer.pop(), i);
+        BOOST_CHECK_EQUAL(buffer.pop(), i + 1000);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_mwmr_multiple_threads )
+{
+    /* Small, so that the producers and consumers both have to wait. */
+    RingBufferMWMR<int> buffer(16);
+
+    int nwriters = 4, nreaders = 4, nitems = 50000;
+
+    vector<vector<int> > received(nreaders);
+
+    auto writeThread = [&] (int writer)
+        {
+            for (unsigned i = 0;  i < nitems;  ++i)
+                buffer.push(writer * nitems + i);
+        };
+
+    auto readThread = [&] (int reader)
+        {
+            for (;;) {
+                int val = buffer.pop();
+                if (val == -1) return;
+                received[reader].push_back(val);
+            }
+        };
+
+    vector<std::thread> writers, readers;
+    for (unsigned i = 0;  i < nreaders;  ++i)
+        readers.emplace_back(readThread, i);
+    for (unsigned i = 0;  i < nwriters;  ++i)
+        writers.emplace_back(writeThread, i);
+
+    for (auto & t: writers) t.join();
+    for (unsigned i = 0;  i < nreaders;  ++i)
+        buffer.push(-1);
+    for (auto & t: readers) t.join();
+
+    /* Everything was received exactly once, and each reader got the values
+       from each writer in the order they were written. */
+    vector<int> seen(nwriters * nitems);
+    for (unsigned i = 0;  i < nreaders;  ++i) {
+        vector<int> last(nwriters, -1);
+        for (int val: received[i]) {
+            BOOST_REQUIRE(val >= 0 && val < nwriters * nitems);
+            ++seen[val];
+            int writer = val / nitems;
+            BOOST_CHECK_LT(last[writer], val);
+            last[writer] = val;
+        }
+    }
+
+    int missing = 0, duplicated = 0;
+    for (unsigned i = 0;  i < seen.size();  ++i) {
+        missing += (seen[i] == 0);
+        duplicated += (seen[i] > 1);
+    }
+
+    BOOST_CHECK_EQUAL(missing, 0);
+    BOOST_CHECK_EQUAL(duplicated, 0);
+}
+
+/* Push nitems timestamps through the buffer and report the throughput and
+   the average time each one spent in the buffer. */
+template<typename Buffer>
+void benchmark(const std::string & name, int nwriters, int nreaders,
+               int nitems)
+{
+    Buffer buffer(1024);
+
+    std::atomic<int> nreceived(0);
+    std::atomic<uint64_t> totalLatency(0);
+
+    auto writeThread = [&] (int writer)
+        {
+            for (unsigned i = writer;  i < nitems;  i += nwriters)
+                buffer.push(ticks());
+        };
+
+    auto readThread = [&] ()
+        {
+            uint64_t latency = 0;
+            while (nreceived < nitems) {
+                uint64_t stamp;
+                if (!buffer.tryPop(stamp, 0.001)) continue;
+                latency += ticks() - stamp;
+                ++nreceived;
+            }
+            totalLatency += latency;
+        };
+
+    uint64_t before = ticks();
+
+    vector<std::thread> threads;
+    for (unsigned i = 0;  i < nreaders;  ++i)
+        threads.emplace_back(readThread);
+    for (unsigned i = 0;  i < nwriters;  ++i)
+        threads.emplace_back(writeThread, i);
+    for (auto & t: threads) t.join();
+
+    double elapsed = (ticks() - before) * seconds_per_tick;
+
+    BOOST_CHECK_EQUAL(nreceived, nitems);
+
+    cerr << format("%-6s %2d writers %2d readers: %10.0f items/s "
+                   "latency %8.2fus",
+                   name.c_str(), nwriters, nreaders, nitems / elapsed,
+                   totalLatency * seconds_per_tick / nitems * 1000000.0)
+         << endl;
+}
+
+BOOST_AUTO_TEST_CASE( benchmark_ring_buffers )
+{
+    int nitems = 20000;
+
+    for (int nthreads = 1;  nthreads <= 64;  nthreads *= 2) {
+        /* Single writer, which is all the SWMR buffer supports. */
+        benchmark<RingBufferSWMR<uint64_t> >
+            ("swmr", 1, nthreads, nitems);
+        benchmark<RingBufferMWMR<uint64_t> >
+            ("mwmr", 1, nthreads, nitems);
+
+        /* Several writers and several readers. */
+        if (nthreads > 1)
+            benchmark<RingBufferMWMR<uint64_t> >
+                ("mwmr", nthreads / 2, nthreads / 2, nitems);
+    }
+}
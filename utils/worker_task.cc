@@ -16,6 +16,7 @@
 #include "jml/utils/guard.h"
 #include <boost/bind.hpp>
 #include "jml/arch/cpu_info.h"
+#include "jml/arch/numa.h"
 
 
 using namespace std;
@@ -25,6 +26,18 @@ namespace ML {
 
 Env_Option<int> NUM_THREADS("NUM_THREADS", -1);
 Env_Option<int> DEBUG_LOGGING("DEBUG_LOGGING", 0);
+Env_Option<int> NUMA_PIN_THREADS("NUMA_PIN_THREADS", 0);
+
+namespace {
+
+/* NUMA node that the current worker thread is pinned to, or -1 if it
+   isn't pinned. */
+__thread int worker_numa_node = -1;
+
+/* How far down the job list to look for a job for our own node. */
+enum { NUMA_SCAN_JOBS = 64 };
+
+} // file scope
 
 int num_threads()
 {
@@ -72,9 +85,16 @@ Worker_Task(int threads)
 
     //cerr << "creating worker task with " << threads << " threads" << endl;
 
+    bool pin = NUMA_PIN_THREADS && numa_nodes() > 1;
+
     /* Create our threads */
-    for (unsigned i = 0;  i < threads;  ++i)
-        workerThreads_.emplace_back(new std::thread(std::bind(&Worker_Task::runWorkerThread, this)));
+    for (unsigned i = 0;  i < threads;  ++i) {
+        if (pin) {
+            int node = numa_partition_node(i, threads);
+            workerThreads_.emplace_back(new std::thread(std::bind(&Worker_Task::runPinnedWorkerThread, this, node)));
+        }
+        else workerThreads_.emplace_back(new std::thread(std::bind(&Worker_Task::runWorkerThread, this)));
+    }
 }
 
 Worker_Task::
@@ -157,11 +177,12 @@ void Worker_Task::unlock_group(int group)
 
 Worker_Task::Id
 Worker_Task::
-add(const Job & job, const Job & error, const std::string & job_info, Id group)
+add(const Job & job, const Job & error, const std::string & job_info, Id group,
+    int node)
 {
     /* Wait to manupulate */
     Guard guard(lock);
-    Job_Info info(job, error, job_info, next_job++, group);
+    Job_Info info(job, error, job_info, next_job++, group, node);
 
     /* Find where to put it. */
 
@@ -196,9 +217,9 @@ add(const Job & job, const Job & error, const std::string & job_info, Id group)
 
 Worker_Task::Id
 Worker_Task::
-add(const Job & job, const std::string & job_info, Id group)
+add(const Job & job, const std::string & job_info, Id group, int node)
 {
-    return add(job, Job(), job_info, group);
+    return add(job, Job(), job_info, group, node);
 }
 
 void Worker_Task::finish_all()
@@ -284,6 +305,16 @@ int Worker_Task::runWorkerThread()
     return 0;
 }
 
+int Worker_Task::runPinnedWorkerThread(int node)
+{
+    if (numa_pin_thread(node))
+        worker_numa_node = node;
+    else cerr << "warning: couldn't pin worker thread to NUMA node "
+              << node << endl;
+
+    return runWorkerThread();
+}
+
 void Worker_Task::notify_state_changed()
 {
     // must be called with the lock held
@@ -715,6 +746,8 @@ get_job_impl_ul(int group)
         if (it == jobs.end())
             throw Exception("get_job(): internal error: "
                             "semaphore acquired with zero jobs");
+
+        it = prefer_local_ul(it, jobs.end(), group);
     }
     else {
         map<Id, Group_Info>::const_iterator group_it
@@ -739,6 +772,8 @@ get_job_impl_ul(int group)
            so that we make some progress. */
         if (it == group_it->second.group_job || !in_group(*it, group))
             return get_job_impl_ul(-1);
+
+        it = prefer_local_ul(it, group_it->second.group_job, group);
     }
     
     Job_Info result = *it;
@@ -754,6 +789,27 @@ get_job_impl_ul(int group)
     return result;
 }
 
+Worker_Task::Jobs::iterator
+Worker_Task::
+prefer_local_ul(Jobs::iterator it, Jobs::iterator end, int group)
+{
+    if (it->node == -1 || numa_nodes() == 1) return it;
+
+    int node = worker_numa_node;
+    if (node == -1) node = numa_current_node();
+
+    if (it->node == node) return it;
+
+    Jobs::iterator jt = it;
+    for (unsigned i = 0;  i < NUMA_SCAN_JOBS && jt != end;  ++jt, ++i) {
+        if (jt->id == -1) continue;
+        if (group != -1 && !in_group(*jt, group)) continue;
+        if (jt->node == node) return jt;
+    }
+
+    return it;
+}
+
 void
 Worker_Task::
 finish_job(const Job_Info & info)
@@ -54,6 +54,12 @@ int num_threads();
    as small as possible.
 
    It works multithreaded, and deals with all locking and unlocking.
+
+   On NUMA machines, setting the NUMA_PIN_THREADS environment variable to
+   1 pins the worker threads to the nodes, spread evenly.  Jobs can be
+   added with a hint for the node that holds their data; a thread will
+   then prefer a nearby job for its own node over the first job in the
+   list (but will never go idle while there is other work).
 */
 
 class Worker_Task {
@@ -119,12 +125,14 @@ private:
         an error, the error job will be called.
     */
     Id add(const Job & job, const Job & error,
-           const std::string & info, Id group = -1);
+           const std::string & info, Id group = -1, int node = -1);
 public:
 
     /** Add a job that belongs to the given group.  Jobs which are scheduled into
-        the same group will be scheduled together. */
-    Id add(const Job & job, const std::string & info, Id group = -1);
+        the same group will be scheduled together.  If node is not -1, then
+        threads running on that NUMA node will prefer to run the job. */
+    Id add(const Job & job, const std::string & info, Id group = -1,
+           int node = -1);
 
     /** Check if a group is finished, and if so call its finish job. */
     bool check_finished(Id group);
@@ -173,6 +181,9 @@ public:
     int runWorkerThread();
 
 private:
+    /** Pin the thread to the given node and then run as a worker. */
+    int runPinnedWorkerThread(int node);
+
     int threads_;
 
     std::vector<std::unique_ptr<std::thread> > workerThreads_;
@@ -182,15 +193,17 @@ private:
     typedef std::list<Job_Info> Jobs;
     
     struct Job_Info {
-        Job_Info() : id(-1), group(-1) {}
+        Job_Info() : id(-1), group(-1), node(-1) {}
         Job_Info(const Job & job, const Job & error,
-                 const std::string & info, Id id, Id group = -1)
-            : job(job), error(error), id(id), group(group),
+                 const std::string & info, Id id, Id group = -1,
+                 int node = -1)
+            : job(job), error(error), id(id), group(group), node(node),
               invalidGroup(false), info(info) {}
         Job job;
         Job error;
         Id id;    // if -1, this is a group end marker
         Id group;
+        int node; // NUMA node that the job would like to run on, or -1
         bool invalidGroup; // true is group has error set
         std::string info;
         void dump(std::ostream & stream, int indent = 0) const;
@@ -230,6 +243,12 @@ private:
     /** Unlocked implementation of the get_job methods.  Requires that the
         jobs_sem be acquired and that the lock already be held. */
     Job_Info get_job_impl_ul(int group);
+
+    /** Given the job that would normally be run next, look a little further
+        down the list for one that wants to run on the calling thread's NUMA
+        node.  Lock must already be held. */
+    Jobs::iterator prefer_local_ul(Jobs::iterator it, Jobs::iterator end,
+                                   int group);
     
     void finish_job(const Job_Info & info);
 